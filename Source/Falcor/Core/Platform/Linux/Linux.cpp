@@ -26,6 +26,8 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "stdafx.h"
+#include <pwd.h>
+#include <unistd.h>
 // #include "Utils/StringUtils.h"
 // #include "Utils/Platform/OS.h"
 // #include "Utils/Logger.h"
@@ -208,8 +210,27 @@ namespace Falcor
 
     const std::filesystem::path& getAppDataDirectory()
     {
-        FALCOR_ASSERT(0);
-        static std::filesystem::path path;
+        static const std::filesystem::path path = []()
+        {
+            // Falcor only stores caches in the application data directory, so we follow the XDG base directory
+            // specification for cache data. FALCOR_APP_DATA_DIR takes precedence, e.g. to use a node-local disk.
+            std::string value;
+            if (getEnvironmentVariable("FALCOR_APP_DATA_DIR", value) && !value.empty())
+            {
+                return std::filesystem::path(value);
+            }
+            if (getEnvironmentVariable("XDG_CACHE_HOME", value) && std::filesystem::path(value).is_absolute())
+            {
+                return std::filesystem::path(value);
+            }
+            if (!getEnvironmentVariable("HOME", value) || value.empty())
+            {
+                const passwd* pw = getpwuid(getuid());
+                if (!pw || !pw->pw_dir) throw RuntimeError("Failed to get the application data directory.");
+                value = pw->pw_dir;
+            }
+            return std::filesystem::path(value) / ".cache";
+        }();
         return path;
     }
 
@@ -220,8 +241,7 @@ namespace Falcor
         {
             return false;
         }
-        static std::string strvar(val);
-        value = strvar;
+        value = val;
         return true;
     }
 
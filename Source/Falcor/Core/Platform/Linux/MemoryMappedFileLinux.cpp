@@ -0,0 +1,85 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Falcor
+{
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (mpData) munmap(const_cast<uint8_t*>(mpData), mSize);
+    }
+
+    MemoryMappedFile::SharedPtr MemoryMappedFile::create(const std::filesystem::path& path)
+    {
+        SharedPtr pFile = SharedPtr(new MemoryMappedFile());
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw RuntimeError("Failed to open file '{}' for memory mapping.", path);
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw RuntimeError("Failed to query size of file '{}'.", path);
+        }
+        pFile->mSize = (size_t)st.st_size;
+
+        if (pFile->mSize > 0)
+        {
+            void* pData = mmap(nullptr, pFile->mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (pData == MAP_FAILED)
+            {
+                close(fd);
+                throw RuntimeError("Failed to map file '{}'.", path);
+            }
+            pFile->mpData = static_cast<const uint8_t*>(pData);
+        }
+
+        // The mapping keeps its own reference to the file.
+        close(fd);
+
+        return pFile;
+    }
+
+    void MemoryMappedFile::prefetch(size_t offset, size_t size) const
+    {
+        if (!mpData || offset >= mSize) return;
+
+        // madvise requires a page aligned start address.
+        const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        size_t begin = offset & ~(pageSize - 1);
+        size_t end = std::min(offset + size, mSize);
+        madvise(const_cast<uint8_t*>(mpData + begin), end - begin, MADV_WILLNEED);
+    }
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <filesystem>
+
+namespace Falcor
+{
+    /** Read-only memory mapping of a file.
+        The file contents are paged in on demand by the OS, which avoids an intermediate copy through a stream buffer.
+        The mapping stays valid for the lifetime of the object.
+    */
+    class FALCOR_API MemoryMappedFile
+    {
+    public:
+        using SharedPtr = std::shared_ptr<MemoryMappedFile>;
+        ~MemoryMappedFile();
+
+        /** Map a file into memory.
+            Throws a RuntimeError if the file cannot be opened or mapped.
+            \param[in] path File path.
+            \return Returns the mapped file.
+        */
+        static SharedPtr create(const std::filesystem::path& path);
+
+        /** Get a pointer to the start of the mapped file. Returns nullptr for empty files.
+        */
+        const uint8_t* getData() const { return mpData; }
+
+        /** Get the size of the mapped file in bytes.
+        */
+        size_t getSize() const { return mSize; }
+
+        /** Hint the OS that a range of the file will be accessed soon.
+            This lets the OS issue large sequential reads instead of faulting in one page at a time.
+            \param[in] offset Offset in bytes.
+            \param[in] size Size in bytes.
+        */
+        void prefetch(size_t offset, size_t size) const;
+
+    private:
+        MemoryMappedFile() = default;
+
+        const uint8_t* mpData = nullptr;
+        size_t mSize = 0;
+        void* mFileHandle = nullptr;        ///< Platform file handle (Windows only).
+        void* mMappingHandle = nullptr;     ///< Platform file mapping handle (Windows only).
+    };
+}
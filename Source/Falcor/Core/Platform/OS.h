@@ -251,6 +251,8 @@ namespace Falcor
     FALCOR_API const std::string& getExecutableName();
 
     /** Get the application data directory.
+        This is the local application data folder on Windows and the XDG cache directory ($XDG_CACHE_HOME or ~/.cache) on Linux.
+        The FALCOR_APP_DATA_DIR environment variable overrides the default location on all platforms.
     */
     FALCOR_API const std::filesystem::path& getAppDataDirectory();
 
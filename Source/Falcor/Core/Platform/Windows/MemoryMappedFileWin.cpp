@@ -0,0 +1,71 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+namespace Falcor
+{
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (mpData) UnmapViewOfFile(mpData);
+        if (mMappingHandle) CloseHandle((HANDLE)mMappingHandle);
+        if (mFileHandle) CloseHandle((HANDLE)mFileHandle);
+    }
+
+    MemoryMappedFile::SharedPtr MemoryMappedFile::create(const std::filesystem::path& path)
+    {
+        SharedPtr pFile = SharedPtr(new MemoryMappedFile());
+
+        HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE) throw RuntimeError("Failed to open file '{}' for memory mapping.", path);
+        pFile->mFileHandle = hFile;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(hFile, &size)) throw RuntimeError("Failed to query size of file '{}'.", path);
+        pFile->mSize = (size_t)size.QuadPart;
+        if (pFile->mSize == 0) return pFile;
+
+        HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!hMapping) throw RuntimeError("Failed to create file mapping for '{}'.", path);
+        pFile->mMappingHandle = hMapping;
+
+        pFile->mpData = static_cast<const uint8_t*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+        if (!pFile->mpData) throw RuntimeError("Failed to map view of file '{}'.", path);
+
+        return pFile;
+    }
+
+    void MemoryMappedFile::prefetch(size_t offset, size_t size) const
+    {
+        if (!mpData || offset >= mSize) return;
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(mpData + offset);
+        range.NumberOfBytes = std::min(size, mSize - offset);
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+}
@@ -315,6 +315,14 @@ namespace Falcor
         static std::filesystem::path path;
         if (path.empty())
         {
+            // FALCOR_APP_DATA_DIR takes precedence, e.g. to use a node-local disk.
+            std::string value;
+            if (getEnvironmentVariable("FALCOR_APP_DATA_DIR", value) && !value.empty())
+            {
+                path = value;
+                return path;
+            }
+
             PWSTR pathStr;
             if (!SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &pathStr)))
             {
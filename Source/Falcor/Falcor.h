@@ -66,6 +66,7 @@
 #include "Core/BufferTypes/VariablesBufferUI.h"
 
 // Core/Platform
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Core/Platform/OS.h"
 #include "Core/Platform/ProgressBar.h"
 
@@ -116,7 +117,9 @@
 // Utils
 #include "Utils/Math/AABB.h"
 #include "Utils/BinaryFileStream.h"
+#include "Utils/BlockCompressedStream.h"
 #include "Utils/CryptoUtils.h"
+#include "Utils/DiskCache.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
 #include "Utils/StringUtils.h"
@@ -128,6 +131,7 @@
 #include "Utils/Image/Bitmap.h"
 #include "Utils/Image/ImageIO.h"
 #include "Utils/Image/TextureManager.h"
+#include "Utils/Image/TextureCache.h"
 #include "Utils/Image/ImageProcessing.h"
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/FalcorMath.h"
@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "Animation.h"
 #include "AnimatedVertexCache.h"
+#include "CpuVertexAnimation.h"
 
 namespace Falcor
 {
@@ -37,67 +38,70 @@ namespace Falcor
         const std::string kUpdateCurveAABBsFilename = "Scene/Animation/UpdateCurveAABBs.slang";
         const std::string kUpdateCurvePolyTubeVerticesFilename = "Scene/Animation/UpdateCurvePolyTubeVertices.slang";
 
-        InterpolationInfo calculateInterpolation(double time, const std::vector<double>& timeSamples, Animation::Behavior preInfinityBehavior, Animation::Behavior postInfinityBehavior)
+        std::vector<double> getCurveKeyframeTimes(const std::vector<CachedCurve>& cachedCurves)
         {
-            if (!std::isfinite(time))
+            std::vector<double> keyframeTimes;
+            for (const auto& cache : cachedCurves)
             {
-                return InterpolationInfo{ uint2(0), 0.f };
+                keyframeTimes.insert(keyframeTimes.end(), cache.timeSamples.begin(), cache.timeSamples.end());
             }
+            std::sort(keyframeTimes.begin(), keyframeTimes.end());
+            keyframeTimes.erase(std::unique(keyframeTimes.begin(), keyframeTimes.end()), keyframeTimes.end());
+            return keyframeTimes;
+        }
 
-            // Clamp to positive
-            time = std::max(time, 0.0);
-
-            // Post-Infinity Behavior
-            if (time > timeSamples.back())
+        /** Build the vertices of all curves with the given tessellation mode at a merged curve keyframe.
+            Curves without a time sample at the keyframe are linearly interpolated.
+        */
+        std::vector<DynamicCurveVertexData> buildCurveKeyframe(const std::vector<CachedCurve>& cachedCurves, const std::vector<double>& keyframeTimes, CurveTessellationMode tessellationMode, uint32_t keyframe)
+        {
+            size_t vertexCount = 0;
+            for (const auto& cache : cachedCurves)
             {
-                if (postInfinityBehavior == Animation::Behavior::Constant)
-                {
-                    time = timeSamples.back();
-                }
-                else if (postInfinityBehavior == Animation::Behavior::Cycle)
-                {
-                    time = std::fmod(time, timeSamples.back());
-                }
+                if (cache.tessellationMode == tessellationMode) vertexCount += cache.vertexData[0].size();
             }
 
-            uint2 keyframeIndices;
-            float t = 0.0f;
+            std::vector<DynamicCurveVertexData> vertices(vertexCount);
+            const double time = keyframeTimes[keyframe];
 
-            // Pre-Infinity Behavior
-            if (time <= timeSamples.front())
+            size_t offset = 0;
+            for (const auto& cache : cachedCurves)
             {
-                if (preInfinityBehavior == Animation::Behavior::Constant)
+                if (cache.tessellationMode != tessellationMode) continue;
+
+                const auto& timeSamples = cache.timeSamples;
+                const size_t cacheVertexCount = cache.vertexData[0].size();
+
+                // Find the first time sample at or after the keyframe, or the last one.
+                size_t k = std::lower_bound(timeSamples.begin(), timeSamples.end(), time) - timeSamples.begin();
+                k = std::min(k, timeSamples.size() - 1);
+
+                if (timeSamples[k] == time || k == 0)
                 {
-                    keyframeIndices = uint2(0);
-                    t = 0.f;
+                    std::copy(cache.vertexData[k].begin(), cache.vertexData[k].end(), vertices.begin() + offset);
                 }
-                else if (preInfinityBehavior == Animation::Behavior::Cycle)
+                else
                 {
-                    keyframeIndices.x = (uint32_t)timeSamples.size() - 1;
-                    keyframeIndices.y = 0;
-
-                    // The first keyframe has timeCode >= 1 (see processCurve() in ImporterContext.cpp).
-                    FALCOR_ASSERT(timeSamples.front() >= 1.0);
-                    t = (float)(time / timeSamples.front());
+                    // Linearly interpolate at the missing keyframe.
+                    float t = float((time - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
+                    for (size_t p = 0; p < cacheVertexCount; p++)
+                    {
+                        vertices[offset + p].position = lerp(cache.vertexData[k - 1][p].position, cache.vertexData[k][p].position, t);
+                    }
                 }
-            }
-            // Regular Interpolation
-            else
-            {
-                keyframeIndices.y = uint32_t(std::lower_bound(timeSamples.begin(), timeSamples.end(), time) - timeSamples.begin());
-                keyframeIndices.x = keyframeIndices.y - 1;
-                FALCOR_ASSERT(timeSamples[keyframeIndices.y] > timeSamples[keyframeIndices.x]);
-                t = (float)((time - timeSamples[keyframeIndices.x]) / (timeSamples[keyframeIndices.y] - timeSamples[keyframeIndices.x]));
+
+                offset += cacheVertexCount;
             }
 
-            return InterpolationInfo{ keyframeIndices, t };
+            return vertices;
         }
     }
 
-    AnimatedVertexCache::AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes,
+        const VertexCacheStreamingSettings* pStreamingSettings, const KeyframeFile::SharedPtr& pKeyframeFile)
         : mpScene(pScene)
-        , mCachedCurves(cachedCurves)
-        , mCachedMeshes(cachedMeshes)
+        , mCachedCurves(std::move(cachedCurves))
+        , mCachedMeshes(std::move(cachedMeshes))
         , mpPrevVertexData(pPrevVertexData)
     {
         if (mCachedCurves.empty() && mCachedMeshes.empty()) return;
@@ -111,7 +115,17 @@ namespace Falcor
             }
 
             initCurveKeyframes();
+        }
 
+        if (!mCachedMeshes.empty())
+        {
+            initMeshKeyframes();
+        }
+
+        if (pStreamingSettings) initStreaming(*pStreamingSettings, pKeyframeFile);
+
+        if (!mCachedCurves.empty())
+        {
             if (mCurveLSSCount > 0)
             {
                 bindCurveLSSBuffers();
@@ -128,42 +142,89 @@ namespace Falcor
 
         if (!mCachedMeshes.empty())
         {
-            initMeshKeyframes();
             initMeshBuffers();
 
             createMeshVertexUpdatePass();
         }
+
+        // The keyframes are read from the keyframe file, release the host copy.
+        if (isStreaming())
+        {
+            if (mKeyframeChunkCount != mpKeyframeFile->getChunkCount()) throw RuntimeError("Keyframe file does not match the vertex caches.");
+
+            for (auto& cache : mCachedCurves)
+            {
+                cache.vertexData.clear();
+                cache.vertexData.shrink_to_fit();
+            }
+            for (auto& cache : mCachedMeshes)
+            {
+                cache.vertexData.clear();
+                cache.vertexData.shrink_to_fit();
+            }
+        }
     }
 
-    AnimatedVertexCache::UniquePtr AnimatedVertexCache::create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes)
+    AnimatedVertexCache::UniquePtr AnimatedVertexCache::create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes,
+        const VertexCacheStreamingSettings* pStreamingSettings, const KeyframeFile::SharedPtr& pKeyframeFile)
     {
-        return UniquePtr(new AnimatedVertexCache(pScene, pPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes)));
+        return UniquePtr(new AnimatedVertexCache(pScene, pPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes), pStreamingSettings, pKeyframeFile));
+    }
+
+    void AnimatedVertexCache::writeKeyframes(KeyframeFile& file, const std::vector<CachedCurve>& cachedCurves, const std::vector<CachedMesh>& cachedMeshes)
+    {
+        // The chunks are written in the order in which the keyframe streams are created:
+        // the merged curve keyframes of each tessellation mode, followed by the keyframes of each mesh.
+        const auto curveKeyframeTimes = getCurveKeyframeTimes(cachedCurves);
+        for (auto tessellationMode : { CurveTessellationMode::LinearSweptSphere, CurveTessellationMode::PolyTube })
+        {
+            bool hasCurves = std::any_of(cachedCurves.begin(), cachedCurves.end(), [tessellationMode](const CachedCurve& cache) { return cache.tessellationMode == tessellationMode; });
+            if (!hasCurves) continue;
+
+            for (uint32_t j = 0; j < (uint32_t)curveKeyframeTimes.size(); j++)
+            {
+                auto vertices = buildCurveKeyframe(cachedCurves, curveKeyframeTimes, tessellationMode, j);
+                file.addChunk(vertices.data(), vertices.size() * sizeof(DynamicCurveVertexData));
+            }
+        }
+
+        for (const auto& cache : cachedMeshes)
+        {
+            for (const auto& vertexData : cache.vertexData) file.addChunk(vertexData.data(), vertexData.size() * sizeof(PackedStaticVertexData));
+        }
     }
 
     bool AnimatedVertexCache::animate(RenderContext* pRenderContext, double time)
     {
         if (!hasAnimations()) return false;
 
+        const bool forward = time >= mPrevAnimateTime;
+        mPrevAnimateTime = time;
+
         if (!mCachedCurves.empty())
         {
             double curveTime = mLoopAnimations ? std::fmod(time, mGlobalCurveAnimationLength) : time;
-            InterpolationInfo interpolationInfo = calculateInterpolation(curveTime, mCurveKeyframeTimes, mPreInfinityBehavior, Animation::Behavior::Constant);
+            InterpolationInfo interpolationInfo = CpuVertexAnimation::calculateInterpolation(curveTime, mCurveKeyframeTimes, mPreInfinityBehavior, Animation::Behavior::Constant);
 
             if (mCurveLSSCount > 0)
             {
-                executeCurveLSSVertexUpdatePass(pRenderContext, interpolationInfo);
+                InterpolationInfo info = interpolationInfo;
+                if (mpCurveKeyframeStream) info.keyframeIndices = mpCurveKeyframeStream->acquire(info.keyframeIndices, forward, mLoopAnimations);
+                executeCurveLSSVertexUpdatePass(pRenderContext, info);
                 executeCurveLSSAABBUpdatePass(pRenderContext);
             }
 
             if (mCurvePolyTubeCount > 0)
             {
-                executeCurvePolyTubeVertexUpdatePass(pRenderContext, interpolationInfo);
+                InterpolationInfo info = interpolationInfo;
+                if (mpCurvePolyTubeKeyframeStream) info.keyframeIndices = mpCurvePolyTubeKeyframeStream->acquire(info.keyframeIndices, forward, mLoopAnimations);
+                executeCurvePolyTubeVertexUpdatePass(pRenderContext, info);
             }
         }
 
         if (!mCachedMeshes.empty())
         {
-            executeMeshVertexUpdatePass(pRenderContext, time);
+            executeMeshVertexUpdatePass(pRenderContext, time, forward);
         }
 
         return true;
@@ -174,7 +235,7 @@ namespace Falcor
         executeCurveLSSVertexUpdatePass(pRenderContext, InterpolationInfo{ uint2(0), 0.f }, true);
         executeCurvePolyTubeVertexUpdatePass(pRenderContext, InterpolationInfo{ uint2(0), 0.f }, true);
 
-        executeMeshVertexUpdatePass(pRenderContext, 0.0f, true);
+        executeMeshVertexUpdatePass(pRenderContext, 0.0f, true, true);
     }
 
     bool AnimatedVertexCache::hasAnimations() const
@@ -194,21 +255,74 @@ namespace Falcor
         return m;
     }
 
+    KeyframeStream::Stats AnimatedVertexCache::getStreamingStats() const
+    {
+        KeyframeStream::Stats stats;
+        for (const auto& pStream : mMeshKeyframeStreams) stats += pStream->getStats();
+        if (mpCurveKeyframeStream) stats += mpCurveKeyframeStream->getStats();
+        if (mpCurvePolyTubeKeyframeStream) stats += mpCurvePolyTubeKeyframeStream->getStats();
+        return stats;
+    }
+
     // We create a merged list of all timestamps and generate new frames for curves where those timestamps are missing.
     // This can lead to fairly heavy overhead if we have cached curves with vastly different total length.
     // Currently, our assets have cached curves with the same list of timestamps.
     void AnimatedVertexCache::initCurveKeyframes()
     {
         // Align the time samples across vertex caches.
-        mCurveKeyframeTimes.clear();
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
+        mCurveKeyframeTimes = getCurveKeyframeTimes(mCachedCurves);
+
+        mGlobalCurveAnimationLength = mCurveKeyframeTimes.empty() ? 0 : mCurveKeyframeTimes.back();
+    }
+
+    void AnimatedVertexCache::initStreaming(const VertexCacheStreamingSettings& settings, const KeyframeFile::SharedPtr& pKeyframeFile)
+    {
+        // Each vertex cache keeps the same number of keyframes resident, so the budget is divided by the size of one keyframe of all caches.
+        uint64_t keyframeSize = 0;
+        uint32_t maxKeyframeCount = 2;
+        for (const auto& cache : mCachedMeshes)
         {
-            mCurveKeyframeTimes.insert(mCurveKeyframeTimes.end(), mCachedCurves[i].timeSamples.begin(), mCachedCurves[i].timeSamples.end());
+            keyframeSize += cache.vertexData.front().size() * sizeof(PackedStaticVertexData);
+            maxKeyframeCount = std::max(maxKeyframeCount, (uint32_t)cache.timeSamples.size());
+        }
+        for (const auto& cache : mCachedCurves)
+        {
+            keyframeSize += cache.vertexData.front().size() * sizeof(DynamicCurveVertexData);
+            maxKeyframeCount = std::max(maxKeyframeCount, (uint32_t)mCurveKeyframeTimes.size());
         }
-        std::sort(mCurveKeyframeTimes.begin(), mCurveKeyframeTimes.end());
-        mCurveKeyframeTimes.erase(std::unique(mCurveKeyframeTimes.begin(), mCurveKeyframeTimes.end()), mCurveKeyframeTimes.end());
 
-        mGlobalCurveAnimationLength = mCurveKeyframeTimes.empty() ? 0 : mCurveKeyframeTimes.back();
+        uint64_t slotCount = keyframeSize > 0 ? settings.memoryBudget / keyframeSize : maxKeyframeCount;
+        if (slotCount < 2)
+        {
+            logWarning("Vertex cache streaming memory budget ({}) is smaller than two keyframes of all vertex caches ({}). Keeping two keyframes resident.",
+                formatByteSize(settings.memoryBudget), formatByteSize(2 * keyframeSize));
+        }
+        mStreamingSlotCount = (uint32_t)std::clamp<uint64_t>(slotCount, 2, maxKeyframeCount);
+
+        if (pKeyframeFile)
+        {
+            mpKeyframeFile = pKeyframeFile;
+        }
+        else
+        {
+            // Without a keyframe file from the scene cache, the keyframes are written to a scratch file.
+            mpKeyframeFile = KeyframeFile::create();
+            writeKeyframes(*mpKeyframeFile, mCachedCurves, mCachedMeshes);
+        }
+    }
+
+    std::vector<uint32_t> AnimatedVertexCache::getKeyframeChunks(uint32_t keyframeCount, size_t keyframeSize)
+    {
+        // The keyframe streams use consecutive chunks in the order written by writeKeyframes().
+        if (mKeyframeChunkCount + keyframeCount > mpKeyframeFile->getChunkCount()) throw RuntimeError("Keyframe file does not match the vertex caches.");
+
+        std::vector<uint32_t> chunkIDs(keyframeCount);
+        for (auto& chunkID : chunkIDs)
+        {
+            chunkID = mKeyframeChunkCount++;
+            if (mpKeyframeFile->getChunkSize(chunkID) != keyframeSize) throw RuntimeError("Keyframe file does not match the vertex caches.");
+        }
+        return chunkIDs;
     }
 
     void AnimatedVertexCache::bindCurveLSSBuffers()
@@ -224,64 +338,21 @@ namespace Falcor
             mCurveIndexCount += (uint32_t)mCachedCurves[i].indexData.size();
         }
 
-        // Create buffers for vertex positions in curve vertex caches.
-        ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurveVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
-        {
-            mpCurveVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
-            mpCurveVertexBuffers[i]->setName("AnimatedVertexCache::mpCurveVertexBuffers[" + std::to_string(i) + "]");
-        }
+        // Create and initialize buffers for vertex positions in curve vertex caches.
+        initCurveKeyframeBuffers(CurveTessellationMode::LinearSweptSphere, mCurveVertexCount, mpCurveVertexBuffers, mpCurveKeyframeStream, "AnimatedVertexCache::mpCurveVertexBuffers");
 
-        // Create buffers for previous vertex positions.
-        mpPrevCurveVertexBuffer = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+        // Create buffers for previous vertex positions and initialize it with positions at the first keyframe.
+        ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+        auto prevVertices = buildCurveKeyframe(mCachedCurves, mCurveKeyframeTimes, CurveTessellationMode::LinearSweptSphere, 0);
+        mpPrevCurveVertexBuffer = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurveVertexCount, vbBindFlags, Buffer::CpuAccess::None, prevVertices.data(), false);
         mpPrevCurveVertexBuffer->setName("AnimatedVertexCache::mpPrevCurveVertexBuffer");
 
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
-        {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::LinearSweptSphere) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurveVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurveVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            // Initialize it with positions at the first keyframe.
-            mpPrevCurveVertexBuffer->setBlob(mCachedCurves[i].vertexData[0].data(), offset, bufSize);
-
-            offset += bufSize;
-        }
-
         // Create curve index buffer.
-        vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurveIndexBuffer = Buffer::create(sizeof(uint32_t) * mCurveIndexCount, vbBindFlags);
         mpCurveIndexBuffer->setName("AnimatedVertexCache::mpCurveIndexBuffer");
 
         // Initialize index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         std::vector<uint32_t> indexData(mCurveIndexCount);
         for (uint32_t i = 0; i < (uint32_t)mCachedCurves.size(); i++)
         {
@@ -337,57 +408,16 @@ namespace Falcor
         mpCurvePolyTubeMeshMetadataBuffer = Buffer::createStructured(sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
         mpCurvePolyTubeMeshMetadataBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeMeshMetadataBuffer");
 
-        // Create buffers for vertex positions in curve vertex caches.
-        ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
-        mpCurvePolyTubeVertexBuffers.resize(mCurveKeyframeTimes.size());
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++)
-        {
-            mpCurvePolyTubeVertexBuffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), mCurvePolyTubeVertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
-            mpCurvePolyTubeVertexBuffers[i]->setName("AnimatedVertexCache::mpCurvePolyTubeVertexBuffers[" + std::to_string(i) + "]");
-        }
-
-        // Initialize vertex buffers with cached positions.
-        uint32_t offset = 0;
-        for (size_t i = 0; i < mCachedCurves.size(); i++)
-        {
-            if (mCachedCurves[i].tessellationMode != CurveTessellationMode::PolyTube) continue;
-
-            size_t vertexCount = mCachedCurves[i].vertexData[0].size();
-            uint32_t bufSize = uint32_t(vertexCount * sizeof(DynamicCurveVertexData));
-            uint32_t k = 0;
-            const auto& timeSamples = mCachedCurves[i].timeSamples;
-
-            for (uint32_t j = 0; j < mCurveKeyframeTimes.size(); j++)
-            {
-                while (k + 1 < timeSamples.size() && timeSamples[k] < mCurveKeyframeTimes[j]) k++;
-
-                if (timeSamples[k] == mCurveKeyframeTimes[j])
-                {
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(mCachedCurves[i].vertexData[k].data(), offset, bufSize);
-                }
-                else
-                {
-                    // Linearly interpolate at the missing keyframe.
-                    float t = float((mCurveKeyframeTimes[j] - timeSamples[k - 1]) / (timeSamples[k] - timeSamples[k - 1]));
-                    std::vector<DynamicCurveVertexData> interpVertices(vertexCount);
-                    for (size_t p = 0; p < vertexCount; p++)
-                    {
-                        interpVertices[p].position = lerp(mCachedCurves[i].vertexData[k - 1][p].position, mCachedCurves[i].vertexData[k][p].position, t);
-                    }
-                    mpCurvePolyTubeVertexBuffers[j]->setBlob(interpVertices.data(), offset, bufSize);
-                }
-            }
-
-            offset += bufSize;
-        }
+        // Create and initialize buffers for vertex positions in curve vertex caches.
+        initCurveKeyframeBuffers(CurveTessellationMode::PolyTube, mCurvePolyTubeVertexCount, mpCurvePolyTubeVertexBuffers, mpCurvePolyTubeKeyframeStream, "AnimatedVertexCache::mpCurvePolyTubeVertexBuffers");
 
         // Create curve strand index buffer.
-        vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+        ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
         mpCurvePolyTubeStrandIndexBuffer = Buffer::create(sizeof(uint32_t) * mCurvePolyTubeVertexCount, vbBindFlags);
         mpCurvePolyTubeStrandIndexBuffer->setName("AnimatedVertexCache::mpCurvePolyTubeStrandIndexBuffer");
 
         // Initialize strand index buffer.
-        offset = 0;
+        uint32_t offset = 0;
         const uint32_t strandLastVertexIndex = 0xffffffff;
         std::vector<uint32_t> strandIndexData(mCurvePolyTubeVertexCount);
         for (uint32_t i = 0; i < (uint32_t)mCachedCurves.size(); i++)
@@ -422,19 +452,50 @@ namespace Falcor
         mpCurvePolyTubeStrandIndexBuffer->setBlob(strandIndexData.data(), 0, mCurvePolyTubeVertexCount * sizeof(uint32_t));
     }
 
+    void AnimatedVertexCache::initCurveKeyframeBuffers(CurveTessellationMode tessellationMode, uint32_t vertexCount, std::vector<Buffer::SharedPtr>& buffers, std::unique_ptr<KeyframeStream>& pStream,
+        const std::string& name)
+    {
+        const uint32_t keyframeCount = (uint32_t)mCurveKeyframeTimes.size();
+        const uint32_t bufferCount = isStreaming() ? std::min(mStreamingSlotCount, keyframeCount) : keyframeCount;
+
+        ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess;
+        buffers.resize(bufferCount);
+        for (uint32_t i = 0; i < bufferCount; i++)
+        {
+            buffers[i] = Buffer::createStructured(sizeof(DynamicCurveVertexData), vertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
+            buffers[i]->setName(name + "[" + std::to_string(i) + "]");
+        }
+
+        if (isStreaming())
+        {
+            // The keyframes are uploaded to the buffers on demand.
+            auto chunkIDs = getKeyframeChunks(keyframeCount, vertexCount * sizeof(DynamicCurveVertexData));
+            pStream = std::make_unique<KeyframeStream>(mpKeyframeFile, std::move(chunkIDs), bufferCount, [&buffers](uint32_t slot, const void* pData, size_t size)
+            {
+                buffers[slot]->setBlob(pData, 0, size);
+            });
+        }
+        else
+        {
+            for (uint32_t j = 0; j < keyframeCount; j++)
+            {
+                auto vertices = buildCurveKeyframe(mCachedCurves, mCurveKeyframeTimes, tessellationMode, j);
+                buffers[j]->setBlob(vertices.data(), 0, vertices.size() * sizeof(DynamicCurveVertexData));
+            }
+        }
+    }
+
     void AnimatedVertexCache::initMeshKeyframes()
     {
         for (const auto& cache : mCachedMeshes)
         {
             mGlobalMeshAnimationLength = std::max(mGlobalMeshAnimationLength, cache.timeSamples.back());
-            mMeshKeyframeCount += (uint32_t)cache.timeSamples.size();
             mMaxMeshVertexCount = std::max((uint32_t)cache.vertexData.front().size(), mMaxMeshVertexCount);
         }
     }
 
     void AnimatedVertexCache::initMeshBuffers()
     {
-        mpMeshVertexBuffers.resize(mMeshKeyframeCount);
         std::vector<PerMeshMetadata> meshMetadata;
         meshMetadata.reserve(mCachedMeshes.size());
 
@@ -450,17 +511,30 @@ namespace Falcor
             meta.prevVbOffset = mpScene->getMesh(cache.meshID).prevVbOffset;
             meshMetadata.push_back(meta);
 
-            // Create vertex buffer for each keyframe on this mesh
-            for (size_t i = 0; i < cache.vertexData.size(); i++)
+            // Create vertex buffer for each keyframe on this mesh, or for each resident keyframe if streaming.
+            const uint32_t keyframeCount = (uint32_t)cache.timeSamples.size();
+            const uint32_t bufferCount = isStreaming() ? std::min(mStreamingSlotCount, keyframeCount) : keyframeCount;
+            for (uint32_t i = 0; i < bufferCount; i++)
             {
-                auto& data = cache.vertexData[i];
+                const void* pInitData = isStreaming() ? nullptr : cache.vertexData[i].data();
                 size_t index = keyframeOffset + i;
-                mpMeshVertexBuffers[index] = Buffer::createStructured(sizeof(PackedStaticVertexData), (uint32_t)data.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, data.data(), false);
+                mpMeshVertexBuffers.push_back(Buffer::createStructured(sizeof(PackedStaticVertexData), meta.vertexCount, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, pInitData, false));
                 mpMeshVertexBuffers[index]->setName("AnimatedVertexCache::mpMeshVertexBuffers[" + std::to_string(index) + "]");
             }
 
-            keyframeOffset += (uint32_t)cache.timeSamples.size();
+            if (isStreaming())
+            {
+                // The keyframes are uploaded to the buffers on demand.
+                auto chunkIDs = getKeyframeChunks(keyframeCount, meta.vertexCount * sizeof(PackedStaticVertexData));
+                mMeshKeyframeStreams.push_back(std::make_unique<KeyframeStream>(mpKeyframeFile, std::move(chunkIDs), bufferCount, [this, keyframeOffset](uint32_t slot, const void* pData, size_t size)
+                {
+                    mpMeshVertexBuffers[keyframeOffset + slot]->setBlob(pData, 0, size);
+                }));
+            }
+
+            keyframeOffset += bufferCount;
         }
+        mMeshKeyframeCount = keyframeOffset;
 
         mpMeshMetadataBuffer = Buffer::createStructured(sizeof(PerMeshMetadata), (uint32_t)meshMetadata.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, meshMetadata.data(), false);
         mpMeshMetadataBuffer->setName("AnimatedVertexCache::mpMeshMetadataBuffer");
@@ -493,14 +567,14 @@ namespace Falcor
         FALCOR_ASSERT(mCurveLSSCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mpCurveVertexBuffers.size()));
         mpCurveVertexUpdatePass = ComputePass::create(kUpdateCurveVerticesFilename, "main", defines);
 
         auto block = mpCurveVertexUpdatePass->getVars()["gCurveVertexUpdater"];
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
+        for (uint32_t i = 0; i < mpCurveVertexBuffers.size(); i++) var[i]["vertexData"] = mpCurveVertexBuffers[i];
     }
 
     void AnimatedVertexCache::createCurveLSSAABBUpdatePass()
@@ -518,7 +592,7 @@ namespace Falcor
         FALCOR_ASSERT(mCurvePolyTubeCount > 0);
 
         Program::DefineList defines;
-        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mCurveKeyframeTimes.size()));
+        defines.add("CURVE_KEYFRAME_COUNT", std::to_string(mpCurvePolyTubeVertexBuffers.size()));
         mpCurvePolyTubeVertexUpdatePass = ComputePass::create(kUpdateCurvePolyTubeVerticesFilename, "main", defines);
 
         auto block = mpCurvePolyTubeVertexUpdatePass->getVars()["gCurvePolyTubeVertexUpdater"];
@@ -528,23 +602,29 @@ namespace Falcor
         auto var = block["curvePerKeyframe"];
 
         // Bind curve vertex data.
-        for (uint32_t i = 0; i < mCurveKeyframeTimes.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
+        for (uint32_t i = 0; i < mpCurvePolyTubeVertexBuffers.size(); i++) var[i]["vertexData"] = mpCurvePolyTubeVertexBuffers[i];
     }
 
-    void AnimatedVertexCache::executeMeshVertexUpdatePass(RenderContext* pRenderContext, double t, bool copyPrev)
+    void AnimatedVertexCache::executeMeshVertexUpdatePass(RenderContext* pRenderContext, double t, bool forward, bool copyPrev)
     {
         if (!mpMeshVertexUpdatePass) return;
 
         FALCOR_PROFILE("update mesh vertices");
 
-        // Update interpolation
-        for (size_t i = 0; i < mMeshInterpolationInfo.size(); i++)
+        // Update interpolation. The interpolation info is not used when copying to the previous vertices.
+        if (!copyPrev)
         {
-            auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
-            mMeshInterpolationInfo[i] = calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior);
-        }
+            for (size_t i = 0; i < mMeshInterpolationInfo.size(); i++)
+            {
+                auto postInfinityBehavior = mLoopAnimations ? Animation::Behavior::Cycle : Animation::Behavior::Constant;
+                mMeshInterpolationInfo[i] = CpuVertexAnimation::calculateInterpolation(t, mCachedMeshes[i].timeSamples, mPreInfinityBehavior, postInfinityBehavior);
+
+                // Map keyframes to the buffers holding them.
+                if (isStreaming()) mMeshInterpolationInfo[i].keyframeIndices = mMeshKeyframeStreams[i]->acquire(mMeshInterpolationInfo[i].keyframeIndices, forward, mLoopAnimations);
+            }
 
-        mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
+            mpMeshInterpolationBuffer->setBlob(mMeshInterpolationInfo.data(), 0, mpMeshInterpolationBuffer->getSize());
+        }
 
         auto block = mpMeshVertexUpdatePass->getVars()["gMeshVertexUpdater"];
         block["sceneVertexData"] = mpScene->getMeshVao()->getVertexBuffer(Scene::kStaticDataBufferIndex);
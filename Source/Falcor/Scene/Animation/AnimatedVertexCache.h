@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Animation.h"
+#include "KeyframeStream.h"
 #include "RenderGraph/BasePasses/ComputePass.h"
 #include "Scene/Curves/CurveConfig.h"
 #include "Scene/SceneTypes.slang"
@@ -66,6 +67,13 @@ namespace Falcor
         std::vector<std::vector<PackedStaticVertexData>> vertexData;
     };
 
+    /** Settings for streaming vertex cache keyframes from disk, see SceneBuilder::Flags::StreamVertexCaches.
+    */
+    struct VertexCacheStreamingSettings
+    {
+        uint64_t memoryBudget = 256ull << 20;   ///< GPU memory budget in bytes for the resident keyframes of all vertex caches. At least two keyframes are kept resident regardless.
+    };
+
     class FALCOR_API AnimatedVertexCache
     {
     public:
@@ -73,7 +81,26 @@ namespace Falcor
         using UniqueConstPtr = std::unique_ptr<const AnimatedVertexCache>;
         ~AnimatedVertexCache() = default;
 
-        static UniquePtr create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        /** Create a new object.
+            \param[in] pScene The scene.
+            \param[in] pPrevVertexData Buffer holding the previous vertex positions. Owned by the AnimationController.
+            \param[in] cachedCurves Vertex caches of curves.
+            \param[in] cachedMeshes Vertex caches of meshes.
+            \param[in] pStreamingSettings Optional. If set, the keyframes are streamed from a file on disk through a ring of resident keyframes
+                        instead of keeping all keyframes in GPU memory.
+            \param[in] pKeyframeFile Optional. File holding the keyframes as written by writeKeyframes(), used when streaming.
+                        If null, the keyframes are written to a scratch file. The vertex caches then only need to hold the first keyframe.
+            \return A new object, or throws an exception if creation failed.
+        */
+        static UniquePtr create(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes,
+            const VertexCacheStreamingSettings* pStreamingSettings = nullptr, const KeyframeFile::SharedPtr& pKeyframeFile = nullptr);
+
+        /** Write the keyframes of vertex caches to a keyframe file in the layout used for streaming.
+            \param[in] file Keyframe file to append the keyframes to.
+            \param[in] cachedCurves Vertex caches of curves.
+            \param[in] cachedMeshes Vertex caches of meshes.
+        */
+        static void writeKeyframes(KeyframeFile& file, const std::vector<CachedCurve>& cachedCurves, const std::vector<CachedMesh>& cachedMeshes);
 
         void setIsLooped(bool looped) { mLoopAnimations = looped; }
 
@@ -97,13 +124,36 @@ namespace Falcor
 
         uint64_t getMemoryUsageInBytes() const;
 
+        /** Returns true if the keyframes are streamed from disk.
+        */
+        bool isStreaming() const { return mpKeyframeFile != nullptr; }
+
+        /** Get the accumulated keyframe streaming statistics of all vertex caches.
+        */
+        KeyframeStream::Stats getStreamingStats() const;
+
+        /** Get the size in bytes of the keyframe data stored on disk.
+        */
+        uint64_t getStreamedSizeInBytes() const { return mpKeyframeFile ? mpKeyframeFile->getSize() : 0; }
+
     private:
-        AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes);
+        AnimatedVertexCache(Scene* pScene, const Buffer::SharedPtr& pPrevVertexData, std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes,
+            const VertexCacheStreamingSettings* pStreamingSettings, const KeyframeFile::SharedPtr& pKeyframeFile);
 
         void initCurveKeyframes();
+        void initStreaming(const VertexCacheStreamingSettings& settings, const KeyframeFile::SharedPtr& pKeyframeFile);
         void bindCurveLSSBuffers();
         void bindCurvePolyTubeBuffers();
 
+        /** Get the IDs of the next keyframe file chunks for a keyframe stream. Throws if they don't match the expected keyframe size.
+        */
+        std::vector<uint32_t> getKeyframeChunks(uint32_t keyframeCount, size_t keyframeSize);
+
+        /** Create the keyframe buffers of curves with the given tessellation mode, and write the keyframes to the buffers or to the keyframe stream.
+        */
+        void initCurveKeyframeBuffers(CurveTessellationMode tessellationMode, uint32_t vertexCount, std::vector<Buffer::SharedPtr>& buffers, std::unique_ptr<KeyframeStream>& pStream,
+            const std::string& name);
+
         void createCurveLSSVertexUpdatePass();
         void createCurveLSSAABBUpdatePass();
         void createCurvePolyTubeVertexUpdatePass();
@@ -113,7 +163,7 @@ namespace Falcor
 
         void createMeshVertexUpdatePass();
 
-        void executeMeshVertexUpdatePass(RenderContext* pContext, double t, bool copyPrev = false);
+        void executeMeshVertexUpdatePass(RenderContext* pContext, double t, bool forward, bool copyPrev = false);
 
         // Interpolate vertex positions.
         // When copyPrev is set to true, interpolation info is ignored and we just copy the current vertex data to the previous data.
@@ -125,6 +175,7 @@ namespace Falcor
         void executeCurvePolyTubeVertexUpdatePass(RenderContext* pContext, const InterpolationInfo& info, bool copyPrev = false);
 
         bool mLoopAnimations = true;
+        double mPrevAnimateTime = 0.0; ///< Time of the previous call to animate(), used to determine the playback direction.
         double mGlobalCurveAnimationLength = 0;
         double mGlobalMeshAnimationLength = 0;
         Scene* mpScene = nullptr;
@@ -165,11 +216,19 @@ namespace Falcor
 
         std::vector<CachedMesh> mCachedMeshes;
         std::vector<InterpolationInfo> mMeshInterpolationInfo;
-        uint32_t mMeshKeyframeCount = 0; ///< Total count of all keyframes for all meshes
+        uint32_t mMeshKeyframeCount = 0; ///< Total count of keyframe buffers for all meshes. This is the count of all keyframes unless streaming.
         uint32_t mMaxMeshVertexCount = 0; ///< Greatest vertex count a mesh has
 
         std::vector<Buffer::SharedPtr> mpMeshVertexBuffers;
         Buffer::SharedPtr mpMeshInterpolationBuffer;
         Buffer::SharedPtr mpMeshMetadataBuffer;
+
+        // Keyframe streaming
+        KeyframeFile::SharedPtr mpKeyframeFile;
+        uint32_t mStreamingSlotCount = 0; ///< Number of resident keyframes per vertex cache.
+        uint32_t mKeyframeChunkCount = 0; ///< Number of keyframe file chunks used by the keyframe streams.
+        std::vector<std::unique_ptr<KeyframeStream>> mMeshKeyframeStreams;
+        std::unique_ptr<KeyframeStream> mpCurveKeyframeStream;
+        std::unique_ptr<KeyframeStream> mpCurvePolyTubeKeyframeStream;
     };
 }
@@ -31,6 +31,11 @@
 #include "glm/gtc/quaternion.hpp"
 #include "glm/gtx/transform.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FALCOR_ANIMATION_SIMD 1
+#endif
+
 namespace Falcor
 {
     namespace
@@ -92,16 +97,211 @@ namespace Falcor
             return result;
         }
 
-        Animation::Keyframe interpolateHermite(const Animation::Keyframe& k0, const Animation::Keyframe& k1, const Animation::Keyframe& k2, const Animation::Keyframe& k3, float t)
+        // Computes translate(t) * mat4_cast(r) * scale(s) without the full matrix products.
+        glm::mat4 composeTransform(const float3& t, const glm::quat& r, const float3& s)
         {
-            FALCOR_ASSERT(t >= 0.f && t <= 1.f);
-            Animation::Keyframe result;
-            result.translation = interpolateHermite(k0.translation, k1.translation, k2.translation, k3.translation, t);
-            result.scaling = lerp(k1.scaling, k2.scaling, t);
-            result.rotation = interpolateHermite(k0.rotation, k1.rotation, k2.rotation, k3.rotation, t);
-            result.time = glm::lerp(k1.time, k2.time, (double)t);
-            return result;
+            glm::mat3 R = glm::mat3_cast(r);
+            return glm::mat4(float4(R[0] * s.x, 0.f), float4(R[1] * s.y, 0.f), float4(R[2] * s.z, 0.f), float4(t, 1.f));
+        }
+
+        // Number of animations interpolated together, one per SIMD lane.
+        const size_t kBatchSize = 4;
+
+        /** Keyframes of a batch of animations gathered in SoA layout, with one lane per animation.
+            Linear interpolation only uses keyframes 1 and 2.
+        */
+        struct KeyframeBatch
+        {
+            alignas(16) float t[kBatchSize];
+            alignas(16) float translations[4][3][kBatchSize];   ///< Translation per keyframe and component (x, y, z).
+            alignas(16) float rotations[4][4][kBatchSize];      ///< Rotation per keyframe and component (x, y, z, w).
+            alignas(16) float scalings[2][3][kBatchSize];       ///< Scaling of keyframes 1 and 2 per component.
+            float4x4* pResults[kBatchSize];                     ///< Matrices to write the transforms to.
+        };
+
+#if FALCOR_ANIMATION_SIMD
+        // The lane operations below follow the order of operations of the scalar glm code, so both paths round the same way.
+
+        struct Float3Lanes { __m128 x, y, z; };
+        struct QuatLanes { __m128 x, y, z, w; };
+
+        Float3Lanes loadFloat3(const float (&v)[3][kBatchSize])
+        {
+            return { _mm_load_ps(v[0]), _mm_load_ps(v[1]), _mm_load_ps(v[2]) };
+        }
+
+        QuatLanes loadQuat(const float (&q)[4][kBatchSize])
+        {
+            return { _mm_load_ps(q[0]), _mm_load_ps(q[1]), _mm_load_ps(q[2]), _mm_load_ps(q[3]) };
+        }
+
+        // Same as glm::mix(a, b, t), i.e. a * (1 - t) + b * t.
+        __m128 lerp(__m128 a, __m128 b, __m128 t, __m128 oneMinusT)
+        {
+            return _mm_add_ps(_mm_mul_ps(a, oneMinusT), _mm_mul_ps(b, t));
+        }
+
+        Float3Lanes lerp(const Float3Lanes& a, const Float3Lanes& b, __m128 t, __m128 oneMinusT)
+        {
+            return { lerp(a.x, b.x, t, oneMinusT), lerp(a.y, b.y, t, oneMinusT), lerp(a.z, b.z, t, oneMinusT) };
+        }
+
+        // Same as glm::slerp(a, b, t), with the trigonometric functions evaluated per lane.
+        QuatLanes slerp(const QuatLanes& a, const QuatLanes& b, __m128 t, __m128 oneMinusT)
+        {
+            // Take the short way around by negating b if the quaternions point in opposite directions.
+            __m128 cosTheta = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.w, b.w), _mm_mul_ps(a.x, b.x)), _mm_add_ps(_mm_mul_ps(a.y, b.y), _mm_mul_ps(a.z, b.z)));
+            const __m128 signMask = _mm_set1_ps(-0.f);
+            __m128 flip = _mm_and_ps(_mm_cmplt_ps(cosTheta, _mm_setzero_ps()), signMask);
+            QuatLanes c = { _mm_xor_ps(b.x, flip), _mm_xor_ps(b.y, flip), _mm_xor_ps(b.z, flip), _mm_xor_ps(b.w, flip) };
+            cosTheta = _mm_xor_ps(cosTheta, flip);
+
+            // Interpolate linearly when the angle is close to zero.
+            __m128 isLinear = _mm_cmpgt_ps(cosTheta, _mm_set1_ps(1.f - std::numeric_limits<float>::epsilon()));
+
+            alignas(16) float cosThetas[kBatchSize], ts[kBatchSize];
+            alignas(16) float w0[kBatchSize], w1[kBatchSize], sinTheta[kBatchSize];
+            _mm_store_ps(cosThetas, cosTheta);
+            _mm_store_ps(ts, t);
+            int linearMask = _mm_movemask_ps(isLinear);
+            for (size_t lane = 0; lane < kBatchSize; lane++)
+            {
+                if (linearMask & (1 << lane))
+                {
+                    w0[lane] = w1[lane] = 0.f;
+                    sinTheta[lane] = 1.f;
+                    continue;
+                }
+                float angle = std::acos(cosThetas[lane]);
+                w0[lane] = std::sin((1.f - ts[lane]) * angle);
+                w1[lane] = std::sin(ts[lane] * angle);
+                sinTheta[lane] = std::sin(angle);
+            }
+
+            __m128 vw0 = _mm_load_ps(w0), vw1 = _mm_load_ps(w1), vs = _mm_load_ps(sinTheta);
+            auto component = [&](__m128 ac, __m128 cc)
+            {
+                __m128 linear = lerp(ac, cc, t, oneMinusT);
+                __m128 spherical = _mm_div_ps(_mm_add_ps(_mm_mul_ps(vw0, ac), _mm_mul_ps(vw1, cc)), vs);
+                return _mm_or_ps(_mm_and_ps(isLinear, linear), _mm_andnot_ps(isLinear, spherical));
+            };
+            return { component(a.x, c.x), component(a.y, c.y), component(a.z, c.z), component(a.w, c.w) };
+        }
+
+        // Bezier control points of the hermite spline through p1 and p2, i.e. p1 + (p2 - p0) * 0.5 / 3 and p2 - (p3 - p1) * 0.5 / 3.
+        __m128 hermiteControlPoint(__m128 p, __m128 pNext, __m128 pPrev, bool add)
+        {
+            __m128 d = _mm_div_ps(_mm_mul_ps(_mm_sub_ps(pNext, pPrev), _mm_set1_ps(0.5f)), _mm_set1_ps(3.f));
+            return add ? _mm_add_ps(p, d) : _mm_sub_ps(p, d);
+        }
+
+        Float3Lanes interpolateHermite(const Float3Lanes (&p)[4], __m128 t, __m128 oneMinusT)
+        {
+            Float3Lanes b0 = p[1];
+            Float3Lanes b1 = { hermiteControlPoint(p[1].x, p[2].x, p[0].x, true), hermiteControlPoint(p[1].y, p[2].y, p[0].y, true), hermiteControlPoint(p[1].z, p[2].z, p[0].z, true) };
+            Float3Lanes b2 = { hermiteControlPoint(p[2].x, p[3].x, p[1].x, false), hermiteControlPoint(p[2].y, p[3].y, p[1].y, false), hermiteControlPoint(p[2].z, p[3].z, p[1].z, false) };
+            Float3Lanes b3 = p[2];
+
+            Float3Lanes q0 = lerp(b0, b1, t, oneMinusT);
+            Float3Lanes q1 = lerp(b1, b2, t, oneMinusT);
+            Float3Lanes q2 = lerp(b2, b3, t, oneMinusT);
+
+            Float3Lanes qq0 = lerp(q0, q1, t, oneMinusT);
+            Float3Lanes qq1 = lerp(q1, q2, t, oneMinusT);
+
+            return lerp(qq0, qq1, t, oneMinusT);
+        }
+
+        QuatLanes interpolateHermite(const QuatLanes (&r)[4], __m128 t, __m128 oneMinusT)
+        {
+            QuatLanes b0 = r[1];
+            QuatLanes b1 = { hermiteControlPoint(r[1].x, r[2].x, r[0].x, true), hermiteControlPoint(r[1].y, r[2].y, r[0].y, true), hermiteControlPoint(r[1].z, r[2].z, r[0].z, true), hermiteControlPoint(r[1].w, r[2].w, r[0].w, true) };
+            QuatLanes b2 = { hermiteControlPoint(r[2].x, r[3].x, r[1].x, false), hermiteControlPoint(r[2].y, r[3].y, r[1].y, false), hermiteControlPoint(r[2].z, r[3].z, r[1].z, false), hermiteControlPoint(r[2].w, r[3].w, r[1].w, false) };
+            QuatLanes b3 = r[2];
+
+            QuatLanes q0 = slerp(b0, b1, t, oneMinusT);
+            QuatLanes q1 = slerp(b1, b2, t, oneMinusT);
+            QuatLanes q2 = slerp(b2, b3, t, oneMinusT);
+
+            QuatLanes qq0 = slerp(q0, q1, t, oneMinusT);
+            QuatLanes qq1 = slerp(q1, q2, t, oneMinusT);
+
+            return slerp(qq0, qq1, t, oneMinusT);
         }
+
+        // Same as composeTransform() per lane. The matrix columns are transposed from SoA to one column per lane before storing.
+        void storeTransforms(const KeyframeBatch& batch, const Float3Lanes& t, const QuatLanes& r, const Float3Lanes& s)
+        {
+            const __m128 one = _mm_set1_ps(1.f);
+            const __m128 two = _mm_set1_ps(2.f);
+            __m128 qxx = _mm_mul_ps(r.x, r.x), qyy = _mm_mul_ps(r.y, r.y), qzz = _mm_mul_ps(r.z, r.z);
+            __m128 qxz = _mm_mul_ps(r.x, r.z), qxy = _mm_mul_ps(r.x, r.y), qyz = _mm_mul_ps(r.y, r.z);
+            __m128 qwx = _mm_mul_ps(r.w, r.x), qwy = _mm_mul_ps(r.w, r.y), qwz = _mm_mul_ps(r.w, r.z);
+
+            __m128 columns[4][4] =
+            {
+                {
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz))), s.x),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxy, qwz)), s.x),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxz, qwy)), s.x),
+                    _mm_setzero_ps(),
+                },
+                {
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxy, qwz)), s.y),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz))), s.y),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qyz, qwx)), s.y),
+                    _mm_setzero_ps(),
+                },
+                {
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxz, qwy)), s.z),
+                    _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qyz, qwx)), s.z),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy))), s.z),
+                    _mm_setzero_ps(),
+                },
+                { t.x, t.y, t.z, one },
+            };
+
+            for (auto& column : columns)
+            {
+                _MM_TRANSPOSE4_PS(column[0], column[1], column[2], column[3]);
+            }
+            for (size_t lane = 0; lane < kBatchSize; lane++)
+            {
+                float4x4& m = *batch.pResults[lane];
+                for (int c = 0; c < 4; c++) _mm_storeu_ps(&m[c][0], columns[c][lane]);
+            }
+        }
+
+        void interpolateLinearBatch(const KeyframeBatch& batch)
+        {
+            __m128 t = _mm_load_ps(batch.t);
+            __m128 oneMinusT = _mm_sub_ps(_mm_set1_ps(1.f), t);
+
+            Float3Lanes translation = lerp(loadFloat3(batch.translations[1]), loadFloat3(batch.translations[2]), t, oneMinusT);
+            QuatLanes rotation = slerp(loadQuat(batch.rotations[1]), loadQuat(batch.rotations[2]), t, oneMinusT);
+            Float3Lanes scaling = lerp(loadFloat3(batch.scalings[0]), loadFloat3(batch.scalings[1]), t, oneMinusT);
+            storeTransforms(batch, translation, rotation, scaling);
+        }
+
+        void interpolateHermiteBatch(const KeyframeBatch& batch)
+        {
+            __m128 t = _mm_load_ps(batch.t);
+            __m128 oneMinusT = _mm_sub_ps(_mm_set1_ps(1.f), t);
+
+            Float3Lanes translations[4];
+            QuatLanes rotations[4];
+            for (size_t i = 0; i < 4; i++)
+            {
+                translations[i] = loadFloat3(batch.translations[i]);
+                rotations[i] = loadQuat(batch.rotations[i]);
+            }
+
+            Float3Lanes translation = interpolateHermite(translations, t, oneMinusT);
+            QuatLanes rotation = interpolateHermite(rotations, t, oneMinusT);
+            Float3Lanes scaling = lerp(loadFloat3(batch.scalings[0]), loadFloat3(batch.scalings[1]), t, oneMinusT);
+            storeTransforms(batch, translation, rotation, scaling);
+        }
+#endif
     }
 
     Animation::SharedPtr Animation::create(const std::string& name, uint32_t nodeID, double duration)
@@ -118,29 +318,25 @@ namespace Falcor
     glm::mat4 Animation::animate(double currentTime)
     {
         // Calculate the sample time.
-        double time = currentTime;
-        if (time < mKeyframes.front().time || time > mKeyframes.back().time)
-        {
-            time = calcSampleTime(currentTime);
-        }
+        double time = getSampleTime(currentTime);
 
         // Determine if the animation behaves linearly outside of defined keyframes.
-        bool isLinearPostInfinity = time > mKeyframes.back().time && this->getPostInfinityBehavior() == Behavior::Linear;
-        bool isLinearPreInfinity = time < mKeyframes.front().time && this->getPreInfinityBehavior() == Behavior::Linear;
+        bool isLinearPostInfinity = time > mTimes.back() && this->getPostInfinityBehavior() == Behavior::Linear;
+        bool isLinearPreInfinity = time < mTimes.front() && this->getPreInfinityBehavior() == Behavior::Linear;
 
         Keyframe interpolated;
 
-        if (isLinearPreInfinity && mKeyframes.size() > 1)
+        if (isLinearPreInfinity && mTimes.size() > 1)
         {
-            const auto& k0 = mKeyframes.front();
+            auto k0 = getKeyframeAt(0);
             auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
             interpolated = interpolateLinear(k0, k1, t);
         }
-        else if (isLinearPostInfinity && mKeyframes.size() > 1)
+        else if (isLinearPostInfinity && mTimes.size() > 1)
         {
-            const auto& k1 = mKeyframes.back();
+            auto k1 = getKeyframeAt(mTimes.size() - 1);
             auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
@@ -151,75 +347,200 @@ namespace Falcor
             interpolated = interpolate(mInterpolationMode, time);
         }
 
-        glm::mat4 T = translate(interpolated.translation);
-        glm::mat4 R = mat4_cast(interpolated.rotation);
-        glm::mat4 S = scale(interpolated.scaling);
-        glm::mat4 transform = T * R * S;
-
-        return transform;
+        return composeTransform(interpolated.translation, interpolated.rotation, interpolated.scaling);
     }
 
-    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    void Animation::animateBatch(const std::vector<SharedPtr>& animations, const uint32_t* pAnimationIDs, size_t count, double currentTime, std::vector<float4x4>& localMatrices)
     {
-        FALCOR_ASSERT(!mKeyframes.empty());
+        struct Lane
+        {
+            Animation* pAnimation;
+            Segment segment;
+        };
 
-        // Validate cached frame index.
-        size_t frameIndex = clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
+        auto evaluate = [&localMatrices](const Lane& lane)
+        {
+            Keyframe interpolated = lane.pAnimation->interpolate(lane.segment);
+            localMatrices[lane.pAnimation->mNodeID] = composeTransform(interpolated.translation, interpolated.rotation, interpolated.scaling);
+        };
 
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
+        // Gather the keyframes of a full batch into SIMD lanes and interpolate them together.
+        auto evaluateBatch = [&](const std::array<Lane, kBatchSize>& lanes, bool hermite)
         {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
+#if FALCOR_ANIMATION_SIMD
+            KeyframeBatch batch;
+            for (size_t lane = 0; lane < kBatchSize; lane++)
+            {
+                const Animation& animation = *lanes[lane].pAnimation;
+                const Segment& segment = lanes[lane].segment;
+                batch.t[lane] = segment.t;
+                for (size_t i = 0; i < 4; i++)
+                {
+                    const float3& translation = animation.mTranslations[segment.frames[i]];
+                    const glm::quat& rotation = animation.mRotations[segment.frames[i]];
+                    for (int c = 0; c < 3; c++) batch.translations[i][c][lane] = translation[c];
+                    batch.rotations[i][0][lane] = rotation.x;
+                    batch.rotations[i][1][lane] = rotation.y;
+                    batch.rotations[i][2][lane] = rotation.z;
+                    batch.rotations[i][3][lane] = rotation.w;
+                }
+                for (size_t i = 0; i < 2; i++)
+                {
+                    const float3& scaling = animation.mScalings[segment.frames[i + 1]];
+                    for (int c = 0; c < 3; c++) batch.scalings[i][c][lane] = scaling[c];
+                }
+                batch.pResults[lane] = &localMatrices[animation.mNodeID];
+            }
+
+            if (hermite) interpolateHermiteBatch(batch);
+            else interpolateLinearBatch(batch);
+#else
+            for (const auto& lane : lanes) evaluate(lane);
+#endif
+        };
+
+        // Queue the animations by interpolation mode until a batch is full.
+        std::array<Lane, kBatchSize> queues[2];
+        size_t queueSizes[2] = {};
+
+        for (size_t i = 0; i < count; i++)
+        {
+            Animation* pAnimation = animations[pAnimationIDs[i]].get();
+
+            // Linear extrapolation beyond the keyframes is rare and evaluated one at a time.
+            double time = pAnimation->getSampleTime(currentTime);
+            bool isLinearInfinity = (time < pAnimation->mTimes.front() && pAnimation->mPreInfinityBehavior == Behavior::Linear) ||
+                (time > pAnimation->mTimes.back() && pAnimation->mPostInfinityBehavior == Behavior::Linear);
+            if (isLinearInfinity && pAnimation->mTimes.size() > 1)
+            {
+                localMatrices[pAnimation->mNodeID] = pAnimation->animate(currentTime);
+                continue;
+            }
+
+            Segment segment = pAnimation->findSegment(pAnimation->mInterpolationMode, time);
+            auto& queue = queues[segment.hermite];
+            auto& queueSize = queueSizes[segment.hermite];
+            queue[queueSize++] = { pAnimation, segment };
+            if (queueSize == kBatchSize)
+            {
+                evaluateBatch(queue, segment.hermite);
+                queueSize = 0;
+            }
+        }
+
+        // Evaluate the partial batches one at a time.
+        for (size_t q = 0; q < 2; q++)
+        {
+            for (size_t i = 0; i < queueSizes[q]; i++) evaluate(queues[q][i]);
+        }
+    }
+
+    size_t Animation::findFrame(double time) const
+    {
+        // Find the last keyframe at or before the given time, or the first keyframe if there is none.
+        // The search starts at the cached frame index and takes steps of exponentially increasing size to bracket the
+        // frame before switching to binary search. This takes constant time during playback and logarithmic time for jumps.
+        const size_t count = mTimes.size();
+        size_t lo = 0;
+        size_t hi = count;
+        size_t cachedIndex = std::min(mCachedFrameIndex, count - 1);
+
+        if (mTimes[cachedIndex] <= time)
+        {
+            lo = cachedIndex;
+            for (size_t step = 1; lo + step < count; step *= 2)
+            {
+                if (mTimes[lo + step] > time)
+                {
+                    hi = lo + step;
+                    break;
+                }
+                lo += step;
+            }
+        }
+        else
+        {
+            hi = cachedIndex;
+            for (size_t step = 1; step <= hi; step *= 2)
+            {
+                if (mTimes[hi - step] <= time)
+                {
+                    lo = hi - step;
+                    break;
+                }
+                hi -= step;
+            }
         }
 
-        // Cache frame index;
+        size_t frameIndex = std::upper_bound(mTimes.begin() + lo, mTimes.begin() + hi, time) - mTimes.begin();
+        return frameIndex > 0 ? frameIndex - 1 : 0;
+    }
+
+    Animation::Segment Animation::findSegment(InterpolationMode mode, double time) const
+    {
+        FALCOR_ASSERT(!mTimes.empty());
+
+        // Find and cache frame index.
+        size_t frameIndex = findFrame(time);
         mCachedFrameIndex = frameIndex;
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
         {
-            size_t count = mKeyframes.size();
+            size_t count = mTimes.size();
             return mEnableWarping ? (frame + count + offset) % count : clamp(frame + offset, (size_t)0, count - 1);
         };
 
-        if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
-        {
-            size_t i0 = frameIndex;
-            size_t i1 = adjacentFrame(i0);
+        size_t i1 = frameIndex;
+        size_t i2 = adjacentFrame(i1);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
+        double segmentDuration = mTimes[i2] - mTimes[i1];
+        if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
 
-            double segmentDuration = k1.time - k0.time;
-            if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
-            float t = (float)clamp((segmentDuration > 0.0 ? (time - k0.time) / segmentDuration : 1.0), 0.0, 1.0);
+        Segment segment;
+        segment.t = (float)clamp(segmentDuration > 0.0 ? (time - mTimes[i1]) / segmentDuration : 1.0, 0.0, 1.0);
 
-            return interpolateLinear(k0, k1, t);
+        if (mode == InterpolationMode::Linear || mTimes.size() < 4)
+        {
+            segment.frames = { i1, i1, i2, i2 };
         }
         else if (mode == InterpolationMode::Hermite)
         {
-            size_t i1 = frameIndex;
-            size_t i0 = adjacentFrame(i1, -1);
-            size_t i2 = adjacentFrame(i1, 1);
-            size_t i3 = adjacentFrame(i1, 2);
+            segment.frames = { adjacentFrame(i1, -1), i1, i2, adjacentFrame(i1, 2) };
+            segment.hermite = true;
+        }
+        else
+        {
+            throw ArgumentError("'mode' is unknown interpolation mode");
+        }
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-            const Keyframe& k2 = mKeyframes[i2];
-            const Keyframe& k3 = mKeyframes[i3];
+        return segment;
+    }
 
-            double segmentDuration = k2.time - k1.time;
-            if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
-            float t = (float)clamp(segmentDuration > 0.0 ? (time - k1.time) / segmentDuration : 1.0, 0.0, 1.0);
+    Animation::Keyframe Animation::interpolate(const Segment& segment) const
+    {
+        const auto [i0, i1, i2, i3] = segment.frames;
+        const float t = segment.t;
 
-            return interpolateHermite(k0, k1, k2, k3, t);
+        Keyframe result;
+        if (segment.hermite)
+        {
+            result.translation = interpolateHermite(mTranslations[i0], mTranslations[i1], mTranslations[i2], mTranslations[i3], t);
+            result.rotation = interpolateHermite(mRotations[i0], mRotations[i1], mRotations[i2], mRotations[i3], t);
         }
         else
         {
-            throw ArgumentError("'mode' is unknown interpolation mode");
+            result.translation = lerp(mTranslations[i1], mTranslations[i2], t);
+            result.rotation = slerp(mRotations[i1], mRotations[i2], t);
         }
+        result.scaling = lerp(mScalings[i1], mScalings[i2], t);
+        result.time = glm::lerp(mTimes[i1], mTimes[i2], (double)t);
+        return result;
+    }
+
+    double Animation::getSampleTime(double currentTime)
+    {
+        return (currentTime < mTimes.front() || currentTime > mTimes.back()) ? calcSampleTime(currentTime) : currentTime;
     }
 
     // Calculates the sample time within the keyframe range if the current time lies outside and
@@ -229,8 +550,8 @@ namespace Falcor
     double Animation::calcSampleTime(double currentTime)
     {
         double modifiedTime = currentTime;
-        double firstKeyframeTime = mKeyframes.front().time;
-        double lastKeyframeTime = mKeyframes.back().time;
+        double firstKeyframeTime = mTimes.front();
+        double lastKeyframeTime = mTimes.back();
         double duration = lastKeyframeTime - firstKeyframeTime;
 
         FALCOR_ASSERT(currentTime < firstKeyframeTime || currentTime > lastKeyframeTime);
@@ -261,59 +582,34 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
-        {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
-        }
-        else if (mKeyframes.back().time < keyframe.time)
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), keyframe.time);
+        size_t index = it - mTimes.begin();
+
+        // If we already have a key-frame at the same time, replace it
+        if (it != mTimes.end() && *it == keyframe.time)
         {
-            mKeyframes.push_back(keyframe);
+            mTranslations[index] = keyframe.translation;
+            mScalings[index] = keyframe.scaling;
+            mRotations[index] = keyframe.rotation;
+            return;
         }
-        else
-        {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
-            {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
 
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
-            }
-
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
-        }
+        mTimes.insert(it, keyframe.time);
+        mTranslations.insert(mTranslations.begin() + index, keyframe.translation);
+        mScalings.insert(mScalings.begin() + index, keyframe.scaling);
+        mRotations.insert(mRotations.begin() + index, keyframe.rotation);
     }
 
-    const Animation::Keyframe& Animation::getKeyframe(double time) const
+    Animation::Keyframe Animation::getKeyframe(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
-        throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        auto it = std::lower_bound(mTimes.begin(), mTimes.end(), time);
+        if (it == mTimes.end() || *it != time) throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        return getKeyframeAt(it - mTimes.begin());
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        return std::binary_search(mTimes.begin(), mTimes.end(), time);
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
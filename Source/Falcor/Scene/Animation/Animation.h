@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include <array>
 #include <vector>
 
 namespace Falcor
@@ -126,7 +127,7 @@ namespace Falcor
             \param[in] time Time of the keyframe.
             \return Returns the keyframe.
         */
-        const Keyframe& getKeyframe(double time) const;
+        Keyframe getKeyframe(double time) const;
 
         /** Check if a keyframe exists at the specified time.
             \param[in] time Time of the keyframe.
@@ -134,12 +135,28 @@ namespace Falcor
         */
         bool doesKeyframeExists(double time) const;
 
+        /** Get the number of keyframes.
+        */
+        size_t getKeyframeCount() const { return mTimes.size(); }
+
         /** Compute the animation.
             \param time The current time in seconds. This can be larger then the animation time, in which case the animation will loop.
             \return Returns the animation's transform matrix for the specified time.
         */
         glm::mat4 animate(double currentTime);
 
+        /** Compute the transforms of multiple animations and write them to the local matrices of the animated nodes.
+            Full batches of animations using the same interpolation are interpolated with one SIMD lane per animation.
+            Partial batches and animations extrapolated linearly beyond their keyframes are evaluated one at a time.
+            The results match animate() up to floating-point rounding.
+            \param[in] animations List of animations.
+            \param[in] pAnimationIDs Indices of the animations to evaluate, at most one per node.
+            \param[in] count Number of animations to evaluate.
+            \param[in] currentTime The current time in seconds.
+            \param[out] localMatrices Local matrices indexed by node ID.
+        */
+        static void animateBatch(const std::vector<SharedPtr>& animations, const uint32_t* pAnimationIDs, size_t count, double currentTime, std::vector<float4x4>& localMatrices);
+
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -147,7 +164,22 @@ namespace Falcor
     private:
         Animation(const std::string& name, uint32_t nodeID, double duration);
 
-        Keyframe interpolate(InterpolationMode mode, double time) const;
+        Keyframe getKeyframeAt(size_t index) const { return Keyframe{ mTimes[index], mTranslations[index], mScalings[index], mRotations[index] }; }
+        /** Keyframes and weight for interpolating the animation at a given time.
+            The animation is interpolated between frames[1] and frames[2]. Hermite interpolation also uses the neighbouring frames[0] and frames[3].
+        */
+        struct Segment
+        {
+            std::array<size_t, 4> frames = {};
+            float t = 0.f;
+            bool hermite = false;
+        };
+
+        size_t findFrame(double time) const;
+        Segment findSegment(InterpolationMode mode, double time) const;
+        Keyframe interpolate(const Segment& segment) const;
+        Keyframe interpolate(InterpolationMode mode, double time) const { return interpolate(findSegment(mode, time)); }
+        double getSampleTime(double currentTime);
         double calcSampleTime(double currentTime);
 
         std::string mName;
@@ -160,7 +192,11 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
+        // Keyframes stored as separate channels, sorted by time.
+        std::vector<double> mTimes;
+        std::vector<float3> mTranslations;
+        std::vector<float3> mScalings;
+        std::vector<glm::quat> mRotations;
         mutable size_t mCachedFrameIndex = 0;
 
         friend class SceneCache;
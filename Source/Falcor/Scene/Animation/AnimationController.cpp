@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "AnimationController.h"
+#include "Utils/Threading.h"
 #include <fstream>
 
 namespace Falcor
@@ -37,6 +38,9 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        // Minimum number of animations per task when evaluating animations in parallel.
+        const size_t kAnimationGrainSize = 256;
     }
 
     AnimationController::AnimationController(Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<Animation::SharedPtr>& animations)
@@ -48,6 +52,23 @@ namespace Falcor
         , mInvTransposeGlobalMatrices(pScene->mSceneGraph.size())
         , mMatricesChanged(pScene->mSceneGraph.size())
     {
+        std::vector<uint32_t> parents(pScene->mSceneGraph.size());
+        for (size_t i = 0; i < parents.size(); i++) parents[i] = pScene->mSceneGraph[i].parent;
+        mTransformHierarchy = TransformHierarchy(parents);
+
+        // If several animations target the same node, the last one takes effect. Only evaluate that one,
+        // so that every node is written by a single animation when evaluating them in parallel.
+        std::vector<bool> isNodeAnimated(parents.size());
+        for (size_t i = mAnimations.size(); i-- > 0;)
+        {
+            uint32_t nodeID = mAnimations[i]->getNodeID();
+            FALCOR_ASSERT(nodeID < isNodeAnimated.size());
+            if (isNodeAnimated[nodeID]) continue;
+            isNodeAnimated[nodeID] = true;
+            mActiveAnimations.push_back((uint32_t)i);
+        }
+        std::reverse(mActiveAnimations.begin(), mActiveAnimations.end());
+
         // Create GPU resources.
         FALCOR_ASSERT(mLocalMatrices.size() * 4 <= std::numeric_limits<uint32_t>::max());
         uint32_t float4Count = (uint32_t)mLocalMatrices.size() * 4;
@@ -95,7 +116,8 @@ namespace Falcor
         return UniquePtr(new AnimationController(pScene, staticVertexData, skinningVertexData, prevVertexCount, animations));
     }
 
-    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData)
+    void AnimationController::addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData,
+        const VertexCacheStreamingSettings* pStreamingSettings, const KeyframeFile::SharedPtr& pKeyframeFile)
     {
         size_t totalAnimatedMeshVertexCount = 0;
 
@@ -159,7 +181,7 @@ namespace Falcor
             mpPrevVertexData->setBlob(prevVertexData.data(), byteOffset, prevVertexData.size() * sizeof(PrevVertexData));
         }
 
-        mpVertexCache = AnimatedVertexCache::create(mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes));
+        mpVertexCache = AnimatedVertexCache::create(mpScene, mpPrevVertexData, std::move(cachedCurves), std::move(cachedMeshes), pStreamingSettings, pKeyframeFile);
 
         // Note: It is a workaround to have two pre-infinity behaviors for the cached animation.
         // We need `Cycle` behavior when the length of cached animation is smaller than the length of mesh animation (e.g., tiger forest).
@@ -208,7 +230,7 @@ namespace Falcor
             {
                 mLocalMatrices[i] = sceneGraph[i].transform;
                 mNodesEdited[i] = false;
-                mMatricesChanged[i] = true;
+                mChangedNodes.push_back((uint32_t)i);
                 edited = true;
             }
         }
@@ -291,44 +313,31 @@ namespace Falcor
 
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        // Evaluate the animations in parallel, in SIMD batches within each range. Each animation only modifies its own state and the local matrix of its node.
+        Threading::parallelFor(0, mActiveAnimations.size(), [&](size_t begin, size_t end)
         {
-            uint32_t nodeID = pAnimation->getNodeID();
-            FALCOR_ASSERT(nodeID < mLocalMatrices.size());
-            mLocalMatrices[nodeID] = pAnimation->animate(time);
-            mMatricesChanged[nodeID] = true;
-        }
+            Animation::animateBatch(mAnimations, mActiveAnimations.data() + begin, end - begin, time, mLocalMatrices);
+        }, kAnimationGrainSize);
+
+        for (uint32_t animationID : mActiveAnimations) mChangedNodes.push_back(mAnimations[animationID]->getNodeID());
     }
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
+        TransformHierarchy::Matrices matrices;
+        matrices.pLocal = mLocalMatrices.data();
+        matrices.pGlobal = mGlobalMatrices.data();
+        matrices.pInvTransposeGlobal = mInvTransposeGlobalMatrices.data();
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        if (mpSkinningPass)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != SceneBuilder::kInvalidNode)
-            {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent];
-            }
-
-            if (!mMatricesChanged[i] && !updateAll) continue;
-
-            mGlobalMatrices[i] = mLocalMatrices[i];
-
-            if (mpScene->mSceneGraph[i].parent != SceneBuilder::kInvalidNode)
-            {
-                mGlobalMatrices[i] = mGlobalMatrices[sceneGraph[i].parent] * mGlobalMatrices[i];
-            }
-
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
-
-            if (mpSkinningPass)
-            {
-                mSkinningMatrices[i] = mGlobalMatrices[i] * sceneGraph[i].localToBindSpace;
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
-            }
+            matrices.pLocalToBindSpace = mLocalToBindSpaceMatrices.data();
+            matrices.pSkinning = mSkinningMatrices.data();
+            matrices.pInvTransposeSkinning = mInvTransposeSkinningMatrices.data();
         }
+
+        mTransformHierarchy.update(matrices, mChangedNodes, mMatricesChanged, updateAll);
+        mChangedNodes.clear();
     }
 
     void AnimationController::uploadWorldMatrices(bool uploadAll)
@@ -407,6 +416,7 @@ namespace Falcor
             mSkinningMatrices.resize(mpScene->mSceneGraph.size());
             mInvTransposeSkinningMatrices.resize(mSkinningMatrices.size());
             mMeshBindMatrices.resize(mpScene->mSceneGraph.size());
+            mLocalToBindSpaceMatrices.resize(mpScene->mSceneGraph.size());
 
             mpSkinningPass = ComputePass::create("Scene/Animation/Skinning.slang");
             auto block = mpSkinningPass->getVars()["gData"];
@@ -416,6 +426,7 @@ namespace Falcor
             for (size_t i = 0; i < mpScene->mSceneGraph.size(); i++)
             {
                 mMeshBindMatrices[i] = mpScene->mSceneGraph[i].meshBind;
+                mLocalToBindSpaceMatrices[i] = mpScene->mSceneGraph[i].localToBindSpace;
                 meshInvBindMatrices[i] = glm::inverse(mMeshBindMatrices[i]);
             }
 
@@ -481,6 +492,22 @@ namespace Falcor
         }
         widget.tooltip("Enable/disable global animation looping.");
 
+        if (mpVertexCache && mpVertexCache->isStreaming())
+        {
+            if (auto streamingGroup = widget.group("Vertex Cache Streaming"))
+            {
+                const auto stats = mpVertexCache->getStreamingStats();
+                std::ostringstream oss;
+                oss << "Resident keyframes: " << formatByteSize(mpVertexCache->getMemoryUsageInBytes()) << std::endl
+                    << "Keyframes on disk: " << formatByteSize(mpVertexCache->getStreamedSizeInBytes()) << std::endl
+                    << "Requests: " << stats.requests << std::endl
+                    << "Hits: " << stats.hits << std::endl
+                    << "Stalls: " << stats.stalls << " (" << std::fixed << std::setprecision(2) << stats.stallTime << " ms)" << std::endl
+                    << "Uploads: " << stats.uploads << " (" << formatByteSize(stats.uploadedBytes) << ")" << std::endl;
+                streamingGroup.text(oss.str());
+            }
+        }
+
         for (auto& animation : mAnimations)
         {
             if (auto animGroup = widget.group(animation->getName()))
@@ -28,6 +28,7 @@
 #pragma once
 #include "Animation.h"
 #include "AnimatedVertexCache.h"
+#include "TransformHierarchy.h"
 #include "RenderGraph/BasePasses/ComputePass.h"
 #include "Scene/SceneTypes.slang"
 
@@ -54,8 +55,11 @@ namespace Falcor
         static UniquePtr create(Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<Animation::SharedPtr>& animations);
 
         /** Add animated vertex caches (curves and meshes) to the controller.
+            \param[in] pStreamingSettings Optional. If set, the vertex cache keyframes are streamed from disk with these settings.
+            \param[in] pKeyframeFile Optional. File holding the vertex cache keyframes when streaming, see AnimatedVertexCache::create().
         */
-        void addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData);
+        void addAnimatedVertexCaches(std::vector<CachedCurve>&& cachedCurves, std::vector<CachedMesh>&& cachedMeshes, const StaticVertexVector& staticVertexData,
+            const VertexCacheStreamingSettings* pStreamingSettings = nullptr, const KeyframeFile::SharedPtr& pKeyframeFile = nullptr);
 
         /** Returns true if controller contains animations.
         */
@@ -159,11 +163,14 @@ namespace Falcor
 
         // Animation
         std::vector<Animation::SharedPtr> mAnimations;
+        std::vector<uint32_t> mActiveAnimations;    ///< Indices of the animations to evaluate, at most one per node.
         std::vector<bool> mNodesEdited;
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
         std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint32_t> mChangedNodes;        ///< Nodes whose local matrix changed since the last world matrix update.
+        TransformHierarchy mTransformHierarchy;     ///< Scene graph hierarchy for updating the world matrices.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -183,6 +190,7 @@ namespace Falcor
         // Skinning
         ComputePass::SharedPtr mpSkinningPass;
         std::vector<float4x4> mMeshBindMatrices; // Optimization TODO: These are only needed per mesh
+        std::vector<float4x4> mLocalToBindSpaceMatrices;
         std::vector<float4x4> mSkinningMatrices;
         std::vector<float4x4> mInvTransposeSkinningMatrices;
         uint32_t mSkinningDispatchSize = 0;
@@ -0,0 +1,254 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "CpuVertexAnimation.h"
+#include "Utils/Threading.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPU_VERTEX_ANIMATION_SSE2 1
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        // Number of vertices per task.
+        const size_t kGrainSize = 1024;
+
+#if defined(CPU_VERTEX_ANIMATION_SSE2)
+        using Vector = __m128;
+        struct Matrix { __m128 c[4]; };
+
+        Vector makeVector(const float3& v, float w) { return _mm_setr_ps(v.x, v.y, v.z, w); }
+
+        float3 toFloat3(Vector v)
+        {
+            alignas(16) float f[4];
+            _mm_store_ps(f, v);
+            return float3(f[0], f[1], f[2]);
+        }
+
+        Matrix loadMatrix(const float4x4& m)
+        {
+            return { _mm_loadu_ps(&m[0][0]), _mm_loadu_ps(&m[1][0]), _mm_loadu_ps(&m[2][0]), _mm_loadu_ps(&m[3][0]) };
+        }
+
+        Matrix transpose(Matrix m)
+        {
+            _MM_TRANSPOSE4_PS(m.c[0], m.c[1], m.c[2], m.c[3]);
+            return m;
+        }
+
+        // Computes m * v.
+        Vector mul(const Matrix& m, Vector v)
+        {
+            Vector r = _mm_mul_ps(m.c[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm_add_ps(r, _mm_mul_ps(m.c[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+            r = _mm_add_ps(r, _mm_mul_ps(m.c[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+            r = _mm_add_ps(r, _mm_mul_ps(m.c[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+            return r;
+        }
+
+        // Computes the weighted sum of four matrices.
+        Matrix blend(const float4x4* pMatrices, const uint4& ids, const float4& weights)
+        {
+            Matrix r;
+            for (int i = 0; i < 4; i++)
+            {
+                Vector c = _mm_mul_ps(_mm_loadu_ps(&pMatrices[ids.x][i][0]), _mm_set1_ps(weights.x));
+                c = _mm_add_ps(c, _mm_mul_ps(_mm_loadu_ps(&pMatrices[ids.y][i][0]), _mm_set1_ps(weights.y)));
+                c = _mm_add_ps(c, _mm_mul_ps(_mm_loadu_ps(&pMatrices[ids.z][i][0]), _mm_set1_ps(weights.z)));
+                c = _mm_add_ps(c, _mm_mul_ps(_mm_loadu_ps(&pMatrices[ids.w][i][0]), _mm_set1_ps(weights.w)));
+                r.c[i] = c;
+            }
+            return r;
+        }
+#else
+        using Vector = float4;
+        using Matrix = glm::mat4;
+
+        Vector makeVector(const float3& v, float w) { return float4(v, w); }
+        float3 toFloat3(Vector v) { return float3(v); }
+        Matrix loadMatrix(const float4x4& m) { return m; }
+        Matrix transpose(const Matrix& m) { return glm::transpose(m); }
+        Vector mul(const Matrix& m, Vector v) { return m * v; }
+
+        Matrix blend(const float4x4* pMatrices, const uint4& ids, const float4& weights)
+        {
+            return pMatrices[ids.x] * weights.x + pMatrices[ids.y] * weights.y + pMatrices[ids.z] * weights.z + pMatrices[ids.w] * weights.w;
+        }
+#endif
+
+        StaticVertexData skinVertex(const StaticVertexData& s, const SkinningVertexData& d, const CpuVertexAnimation::SkinningMatrices& matrices)
+        {
+            Matrix bone = blend(matrices.pSkinning, d.boneID, d.boneWeight);
+            Matrix meshBind = loadMatrix(matrices.pMeshBind[d.bindMatrixID]);
+            Matrix meshInvBind = loadMatrix(matrices.pMeshInvBind[d.bindMatrixID]);
+            Matrix invWorld = transpose(loadMatrix(matrices.pInvTransposeWorld[d.skeletonMatrixID]));
+
+            // Apply the mesh bind transform (mesh to skeleton local at bind time), skin to world space,
+            // and return to skeleton local and mesh local space. This is the blended matrix of the skinning pass applied right to left.
+            auto transform = [&](Vector v) { return mul(meshInvBind, mul(invWorld, mul(bone, mul(meshBind, v)))); };
+
+            StaticVertexData result = s;
+            result.position = toFloat3(transform(makeVector(s.position, 1.f)));
+            result.tangent = float4(toFloat3(transform(makeVector(float3(s.tangent), 0.f))), s.tangent.w);
+
+            // The skinning pass transforms the normal by the transpose of (transpose(world) * blended inverse transpose bone matrix).
+            Matrix invTransposeBone = blend(matrices.pInvTransposeSkinning, d.boneID, d.boneWeight);
+            Matrix world = loadMatrix(matrices.pWorld[d.skeletonMatrixID]);
+            result.normal = toFloat3(mul(transpose(invTransposeBone), mul(world, makeVector(s.normal, 0.f))));
+
+            return result;
+        }
+
+        template<typename Func>
+        AABB parallelBounds(size_t count, Func func)
+        {
+            return Threading::parallelReduce(0, count, AABB(), [&](size_t begin, size_t end)
+            {
+                AABB bounds;
+                for (size_t i = begin; i < end; i++) func(i, bounds);
+                return bounds;
+            }, [](AABB a, const AABB& b) { return a.include(b); }, kGrainSize);
+        }
+    }
+
+    namespace CpuVertexAnimation
+    {
+        InterpolationInfo calculateInterpolation(double time, const std::vector<double>& timeSamples, Animation::Behavior preInfinityBehavior, Animation::Behavior postInfinityBehavior)
+        {
+            if (!std::isfinite(time))
+            {
+                return InterpolationInfo{ uint2(0), 0.f };
+            }
+
+            // Clamp to positive
+            time = std::max(time, 0.0);
+
+            // Post-Infinity Behavior
+            if (time > timeSamples.back())
+            {
+                if (postInfinityBehavior == Animation::Behavior::Constant)
+                {
+                    time = timeSamples.back();
+                }
+                else if (postInfinityBehavior == Animation::Behavior::Cycle)
+                {
+                    time = std::fmod(time, timeSamples.back());
+                }
+            }
+
+            uint2 keyframeIndices;
+            float t = 0.0f;
+
+            // Pre-Infinity Behavior
+            if (time <= timeSamples.front())
+            {
+                if (preInfinityBehavior == Animation::Behavior::Constant)
+                {
+                    keyframeIndices = uint2(0);
+                    t = 0.f;
+                }
+                else if (preInfinityBehavior == Animation::Behavior::Cycle)
+                {
+                    keyframeIndices.x = (uint32_t)timeSamples.size() - 1;
+                    keyframeIndices.y = 0;
+
+                    // The first keyframe has timeCode >= 1 (see processCurve() in ImporterContext.cpp).
+                    FALCOR_ASSERT(timeSamples.front() >= 1.0);
+                    t = (float)(time / timeSamples.front());
+                }
+            }
+            // Regular Interpolation
+            else
+            {
+                keyframeIndices.y = uint32_t(std::lower_bound(timeSamples.begin(), timeSamples.end(), time) - timeSamples.begin());
+                keyframeIndices.x = keyframeIndices.y - 1;
+                FALCOR_ASSERT(timeSamples[keyframeIndices.y] > timeSamples[keyframeIndices.x]);
+                t = (float)((time - timeSamples[keyframeIndices.x]) / (timeSamples[keyframeIndices.y] - timeSamples[keyframeIndices.x]));
+            }
+
+            return InterpolationInfo{ keyframeIndices, t };
+        }
+
+        AABB skinVertices(const PackedStaticVertexData* pStaticData, const SkinningVertexData* pSkinningData, size_t skinningVertexCount, const SkinningMatrices& matrices, PackedStaticVertexData* pSkinnedVertices)
+        {
+            FALCOR_ASSERT(matrices.pSkinning && matrices.pInvTransposeSkinning && matrices.pWorld && matrices.pInvTransposeWorld && matrices.pMeshBind && matrices.pMeshInvBind);
+
+            return parallelBounds(skinningVertexCount, [&](size_t i, AABB& bounds)
+            {
+                const SkinningVertexData& d = pSkinningData[i];
+                StaticVertexData v = skinVertex(pStaticData[d.staticIndex].unpack(), d, matrices);
+                pSkinnedVertices[d.staticIndex].pack(v);
+                bounds.include(v.position);
+            });
+        }
+
+        AABB interpolateMeshVertices(const CachedMesh& cache, const InterpolationInfo& info, PackedStaticVertexData* pVertices)
+        {
+            FALCOR_ASSERT(info.keyframeIndices.x < cache.vertexData.size() && info.keyframeIndices.y < cache.vertexData.size());
+            const auto& vertexData0 = cache.vertexData[info.keyframeIndices.x];
+            const auto& vertexData1 = cache.vertexData[info.keyframeIndices.y];
+            const float t = info.t;
+
+            return parallelBounds(vertexData0.size(), [&](size_t i, AABB& bounds)
+            {
+                StaticVertexData v0 = vertexData0[i].unpack();
+                StaticVertexData v1 = vertexData1[i].unpack();
+
+                StaticVertexData result;
+                result.position = lerp(v0.position, v1.position, t);
+                result.normal = glm::normalize(lerp(v0.normal, v1.normal, t));
+                result.tangent = lerp(v0.tangent, v1.tangent, t);
+                result.tangent = float4(glm::normalize(float3(result.tangent)), result.tangent.w);
+                result.texCrd = pVertices[i].texCrd;
+                result.curveRadius = 0.f;
+
+                pVertices[i].pack(result);
+                bounds.include(result.position);
+            });
+        }
+
+        AABB interpolateCurveVertices(const CachedCurve& cache, const InterpolationInfo& info, StaticCurveVertexData* pVertices)
+        {
+            FALCOR_ASSERT(info.keyframeIndices.x < cache.vertexData.size() && info.keyframeIndices.y < cache.vertexData.size());
+            const auto& vertexData0 = cache.vertexData[info.keyframeIndices.x];
+            const auto& vertexData1 = cache.vertexData[info.keyframeIndices.y];
+            const float t = info.t;
+
+            return parallelBounds(vertexData0.size(), [&](size_t i, AABB& bounds)
+            {
+                float3 position = lerp(vertexData0[i].position, vertexData1[i].position, t);
+                pVertices[i].position = position;
+                bounds.include(AABB(position - pVertices[i].radius, position + pVertices[i].radius));
+            });
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Animation.h"
+#include "AnimatedVertexCache.h"
+#include "Scene/SceneTypes.slang"
+#include "SharedTypes.slang"
+#include "Utils/Math/AABB.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU implementation of the vertex animation passes (Skinning.slang, UpdateMeshVertices.slang and UpdateCurveVertices.slang).
+        The functions produce the same vertex data as the GPU passes up to floating-point rounding, and run multithreaded.
+        They can be used for baking animated geometry, for validating the GPU passes and for computing the exact bounds of animated geometry.
+        Pass the animated vertex data to Scene::updateAnimatedMeshBounds() and Scene::updateAnimatedCurveBounds() to refresh the scene bounds.
+    */
+    namespace CpuVertexAnimation
+    {
+        /** Matrices used for skinning, indexed by scene graph node ID. These are the matrices AnimationController uploads for the skinning pass.
+        */
+        struct SkinningMatrices
+        {
+            const float4x4* pSkinning = nullptr;                ///< Skinning matrices of the bones, i.e. the global matrices times the local-to-bind-space matrices.
+            const float4x4* pInvTransposeSkinning = nullptr;    ///< Inverse transpose of the skinning matrices.
+            const float4x4* pWorld = nullptr;                   ///< Global matrices.
+            const float4x4* pInvTransposeWorld = nullptr;       ///< Inverse transpose of the global matrices.
+            const float4x4* pMeshBind = nullptr;                ///< Mesh bind matrices.
+            const float4x4* pMeshInvBind = nullptr;             ///< Inverse of the mesh bind matrices.
+        };
+
+        /** Compute the keyframes to interpolate and the interpolation weight of a vertex cache.
+            \param[in] time Time in seconds.
+            \param[in] timeSamples Keyframe times in ascending order.
+            \param[in] preInfinityBehavior Behavior before the first keyframe. Only Constant and Cycle are supported.
+            \param[in] postInfinityBehavior Behavior after the last keyframe. Only Constant and Cycle are supported.
+            \return Interpolation info.
+        */
+        FALCOR_API InterpolationInfo calculateInterpolation(double time, const std::vector<double>& timeSamples, Animation::Behavior preInfinityBehavior, Animation::Behavior postInfinityBehavior);
+
+        /** Skin vertices, same as the skinning pass.
+            \param[in] pStaticData Unmodified input vertices.
+            \param[in] pSkinningData Bone IDs and weights of the skinned vertices.
+            \param[in] skinningVertexCount Number of skinned vertices.
+            \param[in] matrices Skinning matrices.
+            \param[in,out] pSkinnedVertices Skinned vertex buffer with the same layout as the input vertices. Only the skinned vertices are written.
+            \return Bounds of the skinned vertex positions.
+        */
+        FALCOR_API AABB skinVertices(const PackedStaticVertexData* pStaticData, const SkinningVertexData* pSkinningData, size_t skinningVertexCount, const SkinningMatrices& matrices, PackedStaticVertexData* pSkinnedVertices);
+
+        /** Interpolate the vertices of a cached mesh, same as the mesh vertex update pass.
+            \param[in] cache Mesh vertex cache.
+            \param[in] info Interpolation info, see calculateInterpolation().
+            \param[in,out] pVertices Vertices of the mesh. The texture coordinates are kept, all other attributes are replaced.
+            \return Bounds of the interpolated vertex positions.
+        */
+        FALCOR_API AABB interpolateMeshVertices(const CachedMesh& cache, const InterpolationInfo& info, PackedStaticVertexData* pVertices);
+
+        /** Interpolate the vertices of a cached curve, same as the curve vertex update pass.
+            Note that the GPU pass interpolates between the keyframes of all curves merged, so its results differ if the curves have different time samples.
+            \param[in] cache Curve vertex cache.
+            \param[in] info Interpolation info for the time samples of the curve, see calculateInterpolation().
+            \param[in,out] pVertices Vertices of the curve. Only the positions are replaced.
+            \return Bounds of the interpolated curve, including the vertex radii.
+        */
+        FALCOR_API AABB interpolateCurveVertices(const CachedCurve& cache, const InterpolationInfo& info, StaticCurveVertexData* pVertices);
+    }
+}
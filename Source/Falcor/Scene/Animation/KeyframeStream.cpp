@@ -0,0 +1,370 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "KeyframeStream.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kMagic[8] = { 'K', 'E', 'Y', 'F', 'R', 'A', 'M', 'E' };
+        const uint32_t kVersion = 1;
+
+        struct Header
+        {
+            char magic[8]{};
+            uint32_t version = 0;
+            uint32_t chunkCount = 0;
+            uint64_t tableOffset = 0;   ///< Offset of the chunk table, or 0 if the file is not finished.
+        };
+    }
+
+    KeyframeFile::SharedPtr KeyframeFile::create()
+    {
+        return SharedPtr(new KeyframeFile(getTempFilePath(), true, true));
+    }
+
+    KeyframeFile::SharedPtr KeyframeFile::create(const std::filesystem::path& path)
+    {
+        return SharedPtr(new KeyframeFile(path, true, false));
+    }
+
+    KeyframeFile::SharedPtr KeyframeFile::open(const std::filesystem::path& path)
+    {
+        return SharedPtr(new KeyframeFile(path, false, false));
+    }
+
+    KeyframeFile::KeyframeFile(const std::filesystem::path& path, bool create, bool deleteOnDestroy)
+        : mPath(path)
+        , mWritable(create)
+        , mDeleteOnDestroy(deleteOnDestroy)
+    {
+        if (create)
+        {
+            mStream.open(mPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!mStream) throw RuntimeError("Failed to create keyframe file '{}'.", mPath);
+
+            // The header is patched by finish().
+            Header header;
+            mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            if (!mStream) throw RuntimeError("Failed to write to keyframe file '{}'.", mPath);
+            mEnd = sizeof(header);
+        }
+        else
+        {
+            mStream.open(mPath, std::ios::in | std::ios::binary);
+            if (!mStream) throw RuntimeError("Failed to open keyframe file '{}'.", mPath);
+            readTable();
+        }
+    }
+
+    KeyframeFile::~KeyframeFile()
+    {
+        mStream.close();
+        if (mDeleteOnDestroy)
+        {
+            std::error_code ec;
+            std::filesystem::remove(mPath, ec);
+        }
+    }
+
+    uint32_t KeyframeFile::addChunk(const void* pData, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mWritable) throw RuntimeError("Keyframe file '{}' is read-only.", mPath);
+
+        mStream.seekp(mEnd);
+        mStream.write(reinterpret_cast<const char*>(pData), size);
+        if (!mStream) throw RuntimeError("Failed to write to keyframe file '{}'.", mPath);
+
+        mChunks.push_back({ mEnd, size });
+        mEnd += size;
+        mSize += size;
+        return (uint32_t)(mChunks.size() - 1);
+    }
+
+    void KeyframeFile::finish()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mWritable) return;
+
+        Header header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.chunkCount = (uint32_t)mChunks.size();
+        header.tableOffset = mEnd;
+
+        mStream.seekp(mEnd);
+        mStream.write(reinterpret_cast<const char*>(mChunks.data()), mChunks.size() * sizeof(Chunk));
+        mStream.seekp(0);
+        mStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        mStream.flush();
+        if (!mStream) throw RuntimeError("Failed to write to keyframe file '{}'.", mPath);
+
+        mWritable = false;
+    }
+
+    void KeyframeFile::readTable()
+    {
+        Header header;
+        mStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!mStream || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion)
+        {
+            throw RuntimeError("Invalid header in keyframe file '{}'.", mPath);
+        }
+
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(mPath, ec);
+        if (ec || header.tableOffset < sizeof(header) || header.tableOffset > fileSize ||
+            header.chunkCount > (fileSize - header.tableOffset) / sizeof(Chunk))
+        {
+            throw RuntimeError("Invalid chunk table in keyframe file '{}'.", mPath);
+        }
+
+        mChunks.resize(header.chunkCount);
+        mStream.seekg(header.tableOffset);
+        mStream.read(reinterpret_cast<char*>(mChunks.data()), mChunks.size() * sizeof(Chunk));
+        if (!mStream) throw RuntimeError("Failed to read from keyframe file '{}'.", mPath);
+
+        for (const auto& chunk : mChunks)
+        {
+            if (chunk.offset < sizeof(header) || chunk.offset > header.tableOffset || chunk.size > header.tableOffset - chunk.offset)
+            {
+                throw RuntimeError("Invalid chunk table in keyframe file '{}'.", mPath);
+            }
+            mSize += chunk.size;
+        }
+        mEnd = header.tableOffset;
+    }
+
+    void KeyframeFile::readChunk(uint32_t chunkID, void* pData) const
+    {
+        FALCOR_ASSERT(chunkID < mChunks.size());
+        const auto& chunk = mChunks[chunkID];
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStream.seekg(chunk.offset);
+        mStream.read(reinterpret_cast<char*>(pData), chunk.size);
+        if (!mStream) throw RuntimeError("Failed to read from keyframe file '{}'.", mPath);
+    }
+
+    KeyframeStream::KeyframeStream(const KeyframeFile::SharedPtr& pFile, std::vector<uint32_t> chunkIDs, uint32_t slotCount, UploadFunc upload)
+        : mpFile(pFile)
+        , mChunkIDs(std::move(chunkIDs))
+        , mUpload(std::move(upload))
+    {
+        checkArgument(mpFile != nullptr, "'pFile' must not be null.");
+        checkArgument(!mChunkIDs.empty(), "'chunkIDs' must not be empty.");
+        checkArgument(slotCount >= std::min(2u, (uint32_t)mChunkIDs.size()), "'slotCount' must be at least 2.");
+
+        slotCount = std::min(slotCount, (uint32_t)mChunkIDs.size());
+        mSlotKeyframes.resize(slotCount, kInvalidSlot);
+        mSlotLastUse.resize(slotCount, 0);
+        mKeyframeSlots.resize(mChunkIDs.size(), kInvalidSlot);
+    }
+
+    KeyframeStream::~KeyframeStream()
+    {
+        for (auto& [keyframe, read] : mPendingReads)
+        {
+            try
+            {
+                read.task.finish();
+            }
+            catch (const std::exception&)
+            {
+                // Errors of reads that were never used are ignored.
+            }
+        }
+    }
+
+    uint2 KeyframeStream::acquire(uint2 keyframes, bool forward, bool wrap)
+    {
+        FALCOR_ASSERT(keyframes.x < getKeyframeCount() && keyframes.y < getKeyframeCount());
+
+        const auto window = getWindow(keyframes, forward, wrap);
+        auto isInWindow = [&window](uint32_t keyframe) { return std::find(window.begin(), window.end(), keyframe) != window.end(); };
+
+        uint2 slots;
+        slots.x = makeResident(keyframes.x, window);
+        slots.y = makeResident(keyframes.y, window);
+
+        // Upload finished reads of upcoming keyframes and drop the reads that fell out of the window.
+        for (auto it = mPendingReads.begin(); it != mPendingReads.end();)
+        {
+            if (!isInWindow(it->first))
+            {
+                // Running reads keep their own reference to the data, so dropping them is safe.
+                it = mPendingReads.erase(it);
+                continue;
+            }
+            if (it->second.task.isRunning())
+            {
+                ++it;
+                continue;
+            }
+
+            it->second.task.finish();
+            uint32_t slot = allocateSlot(window);
+            FALCOR_ASSERT(slot != kInvalidSlot);
+            upload(it->first, slot, it->second.pData->data());
+            it = mPendingReads.erase(it);
+        }
+
+        // Start reading the upcoming keyframes that are not resident yet.
+        // Without a thread pool, keyframes are only read on demand.
+        if (Threading::getThreadCount() > 0)
+        {
+            for (uint32_t keyframe : window)
+            {
+                if (mKeyframeSlots[keyframe] != kInvalidSlot || mPendingReads.count(keyframe) > 0) continue;
+
+                PendingRead read;
+                read.pData = std::make_shared<std::vector<uint8_t>>(mpFile->getChunkSize(mChunkIDs[keyframe]));
+                read.task = Threading::dispatchTask([pFile = mpFile, chunkID = mChunkIDs[keyframe], pData = read.pData]()
+                {
+                    pFile->readChunk(chunkID, pData->data());
+                });
+                mPendingReads.emplace(keyframe, std::move(read));
+            }
+        }
+
+        return slots;
+    }
+
+    std::vector<uint32_t> KeyframeStream::getWindow(uint2 keyframes, bool forward, bool wrap) const
+    {
+        const uint32_t keyframeCount = getKeyframeCount();
+        const uint32_t slotCount = getSlotCount();
+
+        std::vector<uint32_t> window;
+        window.reserve(slotCount);
+        auto add = [&window](uint32_t keyframe)
+        {
+            if (std::find(window.begin(), window.end(), keyframe) == window.end()) window.push_back(keyframe);
+        };
+
+        add(keyframes.x);
+        add(keyframes.y);
+
+        // Continue in playback direction from the keyframe that is reached last.
+        uint32_t keyframe = forward ? keyframes.y : keyframes.x;
+        for (uint32_t i = 0; i < keyframeCount && window.size() < slotCount; i++)
+        {
+            if (forward)
+            {
+                if (keyframe + 1 < keyframeCount) keyframe++;
+                else if (wrap) keyframe = 0;
+                else break;
+            }
+            else
+            {
+                if (keyframe > 0) keyframe--;
+                else if (wrap) keyframe = keyframeCount - 1;
+                else break;
+            }
+            add(keyframe);
+        }
+
+        return window;
+    }
+
+    uint32_t KeyframeStream::makeResident(uint32_t keyframe, const std::vector<uint32_t>& window)
+    {
+        mStats.requests++;
+
+        uint32_t slot = mKeyframeSlots[keyframe];
+        if (slot != kInvalidSlot)
+        {
+            mStats.hits++;
+            mSlotLastUse[slot] = ++mUseCounter;
+            return slot;
+        }
+
+        std::shared_ptr<std::vector<uint8_t>> pData;
+        auto it = mPendingReads.find(keyframe);
+        if (it != mPendingReads.end() && !it->second.task.isRunning())
+        {
+            mStats.hits++;
+            it->second.task.finish();
+            pData = it->second.pData;
+            mPendingReads.erase(it);
+        }
+        else
+        {
+            mStats.stalls++;
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            if (it != mPendingReads.end())
+            {
+                it->second.task.finish();
+                pData = it->second.pData;
+                mPendingReads.erase(it);
+            }
+            else
+            {
+                pData = std::make_shared<std::vector<uint8_t>>(mpFile->getChunkSize(mChunkIDs[keyframe]));
+                mpFile->readChunk(mChunkIDs[keyframe], pData->data());
+            }
+            mStats.stallTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        }
+
+        slot = allocateSlot(window);
+        FALCOR_ASSERT(slot != kInvalidSlot);
+        upload(keyframe, slot, pData->data());
+        return slot;
+    }
+
+    uint32_t KeyframeStream::allocateSlot(const std::vector<uint32_t>& window)
+    {
+        // Use an empty slot if there is one, otherwise evict the least recently used keyframe outside the window.
+        uint32_t lruSlot = kInvalidSlot;
+        for (uint32_t slot = 0; slot < getSlotCount(); slot++)
+        {
+            uint32_t keyframe = mSlotKeyframes[slot];
+            if (keyframe == kInvalidSlot) return slot;
+            if (std::find(window.begin(), window.end(), keyframe) != window.end()) continue;
+            if (lruSlot == kInvalidSlot || mSlotLastUse[slot] < mSlotLastUse[lruSlot]) lruSlot = slot;
+        }
+
+        if (lruSlot != kInvalidSlot) mKeyframeSlots[mSlotKeyframes[lruSlot]] = kInvalidSlot;
+        return lruSlot;
+    }
+
+    void KeyframeStream::upload(uint32_t keyframe, uint32_t slot, const void* pData)
+    {
+        size_t size = mpFile->getChunkSize(mChunkIDs[keyframe]);
+        mUpload(slot, pData, size);
+
+        mSlotKeyframes[slot] = keyframe;
+        mSlotLastUse[slot] = ++mUseCounter;
+        mKeyframeSlots[keyframe] = slot;
+        mStats.uploads++;
+        mStats.uploadedBytes += size;
+    }
+}
@@ -0,0 +1,216 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Threading.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Falcor
+{
+    /** File storing keyframe data in chunks that can be read independently.
+        The file starts with a header and ends with the chunk table, which is written by finish(). Finished files can be reopened with open().
+        Scratch files are created in the system temp directory and deleted when the object is destroyed.
+    */
+    class FALCOR_API KeyframeFile
+    {
+    public:
+        using SharedPtr = std::shared_ptr<KeyframeFile>;
+
+        /** Create an empty scratch file. Throws a RuntimeError if the file cannot be created.
+        */
+        static SharedPtr create();
+
+        /** Create an empty file that is kept when the object is destroyed. Throws a RuntimeError if the file cannot be created.
+            \param[in] path File path.
+        */
+        static SharedPtr create(const std::filesystem::path& path);
+
+        /** Open a finished file for reading. Throws a RuntimeError if the file cannot be opened or is invalid.
+            \param[in] path File path.
+        */
+        static SharedPtr open(const std::filesystem::path& path);
+
+        ~KeyframeFile();
+
+        /** Append a chunk.
+            \param[in] pData Chunk data.
+            \param[in] size Chunk size in bytes.
+            \return Chunk ID.
+        */
+        uint32_t addChunk(const void* pData, size_t size);
+
+        /** Write the chunk table. No chunks can be added afterwards.
+        */
+        void finish();
+
+        /** Get the number of chunks.
+        */
+        uint32_t getChunkCount() const { return (uint32_t)mChunks.size(); }
+
+        /** Get the size of a chunk in bytes.
+        */
+        size_t getChunkSize(uint32_t chunkID) const { return mChunks[chunkID].size; }
+
+        /** Read a chunk. This is thread-safe.
+            \param[in] chunkID Chunk ID.
+            \param[out] pData Buffer receiving getChunkSize() bytes.
+        */
+        void readChunk(uint32_t chunkID, void* pData) const;
+
+        /** Get the size of the chunk data in bytes.
+        */
+        uint64_t getSize() const { return mSize; }
+
+    private:
+        KeyframeFile(const std::filesystem::path& path, bool create, bool deleteOnDestroy);
+
+        void readTable();
+
+        struct Chunk
+        {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        std::filesystem::path mPath;
+        mutable std::fstream mStream;
+        mutable std::mutex mMutex;
+        std::vector<Chunk> mChunks;
+        uint64_t mSize = 0;
+        uint64_t mEnd = 0;              ///< Offset of the end of the chunk data.
+        bool mWritable = false;
+        bool mDeleteOnDestroy = false;
+    };
+
+    /** Streams the keyframes of a vertex cache track through a ring of resident slots.
+        The two keyframes being interpolated and the keyframes following them in playback direction are kept resident,
+        up to the number of slots. Keyframes that are not resident yet are read from the keyframe file on the thread pool
+        ahead of time and uploaded to a free or least recently used slot when they are needed.
+    */
+    class FALCOR_API KeyframeStream
+    {
+    public:
+        static constexpr uint32_t kInvalidSlot = uint32_t(-1);
+
+        /** Function uploading keyframe data to a slot.
+        */
+        using UploadFunc = std::function<void(uint32_t slot, const void* pData, size_t size)>;
+
+        /** Streaming statistics.
+        */
+        struct Stats
+        {
+            uint64_t requests = 0;          ///< Number of keyframe requests.
+            uint64_t hits = 0;              ///< Requests for keyframes that were resident or prefetched.
+            uint64_t stalls = 0;            ///< Requests that had to wait for keyframe data to be read.
+            uint64_t uploads = 0;           ///< Number of keyframes uploaded to the slots.
+            uint64_t uploadedBytes = 0;     ///< Number of bytes uploaded to the slots.
+            double stallTime = 0.0;         ///< Time in milliseconds spent waiting for keyframe data.
+
+            Stats& operator+=(const Stats& other)
+            {
+                requests += other.requests;
+                hits += other.hits;
+                stalls += other.stalls;
+                uploads += other.uploads;
+                uploadedBytes += other.uploadedBytes;
+                stallTime += other.stallTime;
+                return *this;
+            }
+        };
+
+        /** Constructor.
+            \param[in] pFile File holding the keyframe data.
+            \param[in] chunkIDs Chunk ID of each keyframe in the file.
+            \param[in] slotCount Number of resident slots. Must be at least two unless there are fewer keyframes.
+            \param[in] upload Function uploading keyframe data to a slot.
+        */
+        KeyframeStream(const KeyframeFile::SharedPtr& pFile, std::vector<uint32_t> chunkIDs, uint32_t slotCount, UploadFunc upload);
+
+        /** Destructor. Waits for pending reads.
+        */
+        ~KeyframeStream();
+
+        KeyframeStream(const KeyframeStream&) = delete;
+        KeyframeStream& operator=(const KeyframeStream&) = delete;
+
+        /** Make two keyframes resident and start reading the keyframes following them.
+            \param[in] keyframes Indices of the keyframes to interpolate.
+            \param[in] forward True if playback runs forward in time.
+            \param[in] wrap True if playback wraps around from the last to the first keyframe.
+            \return Slots holding the keyframes.
+        */
+        uint2 acquire(uint2 keyframes, bool forward, bool wrap);
+
+        /** Get the slot holding a keyframe.
+            \return The slot, or kInvalidSlot if the keyframe is not resident.
+        */
+        uint32_t getSlot(uint32_t keyframe) const { return mKeyframeSlots[keyframe]; }
+
+        /** Get the number of keyframes.
+        */
+        uint32_t getKeyframeCount() const { return (uint32_t)mChunkIDs.size(); }
+
+        /** Get the number of resident slots.
+        */
+        uint32_t getSlotCount() const { return (uint32_t)mSlotKeyframes.size(); }
+
+        /** Get the streaming statistics.
+        */
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        struct PendingRead
+        {
+            Threading::Task task;
+            std::shared_ptr<std::vector<uint8_t>> pData;
+        };
+
+        std::vector<uint32_t> getWindow(uint2 keyframes, bool forward, bool wrap) const;
+        uint32_t makeResident(uint32_t keyframe, const std::vector<uint32_t>& window);
+        uint32_t allocateSlot(const std::vector<uint32_t>& window);
+        void upload(uint32_t keyframe, uint32_t slot, const void* pData);
+
+        KeyframeFile::SharedPtr mpFile;
+        std::vector<uint32_t> mChunkIDs;
+        UploadFunc mUpload;
+
+        std::vector<uint32_t> mSlotKeyframes;       ///< Keyframe held by each slot, or kInvalidSlot if the slot is empty.
+        std::vector<uint64_t> mSlotLastUse;         ///< Request counter value at the last use of each slot.
+        std::vector<uint32_t> mKeyframeSlots;       ///< Slot holding each keyframe, or kInvalidSlot if the keyframe is not resident.
+        std::map<uint32_t, PendingRead> mPendingReads;
+        uint64_t mUseCounter = 0;
+
+        Stats mStats;
+    };
+}
@@ -0,0 +1,333 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "TransformHierarchy.h"
+#include "Utils/Threading.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_HIERARCHY_SSE2 1
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        // Minimum number of nodes per task. Levels with fewer nodes to update are processed on the calling thread.
+        const size_t kGrainSize = 1024;
+
+        // Minimum number of nodes in a level for its subtrees to be updated in parallel.
+        const uint32_t kMinSubtreeCount = 64;
+
+#if defined(TRANSFORM_HIERARCHY_SSE2)
+        /** Matrix with one column per register.
+        */
+        struct Mat4
+        {
+            __m128 c[4];
+        };
+
+        inline Mat4 load(const glm::mat4& m)
+        {
+            return { _mm_loadu_ps(&m[0][0]), _mm_loadu_ps(&m[1][0]), _mm_loadu_ps(&m[2][0]), _mm_loadu_ps(&m[3][0]) };
+        }
+
+        inline void store(const Mat4& m, glm::mat4& result)
+        {
+            for (int i = 0; i < 4; i++) _mm_storeu_ps(&result[i][0], m.c[i]);
+        }
+
+        template<int X, int Y, int Z, int W>
+        inline __m128 swizzle(__m128 v)
+        {
+            return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        inline Mat4 transpose(Mat4 m)
+        {
+            _MM_TRANSPOSE4_PS(m.c[0], m.c[1], m.c[2], m.c[3]);
+            return m;
+        }
+
+        /** Matrix product a * b. The terms are summed in the same order as in glm's operator*.
+        */
+        inline Mat4 multiply(const Mat4& a, const Mat4& b)
+        {
+            Mat4 result;
+            for (int i = 0; i < 4; i++)
+            {
+                __m128 sum = _mm_mul_ps(a.c[0], swizzle<0, 0, 0, 0>(b.c[i]));
+                sum = _mm_add_ps(sum, _mm_mul_ps(a.c[1], swizzle<1, 1, 1, 1>(b.c[i])));
+                sum = _mm_add_ps(sum, _mm_mul_ps(a.c[2], swizzle<2, 2, 2, 2>(b.c[i])));
+                result.c[i] = _mm_add_ps(sum, _mm_mul_ps(a.c[3], swizzle<3, 3, 3, 3>(b.c[i])));
+            }
+            return result;
+        }
+
+        /** Transposed inverse of a matrix.
+            This evaluates the cofactor expansion of glm::inverse() with the four components of each of its vec4 operations in one register.
+        */
+        inline Mat4 inverseTranspose(const Mat4& m)
+        {
+            // Rows of the matrix, i.e. t.c[r] = (m[0][r], m[1][r], m[2][r], m[3][r]).
+            const Mat4 t = transpose(m);
+
+            // 2x2 determinants of rows r and s, corresponding to glm's Fac0 to Fac5.
+            auto factor = [](__m128 r, __m128 s)
+            {
+                return _mm_sub_ps(_mm_mul_ps(swizzle<2, 2, 1, 1>(r), swizzle<3, 3, 3, 2>(s)), _mm_mul_ps(swizzle<3, 3, 3, 2>(r), swizzle<2, 2, 1, 1>(s)));
+            };
+            const __m128 fac0 = factor(t.c[2], t.c[3]);
+            const __m128 fac1 = factor(t.c[1], t.c[3]);
+            const __m128 fac2 = factor(t.c[1], t.c[2]);
+            const __m128 fac3 = factor(t.c[0], t.c[3]);
+            const __m128 fac4 = factor(t.c[0], t.c[2]);
+            const __m128 fac5 = factor(t.c[0], t.c[1]);
+
+            const __m128 vec0 = swizzle<1, 0, 0, 0>(t.c[0]);
+            const __m128 vec1 = swizzle<1, 0, 0, 0>(t.c[1]);
+            const __m128 vec2 = swizzle<1, 0, 0, 0>(t.c[2]);
+            const __m128 vec3 = swizzle<1, 0, 0, 0>(t.c[3]);
+
+            auto cofactors = [](__m128 a, __m128 fa, __m128 b, __m128 fb, __m128 c, __m128 fc, __m128 sign)
+            {
+                __m128 result = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(a, fa), _mm_mul_ps(b, fb)), _mm_mul_ps(c, fc));
+                return _mm_mul_ps(result, sign);
+            };
+            const __m128 signA = _mm_setr_ps(1.f, -1.f, 1.f, -1.f);
+            const __m128 signB = _mm_setr_ps(-1.f, 1.f, -1.f, 1.f);
+
+            Mat4 inverse;
+            inverse.c[0] = cofactors(vec1, fac0, vec2, fac1, vec3, fac2, signA);
+            inverse.c[1] = cofactors(vec0, fac0, vec2, fac3, vec3, fac4, signB);
+            inverse.c[2] = cofactors(vec0, fac1, vec1, fac3, vec3, fac5, signA);
+            inverse.c[3] = cofactors(vec0, fac2, vec1, fac4, vec2, fac5, signB);
+
+            // Determinant from the first row of the inverse, summed pairwise as in glm.
+            const __m128 row0 = _mm_movelh_ps(_mm_unpacklo_ps(inverse.c[0], inverse.c[1]), _mm_unpacklo_ps(inverse.c[2], inverse.c[3]));
+            float dot[4];
+            _mm_storeu_ps(dot, _mm_mul_ps(m.c[0], row0));
+            const __m128 oneOverDeterminant = _mm_set1_ps(1.f / ((dot[0] + dot[1]) + (dot[2] + dot[3])));
+
+            for (int i = 0; i < 4; i++) inverse.c[i] = _mm_mul_ps(inverse.c[i], oneOverDeterminant);
+            return transpose(inverse);
+        }
+#else
+        using Mat4 = glm::mat4;
+
+        inline Mat4 load(const glm::mat4& m) { return m; }
+        inline void store(const Mat4& m, glm::mat4& result) { result = m; }
+        inline Mat4 multiply(const Mat4& a, const Mat4& b) { return a * b; }
+        inline Mat4 inverseTranspose(const Mat4& m) { return glm::transpose(glm::inverse(m)); }
+#endif
+    }
+
+    TransformHierarchy::TransformHierarchy(const std::vector<uint32_t>& parents)
+        : mParents(parents)
+    {
+        checkArgument(parents.size() < kInvalidNode, "Too many nodes ({})", parents.size());
+        const uint32_t nodeCount = (uint32_t)parents.size();
+
+        // Compute the level of each node. Parents precede their children, so one pass in node order is enough.
+        mLevels.resize(nodeCount);
+        std::vector<uint32_t> levelSizes;
+        for (uint32_t nodeID = 0; nodeID < nodeCount; nodeID++)
+        {
+            uint32_t parentID = parents[nodeID];
+            if (parentID != kInvalidNode && parentID >= nodeID) throw RuntimeError("Scene graph node {} has parent {}. Parents must precede their children.", nodeID, parentID);
+            mLevels[nodeID] = parentID == kInvalidNode ? 0 : mLevels[parentID] + 1;
+            if (mLevels[nodeID] == levelSizes.size()) levelSizes.push_back(0);
+            levelSizes[mLevels[nodeID]]++;
+        }
+        mLevelCount = (uint32_t)levelSizes.size();
+
+        // List the children of each node, ordered by node ID.
+        mChildOffsets.assign(nodeCount + 1, 0);
+        for (uint32_t parentID : parents)
+        {
+            if (parentID != kInvalidNode) mChildOffsets[parentID + 1]++;
+        }
+        for (uint32_t nodeID = 0; nodeID < nodeCount; nodeID++) mChildOffsets[nodeID + 1] += mChildOffsets[nodeID];
+
+        std::vector<uint32_t> nextChild(mChildOffsets.begin(), mChildOffsets.end() - 1);
+        mChildren.resize(mChildOffsets[nodeCount]);
+        for (uint32_t nodeID = 0; nodeID < nodeCount; nodeID++)
+        {
+            if (parents[nodeID] != kInvalidNode) mChildren[nextChild[parents[nodeID]]++] = nodeID;
+        }
+
+        mSplitLevel = mLevelCount;
+        for (uint32_t level = 0; level < mLevelCount; level++)
+        {
+            if (levelSizes[level] >= kMinSubtreeCount)
+            {
+                mSplitLevel = level;
+                break;
+            }
+        }
+
+        // Assign the nodes to groups. There is one group per level above the split level, followed by one group
+        // per subtree rooted at the split level.
+        mGroups.resize(nodeCount);
+        uint32_t groupCount = mSplitLevel;
+        for (uint32_t nodeID = 0; nodeID < nodeCount; nodeID++)
+        {
+            if (mLevels[nodeID] < mSplitLevel) mGroups[nodeID] = mLevels[nodeID];
+            else if (mLevels[nodeID] == mSplitLevel) mGroups[nodeID] = groupCount++;
+            else mGroups[nodeID] = mGroups[parents[nodeID]];
+        }
+
+        // Sort the nodes by group with a counting sort. The sort is stable, so the nodes within a group are ordered by ID.
+        mGroupOffsets.assign(groupCount + 1, 0);
+        for (uint32_t group : mGroups) mGroupOffsets[group + 1]++;
+        for (uint32_t group = 0; group < groupCount; group++) mGroupOffsets[group + 1] += mGroupOffsets[group];
+
+        std::vector<uint32_t> nextOffsets(mGroupOffsets.begin(), mGroupOffsets.end() - 1);
+        mNodes.resize(nodeCount);
+        mNodeOrder.resize(nodeCount);
+        for (uint32_t nodeID = 0; nodeID < nodeCount; nodeID++)
+        {
+            mNodeOrder[nodeID] = nextOffsets[mGroups[nodeID]]++;
+            mNodes[mNodeOrder[nodeID]] = nodeID;
+        }
+
+        mDirtyLevels.resize(mLevelCount);
+        mDirtyMarks.assign(nodeCount, 0);
+    }
+
+    void TransformHierarchy::update(const Matrices& matrices, const std::vector<uint32_t>& changedNodes, std::vector<bool>& changed, bool updateAll)
+    {
+        FALCOR_ASSERT(changed.size() == mParents.size());
+        FALCOR_ASSERT(matrices.pLocal && matrices.pGlobal && matrices.pInvTransposeGlobal);
+        FALCOR_ASSERT(!matrices.pLocalToBindSpace || (matrices.pSkinning && matrices.pInvTransposeSkinning));
+
+        if (mParents.empty()) return;
+
+        // Propagate the changes level by level. Each level list holds the changed nodes of the level, and the children
+        // of its nodes are appended to the list of the next level. Every changed node is visited once.
+        for (auto& dirtyLevel : mDirtyLevels) dirtyLevel.clear();
+        for (uint32_t nodeID : changedNodes)
+        {
+            FALCOR_ASSERT(nodeID < mParents.size());
+            if (mDirtyMarks[nodeID]) continue;
+            mDirtyMarks[nodeID] = 1;
+            mDirtyLevels[mLevels[nodeID]].push_back(nodeID);
+        }
+
+        for (uint32_t level = 0; level < mLevelCount; level++)
+        {
+            // The list of the next level grows while iterating, so index into the lists rather than holding references.
+            for (size_t i = 0; i < mDirtyLevels[level].size(); i++)
+            {
+                uint32_t nodeID = mDirtyLevels[level][i];
+                changed[nodeID] = true;
+                for (uint32_t c = mChildOffsets[nodeID]; c < mChildOffsets[nodeID + 1]; c++)
+                {
+                    uint32_t childID = mChildren[c];
+                    if (mDirtyMarks[childID]) continue;
+                    mDirtyMarks[childID] = 1;
+                    mDirtyLevels[level + 1].push_back(childID);
+                }
+            }
+        }
+
+        // Update the levels above the split level in order. The nodes of a level only depend on the nodes of the previous levels.
+        for (uint32_t level = 0; level < mSplitLevel; level++)
+        {
+            const uint32_t* pNodes = updateAll ? mNodes.data() + mGroupOffsets[level] : mDirtyLevels[level].data();
+            size_t count = updateAll ? mGroupOffsets[level + 1] - mGroupOffsets[level] : mDirtyLevels[level].size();
+            Threading::parallelFor(0, count, [&](size_t begin, size_t end)
+            {
+                updateNodes(matrices, pNodes + begin, end - begin);
+            }, kGrainSize);
+        }
+
+        // Collect the changed nodes of the subtrees. Sorting them by their index in the update order groups them by subtree.
+        const uint32_t* pSubtreeNodes = mNodes.data();
+        const uint32_t* pSubtreeOffsets = mGroupOffsets.data() + mSplitLevel;
+        size_t subtreeCount = mGroupOffsets.size() - 1 - mSplitLevel;
+        if (!updateAll)
+        {
+            mDirtyNodes.clear();
+            for (uint32_t level = mSplitLevel; level < mLevelCount; level++)
+            {
+                mDirtyNodes.insert(mDirtyNodes.end(), mDirtyLevels[level].begin(), mDirtyLevels[level].end());
+            }
+            std::sort(mDirtyNodes.begin(), mDirtyNodes.end(), [this](uint32_t a, uint32_t b) { return mNodeOrder[a] < mNodeOrder[b]; });
+
+            mDirtyOffsets.clear();
+            for (uint32_t i = 0; i < (uint32_t)mDirtyNodes.size(); i++)
+            {
+                if (i == 0 || mGroups[mDirtyNodes[i]] != mGroups[mDirtyNodes[i - 1]]) mDirtyOffsets.push_back(i);
+            }
+            mDirtyOffsets.push_back((uint32_t)mDirtyNodes.size());
+
+            pSubtreeNodes = mDirtyNodes.data();
+            pSubtreeOffsets = mDirtyOffsets.data();
+            subtreeCount = mDirtyOffsets.size() - 1;
+        }
+
+        // Update the subtrees in parallel. Consecutive subtrees are stored contiguously, so a range of subtrees is updated in one go.
+        size_t subtreeNodeCount = pSubtreeOffsets[subtreeCount] - pSubtreeOffsets[0];
+        if (subtreeNodeCount > 0)
+        {
+            // Choose the number of subtrees per task to get about kGrainSize nodes per task on average.
+            size_t grainSize = std::max<size_t>(kGrainSize * subtreeCount / subtreeNodeCount, 1);
+            Threading::parallelFor(0, subtreeCount, [&](size_t begin, size_t end)
+            {
+                updateNodes(matrices, pSubtreeNodes + pSubtreeOffsets[begin], pSubtreeOffsets[end] - pSubtreeOffsets[begin]);
+            }, grainSize);
+        }
+
+        for (const auto& dirtyLevel : mDirtyLevels)
+        {
+            for (uint32_t nodeID : dirtyLevel) mDirtyMarks[nodeID] = 0;
+        }
+    }
+
+    void TransformHierarchy::updateNodes(const Matrices& matrices, const uint32_t* pNodes, size_t count) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t nodeID = pNodes[i];
+            uint32_t parentID = mParents[nodeID];
+
+            Mat4 global = load(matrices.pLocal[nodeID]);
+            if (parentID != kInvalidNode) global = multiply(load(matrices.pGlobal[parentID]), global);
+            store(global, matrices.pGlobal[nodeID]);
+            store(inverseTranspose(global), matrices.pInvTransposeGlobal[nodeID]);
+
+            if (matrices.pLocalToBindSpace)
+            {
+                Mat4 skinning = multiply(global, load(matrices.pLocalToBindSpace[nodeID]));
+                store(skinning, matrices.pSkinning[nodeID]);
+                store(inverseTranspose(skinning), matrices.pInvTransposeSkinning[nodeID]);
+            }
+        }
+    }
+}
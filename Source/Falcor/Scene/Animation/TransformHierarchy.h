@@ -0,0 +1,114 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Scene graph hierarchy laid out in topological levels for updating world transforms in parallel.
+        Level 0 holds the root nodes and level n the nodes whose parent is in level n-1, so the nodes within
+        a level are independent of each other. The levels are updated in order with the nodes of each level in parallel,
+        down to the first level with enough nodes to keep all threads busy. The subtrees below the nodes of that level
+        are then updated in parallel, each in node order. This keeps the memory accesses mostly sequential for
+        scene graphs with deep hierarchies like skeletons.
+        The matrices are computed with SIMD kernels that perform the same floating-point operations in the same order
+        as the glm matrix product and glm::inverse(), so the results are bitwise identical to a serial update with glm.
+    */
+    class FALCOR_API TransformHierarchy
+    {
+    public:
+        static const uint32_t kInvalidNode = -1;
+
+        /** Matrix arrays with one entry per node.
+        */
+        struct Matrices
+        {
+            const glm::mat4* pLocal = nullptr;              ///< Local transforms (input).
+            const glm::mat4* pLocalToBindSpace = nullptr;   ///< Local-to-bind-space transforms (input). Optional, skinning matrices are only updated if set.
+            glm::mat4* pGlobal = nullptr;                   ///< World transforms, i.e. the local transforms concatenated with the world transforms of the parents.
+            glm::mat4* pInvTransposeGlobal = nullptr;       ///< Transposed inverse world transforms.
+            glm::mat4* pSkinning = nullptr;                 ///< Skinning transforms, i.e. the world transform concatenated with the local-to-bind-space transform.
+            glm::mat4* pInvTransposeSkinning = nullptr;     ///< Transposed inverse skinning transforms.
+        };
+
+        TransformHierarchy() = default;
+
+        /** Create the hierarchy.
+            Throws an exception if a parent does not precede its children.
+            \param[in] parents Parent node ID of each node, or kInvalidNode for root nodes.
+        */
+        explicit TransformHierarchy(const std::vector<uint32_t>& parents);
+
+        /** Get the number of nodes.
+        */
+        uint32_t getNodeCount() const { return (uint32_t)mParents.size(); }
+
+        /** Get the number of levels, i.e. the depth of the deepest node plus one.
+        */
+        uint32_t getLevelCount() const { return mLevelCount; }
+
+        /** Get the number of levels that are updated one level at a time. The nodes of the remaining levels are updated by subtree.
+        */
+        uint32_t getSplitLevel() const { return mSplitLevel; }
+
+        /** Propagate changes from the changed nodes to their descendants and update the matrices of the changed nodes.
+            The changes are propagated level by level through lists of changed nodes, so the cost depends on the number
+            of changed nodes and their descendants rather than on the total number of nodes.
+            \param[in] matrices Matrix arrays. The output arrays are only written for changed nodes.
+            \param[in] changedNodes IDs of the nodes whose local transforms changed, in any order and possibly repeated.
+            \param[in,out] changed Change flag per node. On return, the flags of the changed nodes and their descendants are set. Other flags are left unchanged.
+            \param[in] updateAll Update the matrices of all nodes, not only the changed ones.
+        */
+        void update(const Matrices& matrices, const std::vector<uint32_t>& changedNodes, std::vector<bool>& changed, bool updateAll);
+
+    private:
+        void updateNodes(const Matrices& matrices, const uint32_t* pNodes, size_t count) const;
+
+        std::vector<uint32_t> mParents;         ///< Parent node ID of each node.
+        std::vector<uint32_t> mLevels;          ///< Level of each node.
+        std::vector<uint32_t> mGroups;          ///< Group of each node, see mGroupOffsets.
+        std::vector<uint32_t> mChildOffsets;    ///< Offset of the first child of each node in mChildren, plus the child count.
+        std::vector<uint32_t> mChildren;        ///< Child node IDs, grouped by parent.
+        uint32_t mLevelCount = 0;               ///< Number of levels.
+        uint32_t mSplitLevel = 0;               ///< First level whose nodes are the roots of subtrees that are updated in parallel.
+
+        /** Nodes in update order. These are the nodes of the levels above the split level ordered by level, followed by
+            the nodes of the subtrees ordered by subtree. The nodes of a level or subtree are ordered by node ID.
+        */
+        std::vector<uint32_t> mNodes;
+        std::vector<uint32_t> mNodeOrder;       ///< Index of each node in mNodes.
+        std::vector<uint32_t> mGroupOffsets;    ///< Offset of the first node of each level and then each subtree in mNodes, plus the node count.
+
+        std::vector<std::vector<uint32_t>> mDirtyLevels;    ///< Scratch lists of the changed nodes of each level.
+        std::vector<uint8_t> mDirtyMarks;                   ///< Scratch flag per node, set for the nodes in mDirtyLevels.
+        std::vector<uint32_t> mDirtyNodes;                  ///< Scratch list of the changed nodes of the subtrees, in update order.
+        std::vector<uint32_t> mDirtyOffsets;                ///< Offset of the first node of each changed subtree in mDirtyNodes, plus the total count.
+    };
+}
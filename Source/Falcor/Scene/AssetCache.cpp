@@ -0,0 +1,229 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "AssetCache.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Asset cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/AssetCache";
+
+        const char kMagic[4] = { 'F', 'A', 'C', 'E' };
+        const uint32_t kVersion = 1;
+
+        struct EntryHeader
+        {
+            char magic[4]{};
+            uint32_t version = 0;
+            uint64_t size = 0;
+        };
+
+        const size_t kFileReadChunkSize = 4 * 1024 * 1024;
+        const size_t kBulkDataSize = 4096; ///< Data of at least this size is hashed with Hash128 before adding it to the key.
+
+        std::mutex sActiveMutex;
+        AssetCache::SharedPtr spActive;
+        bool sActiveReadEntries = true;
+    }
+
+    // KeyBuilder
+
+    AssetCache::KeyBuilder::KeyBuilder(const std::string& type, uint32_t version)
+    {
+        add(type);
+        add(version);
+    }
+
+    AssetCache::KeyBuilder& AssetCache::KeyBuilder::add(const std::string& str)
+    {
+        add((uint64_t)str.size());
+        return addData(str.data(), str.size());
+    }
+
+    AssetCache::KeyBuilder& AssetCache::KeyBuilder::addData(const void* data, size_t size)
+    {
+        if (size >= kBulkDataSize)
+        {
+            // SHA-1 is too slow for bulk data, so only the digest of the much faster Hash128 is added.
+            auto md = Hash128::computeParallel(data, size);
+            mSha1.update(md.data(), md.size());
+            mSha1.update(&size, sizeof(size));
+        }
+        else if (size > 0)
+        {
+            mSha1.update(data, size);
+        }
+        return *this;
+    }
+
+    AssetCache::KeyBuilder& AssetCache::KeyBuilder::addFile(const std::filesystem::path& path)
+    {
+        std::ifstream fs(path, std::ios::binary);
+        if (!fs) throw RuntimeError("Failed to open file '{}' for hashing.", path);
+
+        // The content is hashed with the faster Hash128 and only its digest is added to the key.
+        Hash128 hash;
+        std::vector<char> buffer(kFileReadChunkSize);
+        uint64_t totalSize = 0;
+        while (fs)
+        {
+            fs.read(buffer.data(), buffer.size());
+            size_t count = (size_t)fs.gcount();
+            hash.update(buffer.data(), count);
+            totalSize += count;
+        }
+        if (fs.bad()) throw RuntimeError("Failed to read file '{}' for hashing.", path);
+        auto md = hash.final();
+        addData(md.data(), md.size());
+        return add(totalSize);
+    }
+
+    AssetCache::Key AssetCache::KeyBuilder::getKey()
+    {
+        return mSha1.final();
+    }
+
+    // AssetCache
+
+    AssetCache::SharedPtr AssetCache::create(const std::filesystem::path& directory, uint64_t sizeLimit)
+    {
+        return SharedPtr(new AssetCache(directory, sizeLimit));
+    }
+
+    const AssetCache::SharedPtr& AssetCache::getDefault()
+    {
+        static SharedPtr pDefault = create(getAppDataDirectory() / kDirectory);
+        return pDefault;
+    }
+
+    AssetCache::SharedPtr AssetCache::getActive(bool* pReadEntries)
+    {
+        std::lock_guard<std::mutex> lock(sActiveMutex);
+        if (pReadEntries) *pReadEntries = sActiveReadEntries;
+        return spActive;
+    }
+
+    void AssetCache::setActive(const SharedPtr& pCache, bool readEntries)
+    {
+        std::lock_guard<std::mutex> lock(sActiveMutex);
+        spActive = pCache;
+        sActiveReadEntries = readEntries;
+    }
+
+    AssetCache::AssetCache(const std::filesystem::path& directory, uint64_t sizeLimit)
+        : mpDiskCache(DiskCache::create(directory, sizeLimit))
+    {
+    }
+
+    bool AssetCache::load(const Key& key, std::vector<uint8_t>& data)
+    {
+        // Always check the file system, the entry may have been written by another process.
+        auto name = SHA1::toString(key);
+        std::ifstream fs(mpDiskCache->getEntryPath(name), std::ios::binary);
+
+        EntryHeader header;
+        bool valid = false;
+        if (fs)
+        {
+            fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (fs && std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion)
+            {
+                data.resize(header.size);
+                fs.read(reinterpret_cast<char*>(data.data()), header.size);
+                valid = (uint64_t)fs.gcount() == header.size;
+            }
+        }
+        fs.close();
+
+        if (valid) mpDiskCache->touch(name);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (valid) mStats.hits++;
+        else mStats.misses++;
+        return valid;
+    }
+
+    void AssetCache::store(const Key& key, const void* data, size_t size)
+    {
+        // Write to a temporary file that is renamed on commit, so that readers never see partially written entries.
+        auto name = SHA1::toString(key);
+        auto tempPath = mpDiskCache->createTempPath(name);
+        {
+            std::ofstream fs(tempPath, std::ios::binary);
+            EntryHeader header;
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.size = size;
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(data), size);
+            if (!fs)
+            {
+                fs.close();
+                mpDiskCache->discard(tempPath);
+                logWarning("Failed to write asset cache entry '{}'.", tempPath);
+                return;
+            }
+        }
+
+        if (!mpDiskCache->commit(name, tempPath)) return;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.stores++;
+    }
+
+    void AssetCache::setSizeLimit(uint64_t sizeLimit)
+    {
+        mpDiskCache->setSizeLimit(sizeLimit);
+    }
+
+    uint64_t AssetCache::getSizeLimit() const
+    {
+        return mpDiskCache->getSizeLimit();
+    }
+
+    void AssetCache::clear()
+    {
+        mpDiskCache->clear();
+    }
+
+    AssetCache::Stats AssetCache::getStats() const
+    {
+        auto diskStats = mpDiskCache->getStats();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        Stats stats = mStats;
+        stats.evictions = diskStats.evictions;
+        stats.entryCount = diskStats.entryCount;
+        stats.totalSize = diskStats.totalSize;
+        return stats;
+    }
+}
@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/CryptoUtils.h"
+#include "Utils/DiskCache.h"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Content-addressed on-disk cache for individual processed scene assets.
+        Entries are opaque blobs keyed by a hash of the input data and of the build settings that affect the result.
+        This allows a re-import to only reprocess the assets whose inputs have changed, in contrast to the scene cache
+        which stores the result of a full import.
+        The entries are stored in a DiskCache, so least recently used entries are evicted once the total size
+        exceeds the size limit, and the cache directory can be shared by concurrent processes.
+        All functions are thread safe.
+    */
+    class FALCOR_API AssetCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<AssetCache>;
+        using Key = SHA1::MD;
+
+        static const uint64_t kDefaultSizeLimit = 16ull * 1024 * 1024 * 1024;
+
+        /** Helper for computing cache keys.
+        */
+        class FALCOR_API KeyBuilder
+        {
+        public:
+            /** Constructor.
+                \param[in] type Asset type. Keys of different asset types never collide.
+                \param[in] version Version of the code producing the asset. Increment when the processing changes.
+            */
+            KeyBuilder(const std::string& type, uint32_t version);
+
+            KeyBuilder(const KeyBuilder&) = delete;
+            KeyBuilder& operator=(const KeyBuilder&) = delete;
+
+            template<typename T>
+            KeyBuilder& add(const T& value)
+            {
+                static_assert(std::is_trivially_copyable<T>::value);
+                return addData(&value, sizeof(T));
+            }
+
+            KeyBuilder& add(const std::string& str);
+
+            /** Add raw data.
+                Bulk data (e.g. vertex attributes) is hashed in parallel with Hash128 and only its digest is added to the key.
+            */
+            KeyBuilder& addData(const void* data, size_t size);
+
+            /** Add the content of a file.
+                Throws a RuntimeError if the file cannot be read.
+            */
+            KeyBuilder& addFile(const std::filesystem::path& path);
+
+            Key getKey();
+
+        private:
+            SHA1 mSha1;
+        };
+
+        struct Stats
+        {
+            uint64_t hits = 0;          ///< Number of successful lookups.
+            uint64_t misses = 0;        ///< Number of failed lookups.
+            uint64_t stores = 0;        ///< Number of stored entries.
+            uint64_t evictions = 0;     ///< Number of evicted entries.
+            uint64_t entryCount = 0;    ///< Current number of entries.
+            uint64_t totalSize = 0;     ///< Current total size of all entries in bytes.
+        };
+
+        /** Create an asset cache.
+            \param[in] directory Cache directory. Created if it does not exist.
+            \param[in] sizeLimit Maximum total size of all entries in bytes.
+            \return New object.
+        */
+        static SharedPtr create(const std::filesystem::path& directory, uint64_t sizeLimit = kDefaultSizeLimit);
+
+        /** Get the default asset cache located in the application data directory.
+            The cache is created on first use.
+        */
+        static const SharedPtr& getDefault();
+
+        /** Get the asset cache used by loaders that are invoked without access to a scene builder (e.g. volume grids).
+            \param[out] pReadEntries Optional. Set to false if existing entries must not be used but refreshed instead.
+            \return The active asset cache or nullptr if asset caching is disabled.
+        */
+        static SharedPtr getActive(bool* pReadEntries = nullptr);
+
+        /** Set the active asset cache.
+            \param[in] pCache Asset cache or nullptr to disable caching.
+            \param[in] readEntries If false, loaders ignore existing entries and overwrite them (e.g. when rebuilding the scene cache).
+        */
+        static void setActive(const SharedPtr& pCache, bool readEntries = true);
+
+        /** Look up an entry.
+            \param[in] key Cache key.
+            \param[out] data Entry data if found.
+            \return Returns true if the entry was found.
+        */
+        bool load(const Key& key, std::vector<uint8_t>& data);
+
+        /** Store an entry. An existing entry with the same key is replaced.
+            Least recently used entries are evicted if the size limit is exceeded.
+            \param[in] key Cache key.
+            \param[in] data Entry data.
+            \param[in] size Entry size in bytes.
+        */
+        void store(const Key& key, const void* data, size_t size);
+
+        /** Set the maximum total size of all entries in bytes. Evicts entries if necessary.
+        */
+        void setSizeLimit(uint64_t sizeLimit);
+
+        uint64_t getSizeLimit() const;
+
+        /** Remove all entries.
+        */
+        void clear();
+
+        Stats getStats() const;
+
+        const std::filesystem::path& getDirectory() const { return mpDiskCache->getDirectory(); }
+
+    private:
+        AssetCache(const std::filesystem::path& directory, uint64_t sizeLimit);
+
+        DiskCache::SharedPtr mpDiskCache;
+
+        mutable std::mutex mMutex;
+        Stats mStats;
+    };
+}
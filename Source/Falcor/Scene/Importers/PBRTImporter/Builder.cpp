@@ -213,6 +213,12 @@ namespace Falcor
         {
         }
 
+        BasicSceneBuilder::BasicSceneBuilder(std::unique_ptr<BasicScene> pImportScene)
+            : mpImportScene(std::move(pImportScene))
+            , mScene(*mpImportScene)
+        {
+        }
+
         void BasicSceneBuilder::onReverseOrientation(FileLoc loc)
         {
             VERIFY_WORLD("ReverseOrientation");
@@ -463,6 +469,117 @@ namespace Falcor
             mScene.addInstances(mInstances);
         }
 
+        std::unique_ptr<BasicSceneBuilder> BasicSceneBuilder::copyForImport(FileLoc loc)
+        {
+            VERIFY_WORLD("Import");
+
+            if (mpActiveInstanceDefinition)
+            {
+                throwError(loc, "Import called inside of instance definition.");
+            }
+
+            auto pImportBuilder = std::unique_ptr<BasicSceneBuilder>(new BasicSceneBuilder(std::make_unique<BasicScene>(mScene.mSearchPath)));
+            pImportBuilder->mCurrentBlock = mCurrentBlock;
+            pImportBuilder->mGraphicsState = mGraphicsState;
+            pImportBuilder->mNamedCoordinateSystems = mNamedCoordinateSystems;
+
+            // Unnamed materials are indexed locally in the import builder. The currently active one
+            // is referred to by a placeholder index that is resolved in mergeImported().
+            if (const uint32_t* pIndex = std::get_if<uint32_t>(&mGraphicsState.currentMaterial))
+            {
+                pImportBuilder->mInheritedMaterialIndex = *pIndex;
+                pImportBuilder->mGraphicsState.currentMaterial = BasicScene::kInheritedMaterialIndex;
+            }
+
+            return pImportBuilder;
+        }
+
+        void BasicSceneBuilder::mergeImported(BasicSceneBuilder& importBuilder)
+        {
+            FALCOR_ASSERT(importBuilder.mpImportScene);
+            BasicScene& imported = *importBuilder.mpImportScene;
+
+            // Imported files cannot change the graphics state of the importing file.
+            if (!importBuilder.mStack.empty())
+            {
+                const auto& entry = importBuilder.mStack.back();
+                throwError(entry.loc, "Missing end to {} in imported file.", entry.type == StackEntry::Type::Attribute ? "AttributeBegin" : "ObjectBegin");
+            }
+
+            const uint32_t materialOffset = (uint32_t)mScene.mMaterials.size();
+            const int areaLightOffset = (int)mScene.mAreaLights.size();
+
+            auto remapShape = [&](ShapeSceneEntity& shape)
+            {
+                if (uint32_t* pIndex = std::get_if<uint32_t>(&shape.materialRef))
+                {
+                    *pIndex = *pIndex == BasicScene::kInheritedMaterialIndex ? importBuilder.mInheritedMaterialIndex : *pIndex + materialOffset;
+                }
+                if (shape.lightIndex != -1) shape.lightIndex += areaLightOffset;
+            };
+
+            for (auto& [name, material] : imported.mNamedMaterials)
+            {
+                if (!mNamedMaterialNames.insert(name).second)
+                {
+                    throwError(material.loc, "Redefining named material '{}'.", name);
+                }
+                mScene.mNamedMaterials.emplace(name, std::move(material));
+            }
+
+            for (auto& material : imported.mMaterials)
+            {
+                material.name = fmt::format("Unnamed{}", mUnamedMaterialIndex++);
+                mScene.mMaterials.push_back(std::move(material));
+            }
+
+            for (auto& medium : imported.mMedia)
+            {
+                if (!mMediumNames.insert(medium.name).second)
+                {
+                    throwError(medium.loc, "Redefining named medium '{}'.", medium.name);
+                }
+                mScene.mMedia.push_back(std::move(medium));
+            }
+
+            auto mergeTextures = [](std::set<std::string>& names, std::map<std::string, TextureSceneEntity>& textures, std::map<std::string, TextureSceneEntity>& importedTextures)
+            {
+                for (auto& [name, texture] : importedTextures)
+                {
+                    if (!names.insert(name).second)
+                    {
+                        throwError(texture.loc, "Redefining texture '{}'.", name);
+                    }
+                    textures.emplace(name, std::move(texture));
+                }
+            };
+            mergeTextures(mFloatTextureNames, mScene.mFloatTextures, imported.mFloatTextures);
+            mergeTextures(mSpectrumTextureNames, mScene.mSpectrumTextures, imported.mSpectrumTextures);
+
+            std::move(imported.mLights.begin(), imported.mLights.end(), std::back_inserter(mScene.mLights));
+            std::move(imported.mAreaLights.begin(), imported.mAreaLights.end(), std::back_inserter(mScene.mAreaLights));
+
+            for (auto& [name, instanceDefinition] : imported.mInstanceDefinitions)
+            {
+                if (!mInstanceNames.insert(name).second)
+                {
+                    throwError(instanceDefinition.loc, "{}: trying to redefine an object instance.", name);
+                }
+                for (auto& shape : instanceDefinition.shapes) remapShape(shape);
+                mScene.mInstanceDefinitions.emplace(name, std::move(instanceDefinition));
+            }
+
+            for (auto& shape : importBuilder.mShapes)
+            {
+                remapShape(shape);
+                mShapes.push_back(std::move(shape));
+            }
+            std::move(importBuilder.mInstances.begin(), importBuilder.mInstances.end(), std::back_inserter(mInstances));
+
+            importBuilder.mShapes.clear();
+            importBuilder.mInstances.clear();
+        }
+
         void BasicSceneBuilder::onOption(const std::string& name, const std::string& value, FileLoc loc)
         {
             // Options:
@@ -225,6 +225,11 @@ namespace Falcor
         class BasicScene
         {
         public:
+            /** Unnamed material index used by builders created for 'Import' directives to refer
+                to the unnamed material that was active when the import started.
+            */
+            static constexpr uint32_t kInheritedMaterialIndex = ~0u;
+
             BasicScene(const std::filesystem::path& searchPath);
 
             void setOptions(SceneEntity filter, SceneEntity film, CameraSceneEntity camera,
@@ -284,6 +289,8 @@ namespace Falcor
 
             std::map<std::string, InstanceDefinitionSceneEntity> mInstanceDefinitions;
             std::vector<InstanceSceneEntity> mInstances;
+
+            friend class BasicSceneBuilder;
         };
 
         constexpr uint32_t kMaxTransforms = 2;
@@ -378,7 +385,24 @@ namespace Falcor
 
             void onEndOfFiles() override;
 
+            /** Create a builder for parsing a file referenced by an 'Import' directive.
+                The returned builder inherits the current graphics state but records all entities
+                into its own scene, so it can be used concurrently with this builder.
+                \param[in] loc Location of the 'Import' directive.
+                \return Builder for the imported file.
+            */
+            std::unique_ptr<BasicSceneBuilder> copyForImport(FileLoc loc);
+
+            /** Merge the entities recorded by a builder created with copyForImport().
+                Unnamed materials and area lights are appended to the scene and their indices remapped,
+                so the result only depends on the order in which imports are merged.
+                \param[in] importBuilder Builder for the imported file. Its contents are moved out.
+            */
+            void mergeImported(BasicSceneBuilder& importBuilder);
+
         private:
+            BasicSceneBuilder(std::unique_ptr<BasicScene> pImportScene);
+
             glm::mat4 getTransform() const { return mGraphicsState.ctm[0]; }
 
             static constexpr int kStartTransformBits = 1 << 0;
@@ -416,6 +440,7 @@ namespace Falcor
                 Float transformStartTime = 0, transformEndTime = 1;
             };
 
+            std::unique_ptr<BasicScene> mpImportScene;  ///< Scene owned by builders created for 'Import' directives.
             BasicScene& mScene;
 
             enum class BlockState { OptionsBlock, WorldBlock };
@@ -441,6 +466,7 @@ namespace Falcor
             std::unique_ptr<ActiveInstanceDefinition> mpActiveInstanceDefinition;
 
             uint32_t mUnamedMaterialIndex = 0;
+            uint32_t mInheritedMaterialIndex = BasicScene::kInheritedMaterialIndex; ///< Unnamed material index active when this import builder was created.
             std::set<std::string> mNamedMaterialNames;
             std::set<std::string> mMediumNames;
             std::set<std::string> mFloatTextureNames;
@@ -35,490 +35,646 @@
 #include "LoopSubdivide.h"
 
 #include <algorithm>
-#include <map>
-#include <set>
-#include <memory_resource>
+#include <execution>
+#include <numeric>
 
 namespace Falcor
 {
     namespace pbrt
     {
-        struct SDFace;
-        struct SDVertex;
-
-        #define NEXT(i) (((i) + 1) % 3)
-        #define PREV(i) (((i) + 2) % 3)
-
-        struct SDVertex
+        namespace
         {
-            SDVertex(const float3& p = float3(0.f)) : p(p) {}
+            constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
 
-            int valence();
-            void oneRing(float3 *p);
+            inline uint32_t nextIndex(uint32_t i) { return (i + 1) % 3; }
+            inline uint32_t prevIndex(uint32_t i) { return (i + 2) % 3; }
 
-            float3 p;
-            SDFace* startFace = nullptr;
-            SDVertex* child = nullptr;
-            bool regular = false;
-            bool boundary = false;
-        };
+            [[noreturn]] void throwInvalidTopology()
+            {
+                throw RuntimeError("Invalid mesh topology in Loop subdivision surface.");
+            }
 
-        struct SDFace
-        {
-            SDFace()
+            struct VertexInfo
+            {
+                uint32_t startFace = kInvalidIndex; ///< Any face containing the vertex, or kInvalidIndex if the vertex is unused.
+                bool regular = false;
+                bool boundary = false;
+            };
+
+            /** Flat triangle mesh with face adjacency.
+                Edge i of a face connects the face vertices i and i + 1 and is identified by 3 * face + i.
+                When subdividing, the children of face i are stored at 4 * i + [0..3], the even vertices
+                keep their indices and the odd vertices (one per edge) are appended.
+            */
+            struct SubdivMesh
             {
-                for (uint32_t i = 0; i < 3; ++i)
+                std::vector<float3> positions;
+                std::vector<VertexInfo> vertexInfos;
+                std::vector<uint32_t> faceVertices;     ///< Vertex indices, three per face.
+                std::vector<uint32_t> faceNeighbors;    ///< Neighboring face across each edge, kInvalidIndex on boundaries.
+                std::vector<uint8_t> faceCreases;       ///< Bit i is set if edge i of the face is a crease. Empty if creases are disabled.
+
+                uint32_t getVertexCount() const { return (uint32_t)positions.size(); }
+                uint32_t getFaceCount() const { return (uint32_t)(faceVertices.size() / 3); }
+
+                uint32_t vnum(uint32_t face, uint32_t vertex) const
                 {
-                    v[i] = nullptr;
-                    f[i] = nullptr;
+                    if (face >= getFaceCount()) throwInvalidTopology();
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        if (faceVertices[3 * face + i] == vertex) return i;
+                    }
+                    throwInvalidTopology();
                 }
-                for (uint32_t i = 0; i < 4; ++i)
+
+                uint32_t otherVert(uint32_t face, uint32_t v0, uint32_t v1) const
                 {
-                    children[i] = nullptr;
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        uint32_t v = faceVertices[3 * face + i];
+                        if (v != v0 && v != v1) return v;
+                    }
+                    throwInvalidTopology();
                 }
-            }
 
-            uint32_t vnum(SDVertex* vert) const
+                bool isSharpEdge(uint32_t face, uint32_t edge) const
+                {
+                    return faceNeighbors[3 * face + edge] == kInvalidIndex || (!faceCreases.empty() && (faceCreases[face] & (1 << edge)));
+                }
+            };
+
+            /** Visit the faces around a vertex.
+                Interior vertices are visited starting at the start face, moving across edge i of each face.
+                Boundary vertices are visited starting at the boundary face reached in that direction, moving back across edge i - 1.
+                The visitor is called as visit(face, i), where i is the index of the vertex in the face.
+            */
+            template<typename Visitor>
+            void visitFaces(const SubdivMesh& mesh, uint32_t vertex, Visitor visit)
             {
-                for (int i = 0; i < 3; ++i)
+                const auto& info = mesh.vertexInfos[vertex];
+                if (info.startFace == kInvalidIndex) return;
+
+                // Guard against non-manifold adjacency that never returns to the start face.
+                uint32_t steps = 0;
+                auto step = [&]() { if (++steps > mesh.getFaceCount()) throwInvalidTopology(); };
+
+                uint32_t face = info.startFace;
+                if (!info.boundary)
                 {
-                    if (v[i] == vert) return i;
+                    do
+                    {
+                        uint32_t i = mesh.vnum(face, vertex);
+                        visit(face, i);
+                        face = mesh.faceNeighbors[3 * face + i];
+                        step();
+                    } while (face != info.startFace);
+                }
+                else
+                {
+                    uint32_t nextFace;
+                    while ((nextFace = mesh.faceNeighbors[3 * face + mesh.vnum(face, vertex)]) != kInvalidIndex)
+                    {
+                        face = nextFace;
+                        step();
+                    }
+                    do
+                    {
+                        uint32_t i = mesh.vnum(face, vertex);
+                        visit(face, i);
+                        face = mesh.faceNeighbors[3 * face + prevIndex(i)];
+                        step();
+                    } while (face != kInvalidIndex);
                 }
-                throw RuntimeError("Basic logic error in SDFace::vnum().");
             }
 
-            SDFace* nextFace(SDVertex* vert) const { return f[vnum(vert)]; }
-            SDFace* prevFace(SDVertex* vert) const { return f[PREV(vnum(vert))]; }
-            SDVertex* nextVert(SDVertex* vert) const { return v[NEXT(vnum(vert))]; }
-            SDVertex* prevVert(SDVertex* vert) const { return v[PREV(vnum(vert))]; }
-            SDVertex* otherVert(SDVertex* v0, SDVertex* v1)
+            /** Visit the one-ring vertices of a vertex in the same order as pbrt's SDVertex::oneRing().
+                The visitor is called as visit(ringVertex, sharp), where sharp is true if the edge to the ring vertex is a boundary or crease.
+            */
+            template<typename Visitor>
+            void visitOneRing(const SubdivMesh& mesh, uint32_t vertex, Visitor visit)
             {
-                for (uint32_t i = 0; i < 3; ++i)
+                const bool boundary = mesh.vertexInfos[vertex].boundary;
+                bool first = true;
+                visitFaces(mesh, vertex, [&](uint32_t face, uint32_t i)
                 {
-                    if (v[i] != v0 && v[i] != v1) return v[i];
-                }
-                throw RuntimeError("Basic logic error in SDFace::otherVert()");
+                    if (!boundary || first)
+                    {
+                        visit(mesh.faceVertices[3 * face + nextIndex(i)], mesh.isSharpEdge(face, i));
+                        first = false;
+                    }
+                    if (boundary)
+                    {
+                        visit(mesh.faceVertices[3 * face + prevIndex(i)], mesh.isSharpEdge(face, prevIndex(i)));
+                    }
+                });
             }
 
-            SDVertex* v[3];
-            SDFace* f[3];
-            SDFace* children[4];
-        };
-
-        struct SDEdge
-        {
-            SDEdge(SDVertex* v0 = nullptr, SDVertex* v1 = nullptr)
+            struct RingInfo
             {
-                v[0] = std::min(v0, v1);
-                v[1] = std::max(v0, v1);
-                f[0] = f[1] = nullptr;
-                f0edgeNum = -1;
-            }
+                uint32_t valence = 0;
+                uint32_t sharpCount = 0;            ///< Number of boundary or crease edges.
+                uint32_t sharpVertices[2] = {};     ///< Ring vertices across the first two boundary or crease edges.
+            };
 
-            bool operator<(const SDEdge &e2) const
+            RingInfo getRingInfo(const SubdivMesh& mesh, uint32_t vertex)
             {
-                if (v[0] == e2.v[0]) return v[1] < e2.v[1];
-                return v[0] < e2.v[0];
+                RingInfo ring;
+                visitOneRing(mesh, vertex, [&](uint32_t v, bool sharp)
+                {
+                    if (sharp && ring.sharpCount < 2) ring.sharpVertices[ring.sharpCount] = v;
+                    ring.sharpCount += sharp ? 1 : 0;
+                    ring.valence++;
+                });
+                return ring;
             }
 
-            SDVertex* v[2];
-            SDFace* f[2];
-            int f0edgeNum;
-        };
-
-        static float3 weightOneRing(SDVertex* vert, float beta);
-        static float3 weightBoundary(SDVertex* vert, float beta);
+            /** Subdivision rule of a vertex.
+                Boundary vertices always have two sharp edges, so without creases they use the crease rule.
+                Vertices with a single crease edge (darts) use the smooth rule.
+            */
+            enum class VertexRule
+            {
+                Smooth,
+                Crease,
+                Corner,
+            };
 
-        inline int SDVertex::valence()
-        {
-            SDFace* f = startFace;
-            if (!boundary)
+            VertexRule getVertexRule(const SubdivMesh& mesh, uint32_t vertex, const RingInfo& ring)
             {
-                // Compute valence of interior vertex.
-                int nf = 1;
-                while ((f = f->nextFace(this)) != startFace) ++nf;
-                return nf;
+                if (ring.valence == 0) return VertexRule::Corner;
+                if (!mesh.vertexInfos[vertex].boundary && ring.sharpCount < 2) return VertexRule::Smooth;
+                return ring.sharpCount == 2 ? VertexRule::Crease : VertexRule::Corner;
             }
-            else
+
+            inline float beta(uint32_t valence)
             {
-                // Compute valence of boundary vertex
-                int nf = 1;
-                while ((f = f->nextFace(this)) != nullptr) ++nf;
-                f = startFace;
-                while ((f = f->prevFace(this)) != nullptr) ++nf;
-                return nf + 1;
+                if (valence == 3)
+                    return 3.f / 16.f;
+                else
+                    return 3.f / (8.f * valence);
             }
-        }
-
-        inline float beta(uint32_t valence)
-        {
-            if (valence == 3)
-                return 3.f / 16.f;
-            else
-                return 3.f / (8.f * valence);
-        }
-
-        inline float loopGamma(uint32_t valence)
-        {
-            return 1.f / (valence + 3.f / (8.f * beta(valence)));
-        }
-
-        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
-        {
-            std::vector<SDVertex*> vertices;
-            std::vector<SDFace*> faces;
 
-            // Allocate vertices and faces.
-            std::unique_ptr<SDVertex[]> verts = std::make_unique<SDVertex[]>(positions.size());
-            for (size_t i = 0; i < positions.size(); ++i)
+            inline float loopGamma(uint32_t valence)
             {
-                verts[i] = SDVertex(positions[i]);
-                vertices.push_back(&verts[i]);
+                return 1.f / (valence + 3.f / (8.f * beta(valence)));
             }
-            size_t faceCount = indices.size() / 3;
-            std::unique_ptr<SDFace[]> fs = std::make_unique<SDFace[]>(faceCount);
-            for (size_t i = 0; i < faceCount; ++i)
+
+            float3 weightOneRing(const SubdivMesh& mesh, uint32_t vertex, uint32_t valence, float beta)
             {
-                faces.push_back(&fs[i]);
+                float3 p = (1 - valence * beta) * mesh.positions[vertex];
+                visitOneRing(mesh, vertex, [&](uint32_t v, bool) { p += beta * mesh.positions[v]; });
+                return p;
             }
 
-            // Set face to vertex pointers.
-            const uint32_t* vp = indices.data();
-            for (size_t i = 0; i < faceCount; ++i, vp += 3)
+            float3 weightCrease(const SubdivMesh& mesh, uint32_t vertex, const RingInfo& ring, float beta)
             {
-                SDFace* f = faces[i];
-                for (uint32_t j = 0; j < 3; ++j)
-                {
-                    SDVertex* v = vertices[vp[j]];
-                    f->v[j] = v;
-                    v->startFace = f;
-                }
+                float3 p = (1 - 2 * beta) * mesh.positions[vertex];
+                p += beta * mesh.positions[ring.sharpVertices[0]];
+                p += beta * mesh.positions[ring.sharpVertices[1]];
+                return p;
             }
 
-            // Set neighbor pointers in faces.
-            std::set<SDEdge> edges;
-            for (size_t i = 0; i < faceCount; ++i)
+            /** Compute the tangent normal of a vertex on the limit surface (not normalized).
+                This is only valid for vertices using the smooth rule and for boundary vertices without creases.
+            */
+            float3 computeLimitNormal(const SubdivMesh& mesh, uint32_t vertex, std::vector<float3>& pRing)
             {
-                SDFace* f = faces[i];
-                for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
+                pRing.clear();
+                visitOneRing(mesh, vertex, [&](uint32_t v, bool) { pRing.push_back(mesh.positions[v]); });
+
+                const float3& p = mesh.positions[vertex];
+                uint32_t valence = (uint32_t)pRing.size();
+                float3 S(0.f);
+                float3 T(0.f);
+                if (!mesh.vertexInfos[vertex].boundary)
+                {
+                    // Compute tangents of interior face
+                    for (uint32_t j = 0; j < valence; ++j)
+                    {
+                        S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                        T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                    }
+                }
+                else
                 {
-                    // Update neighbor pointer for edgeNum.
-                    int v0 = edgeNum, v1 = NEXT(edgeNum);
-                    SDEdge e(f->v[v0], f->v[v1]);
-                    if (edges.find(e) == edges.end())
+                    // Compute tangents of boundary face
+                    S = pRing[valence - 1] - pRing[0];
+                    if (valence == 2)
+                    {
+                        T = float3(pRing[0] + pRing[1] - 2.f * p);
+                    }
+                    else if (valence == 3)
+                    {
+                        T = pRing[1] - p;
+                    }
+                    else if (valence == 4) // regular
                     {
-                        // Handle new edge.
-                        e.f[0] = f;
-                        e.f0edgeNum = edgeNum;
-                        edges.insert(e);
+                        T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * p);
                     }
                     else
                     {
-                        // Handle previously seen edge.
-                        e =* edges.find(e);
-                        e.f[0]->f[e.f0edgeNum] = f;
-                        f->f[edgeNum] = e.f[0];
-                        edges.erase(e);
+                        float theta = float(M_PI) / float(valence - 1);
+                        T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
+                        for (uint32_t k = 1; k < valence - 1; ++k)
+                        {
+                            float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
+                            T += float3(wt * pRing[k]);
+                        }
+                        T = -T;
                     }
                 }
+                return cross(S, T);
             }
 
-            // Finish vertex initialization.
-            for (size_t i = 0; i < positions.size(); ++i)
+            float3 computeFaceNormal(const SubdivMesh& mesh, uint32_t face)
             {
-                SDVertex* v = vertices[i];
-                SDFace* f = v->startFace;
-                do
-                {
-                    f = f->nextFace(v);
-                } while ((f != nullptr) && f != v->startFace);
-                v->boundary = (f == nullptr);
-                if (!v->boundary && v->valence() == 6) v->regular = true;
-                else if (v->boundary && v->valence() == 4) v->regular = true;
-                else v->regular = false;
+                const float3& p0 = mesh.positions[mesh.faceVertices[3 * face + 0]];
+                const float3& p1 = mesh.positions[mesh.faceVertices[3 * face + 1]];
+                const float3& p2 = mesh.positions[mesh.faceVertices[3 * face + 2]];
+                return cross(p1 - p0, p2 - p0);
             }
 
-            // Refine LoopSubdiv into triangles.
-            std::vector<SDFace*> f = faces;
-            std::vector<SDVertex*> v = vertices;
-
-            std::pmr::monotonic_buffer_resource buffer;
-            std::pmr::polymorphic_allocator<SDVertex> vertexAllocator(&buffer);
-            std::pmr::polymorphic_allocator<SDFace> faceAllocator(&buffer);
-
-            for (size_t i = 0; i < levels; ++i)
+            struct EdgeKey
             {
-                // Update f and v for next level of subdivision.
-                std::vector<SDFace*> newFaces;
-                std::vector<SDVertex*> newVertices;
+                uint64_t vertexPair;
+                uint32_t edge;
 
-                // Allocate next level of children in mesh tree.
-                for (SDVertex* vertex : v)
+                bool operator<(const EdgeKey& other) const
                 {
-                    vertex->child = vertexAllocator.allocate(1);
-                    vertex->child->regular = vertex->regular;
-                    vertex->child->boundary = vertex->boundary;
-                    newVertices.push_back(vertex->child);
+                    return vertexPair < other.vertexPair || (vertexPair == other.vertexPair && edge < other.edge);
                 }
-                for (SDFace* face : f)
+            };
+
+            /** Returns the edges of all faces sorted by their (unordered) vertex pair and then by edge index.
+            */
+            std::vector<EdgeKey> sortEdges(const SubdivMesh& mesh)
+            {
+                std::vector<EdgeKey> edges(mesh.faceVertices.size());
+                Threading::parallelFor(0, edges.size(), [&](size_t begin, size_t end)
                 {
-                    for (uint32_t k = 0; k < 4; ++k)
+                    for (size_t e = begin; e < end; ++e)
                     {
-                        face->children[k] = faceAllocator.allocate(1);
-                        newFaces.push_back(face->children[k]);
+                        uint32_t v0 = mesh.faceVertices[e];
+                        uint32_t v1 = mesh.faceVertices[e - e % 3 + nextIndex(uint32_t(e % 3))];
+                        edges[e] = { (uint64_t(std::min(v0, v1)) << 32) | std::max(v0, v1), uint32_t(e) };
                     }
-                }
-
-                // Update vertex positions and create new edge vertices.
+                });
+                std::sort(std::execution::par, edges.begin(), edges.end());
+                return edges;
+            }
 
-                // Update vertex positions for even vertices.
-                for (SDVertex* vertex : v)
+            SubdivMesh createControlMesh(fstd::span<const float3> positions, fstd::span<const uint32_t> indices, float creaseAngle)
+            {
+                SubdivMesh mesh;
+                const uint32_t vertexCount = (uint32_t)positions.size();
+                const uint32_t faceCount = (uint32_t)(indices.size() / 3);
+
+                mesh.positions.assign(positions.begin(), positions.end());
+                mesh.vertexInfos.resize(vertexCount);
+                mesh.faceVertices.assign(indices.begin(), indices.begin() + 3 * faceCount);
+                for (uint32_t face = 0; face < faceCount; ++face)
                 {
-                    if (!vertex->boundary)
+                    for (uint32_t i = 0; i < 3; ++i)
                     {
-                        // Apply one-ring rule for even vertex.
-                        if (vertex->regular) vertex->child->p = weightOneRing(vertex, 1.f / 16.f);
-                        else vertex->child->p = weightOneRing(vertex, beta(vertex->valence()));
-                    }
-                    else
-                    {
-                        // Apply boundary rule for even vertex.
-                        vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
+                        uint32_t v = mesh.faceVertices[3 * face + i];
+                        if (v >= vertexCount) throw RuntimeError("Vertex index {} is out of bounds.", v);
+                        mesh.vertexInfos[v].startFace = face;
                     }
                 }
 
-                // Compute new odd edge vertices.
-                std::map<SDEdge, SDVertex*> edgeVerts;
-                for (SDFace* face : f)
+                // Set neighbor pointers in faces.
+                // Edges sharing a vertex pair are linked in pairs in the order they appear, which also
+                // handles non-manifold edges the same way as pbrt's edge set.
+                auto edges = sortEdges(mesh);
+                mesh.faceNeighbors.assign(3 * faceCount, kInvalidIndex);
+                for (size_t i = 0; i + 1 < edges.size(); ++i)
                 {
-                    for (uint32_t k = 0; k < 3; ++k)
+                    if (edges[i].vertexPair == edges[i + 1].vertexPair)
                     {
-                        // Compute odd vertex on kth edge.
-                        SDEdge edge(face->v[k], face->v[NEXT(k)]);
-                        SDVertex* vert = edgeVerts[edge];
-                        if (vert == nullptr)
-                        {
-                            // Create and initialize new odd vertex
-                            vert = vertexAllocator.allocate(1);
-                            newVertices.push_back(vert);
-                            vert->regular = true;
-                            vert->boundary = (face->f[k] == nullptr);
-                            vert->startFace = face->children[3];
-
-                            // Apply edge rules to compute new vertex position
-                            if (vert->boundary)
-                            {
-                                vert->p = 0.5f * edge.v[0]->p;
-                                vert->p += 0.5f * edge.v[1]->p;
-                            }
-                            else
-                            {
-                                vert->p = 3.f / 8.f * edge.v[0]->p;
-                                vert->p += 3.f / 8.f * edge.v[1]->p;
-                                vert->p += 1.f / 8.f * face->otherVert(edge.v[0], edge.v[1])->p;
-                                vert->p += 1.f / 8.f * face->f[k]->otherVert(edge.v[0], edge.v[1])->p;
-                            }
-                            edgeVerts[edge] = vert;
-                        }
+                        mesh.faceNeighbors[edges[i].edge] = edges[i + 1].edge / 3;
+                        mesh.faceNeighbors[edges[i + 1].edge] = edges[i].edge / 3;
+                        ++i;
                     }
                 }
 
-                // Update new mesh topology.
-
-                // Update even vertex face pointers.
-                for (SDVertex* vertex : v)
+                // Detect creases from the dihedral angle between neighboring faces.
+                if (creaseAngle > 0.f)
                 {
-                    int vertNum = vertex->startFace->vnum(vertex);
-                    vertex->child->startFace = vertex->startFace->children[vertNum];
-                }
+                    std::vector<float3> faceNormals(faceCount);
+                    for (uint32_t face = 0; face < faceCount; ++face)
+                    {
+                        float3 n = computeFaceNormal(mesh, face);
+                        float len = length(n);
+                        faceNormals[face] = len > 0.f ? n / len : float3(0.f);
+                    }
 
-                // Update face neighbor pointers.
-                for (SDFace* face : f)
-                {
-                    for (uint32_t j = 0; j < 3; ++j)
+                    float cosCreaseAngle = std::cos(glm::radians(creaseAngle));
+                    mesh.faceCreases.resize(faceCount);
+                    for (uint32_t face = 0; face < faceCount; ++face)
                     {
-                        // Update children f pointers for siblings.
-                        face->children[3]->f[j] = face->children[NEXT(j)];
-                        face->children[j]->f[NEXT(j)] = face->children[3];
-
-                        // Update children f pointers for neighbor children.
-                        SDFace* f2 = face->f[j];
-                        face->children[j]->f[j] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                        f2 = face->f[PREV(j)];
-                        face->children[j]->f[PREV(j)] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
+                        for (uint32_t i = 0; i < 3; ++i)
+                        {
+                            uint32_t neighbor = mesh.faceNeighbors[3 * face + i];
+                            if (neighbor == kInvalidIndex) continue;
+                            const float3& n0 = faceNormals[face];
+                            const float3& n1 = faceNormals[neighbor];
+                            bool degenerate = n0 == float3(0.f) || n1 == float3(0.f);
+                            if (!degenerate && dot(n0, n1) < cosCreaseAngle) mesh.faceCreases[face] |= 1 << i;
+                        }
                     }
                 }
 
-                // Update face vertex pointers.
-                for (SDFace* face : f)
+                // Finish vertex initialization.
+                Threading::parallelFor(0, vertexCount, [&](size_t begin, size_t end)
                 {
-                    for (uint32_t j = 0; j < 3; ++j)
+                    for (uint32_t v = (uint32_t)begin; v < end; ++v)
                     {
-                        // Update child vertex pointer to new even vertex
-                        face->children[j]->v[j] = face->v[j]->child;
-
-                        // Update child vertex pointer to new odd vertex
-                        SDVertex *vert = edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
-                        face->children[j]->v[NEXT(j)] = vert;
-                        face->children[NEXT(j)]->v[j] = vert;
-                        face->children[3]->v[j] = vert;
+                        auto& info = mesh.vertexInfos[v];
+                        if (info.startFace == kInvalidIndex) continue;
+
+                        uint32_t face = info.startFace;
+                        uint32_t steps = 0;
+                        do
+                        {
+                            face = mesh.faceNeighbors[3 * face + mesh.vnum(face, v)];
+                            if (++steps > faceCount) throwInvalidTopology();
+                        } while (face != kInvalidIndex && face != info.startFace);
+                        info.boundary = face == kInvalidIndex;
+
+                        uint32_t valence = getRingInfo(mesh, v).valence;
+                        info.regular = info.boundary ? valence == 4 : valence == 6;
                     }
-                }
+                });
 
-                // Prepare for next level of subdivision
-                f = newFaces;
-                v = newVertices;
+                return mesh;
             }
 
-            // Push vertices to limit surface.
-            std::vector<float3> pLimit(v.size());
-            for (size_t i = 0; i < v.size(); ++i)
-            {
-                if (v[i]->boundary) pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
-                else pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
-            }
-            for (size_t i = 0; i < v.size(); ++i)
+            SubdivMesh subdivide(const SubdivMesh& mesh)
             {
-                v[i]->p = pLimit[i];
-            }
+                const uint32_t vertexCount = mesh.getVertexCount();
+                const uint32_t faceCount = mesh.getFaceCount();
+                const uint32_t edgeCount = 3 * faceCount;
 
-            // Compute vertex tangents on limit surface.
-            std::vector<float3> Ns;
-            Ns.reserve(v.size());
-            std::vector<float3> pRing(16, float3());
-            for (SDVertex* vertex : v)
-            {
-                float3 S(0.f);
-                float3 T(0.f);
-                uint32_t valence = vertex->valence();
-                if (valence > pRing.size()) pRing.resize(valence);
-                vertex->oneRing(&pRing[0]);
-                if (!vertex->boundary)
+                // Assign an odd vertex to each vertex pair. The odd vertices are numbered in the order their
+                // vertex pairs are first encountered when iterating over the face edges, like in pbrt.
+                auto edges = sortEdges(mesh);
+                auto isFirst = [&](size_t i) { return i == 0 || edges[i].vertexPair != edges[i - 1].vertexPair; };
+
+                std::vector<uint32_t> firstEdges(edgeCount, 0);
+                Threading::parallelFor(0, edgeCount, [&](size_t begin, size_t end)
                 {
-                    // Compute tangents of interior face
-                    for (uint32_t j = 0; j < valence; ++j)
+                    for (size_t i = begin; i < end; ++i)
                     {
-                        S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-                        T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                        if (isFirst(i)) firstEdges[edges[i].edge] = 1;
                     }
-                }
-                else
+                });
+
+                std::vector<uint32_t> oddVertices(edgeCount);
+                std::exclusive_scan(std::execution::par, firstEdges.begin(), firstEdges.end(), oddVertices.begin(), vertexCount);
+                const uint32_t oddCount = edgeCount > 0 ? oddVertices.back() + firstEdges.back() - vertexCount : 0;
+
+                Threading::parallelFor(0, edgeCount, [&](size_t begin, size_t end)
                 {
-                    // Compute tangents of boundary face
-                    S = pRing[valence - 1] - pRing[0];
-                    if (valence == 2)
+                    for (size_t i = begin; i < end; ++i)
                     {
-                        T = float3(pRing[0] + pRing[1] - 2.f * vertex->p);
+                        if (!isFirst(i)) continue;
+                        uint32_t oddVertex = oddVertices[edges[i].edge];
+                        for (size_t j = i + 1; j < edgeCount && edges[j].vertexPair == edges[i].vertexPair; ++j)
+                        {
+                            oddVertices[edges[j].edge] = oddVertex;
+                        }
                     }
-                    else if (valence == 3)
+                });
+
+                SubdivMesh child;
+                child.positions.resize(vertexCount + oddCount);
+                child.vertexInfos.resize(vertexCount + oddCount);
+
+                // Update vertex positions for even vertices.
+                Threading::parallelFor(0, vertexCount, [&](size_t begin, size_t end)
+                {
+                    for (uint32_t v = (uint32_t)begin; v < end; ++v)
                     {
-                        T = pRing[1] - vertex->p;
+                        const auto& info = mesh.vertexInfos[v];
+                        auto ring = getRingInfo(mesh, v);
+                        switch (getVertexRule(mesh, v, ring))
+                        {
+                        case VertexRule::Smooth:
+                            // Apply one-ring rule for even vertex.
+                            if (info.regular) child.positions[v] = weightOneRing(mesh, v, ring.valence, 1.f / 16.f);
+                            else child.positions[v] = weightOneRing(mesh, v, ring.valence, beta(ring.valence));
+                            break;
+                        case VertexRule::Crease:
+                            // Apply boundary rule for even vertex.
+                            child.positions[v] = weightCrease(mesh, v, ring, 1.f / 8.f);
+                            break;
+                        case VertexRule::Corner:
+                            child.positions[v] = mesh.positions[v];
+                            break;
+                        }
+
+                        auto& childInfo = child.vertexInfos[v];
+                        childInfo.regular = info.regular;
+                        childInfo.boundary = info.boundary;
+                        if (info.startFace != kInvalidIndex) childInfo.startFace = 4 * info.startFace + mesh.vnum(info.startFace, v);
                     }
-                    else if (valence == 4) // regular
+                });
+
+                // Compute new odd edge vertices.
+                Threading::parallelFor(0, edgeCount, [&](size_t begin, size_t end)
+                {
+                    for (uint32_t edge = (uint32_t)begin; edge < end; ++edge)
                     {
-                        T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex->p);
+                        if (!firstEdges[edge]) continue;
+
+                        uint32_t face = edge / 3;
+                        uint32_t i = edge % 3;
+                        uint32_t v0 = mesh.faceVertices[edge];
+                        uint32_t v1 = mesh.faceVertices[3 * face + nextIndex(i)];
+                        uint32_t neighbor = mesh.faceNeighbors[edge];
+
+                        uint32_t oddVertex = oddVertices[edge];
+                        auto& info = child.vertexInfos[oddVertex];
+                        info.regular = true;
+                        info.boundary = neighbor == kInvalidIndex;
+                        info.startFace = 4 * face + 3;
+
+                        // Apply edge rules to compute new vertex position.
+                        float3& p = child.positions[oddVertex];
+                        if (mesh.isSharpEdge(face, i))
+                        {
+                            p = 0.5f * mesh.positions[v0];
+                            p += 0.5f * mesh.positions[v1];
+                        }
+                        else
+                        {
+                            p = 3.f / 8.f * mesh.positions[v0];
+                            p += 3.f / 8.f * mesh.positions[v1];
+                            p += 1.f / 8.f * mesh.positions[mesh.otherVert(face, v0, v1)];
+                            p += 1.f / 8.f * mesh.positions[mesh.otherVert(neighbor, v0, v1)];
+                        }
                     }
-                    else
+                });
+
+                // Update new mesh topology.
+                child.faceVertices.resize(12 * size_t(faceCount));
+                child.faceNeighbors.resize(12 * size_t(faceCount));
+                if (!mesh.faceCreases.empty()) child.faceCreases.resize(4 * size_t(faceCount));
+
+                Threading::parallelFor(0, faceCount, [&](size_t begin, size_t end)
+                {
+                    for (uint32_t face = (uint32_t)begin; face < end; ++face)
                     {
-                        float theta = float(M_PI) / float(valence - 1);
-                        T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
-                        for (uint32_t k = 1; k < valence - 1; ++k)
+                        const uint32_t center = 4 * face + 3;
+                        for (uint32_t j = 0; j < 3; ++j)
                         {
-                            float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
-                            T += float3(wt * pRing[k]);
+                            const uint32_t corner = 4 * face + j;
+                            const uint32_t v = mesh.faceVertices[3 * face + j];
+                            const uint32_t oddVertex = oddVertices[3 * face + j];
+
+                            // Update child vertex indices for the even and odd vertices.
+                            child.faceVertices[3 * corner + j] = v;
+                            child.faceVertices[3 * corner + nextIndex(j)] = oddVertex;
+                            child.faceVertices[3 * (4 * face + nextIndex(j)) + j] = oddVertex;
+                            child.faceVertices[3 * center + j] = oddVertex;
+
+                            // Update children neighbors for siblings.
+                            child.faceNeighbors[3 * center + j] = 4 * face + nextIndex(j);
+                            child.faceNeighbors[3 * corner + nextIndex(j)] = center;
+
+                            // Update children neighbors for neighbor children.
+                            uint32_t f2 = mesh.faceNeighbors[3 * face + j];
+                            child.faceNeighbors[3 * corner + j] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, v) : kInvalidIndex;
+                            f2 = mesh.faceNeighbors[3 * face + prevIndex(j)];
+                            child.faceNeighbors[3 * corner + prevIndex(j)] = f2 != kInvalidIndex ? 4 * f2 + mesh.vnum(f2, v) : kInvalidIndex;
+
+                            // The outer edges of the corner children are halves of the parent edges.
+                            if (!child.faceCreases.empty())
+                            {
+                                child.faceCreases[corner] = mesh.faceCreases[face] & ((1 << j) | (1 << prevIndex(j)));
+                            }
                         }
-                        T = -T;
+                        if (!child.faceCreases.empty()) child.faceCreases[center] = 0;
                     }
-                }
-                Ns.push_back(cross(S, T));
+                });
+
+                return child;
             }
 
-            // Create triangle mesh from subdivision mesh
+            /** Split a crease or corner vertex into one vertex per smooth sector of faces around it.
+                The first sector keeps the original vertex. Each sector gets the area-weighted normal of its faces.
+            */
+            void splitVertex(SubdivMesh& mesh, uint32_t vertex, std::vector<float3>& normals)
             {
-                size_t ntris = f.size();
-                std::vector<uint32_t> verts(3 * ntris);
-                uint32_t *vp = verts.data();
-                uint32_t totVerts = (uint32_t)v.size();
-                std::map<SDVertex*, uint32_t> usedVerts;
-                for (uint32_t i = 0; i < totVerts; ++i)
+                struct SectorFace
+                {
+                    uint32_t face;
+                    uint32_t i;
+                    bool sharpAfter; ///< True if the edge to the next face around the vertex is sharp.
+                };
+                std::vector<SectorFace> faces;
+                const bool boundary = mesh.vertexInfos[vertex].boundary;
+                visitFaces(mesh, vertex, [&](uint32_t face, uint32_t i)
                 {
-                    usedVerts[v[i]] = i;
+                    faces.push_back({ face, i, mesh.isSharpEdge(face, boundary ? prevIndex(i) : i) });
+                });
+
+                // Start after a sharp edge so that each sector is contiguous.
+                size_t start = 0;
+                if (!boundary)
+                {
+                    auto it = std::find_if(faces.begin(), faces.end(), [](const SectorFace& f) { return f.sharpAfter; });
+                    start = (it - faces.begin() + 1) % faces.size();
                 }
-                for (size_t i = 0; i < ntris; ++i)
+
+                uint32_t sectorVertex = vertex;
+                float3 normal(0.f);
+                for (size_t k = 0; k < faces.size(); ++k)
                 {
-                    for (uint32_t j = 0; j < 3; ++j)
+                    const auto& f = faces[(start + k) % faces.size()];
+                    normal += computeFaceNormal(mesh, f.face);
+                    mesh.faceVertices[3 * f.face + f.i] = sectorVertex;
+
+                    if (f.sharpAfter || k + 1 == faces.size())
                     {
-                        *vp = usedVerts[f[i]->v[j]];
-                        ++vp;
+                        // The limit normals point opposite to the face normals, so flip the sector normals to match.
+                        float len = length(normal);
+                        normals[sectorVertex] = len > 0.f ? -normal / len : float3(0.f);
+                        normal = float3(0.f);
+
+                        if (k + 1 < faces.size())
+                        {
+                            sectorVertex = (uint32_t)mesh.positions.size();
+                            mesh.positions.push_back(mesh.positions[vertex]);
+                            normals.push_back(float3(0.f));
+                        }
                     }
                 }
-
-                LoopSubdivideResult result;
-                result.positions = std::move(pLimit);
-                result.normals = std::move(Ns);
-                result.indices = std::move(verts);
-                return result;
             }
         }
 
-        static float3 weightOneRing(SDVertex* vert, float beta)
+        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices, float creaseAngle)
         {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - valence * beta) * vert->p;
-            for (uint32_t i = 0; i < valence; ++i)
+            // Each level quadruples the face count. Check that the result stays within 32-bit indices.
+            const uint64_t faceCount = indices.size() / 3;
+            if (levels > 15 || faceCount * 3 > (std::numeric_limits<uint32_t>::max() >> (2 * levels)))
             {
-                p += beta * pRing[i];
+                throw RuntimeError("Loop subdivision surface with {} faces and {} levels is too large.", faceCount, levels);
             }
-            return p;
-        }
 
-        void SDVertex::oneRing(float3* p)
-        {
-            if (!boundary)
+            SubdivMesh mesh = createControlMesh(positions, indices, creaseAngle);
+
+            // Refine LoopSubdiv into triangles.
+            for (uint32_t level = 0; level < levels; ++level)
             {
-                // Get one-ring vertices for interior vertex.
-                SDFace* face = startFace;
-                do
-                {
-                    *p++ = face->nextVert(this)->p;
-                    face = face->nextFace(this);
-                } while (face != startFace);
+                mesh = subdivide(mesh);
             }
-            else
+
+            const uint32_t vertexCount = mesh.getVertexCount();
+
+            // Push vertices to limit surface.
+            std::vector<float3> pLimit(vertexCount);
+            Threading::parallelFor(0, vertexCount, [&](size_t begin, size_t end)
             {
-                // Get one-ring vertices for boundary vertex.
-                SDFace* face = startFace;
-                SDFace* f2;
-                while ((f2 = face->nextFace(this)) != nullptr)
+                for (uint32_t v = (uint32_t)begin; v < end; ++v)
                 {
-                    face = f2;
+                    auto ring = getRingInfo(mesh, v);
+                    switch (getVertexRule(mesh, v, ring))
+                    {
+                    case VertexRule::Smooth: pLimit[v] = weightOneRing(mesh, v, ring.valence, loopGamma(ring.valence)); break;
+                    case VertexRule::Crease: pLimit[v] = weightCrease(mesh, v, ring, 1.f / 5.f); break;
+                    case VertexRule::Corner: pLimit[v] = mesh.positions[v]; break;
+                    }
                 }
-                *p++ = face->nextVert(this)->p;
-                do
+            });
+            mesh.positions = std::move(pLimit);
+
+            // Compute vertex normals on limit surface.
+            // Vertices on creases and corners are split into one vertex per smooth sector.
+            std::vector<float3> normals(vertexCount);
+            std::vector<uint8_t> splitVertices(vertexCount, 0);
+            Threading::parallelFor(0, vertexCount, [&](size_t begin, size_t end)
+            {
+                std::vector<float3> pRing;
+                for (uint32_t v = (uint32_t)begin; v < end; ++v)
                 {
-                    *p++ = face->prevVert(this)->p;
-                    face = face->prevFace(this);
-                } while (face != nullptr);
+                    auto ring = getRingInfo(mesh, v);
+                    auto rule = getVertexRule(mesh, v, ring);
+                    if (ring.valence == 0) normals[v] = float3(0.f);
+                    else if (rule == VertexRule::Smooth || (mesh.vertexInfos[v].boundary && ring.sharpCount == 2)) normals[v] = computeLimitNormal(mesh, v, pRing);
+                    else splitVertices[v] = 1;
+                }
+            });
+            for (uint32_t v = 0; v < vertexCount; ++v)
+            {
+                if (splitVertices[v]) splitVertex(mesh, v, normals);
             }
-        }
 
-        static float3 weightBoundary(SDVertex* vert, float beta)
-        {
-            // Put vert one-ring in pRing.
-            uint32_t valence = vert->valence();
-            FALCOR_ASSERT(valence < 16);
-            float3 pRing[16];
-
-            vert->oneRing(pRing);
-            float3 p = (1 - 2 * beta) * vert->p;
-            p += beta * pRing[0];
-            p += beta * pRing[valence - 1];
-            return p;
+            LoopSubdivideResult result;
+            result.positions = std::move(mesh.positions);
+            result.normals = std::move(normals);
+            result.indices = std::move(mesh.faceVertices);
+            return result;
         }
     }
 }
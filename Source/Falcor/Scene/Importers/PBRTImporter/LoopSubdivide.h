@@ -44,6 +44,17 @@ namespace Falcor
             std::vector<uint32_t> indices;
         };
 
-        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> vertices);
+        /** Subdivide a triangle mesh using Loop subdivision and push the vertices to the limit surface.
+            Boundary edges use the boundary rules. If a crease angle is given, interior edges whose dihedral angle
+            exceeds it are treated as creases: they use the boundary rules and their vertices get a separate
+            normal for each side of the crease. With creases disabled, the result matches the pbrt-v4 implementation.
+            Throws an exception if the mesh topology is invalid.
+            \param[in] levels Number of subdivision levels.
+            \param[in] positions Vertex positions of the control mesh.
+            \param[in] vertices Vertex indices of the control mesh triangles.
+            \param[in] creaseAngle Dihedral angle in degrees above which interior edges are treated as creases. Zero disables creases.
+            \return The subdivided mesh.
+        */
+        LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> vertices, float creaseAngle = 0.f);
     }
 }
@@ -64,10 +64,14 @@
 #include "Builder.h"
 #include "Helpers.h"
 #include "LoopSubdivide.h"
+#include "PLYReader.h"
 #include "EnvMapConverter.h"
 
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/euler_angles.hpp>
+#include <atomic>
+#include <execution>
+#include <optional>
 
 namespace Falcor
 {
@@ -140,7 +144,14 @@ namespace Falcor
         {
             Falcor::TriangleMesh::SharedPtr pTriangleMesh;
             glm::mat4 transform;
-            Falcor::Material::SharedPtr pMaterial;
+        };
+
+        /** Holds the results from creating a shape and pre-processing its mesh.
+        */
+        struct ProcessedShape
+        {
+            std::optional<SceneBuilder::ProcessedMesh> mesh; // Empty if the shape has no geometry.
+            glm::mat4 transform;
         };
 
         struct InstanceDefinition
@@ -166,7 +177,7 @@ namespace Falcor
 
             std::map<std::string, InstanceDefinition> instanceDefinitions;
 
-            size_t curveCount = 0;
+            std::atomic<size_t> curveCount = 0;
 
             Falcor::Material::SharedPtr getMaterial(const MaterialRef& materialRef)
             {
@@ -1089,6 +1100,9 @@ namespace Falcor
             }
         }
 
+        /** Create the geometry of a shape.
+            This is thread-safe and may be called for multiple shapes in parallel.
+        */
         Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         {
             auto warnUnsupported = [&]() { warnUnsupportedType(entity.loc, "Shape", entity.name); };
@@ -1144,12 +1158,12 @@ namespace Falcor
                 // Float width, Float width0, Float width1, Int degree, String basis,
                 // Point3[] P, String type, Normal3[] N, Int splitdepth
                 // PBRT scenes typically contain thousands of curve shapes (each shape is just a segment) so we skip warnings.
-                ctx.curveCount++;
-                if (ctx.curveCount < 10)
+                size_t curveCount = ++ctx.curveCount;
+                if (curveCount < 10)
                 {
                     warnUnsupported();
                 }
-                else if (ctx.curveCount == 10)
+                else if (curveCount == 10)
                 {
                     Falcor::logWarning("Skipping additional warnings on unsupported curves.");
                 }
@@ -1232,8 +1246,16 @@ namespace Falcor
                 auto filename = params.getString("filename", "");
                 auto path = ctx.resolver(filename);
 
-                shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
-                if (shape.pTriangleMesh) shape.pTriangleMesh->setName(filename);
+                try
+                {
+                    shape.pTriangleMesh = readPLY(path);
+                }
+                catch (const RuntimeError& e)
+                {
+                    logWarning(entity.loc, "Failed to load PLY file '{}': {} Skipping.", filename, e.what());
+                    return {};
+                }
+                shape.pTriangleMesh->setName(filename);
                 shape.transform = entity.transform;
             }
             else if (type == "loopsubdiv")
@@ -1241,16 +1263,19 @@ namespace Falcor
                 // Parameters:
                 // Int levels, Int[] indices, Point3[] P
                 // String scheme (also not supported in pbrt-v4)
+                // Float creaseangle (Falcor extension)
                 warnUnsupportedParameters(params, { "scheme" });
 
                 auto levels = params.getInt("levels", 3);
                 auto indices = params.getIntArray("indices");
                 auto P = params.getPoint3Array("P");
+                auto creaseAngle = params.getFloat("creaseangle", 0.f);
 
                 if (indices.empty()) throwError(entity.loc, "Missing vertex indices in 'indices'.");
                 if (P.empty()) throwError(entity.loc, "Missing vertex positions in 'P'.");
+                if (levels < 0) throwError(entity.loc, "Number of subdivision levels must be non-negative.");
 
-                auto result = loopSubdivide(levels, P, fstd::span<const uint32_t>(reinterpret_cast<const uint32_t*>(indices.data()), indices.size()));
+                auto result = loopSubdivide(levels, P, fstd::span<const uint32_t>(reinterpret_cast<const uint32_t*>(indices.data()), indices.size()), creaseAngle);
                 Falcor::TriangleMesh::VertexList vertexList(result.positions.size());
                 for (size_t i = 0; i < result.positions.size(); ++i)
                 {
@@ -1260,7 +1285,7 @@ namespace Falcor
                     vertex.texCoord = float3(0.f);
                 }
 
-                shape.pTriangleMesh = Falcor::TriangleMesh::create(vertexList, result.indices);
+                shape.pTriangleMesh = Falcor::TriangleMesh::create(std::move(vertexList), std::move(result.indices));
                 shape.pTriangleMesh->setName("loopsubdiv");
                 shape.transform = entity.transform;
             }
@@ -1275,8 +1300,15 @@ namespace Falcor
                 shape.pTriangleMesh->setFrontFaceCW(!shape.pTriangleMesh->getFrontFaceCW());
             }
 
-            // Get the material.
-            shape.pMaterial = ctx.getMaterial(entity.materialRef);
+            return shape;
+        }
+
+        /** Get the material of a shape, creating a new material if an area light is attached to the shape.
+            This modifies the builder context and is not thread-safe.
+        */
+        Falcor::Material::SharedPtr createShapeMaterial(BuilderContext& ctx, const ShapeSceneEntity& entity)
+        {
+            auto pMaterial = ctx.getMaterial(entity.materialRef);
 
             // Create area light.
             if (entity.lightIndex != -1)
@@ -1286,33 +1318,92 @@ namespace Falcor
                 // Create a new material as we may already use it for other shapes with no area light attached to it.
                 if (!std::holds_alternative<std::monostate>(entity.materialRef))
                 {
-                    shape.pMaterial = createMaterial(ctx, ctx.scene.getMaterial(entity.materialRef));
-                    shape.pMaterial->setName(shape.pMaterial->getName() + "_" + nameSuffix);
+                    pMaterial = createMaterial(ctx, ctx.scene.getMaterial(entity.materialRef));
+                    pMaterial->setName(pMaterial->getName() + "_" + nameSuffix);
                 }
                 else
                 {
                     auto pStandardMaterial = Falcor::StandardMaterial::create(nameSuffix);
                     pStandardMaterial->setBaseColor(float4(0.f, 0.f, 0.f, 1.f));
                     pStandardMaterial->setRoughness(0.f);
-                    shape.pMaterial = pStandardMaterial;
+                    pMaterial = pStandardMaterial;
                 }
                 const SceneEntity& areaLightEntity = ctx.scene.getAreaLight(entity.lightIndex);
-                createAreaLight(ctx, areaLightEntity, shape.pMaterial);
+                createAreaLight(ctx, areaLightEntity, pMaterial);
             }
 
-            return shape;
+            return pMaterial;
+        }
+
+        /** Create a list of shapes and pre-process their meshes.
+            The shape geometry is created in parallel. Materials and area lights are then created serially in entity order,
+            only for shapes that produced a mesh, and the meshes are pre-processed in parallel.
+            Errors are reported for the first failing shape in entity order.
+            \param[in] ctx Builder context.
+            \param[in] entities Shape entities.
+            \return List of processed shapes in the same order as the entities.
+        */
+        std::vector<ProcessedShape> processShapes(BuilderContext& ctx, const std::vector<ShapeSceneEntity>& entities)
+        {
+            // Exceptions must not escape a parallel algorithm, so we capture them and rethrow afterwards.
+            std::vector<std::exception_ptr> exceptions(entities.size());
+            auto rethrowFirst = [&exceptions]()
+            {
+                for (const auto& exception : exceptions)
+                {
+                    if (exception) std::rethrow_exception(exception);
+                }
+            };
+
+            std::vector<Shape> shapes(entities.size());
+            auto range = NumericRange<size_t>(0, entities.size());
+            std::for_each(std::execution::par, range.begin(), range.end(), [&] (size_t i) {
+                try
+                {
+                    shapes[i] = createShape(ctx, entities[i]);
+                }
+                catch (...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+            });
+            rethrowFirst();
+
+            // Shapes without a mesh get no material, so they don't leave orphan materials or emissive lights behind.
+            std::vector<Falcor::Material::SharedPtr> materials(entities.size());
+            for (size_t i = 0; i < entities.size(); ++i)
+            {
+                if (shapes[i].pTriangleMesh) materials[i] = createShapeMaterial(ctx, entities[i]);
+            }
+
+            std::vector<ProcessedShape> processedShapes(entities.size());
+            std::for_each(std::execution::par, range.begin(), range.end(), [&] (size_t i) {
+                if (!shapes[i].pTriangleMesh) return;
+                try
+                {
+                    processedShapes[i].mesh = ctx.builder.processTriangleMesh(shapes[i].pTriangleMesh, materials[i]);
+                    processedShapes[i].transform = shapes[i].transform;
+                }
+                catch (...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+            });
+            rethrowFirst();
+
+            return processedShapes;
         }
 
         InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceDefinitionSceneEntity& entity)
         {
             InstanceDefinition instanceDefinition;
 
-            for (const auto& shapeEntity : entity.shapes)
+            // Add meshes sequentially after being processed in parallel to retain a deterministic order.
+            for (const auto& shape : processShapes(ctx, entity.shapes))
             {
-                auto shape = createShape(ctx, shapeEntity);
-                if (shape.pTriangleMesh)
+                if (shape.mesh)
                 {
-                    auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
+                    auto meshID = ctx.builder.addProcessedMesh(*shape.mesh);
                     instanceDefinition.meshes.emplace_back(meshID, shape.transform);
                 }
             }
@@ -1382,13 +1473,17 @@ namespace Falcor
             }
 
             // Create shapes.
-            for (const auto& entity : ctx.scene.getShapes())
-            {
-                auto shape = createShape(ctx, entity);
-                if (shape.pTriangleMesh)
+            // We retain a deterministic order of the meshes in the global scene buffer by adding
+            // them sequentially after being processed in parallel.
+            const auto& shapeEntities = ctx.scene.getShapes();
+            auto processedShapes = processShapes(ctx, shapeEntities);
+            for (size_t i = 0; i < shapeEntities.size(); ++i)
+            {
+                const auto& shape = processedShapes[i];
+                if (shape.mesh)
                 {
-                    auto nodeID = ctx.builder.addNode({ entity.name, shape.transform });
-                    auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
+                    auto nodeID = ctx.builder.addNode({ shapeEntities[i].name, shape.transform });
+                    auto meshID = ctx.builder.addProcessedMesh(*shape.mesh);
                     ctx.builder.addMeshInstance(nodeID, meshID);
                 }
             }
@@ -0,0 +1,542 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "PLYReader.h"
+#include "Core/Platform/MemoryMappedFile.h"
+
+#include <charconv>
+#include <cstring>
+
+namespace Falcor
+{
+    namespace pbrt
+    {
+        namespace
+        {
+            enum class Format
+            {
+                Ascii,
+                BinaryLittleEndian,
+                BinaryBigEndian,
+            };
+
+            enum class Type
+            {
+                Int8,
+                UInt8,
+                Int16,
+                UInt16,
+                Int32,
+                UInt32,
+                Float32,
+                Float64,
+            };
+
+            struct Property
+            {
+                std::string name;
+                Type type = Type::Float32;
+                bool isList = false;
+                Type countType = Type::UInt8;
+                size_t offset = 0;              ///< Byte offset within the element (binary elements without lists only).
+            };
+
+            struct Element
+            {
+                std::string name;
+                size_t count = 0;
+                std::vector<Property> properties;
+                size_t stride = 0;              ///< Size of one element in bytes, 0 if the element contains lists.
+
+                const Property* findProperty(std::initializer_list<std::string_view> names) const
+                {
+                    for (auto name : names)
+                    {
+                        for (const auto& property : properties)
+                        {
+                            if (property.name == name) return &property;
+                        }
+                    }
+                    return nullptr;
+                }
+            };
+
+            size_t getTypeSize(Type type)
+            {
+                switch (type)
+                {
+                case Type::Int8:
+                case Type::UInt8:
+                    return 1;
+                case Type::Int16:
+                case Type::UInt16:
+                    return 2;
+                case Type::Int32:
+                case Type::UInt32:
+                case Type::Float32:
+                    return 4;
+                case Type::Float64:
+                    return 8;
+                default:
+                    FALCOR_UNREACHABLE();
+                    return 0;
+                }
+            }
+
+            std::optional<Type> parseType(std::string_view name)
+            {
+                if (name == "char" || name == "int8") return Type::Int8;
+                if (name == "uchar" || name == "uint8") return Type::UInt8;
+                if (name == "short" || name == "int16") return Type::Int16;
+                if (name == "ushort" || name == "uint16") return Type::UInt16;
+                if (name == "int" || name == "int32") return Type::Int32;
+                if (name == "uint" || name == "uint32") return Type::UInt32;
+                if (name == "float" || name == "float32") return Type::Float32;
+                if (name == "double" || name == "float64") return Type::Float64;
+                return {};
+            }
+
+            /** Splits a header line into whitespace separated words.
+            */
+            std::vector<std::string_view> splitWords(std::string_view line)
+            {
+                std::vector<std::string_view> words;
+                size_t pos = 0;
+                while (pos < line.size())
+                {
+                    while (pos < line.size() && std::isspace((unsigned char)line[pos])) ++pos;
+                    size_t end = pos;
+                    while (end < line.size() && !std::isspace((unsigned char)line[end])) ++end;
+                    if (end > pos) words.push_back(line.substr(pos, end - pos));
+                    pos = end;
+                }
+                return words;
+            }
+
+            /** Reader for the data section of a PLY file.
+                Binary values are read with memcpy (the data is not aligned) and byte swapped if the file
+                endianness differs from the host. ASCII values are parsed with std::from_chars.
+            */
+            class DataReader
+            {
+            public:
+                DataReader(const std::filesystem::path& path, Format format, const uint8_t* pBegin, const uint8_t* pEnd)
+                    : mPath(path)
+                    , mFormat(format)
+                    , mSwap(format == Format::BinaryBigEndian)
+                    , mPos(pBegin)
+                    , mEnd(pEnd)
+                {}
+
+                bool isBinary() const { return mFormat != Format::Ascii; }
+                bool isNative() const { return mFormat == Format::BinaryLittleEndian; }
+
+                const uint8_t* getPos() const { return mPos; }
+                size_t getRemaining() const { return mEnd - mPos; }
+
+                /** Get a pointer to the next size bytes of binary data and advance past them.
+                */
+                const uint8_t* consume(size_t size)
+                {
+                    if (size > getRemaining()) throw RuntimeError("Unexpected end of data in PLY file '{}'.", mPath);
+                    const uint8_t* p = mPos;
+                    mPos += size;
+                    return p;
+                }
+
+                /** Read a single value of the given type.
+                */
+                template<typename T>
+                T read(Type type)
+                {
+                    if (isBinary()) return decode<T>(consume(getTypeSize(type)), type);
+
+                    skipSpaces();
+                    const char* pBegin = reinterpret_cast<const char*>(mPos);
+                    const char* pEnd = reinterpret_cast<const char*>(mEnd);
+                    std::from_chars_result result;
+                    T value = {};
+                    if (type == Type::Float32 || type == Type::Float64)
+                    {
+                        double d = 0.0;
+                        result = std::from_chars(pBegin, pEnd, d);
+                        value = (T)d;
+                    }
+                    else
+                    {
+                        int64_t i = 0;
+                        result = std::from_chars(pBegin, pEnd, i);
+                        value = (T)i;
+                    }
+                    if (result.ec != std::errc() || result.ptr == pBegin) throw RuntimeError("Invalid number in PLY file '{}'.", mPath);
+                    mPos = reinterpret_cast<const uint8_t*>(result.ptr);
+                    return value;
+                }
+
+                /** Decode a binary value of the given type.
+                */
+                template<typename T>
+                T decode(const uint8_t* p, Type type) const
+                {
+                    switch (type)
+                    {
+                    case Type::Int8: return (T)load<int8_t>(p);
+                    case Type::UInt8: return (T)load<uint8_t>(p);
+                    case Type::Int16: return (T)load<int16_t>(p);
+                    case Type::UInt16: return (T)load<uint16_t>(p);
+                    case Type::Int32: return (T)load<int32_t>(p);
+                    case Type::UInt32: return (T)load<uint32_t>(p);
+                    case Type::Float32: return (T)load<float>(p);
+                    case Type::Float64: return (T)load<double>(p);
+                    default: FALCOR_UNREACHABLE(); return T{};
+                    }
+                }
+
+            private:
+                template<typename T>
+                T load(const uint8_t* p) const
+                {
+                    uint8_t bytes[sizeof(T)];
+                    std::memcpy(bytes, p, sizeof(T));
+                    if (mSwap) std::reverse(bytes, bytes + sizeof(T));
+                    T value;
+                    std::memcpy(&value, bytes, sizeof(T));
+                    return value;
+                }
+
+                void skipSpaces()
+                {
+                    while (mPos < mEnd && std::isspace(*mPos)) ++mPos;
+                }
+
+                const std::filesystem::path& mPath;
+                Format mFormat;
+                bool mSwap;
+                const uint8_t* mPos;
+                const uint8_t* mEnd;
+            };
+
+            /** Skip one element instance, or all instances if the element has a fixed size.
+            */
+            void skipElement(DataReader& reader, const Element& element)
+            {
+                if (reader.isBinary() && element.stride > 0)
+                {
+                    reader.consume(element.count * element.stride);
+                    return;
+                }
+
+                for (size_t i = 0; i < element.count; ++i)
+                {
+                    for (const auto& property : element.properties)
+                    {
+                        size_t count = property.isList ? reader.read<size_t>(property.countType) : 1;
+                        for (size_t j = 0; j < count; ++j) reader.read<double>(property.type);
+                    }
+                }
+            }
+
+            struct Header
+            {
+                Format format = Format::Ascii;
+                std::vector<Element> elements;
+                size_t dataOffset = 0;
+            };
+
+            Header parseHeader(const std::filesystem::path& path, const uint8_t* pData, size_t size)
+            {
+                std::string_view text(reinterpret_cast<const char*>(pData), size);
+                if (text.substr(0, 3) != "ply") throw RuntimeError("File '{}' is not a PLY file.", path);
+
+                Header header;
+                bool hasFormat = false;
+                size_t pos = 0;
+
+                while (true)
+                {
+                    size_t end = text.find('\n', pos);
+                    if (end == std::string_view::npos) throw RuntimeError("Missing 'end_header' in PLY file '{}'.", path);
+                    auto words = splitWords(text.substr(pos, end - pos));
+                    pos = end + 1;
+
+                    if (words.empty() || words[0] == "ply" || words[0] == "comment" || words[0] == "obj_info") continue;
+
+                    if (words[0] == "end_header")
+                    {
+                        header.dataOffset = pos;
+                        break;
+                    }
+                    else if (words[0] == "format" && words.size() >= 2)
+                    {
+                        if (words[1] == "ascii") header.format = Format::Ascii;
+                        else if (words[1] == "binary_little_endian") header.format = Format::BinaryLittleEndian;
+                        else if (words[1] == "binary_big_endian") header.format = Format::BinaryBigEndian;
+                        else throw RuntimeError("Unknown format '{}' in PLY file '{}'.", words[1], path);
+                        hasFormat = true;
+                    }
+                    else if (words[0] == "element" && words.size() == 3)
+                    {
+                        Element element;
+                        element.name = words[1];
+                        auto result = std::from_chars(words[2].data(), words[2].data() + words[2].size(), element.count);
+                        if (result.ec != std::errc()) throw RuntimeError("Invalid element count '{}' in PLY file '{}'.", words[2], path);
+                        header.elements.push_back(std::move(element));
+                    }
+                    else if (words[0] == "property" && !header.elements.empty())
+                    {
+                        Property property;
+                        std::optional<Type> type, countType;
+                        if (words.size() == 5 && words[1] == "list")
+                        {
+                            property.isList = true;
+                            countType = parseType(words[2]);
+                            type = parseType(words[3]);
+                            property.name = words[4];
+                        }
+                        else if (words.size() == 3)
+                        {
+                            type = parseType(words[1]);
+                            property.name = words[2];
+                        }
+                        if (!type || (property.isList && !countType))
+                        {
+                            throw RuntimeError("Invalid property '{}' in PLY file '{}'.", words.back(), path);
+                        }
+                        property.type = *type;
+                        if (countType) property.countType = *countType;
+                        header.elements.back().properties.push_back(std::move(property));
+                    }
+                    else
+                    {
+                        throw RuntimeError("Invalid header line in PLY file '{}'.", path);
+                    }
+                }
+
+                if (!hasFormat) throw RuntimeError("Missing 'format' in PLY file '{}'.", path);
+
+                // Compute property offsets and strides of fixed size elements.
+                for (auto& element : header.elements)
+                {
+                    size_t offset = 0;
+                    bool hasList = false;
+                    for (auto& property : element.properties)
+                    {
+                        property.offset = offset;
+                        offset += getTypeSize(property.type);
+                        hasList |= property.isList;
+                    }
+                    element.stride = hasList ? 0 : offset;
+                }
+
+                return header;
+            }
+
+            /** Parse the PLY data in memory.
+            */
+            TriangleMesh::SharedPtr parsePLY(const std::filesystem::path& path, const uint8_t* pData, size_t size)
+            {
+                Header header = parseHeader(path, pData, size);
+                DataReader reader(path, header.format, pData + header.dataOffset, pData + size);
+
+                TriangleMesh::VertexList vertices;
+                TriangleMesh::IndexList indices;
+                bool hasNormals = false;
+
+                for (const auto& element : header.elements)
+                {
+                    if (element.name == "vertex")
+                    {
+                        if (element.count > std::numeric_limits<uint32_t>::max()) throw RuntimeError("Too many vertices in PLY file '{}'.", path);
+
+                        const Property* pProperties[8] =
+                        {
+                            element.findProperty({ "x" }),
+                            element.findProperty({ "y" }),
+                            element.findProperty({ "z" }),
+                            element.findProperty({ "nx" }),
+                            element.findProperty({ "ny" }),
+                            element.findProperty({ "nz" }),
+                            element.findProperty({ "u", "s", "texture_u", "texture_s" }),
+                            element.findProperty({ "v", "t", "texture_v", "texture_t" }),
+                        };
+                        if (!pProperties[0] || !pProperties[1] || !pProperties[2]) throw RuntimeError("Missing vertex positions in PLY file '{}'.", path);
+                        hasNormals = pProperties[3] && pProperties[4] && pProperties[5];
+                        bool hasTexCoords = pProperties[6] && pProperties[7];
+
+                        vertices.resize(element.count);
+
+                        auto setVertex = [&](TriangleMesh::Vertex& vertex, const float* values)
+                        {
+                            vertex.position = float3(values[0], values[1], values[2]);
+                            vertex.normal = hasNormals ? float3(values[3], values[4], values[5]) : float3(0.f);
+                            // Flip v to match meshes loaded through Assimp (aiProcess_FlipUVs).
+                            vertex.texCoord = hasTexCoords ? float2(values[6], 1.f - values[7]) : float2(0.f);
+                        };
+
+                        if (reader.isBinary() && element.stride > 0)
+                        {
+                            // Fixed size vertices: decode the attributes directly from the mapped file.
+                            const uint8_t* pVertex = reader.consume(element.count * element.stride);
+                            bool allNative = reader.isNative();
+                            for (const Property* pProperty : pProperties) allNative &= !pProperty || pProperty->type == Type::Float32;
+
+                            float values[8] = {};
+                            for (size_t i = 0; i < element.count; ++i, pVertex += element.stride)
+                            {
+                                if (allNative)
+                                {
+                                    for (size_t j = 0; j < 8; ++j) if (pProperties[j]) std::memcpy(&values[j], pVertex + pProperties[j]->offset, sizeof(float));
+                                }
+                                else
+                                {
+                                    for (size_t j = 0; j < 8; ++j) if (pProperties[j]) values[j] = reader.decode<float>(pVertex + pProperties[j]->offset, pProperties[j]->type);
+                                }
+                                setVertex(vertices[i], values);
+                            }
+                        }
+                        else
+                        {
+                            float values[8] = {};
+                            for (size_t i = 0; i < element.count; ++i)
+                            {
+                                for (const auto& property : element.properties)
+                                {
+                                    size_t count = property.isList ? reader.read<size_t>(property.countType) : 1;
+                                    for (size_t j = 0; j < count; ++j)
+                                    {
+                                        float value = reader.read<float>(property.type);
+                                        for (size_t k = 0; k < 8; ++k) if (pProperties[k] == &property) values[k] = value;
+                                    }
+                                }
+                                setVertex(vertices[i], values);
+                            }
+                        }
+                    }
+                    else if (element.name == "face")
+                    {
+                        const Property* pIndices = element.findProperty({ "vertex_indices", "vertex_index" });
+                        if (!pIndices || !pIndices->isList) throw RuntimeError("Missing face vertex indices in PLY file '{}'.", path);
+
+                        indices.reserve(element.count * 3);
+                        const uint32_t vertexCount = (uint32_t)vertices.size();
+                        std::vector<uint32_t> polygon;
+
+                        // Split polygons into a triangle fan.
+                        auto addPolygon = [&]()
+                        {
+                            for (uint32_t index : polygon)
+                            {
+                                if (index >= vertexCount) throw RuntimeError("Vertex index {} is out of bounds in PLY file '{}'.", index, path);
+                            }
+                            for (size_t i = 2; i < polygon.size(); ++i)
+                            {
+                                indices.push_back(polygon[0]);
+                                indices.push_back(polygon[i - 1]);
+                                indices.push_back(polygon[i]);
+                            }
+                        };
+
+                        // Fast path for the common layout of a single list with 8-bit counts and 32-bit indices.
+                        bool fastPath = reader.isNative() && element.properties.size() == 1 && pIndices->countType == Type::UInt8 &&
+                            (pIndices->type == Type::Int32 || pIndices->type == Type::UInt32);
+
+                        for (size_t i = 0; i < element.count; ++i)
+                        {
+                            if (fastPath)
+                            {
+                                size_t count = *reader.consume(1);
+                                polygon.resize(count);
+                                if (count > 0) std::memcpy(polygon.data(), reader.consume(count * sizeof(uint32_t)), count * sizeof(uint32_t));
+                                addPolygon();
+                                continue;
+                            }
+
+                            for (const auto& property : element.properties)
+                            {
+                                size_t count = property.isList ? reader.read<size_t>(property.countType) : 1;
+                                if (&property == pIndices)
+                                {
+                                    polygon.resize(count);
+                                    for (size_t j = 0; j < count; ++j) polygon[j] = reader.read<uint32_t>(property.type);
+                                    addPolygon();
+                                }
+                                else
+                                {
+                                    for (size_t j = 0; j < count; ++j) reader.read<double>(property.type);
+                                }
+                            }
+                        }
+                    }
+                    else
+                    {
+                        skipElement(reader, element);
+                    }
+                }
+
+                if (vertices.empty() || indices.empty()) throw RuntimeError("PLY file '{}' contains no triangles.", path);
+
+                // Without normals, unindex the mesh and use facet normals.
+                if (!hasNormals)
+                {
+                    TriangleMesh::VertexList faceVertices(indices.size());
+                    for (size_t i = 0; i < indices.size(); i += 3)
+                    {
+                        const auto& v0 = vertices[indices[i + 0]];
+                        const auto& v1 = vertices[indices[i + 1]];
+                        const auto& v2 = vertices[indices[i + 2]];
+                        float3 n = glm::cross(v1.position - v0.position, v2.position - v0.position);
+                        float len = glm::length(n);
+                        n = len > 0.f ? n / len : float3(0.f, 0.f, 1.f);
+                        faceVertices[i + 0] = { v0.position, n, v0.texCoord };
+                        faceVertices[i + 1] = { v1.position, n, v1.texCoord };
+                        faceVertices[i + 2] = { v2.position, n, v2.texCoord };
+                        indices[i + 0] = (uint32_t)(i + 0);
+                        indices[i + 1] = (uint32_t)(i + 1);
+                        indices[i + 2] = (uint32_t)(i + 2);
+                    }
+                    vertices = std::move(faceVertices);
+                }
+
+                return TriangleMesh::create(std::move(vertices), std::move(indices));
+            }
+        }
+
+        TriangleMesh::SharedPtr readPLY(const std::filesystem::path& path)
+        {
+            if (hasExtension(path, "gz"))
+            {
+                std::string data = decompressFile(path);
+                return parsePLY(path, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+            }
+
+            auto pFile = MemoryMappedFile::create(path);
+            pFile->prefetch(0, pFile->getSize());
+            return parsePLY(path, pFile->getData(), pFile->getSize());
+        }
+    }
+}
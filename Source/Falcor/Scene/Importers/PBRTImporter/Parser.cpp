@@ -33,9 +33,16 @@
 
 #include "stdafx.h"
 #include "Parser.h"
+#include "Builder.h"
 #include "Helpers.h"
 
 #include <charconv>
+#include <zlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PBRT_TOKENIZER_SSE2 1
+#endif
 
 namespace Falcor
 {
@@ -81,18 +88,169 @@ namespace Falcor
             return 0;
         }
 
+        namespace
+        {
+            const size_t kStreamChunkSize = 4 * 1024 * 1024;
+
+            template<char... Cs>
+            bool isAnyOf(char ch)
+            {
+                return ((ch == Cs) || ...);
+            }
+
+#if defined(PBRT_TOKENIZER_SSE2)
+            /** Returns a bit mask of the bytes in a 16 byte block that match any of the characters.
+            */
+            template<char... Cs>
+            uint32_t matchMask(__m128i v)
+            {
+                __m128i m = _mm_setzero_si128();
+                ((m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(Cs)))), ...);
+                return (uint32_t)_mm_movemask_epi8(m);
+            }
+#endif
+
+            /** Find the first character in [p, end) that is any of the characters.
+                \return Pointer to the character or end if there is none.
+            */
+            template<char... Cs>
+            const char* findFirstOf(const char* p, const char* end)
+            {
+#if defined(PBRT_TOKENIZER_SSE2)
+                while (end - p >= 16)
+                {
+                    uint32_t mask = matchMask<Cs...>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+                    if (mask != 0) return p + bitScanForward(mask);
+                    p += 16;
+                }
+#endif
+                while (p < end && !isAnyOf<Cs...>(*p)) ++p;
+                return p;
+            }
+
+            /** Find the first non-whitespace character in [p, end).
+                \param[in,out] newlineCount Incremented by the number of skipped newlines.
+                \param[in,out] pLineStart Set to the character after the last skipped newline, if any.
+                \return Pointer to the character or end if there is none.
+            */
+            const char* skipSpaces(const char* p, const char* end, uint32_t& newlineCount, const char*& pLineStart)
+            {
+#if defined(PBRT_TOKENIZER_SSE2)
+                while (end - p >= 16)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                    uint32_t nonSpace = ~matchMask<' ', '\n', '\t', '\r'>(v) & 0xffff;
+                    uint32_t count = nonSpace != 0 ? bitScanForward(nonSpace) : 16;
+                    uint32_t newlines = matchMask<'\n'>(v) & ((1u << count) - 1);
+                    if (newlines != 0)
+                    {
+                        newlineCount += popcount(newlines);
+                        pLineStart = p + bitScanReverse(newlines) + 1;
+                    }
+                    p += count;
+                    if (count < 16) return p;
+                }
+#endif
+                for (; p < end && isAnyOf<' ', '\n', '\t', '\r'>(*p); ++p)
+                {
+                    if (*p == '\n')
+                    {
+                        ++newlineCount;
+                        pLineStart = p + 1;
+                    }
+                }
+                return p;
+            }
+
+            /** Find the end of a regular statement or numeric token.
+            */
+            const char* findTokenEnd(const char* p, const char* end)
+            {
+                return findFirstOf<' ', '\n', '\t', '\r', '"', '[', ']'>(p, end);
+            }
+
+            bool parseNumber(const char* begin, const char* end, Float& value)
+            {
+                // Skip '+' character, std::from_chars doesn't handle '+'.
+                if (begin < end && *begin == '+') begin++;
+                auto result = std::from_chars(begin, end, value);
+                return result.ec == std::errc() && result.ptr == end;
+            }
+
+            bool parseNumber(const char* begin, const char* end, int& value)
+            {
+                if (begin < end && *begin == '+') begin++;
+                int64_t value64;
+                auto result = std::from_chars(begin, end, value64);
+                if (result.ec != std::errc() || result.ptr != end) return false;
+                if (value64 < std::numeric_limits<int32_t>::lowest() || value64 > std::numeric_limits<int32_t>::max()) return false;
+                value = (int)value64;
+                return true;
+            }
+        }
+
+        /** Helper for decompressing a memory mapped gzip file in chunks.
+        */
+        struct Tokenizer::GzipReader
+        {
+            MemoryMappedFile::SharedPtr pFile;
+            z_stream zs = {};
+            bool done = false;
+
+            GzipReader(const std::filesystem::path& path)
+            {
+                pFile = MemoryMappedFile::create(path);
+                // MAX_WBITS | 32 to support both zlib or gzip files.
+                if (inflateInit2(&zs, MAX_WBITS | 32) != Z_OK) throw RuntimeError("inflateInit2 failed while decompressing.");
+                zs.next_in = const_cast<Bytef*>(pFile->getData());
+                zs.avail_in = 0;
+            }
+
+            ~GzipReader()
+            {
+                inflateEnd(&zs);
+            }
+
+            /** Decompress up to size bytes.
+                \return Number of bytes written, 0 at the end of the stream.
+            */
+            size_t read(char* pDst, size_t size, const std::filesystem::path& path)
+            {
+                zs.next_out = reinterpret_cast<Bytef*>(pDst);
+                zs.avail_out = (uInt)std::min(size, (size_t)std::numeric_limits<uInt>::max());
+                while (!done && zs.avail_out > 0)
+                {
+                    // Feed the input in pieces as avail_in is limited to 32 bits.
+                    if (zs.avail_in == 0)
+                    {
+                        size_t consumed = zs.next_in - pFile->getData();
+                        zs.avail_in = (uInt)std::min(pFile->getSize() - consumed, (size_t)std::numeric_limits<uInt>::max());
+                    }
+                    int ret = inflate(&zs, Z_NO_FLUSH);
+                    if (ret == Z_STREAM_END) done = true;
+                    else if (ret != Z_OK) throw RuntimeError("Failure to decompress file '{}' (error: {}).", path, ret);
+                }
+                return reinterpret_cast<char*>(zs.next_out) - pDst;
+            }
+        };
+
         std::unique_ptr<Tokenizer> Tokenizer::createFromFile(const std::filesystem::path& path)
         {
+            std::unique_ptr<Tokenizer> pTokenizer(new Tokenizer(path));
             if (hasExtension(path, "gz"))
             {
-                std::string str = decompressFile(path);
-                return std::make_unique<Tokenizer>(std::move(str), path);
+                pTokenizer->mpGzipReader = std::make_unique<GzipReader>(path);
+                pTokenizer->mBuffer.resize(kStreamChunkSize);
+                pTokenizer->setData(pTokenizer->mBuffer.data(), 0);
+                pTokenizer->refill();
             }
             else
             {
-                std::string str = readFile(path);
-                return std::make_unique<Tokenizer>(std::move(str), path);
+                pTokenizer->mpMappedFile = MemoryMappedFile::create(path);
+                pTokenizer->setData(reinterpret_cast<const char*>(pTokenizer->mpMappedFile->getData()), pTokenizer->mpMappedFile->getSize());
             }
+            if (pTokenizer->isUTF16(pTokenizer->mPos, pTokenizer->mEnd - pTokenizer->mPos)) throwError("File is encoded with UTF-16, which is not currently supported.");
+            return pTokenizer;
         }
 
         std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
@@ -100,19 +258,39 @@ namespace Falcor
             return std::make_unique<Tokenizer>(std::move(str), "<string>");
         }
 
-        Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path)
+        Tokenizer::Tokenizer(const std::filesystem::path& path)
             : mPath(path)
-            , mContents(std::move(str))
         {
-            auto pFilename = std::make_unique<std::string>(path.string());
-            mLoc = FileLoc(*pFilename);
-            getFilenames().push_back(std::move(pFilename));
+            mLoc = FileLoc(addFilename(path));
+        }
 
-            mPos = mContents.data();
-            mEnd = mPos + mContents.size();
+        const std::string& Tokenizer::addFilename(const std::filesystem::path& path)
+        {
+            static std::mutex mutex;
+            static std::vector<std::unique_ptr<std::string>> filenames;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            filenames.push_back(std::make_unique<std::string>(path.string()));
+            return *filenames.back();
+        }
+
+        Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path)
+            : Tokenizer(path)
+        {
+            mContents = std::move(str);
+            setData(mContents.data(), mContents.size());
             if (isUTF16(mContents.data(), mContents.size())) throwError("File is encoded with UTF-16, which is not currently supported.");
         }
 
+        Tokenizer::~Tokenizer() = default;
+
+        void Tokenizer::setData(const char* pData, size_t size)
+        {
+            mpBegin = pData;
+            mPos = pData;
+            mEnd = pData + size;
+        }
+
         bool Tokenizer::isUTF16(const void* ptr, size_t len) const
         {
             auto c = reinterpret_cast<const unsigned char*>(ptr);
@@ -120,102 +298,170 @@ namespace Falcor
             return (len >= 2 && ((c[0] == 0xfe && c[1] == 0xff) || (c[0] == 0xff && c[1] == 0xfe)));
         }
 
-        std::optional<Token> Tokenizer::next()
+        bool Tokenizer::refill()
+        {
+            if (!mpGzipReader) return false;
+
+            // Move the data that is still needed to the start of the buffer.
+            // The buffer is grown if a single token does not leave room for another chunk.
+            size_t keep = mEnd - mPos;
+            mBeginOffset += mPos - mpBegin;
+            std::memmove(mBuffer.data(), mPos, keep);
+            if (mBuffer.size() - keep < kStreamChunkSize / 2) mBuffer.resize(keep + kStreamChunkSize);
+
+            size_t count = mpGzipReader->read(mBuffer.data() + keep, mBuffer.size() - keep, mPath);
+            setData(mBuffer.data(), keep + count);
+            return count > 0;
+        }
+
+        void Tokenizer::skipWhitespace()
         {
             while (true)
             {
-                const char* tokenStart = mPos;
-                FileLoc startLoc = mLoc;
+                const char* pLineStart = nullptr;
+                mPos = skipSpaces(mPos, mEnd, mLoc.line, pLineStart);
+                if (pLineStart) mLineStartOffset = mBeginOffset + (pLineStart - mpBegin);
+                if (mPos < mEnd || !refill()) return;
+            }
+        }
 
-                int ch = getChar();
-                if (ch == EOF)
-                {
-                    return {};
-                }
-                else if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r')
+        FileLoc Tokenizer::getLoc() const
+        {
+            FileLoc loc = mLoc;
+            loc.column = (uint32_t)(mBeginOffset + (mPos - mpBegin) - mLineStartOffset);
+            return loc;
+        }
+
+        std::optional<Token> Tokenizer::next()
+        {
+            skipWhitespace();
+            if (mPos == mEnd) return {};
+
+            FileLoc startLoc = getLoc();
+            size_t len = 0;
+
+            // Scan until a character in the given set is found, reading more data when streaming.
+            // The returned length is relative to mPos, which stays at the start of the token.
+            auto scan = [&](size_t offset, auto find) -> bool
+            {
+                while (true)
                 {
-                    // Skip.
+                    const char* p = find(mPos + offset, mEnd);
+                    len = p - mPos;
+                    if (p < mEnd) return true;
+                    offset = len;
+                    if (!refill()) return false;
                 }
-                else if (ch == '"')
-                {
-                    // Scan to closing quote.
-                    bool haveEscaped = false;
-                    while ((ch = getChar()) != '"')
-                    {
-                        if (ch == EOF)
-                        {
-                            throwError(startLoc, "Premature EOF.");
-                        }
-                        else if (ch == '\n')
-                        {
-                            throwError(startLoc, "Unterminated string.");
-                        }
-                        else if (ch == '\\')
-                        {
-                            haveEscaped = true;
-                            // Grab the next character.
-                            if ((ch = getChar()) == EOF)
-                            {
-                                throwError(startLoc, "Premature EOF.");
-                            }
-                        }
-                    }
+            };
 
-                    if (!haveEscaped)
+            char ch = *mPos;
+            if (ch == '"')
+            {
+                // Scan to closing quote.
+                bool haveEscaped = false;
+                size_t offset = 1;
+                while (true)
+                {
+                    if (!scan(offset, findFirstOf<'"', '\\', '\n'>)) throwError(startLoc, "Premature EOF.");
+                    ch = mPos[len];
+                    if (ch == '"')
                     {
-                        return Token({tokenStart, size_t(mPos - tokenStart)}, startLoc);
+                        len++;
+                        break;
                     }
-                    else
+                    else if (ch == '\n')
                     {
-                        mEscaped.clear();
-                        for (const char* p = tokenStart; p < mPos; ++p)
-                        {
-                            if (*p != '\\')
-                            {
-                                mEscaped.push_back(*p);
-                            }
-                            else
-                            {
-                                ++p;
-                                FALCOR_ASSERT(p < mPos);
-                                mEscaped.push_back(decodeEscaped(*p, startLoc));
-                            }
-                        }
-                        return Token({mEscaped.data(), mEscaped.size()}, startLoc);
+                        throwError(startLoc, "Unterminated string.");
                     }
+                    // Escaped character, make sure the next character is available.
+                    haveEscaped = true;
+                    if (mPos + len + 1 == mEnd && !refill()) throwError(startLoc, "Premature EOF.");
+                    offset = len + 2;
                 }
-                else if (ch == '[' || ch == ']')
+
+                const char* tokenStart = mPos;
+                mPos += len;
+
+                if (!haveEscaped)
                 {
-                    return Token({tokenStart, size_t(1)}, startLoc);
+                    return Token({tokenStart, len}, startLoc);
                 }
-                else if (ch == '#')
+                else
                 {
-                    // Comment: scan to EOL (or EOF).
-                    while ((ch = getChar()) != EOF)
+                    mEscaped.clear();
+                    for (const char* p = tokenStart; p < mPos; ++p)
                     {
-                        if (ch == '\n' || ch == '\r')
+                        if (*p != '\\')
                         {
-                            ungetChar();
-                            break;
+                            mEscaped.push_back(*p);
                         }
-                    }
-
-                    return Token({tokenStart, size_t(mPos - tokenStart)}, startLoc);
-                }
-                else
-                {
-                    // Regular statement or numeric token. Scan until we hit a space, opening quote, or bracket.
-                    while ((ch = getChar()) != EOF)
-                    {
-                        if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == '"' || ch == '[' || ch == ']')
+                        else
                         {
-                            ungetChar();
-                            break;
+                            ++p;
+                            FALCOR_ASSERT(p < mPos);
+                            mEscaped.push_back(decodeEscaped(*p, startLoc));
                         }
                     }
-                    return Token({tokenStart, size_t(mPos - tokenStart)}, startLoc);
+                    return Token({mEscaped.data(), mEscaped.size()}, startLoc);
                 }
             }
+            else if (ch == '[' || ch == ']')
+            {
+                len = 1;
+            }
+            else if (ch == '#')
+            {
+                // Comment: scan to EOL (or EOF).
+                scan(1, findFirstOf<'\n', '\r'>);
+            }
+            else
+            {
+                // Regular statement or numeric token. Scan until we hit a space, opening quote, or bracket.
+                scan(1, findTokenEnd);
+            }
+
+            const char* tokenStart = mPos;
+            mPos += len;
+            return Token({tokenStart, len}, startLoc);
+        }
+
+        size_t Tokenizer::parseNumbers(std::vector<Float>& values)
+        {
+            return parseNumbersImpl(values);
+        }
+
+        size_t Tokenizer::parseNumbers(std::vector<int>& values)
+        {
+            return parseNumbersImpl(values);
+        }
+
+        template<typename T>
+        size_t Tokenizer::parseNumbersImpl(std::vector<T>& values)
+        {
+            size_t count = 0;
+            while (true)
+            {
+                skipWhitespace();
+                if (mPos == mEnd) break;
+
+                char ch = *mPos;
+                if (!((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.')) break;
+
+                // Make sure the whole number is in memory when streaming.
+                const char* end = findTokenEnd(mPos + 1, mEnd);
+                if (end == mEnd)
+                {
+                    if (refill()) continue;
+                    end = mEnd;
+                }
+
+                T value;
+                if (!parseNumber(mPos, end, value)) break;
+                values.push_back(value);
+                mPos = end;
+                count++;
+            }
+            return count;
         }
 
         static int32_t parseInt(const Token& t)
@@ -279,8 +525,8 @@ namespace Falcor
         constexpr uint32_t TokenOptional = 0;
         constexpr uint32_t TokenRequired = 1;
 
-        template <typename Next, typename Unget>
-        static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
+        template <typename Next, typename Unget, typename ParseNumbers>
+        static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken, ParseNumbers parseNumbers)
         {
             ParsedParameterVector parameterVector;
 
@@ -412,6 +658,17 @@ namespace Falcor
                 {
                     while (true)
                     {
+                        // Parse runs of plain numbers directly into the parameter arrays.
+                        // Everything else (strings, booleans, comments, the closing bracket) goes through the token path.
+                        if (valType == Int)
+                        {
+                            parseNumbers(param.ints);
+                        }
+                        else if (valType == Unknown || valType == Float)
+                        {
+                            if (parseNumbers(param.floats) > 0) valType = Float;
+                        }
+
                         val = *nextToken(TokenRequired);
                         if (val.token == "]") break;
                         addVal(val);
@@ -485,6 +742,14 @@ namespace Falcor
                 ungetToken = t;
             };
 
+            /** Helper function that parses numbers in bulk from the current file.
+            */
+            auto parseNumbers = [&](auto& values) -> size_t
+            {
+                if (ungetToken.has_value() || fileStack.empty()) return 0;
+                return fileStack.back()->parseNumbers(values);
+            };
+
             /** Helper function for pbrt API entrypoints that take a single string
                 parameter and a ParameterVector (e.g. onShape()).
             */
@@ -493,7 +758,7 @@ namespace Falcor
                 Token t = *nextToken(TokenRequired);
                 std::string_view dequoted = dequoteString(t);
                 std::string n = toString(dequoted);
-                ParsedParameterVector parameterVector = parseParameters(nextToken, unget);
+                ParsedParameterVector parameterVector = parseParameters(nextToken, unget, parseNumbers);
                 (target.*apiFunc)(n, std::move(parameterVector), loc);
             };
 
@@ -509,13 +774,39 @@ namespace Falcor
                 }
             };
 
+            struct PendingImport
+            {
+                std::filesystem::path path;
+                std::unique_ptr<BasicSceneBuilder> pBuilder;
+                Threading::Task task;
+            };
+            std::vector<PendingImport> imports;
+
+            // Make sure no import task outlives its builder if parsing fails.
+            struct ImportGuard
+            {
+                std::vector<PendingImport>& imports;
+                ~ImportGuard()
+                {
+                    for (auto& pending : imports)
+                    {
+                        try { pending.task.finish(); } catch (...) {}
+                    }
+                }
+            } importGuard{imports};
+
             std::optional<Token> tok;
+            std::string directive;
 
             while (true)
             {
                 tok = nextToken(TokenOptional);
                 if (!tok.has_value()) break;
 
+                // Reading further tokens may move the tokenizer's stream buffer, so anchor the directive in owned storage.
+                directive.assign(tok->token);
+                tok->token = directive;
+
                 switch (tok->token[0])
                 {
                 case 'A':
@@ -614,7 +905,27 @@ namespace Falcor
                     }
                     else if (tok->token == "Import")
                     {
-                        throwError(tok->loc, "'Import' directive not supported yet.");
+                        Token filenameToken = *nextToken(TokenRequired);
+                        std::string filename = toString(dequoteString(filenameToken));
+
+                        BasicSceneBuilder* pBuilder = dynamic_cast<BasicSceneBuilder*>(&target);
+                        if (!pBuilder)
+                        {
+                            throwError(tok->loc, "'Import' directive is only supported when building a scene.");
+                        }
+
+                        // Imported files cannot change the graphics state, so they are parsed concurrently
+                        // into separate builders that are merged in directive order once this file is done.
+                        PendingImport& pending = imports.emplace_back();
+                        pending.pBuilder = pBuilder->copyForImport(tok->loc);
+                        pending.path = searchPath / filename;
+                        if (Threading::getThreadCount() > 0)
+                        {
+                            pending.task = Threading::dispatchTask([pImportBuilder = pending.pBuilder.get(), path = pending.path]()
+                            {
+                                parse(*pImportBuilder, Tokenizer::createFromFile(path));
+                            });
+                        }
                     }
                     else if (tok->token == "Identity")
                     {
@@ -821,7 +1132,7 @@ namespace Falcor
                         Token t = *nextToken(TokenRequired);
                         std::string_view dequoted = dequoteString(t);
                         std::string texName = toString(dequoted);
-                        ParsedParameterVector params = parseParameters(nextToken, unget);
+                        ParsedParameterVector params = parseParameters(nextToken, unget, parseNumbers);
                         target.onTexture(name, type, texName, std::move(params), tok->loc);
                     }
                     else
@@ -845,6 +1156,20 @@ namespace Falcor
                     syntaxError(*tok);
                 }
             }
+
+            // Merge imported files in the order of their 'Import' directives.
+            for (auto& pending : imports)
+            {
+                if (pending.task.isValid())
+                {
+                    pending.task.finish();
+                }
+                else
+                {
+                    parse(*pending.pBuilder, Tokenizer::createFromFile(pending.path));
+                }
+                static_cast<BasicSceneBuilder&>(target).mergeImported(*pending.pBuilder);
+            }
         }
 
         void parseFile(ParserTarget& target, const std::filesystem::path& path)
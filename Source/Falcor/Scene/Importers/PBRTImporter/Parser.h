@@ -113,7 +113,11 @@ namespace Falcor
         {
         public:
             Tokenizer(std::string str, const std::filesystem::path& path);
+            ~Tokenizer();
 
+            /** Create a tokenizer for a file.
+                Plain files are memory mapped, gzip compressed files (.gz) are decompressed in chunks while tokenizing.
+            */
             static std::unique_ptr<Tokenizer> createFromFile(const std::filesystem::path& path);
             static std::unique_ptr<Tokenizer> createFromString(std::string str);
 
@@ -122,55 +126,63 @@ namespace Falcor
             */
             std::optional<Token> next();
 
+            /** Parse a run of plain numeric tokens directly into an array.
+                Parsing stops before the first token that is not a plain number (e.g. a closing bracket,
+                a comment or a malformed number), which is left to be returned by next().
+                \param[in,out] values Array the parsed values are appended to.
+                \return Number of values parsed.
+            */
+            size_t parseNumbers(std::vector<Float>& values);
+            size_t parseNumbers(std::vector<int>& values);
+
             const std::filesystem::path& getPath() const { return mPath; }
 
         private:
-            /** Static list of filenames to allow file locations (FileLoc::filename) to be valid
-                even after the tokenizer is destroyed.
+            struct GzipReader;
+
+            Tokenizer(const std::filesystem::path& path);
+
+            void setData(const char* pData, size_t size);
+
+            /** Add a filename to a static list to allow file locations (FileLoc::filename) to be valid
+                even after the tokenizer is destroyed. This is thread-safe, as imported files are tokenized concurrently.
+                \param[in] path File path.
+                \return Reference to the stored filename.
             */
-            static std::vector<std::unique_ptr<std::string>>& getFilenames()
-            {
-                static std::vector<std::unique_ptr<std::string>> filenames;
-                return filenames;
-            }
+            static const std::string& addFilename(const std::filesystem::path& path);
 
             bool isUTF16(const void* ptr, size_t len) const;
 
-            int getChar()
-            {
-                if (mPos == mEnd) return EOF;
-                int ch = *mPos++;
-                if (ch == '\n')
-                {
-                    ++mLoc.line;
-                    mLoc.column = 0;
-                }
-                else
-                {
-                    ++mLoc.column;
-                }
-                return ch;
-            }
-
-            void ungetChar()
-            {
-                --mPos;
-                if (*mPos == '\n')
-                {
-                    // Don't worry about the column; we'll be going to the start of
-                    // the next line again shortly...
-                    --mLoc.line;
-                }
-            }
-
-            std::filesystem::path mPath;    ///< File path we're reading from.
-            FileLoc mLoc;                   ///< File location.
-            std::string mContents;          ///< File contents we're parsing.
-
-            const char* mPos;               ///< Current position in the file.
-            const char* mEnd;               ///< End of the file (one past).
-
-            std::string mEscaped;           ///< Temporary storage for escaped tokens.
+            /** Read more data when streaming. The data from the current position onwards is kept and moved to the start of the buffer.
+                \return Returns false if there is no more data.
+            */
+            bool refill();
+
+            /** Skip whitespace and keep track of the line count.
+            */
+            void skipWhitespace();
+
+            /** Get the location of the current position.
+            */
+            FileLoc getLoc() const;
+
+            template<typename T>
+            size_t parseNumbersImpl(std::vector<T>& values);
+
+            std::filesystem::path mPath;                    ///< File path we're reading from.
+            FileLoc mLoc;                                   ///< File location. Only the line is kept up to date, the column is computed from mLineStartOffset.
+            std::string mContents;                          ///< File contents we're parsing if created from a string.
+            MemoryMappedFile::SharedPtr mpMappedFile;       ///< Mapped file if reading a plain file.
+            std::unique_ptr<GzipReader> mpGzipReader;       ///< Decompressor if streaming a compressed file.
+            std::vector<char> mBuffer;                      ///< Window of decompressed data if streaming.
+
+            const char* mpBegin = nullptr;                  ///< Start of the data in memory.
+            const char* mPos = nullptr;                     ///< Current position in the data.
+            const char* mEnd = nullptr;                     ///< End of the data (one past).
+            uint64_t mBeginOffset = 0;                      ///< Offset of mpBegin in the file.
+            uint64_t mLineStartOffset = 0;                  ///< Offset of the start of the current line in the file.
+
+            std::string mEscaped;                           ///< Temporary storage for escaped tokens.
         };
     }
 }
@@ -84,6 +84,9 @@ namespace Falcor
         const std::string kAddViewpoint = "addViewpoint";
         const std::string kRemoveViewpoint = "kRemoveViewpoint";
         const std::string kSelectViewpoint = "selectViewpoint";
+        const std::string kGetMeshLODCount = "getMeshLODCount";
+        const std::string kSetMeshInstanceLOD = "setMeshInstanceLOD";
+        const std::string kGetMeshInstanceLOD = "getMeshInstanceLOD";
 
         // Checks if the transform flips the coordinate system handedness (its determinant is negative).
         bool doesTransformFlip(const glm::mat4& m)
@@ -125,11 +128,28 @@ namespace Falcor
         mMeshBBs = std::move(sceneData.meshBBs);
         mMeshIdToInstanceIds = std::move(sceneData.meshIdToInstanceIds);
         mMeshGroups = std::move(sceneData.meshGroups);
+        mMeshletDesc = std::move(sceneData.meshletDesc);
+        mMeshletOffsets = std::move(sceneData.meshletOffsets);
+        mMeshletVertices = std::move(sceneData.meshletVertices);
+        mMeshletTriangles = std::move(sceneData.meshletTriangles);
+        mMeshLODDesc = std::move(sceneData.meshLODDesc);
+        mMeshLODOffsets = std::move(sceneData.meshLODOffsets);
 
         mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
         mHas16BitIndices = sceneData.has16BitIndices;
         mHas32BitIndices = sceneData.has32BitIndices;
 
+        mSceneStats.vertexCacheACMRBefore = sceneData.vertexCacheStatsBefore.getACMR();
+        mSceneStats.vertexCacheACMRAfter = sceneData.vertexCacheStatsAfter.getACMR();
+        mSceneStats.vertexCacheATVRBefore = sceneData.vertexCacheStatsBefore.getATVR();
+        mSceneStats.vertexCacheATVRAfter = sceneData.vertexCacheStatsAfter.getATVR();
+
+        mSceneStats.blasSplitGroupCount = sceneData.meshGroupSplitStats.splitGroupCount;
+        mSceneStats.blasSplitResultGroupCount = sceneData.meshGroupSplitStats.resultGroupCount;
+        mSceneStats.blasSplitSubMeshCount = sceneData.meshGroupSplitStats.subMeshCount;
+        mSceneStats.blasSplitCost = sceneData.meshGroupSplitStats.cost;
+        mSceneStats.blasSplitOverlap = sceneData.meshGroupSplitStats.overlap;
+
         mCurveDesc = std::move(sceneData.curveDesc);
         mCurveBBs = std::move(sceneData.curveBBs);
         mCurveIndexData = std::move(sceneData.curveIndexData);
@@ -153,6 +173,34 @@ namespace Falcor
         // Setup volume grid -> id map.
         for (size_t i = 0; i < mGrids.size(); ++i) mGridIDs.emplace(mGrids[i], (uint32_t)i);
 
+        // Streamed grid sequences only contribute the grid of the current frame to the scene.
+        // Each streamed slot gets one grid ID that is reused for the grids of later frames. If the grid of the
+        // current frame is not resident yet, the ID is reserved with an empty entry that is bound once a frame has loaded.
+        mStreamedGridIDs.resize(mGridVolumes.size());
+        for (size_t volumeIndex = 0; volumeIndex < mGridVolumes.size(); ++volumeIndex)
+        {
+            const auto& pGridVolume = mGridVolumes[volumeIndex];
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridVolume::GridSlot::Count; ++slotIndex)
+            {
+                auto slot = (GridVolume::GridSlot)slotIndex;
+                uint32_t& gridID = mStreamedGridIDs[volumeIndex][slotIndex];
+                gridID = kInvalidGrid;
+                if (!pGridVolume->isStreaming(slot)) continue;
+
+                const auto& pGrid = pGridVolume->getGrid(slot);
+                auto it = pGrid ? mGridIDs.find(pGrid) : mGridIDs.end();
+                if (it != mGridIDs.end())
+                {
+                    gridID = it->second;
+                }
+                else
+                {
+                    gridID = (uint32_t)mGrids.size();
+                    mGrids.push_back(nullptr);
+                }
+            }
+        }
+
         // Set default SDF grid config.
         setSDFGridConfig();
 
@@ -171,10 +219,12 @@ namespace Falcor
                 if (mesh.prevVbOffset + mesh.vertexCount > sceneData.prevVertexCount) throw RuntimeError("Cached Mesh Animation: Invalid prevVbOffset");
             }
         }
+        // Vertex caches streamed from a keyframe file only hold their first keyframe.
+        const bool keyframesInFile = sceneData.streamVertexCaches && sceneData.pVertexCacheKeyframeFile;
         for (const auto &mesh : sceneData.cachedMeshes)
         {
             if (!mMeshDesc[mesh.meshID].isAnimated()) throw RuntimeError("Cached Mesh Animation: Referenced mesh ID is not dynamic");
-            if (mesh.timeSamples.size() != mesh.vertexData.size()) throw RuntimeError("Cached Mesh Animation: Time sample count mismatch.");
+            if (mesh.vertexData.empty() || (!keyframesInFile && mesh.timeSamples.size() != mesh.vertexData.size())) throw RuntimeError("Cached Mesh Animation: Time sample count mismatch.");
             for (const auto &vertices : mesh.vertexData)
             {
                 if (vertices.size() != mMeshDesc[mesh.meshID].vertexCount) throw RuntimeError("Cached Mesh Animation: Vertex count mismatch.");
@@ -189,7 +239,8 @@ namespace Falcor
         }
 
         // Must be placed after curve data/AABB creation.
-        mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.meshStaticData);
+        mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes), sceneData.meshStaticData,
+            sceneData.streamVertexCaches ? &sceneData.vertexCacheStreamingSettings : nullptr, sceneData.pVertexCacheKeyframeFile);
 
         // Finalize scene.
         finalize();
@@ -721,6 +772,43 @@ namespace Falcor
         }
     }
 
+    void Scene::updateAnimatedMeshBounds(const std::vector<PackedStaticVertexData>& vertices, const std::vector<uint32_t>& meshIDs)
+    {
+        for (uint32_t meshID : meshIDs)
+        {
+            checkArgument(meshID < mMeshDesc.size(), "'meshID' ({}) is out of range", meshID);
+            const MeshDesc& mesh = mMeshDesc[meshID];
+            checkArgument((size_t)mesh.vbOffset + mesh.vertexCount <= vertices.size(), "Vertex data does not cover mesh {}", meshID);
+
+            AABB meshBB;
+            for (uint32_t i = mesh.vbOffset; i < mesh.vbOffset + mesh.vertexCount; i++) meshBB.include(vertices[i].position);
+            mMeshBBs[meshID] = meshBB;
+        }
+
+        updateBounds();
+    }
+
+    void Scene::updateAnimatedCurveBounds(const std::vector<StaticCurveVertexData>& vertices, const std::vector<uint32_t>& curveIDs)
+    {
+        for (uint32_t curveID : curveIDs)
+        {
+            checkArgument(curveID < mCurveDesc.size(), "'curveID' ({}) is out of range", curveID);
+            const CurveDesc& curve = mCurveDesc[curveID];
+            checkArgument((size_t)curve.vbOffset + curve.vertexCount <= vertices.size(), "Vertex data does not cover curve {}", curveID);
+
+            // Include the radius at each vertex, same as the bounds computed by the scene builder.
+            AABB curveBB;
+            for (uint32_t i = curve.vbOffset; i < curve.vbOffset + curve.vertexCount; i++)
+            {
+                curveBB.include(vertices[i].position - float3(vertices[i].radius));
+                curveBB.include(vertices[i].position + float3(vertices[i].radius));
+            }
+            mCurveBBs[curveID] = curveBB;
+        }
+
+        updateBounds();
+    }
+
     void Scene::updateGeometryInstances(bool forceUpdate)
     {
         if (mGeometryInstanceData.empty()) return;
@@ -1111,6 +1199,10 @@ namespace Falcor
         s.sdfGridInstancesCount = 0;
 
         s.customPrimitiveCount = getCustomPrimitiveCount();
+        s.meshletCount = getMeshletCount();
+        s.meshLODCount = mMeshLODDesc.size();
+        s.meshLODTriangleCount = 0;
+        for (const auto& lod : mMeshLODDesc) s.meshLODTriangleCount += lod.getTriangleCount();
 
         for (uint32_t instanceID = 0; instanceID < getGeometryInstanceCount(); instanceID++)
         {
@@ -1319,6 +1411,7 @@ namespace Falcor
 
         for (const auto& pGrid : mGrids)
         {
+            if (!pGrid) continue;
             s.gridVoxelCount += pGrid->getVoxelCount();
             s.gridMemoryInBytes += pGrid->getGridSizeInBytes();
         }
@@ -1438,16 +1531,44 @@ namespace Falcor
         // Early out if no volumes have changed.
         if (!forceUpdate && combinedUpdates == GridVolume::UpdateFlags::None) return UpdateFlags::None;
 
+        // Rebind the grid IDs of streamed grid sequences to the grids of the current frames.
+        for (size_t volumeIndex = 0; volumeIndex < mGridVolumes.size(); ++volumeIndex)
+        {
+            const auto& pGridVolume = mGridVolumes[volumeIndex];
+            if (!is_set(pGridVolume->getUpdates(), GridVolume::UpdateFlags::GridsChanged)) continue;
+
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)GridVolume::GridSlot::Count; ++slotIndex)
+            {
+                uint32_t gridID = mStreamedGridIDs[volumeIndex][slotIndex];
+                const auto& pGrid = pGridVolume->getGrid((GridVolume::GridSlot)slotIndex);
+                if (gridID == kInvalidGrid || !pGrid || mGrids[gridID] == pGrid) continue;
+
+                auto it = mGridIDs.find(mGrids[gridID]);
+                if (it != mGridIDs.end() && it->second == gridID) mGridIDs.erase(it);
+                mGrids[gridID] = pGrid;
+                mGridIDs[pGrid] = gridID;
+                if (!forceUpdate) pGrid->setShaderData(mpSceneBlock["grids"][gridID]);
+            }
+        }
+
         // Upload grids.
         if (forceUpdate)
         {
             auto var = mpSceneBlock["grids"];
             for (size_t i = 0; i < mGrids.size(); ++i)
             {
-                mGrids[i]->setShaderData(var[i]);
+                // Grid IDs reserved for streamed sequences are empty until a frame is resident.
+                if (mGrids[i]) mGrids[i]->setShaderData(var[i]);
             }
         }
 
+        // Frames of streamed sequences that failed to load have no grid ID.
+        auto getGridID = [this](const Grid::SharedPtr& pGrid)
+        {
+            auto it = mGridIDs.find(pGrid);
+            return it != mGridIDs.end() ? it->second : kInvalidGrid;
+        };
+
         // Upload volumes and clear updates.
         uint32_t volumeIndex = 0;
         for (const auto& pGridVolume : mGridVolumes)
@@ -1456,8 +1577,8 @@ namespace Falcor
             {
                 // Fetch copy of volume data.
                 auto data = pGridVolume->getData();
-                data.densityGrid = pGridVolume->getDensityGrid() ? mGridIDs.at(pGridVolume->getDensityGrid()) : kInvalidGrid;
-                data.emissionGrid = pGridVolume->getEmissionGrid() ? mGridIDs.at(pGridVolume->getEmissionGrid()) : kInvalidGrid;
+                data.densityGrid = pGridVolume->getDensityGrid() ? getGridID(pGridVolume->getDensityGrid()) : kInvalidGrid;
+                data.emissionGrid = pGridVolume->getEmissionGrid() ? getGridID(pGridVolume->getEmissionGrid()) : kInvalidGrid;
                 // Merge grid and volume transforms.
                 const auto& densityGrid = pGridVolume->getDensityGrid();
                 if (densityGrid)
@@ -1546,8 +1667,18 @@ namespace Falcor
             mBlasDataValid = false;
         }
 
+        if (mMeshInstanceLODsChanged)
+        {
+            // Upload the new index ranges of the instances, and rebuild the draw arguments and the BLASes.
+            updateGeometryInstances(true);
+            createDrawList();
+            mBlasDataValid = false;
+            flags |= UpdateFlags::MeshLODsChanged;
+        }
+
         mCustomPrimitivesMoved = false;
         mCustomPrimitivesChanged = false;
+        mMeshInstanceLODsChanged = false;
         return flags;
     }
 
@@ -1821,6 +1952,11 @@ namespace Falcor
                 << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
                 << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
                 << "  Animation data memory: " << formatByteSize(s.animationMemoryInBytes) << std::endl
+                << "  Vertex cache ACMR (before/after optimization): " << s.vertexCacheACMRBefore << " / " << s.vertexCacheACMRAfter << std::endl
+                << "  Vertex cache ATVR (before/after optimization): " << s.vertexCacheATVRBefore << " / " << s.vertexCacheATVRAfter << std::endl
+                << "  Meshlet count: " << s.meshletCount << std::endl
+                << "  Mesh LOD count: " << s.meshLODCount << std::endl
+                << "  Mesh LOD triangle count: " << s.meshLODTriangleCount << std::endl
                 << "  Curve count: " << s.curveCount << std::endl
                 << "  Curve instance count: " << s.curveInstanceCount << std::endl
                 << "  Unique curve segment count: " << s.uniqueCurveSegmentCount << std::endl
@@ -1851,6 +1987,9 @@ namespace Falcor
                 << "  TLAS count: " << s.tlasCount << std::endl
                 << "  TLAS memory (final): " << formatByteSize(s.tlasMemoryInBytes) << std::endl
                 << "  TLAS memory (scratch): " << formatByteSize(s.tlasScratchMemoryInBytes) << std::endl
+                << "  Mesh groups split (input/output): " << s.blasSplitGroupCount << " / " << s.blasSplitResultGroupCount << std::endl
+                << "  Mesh group split sub-meshes: " << s.blasSplitSubMeshCount << std::endl
+                << "  Mesh group split cost (SAH/overlap): " << s.blasSplitCost << " / " << s.blasSplitOverlap << std::endl
                 << std::endl;
 
             // Material stats.
@@ -2328,17 +2467,19 @@ namespace Falcor
             std::vector<DrawIndexedArguments> drawClockwiseMeshes[2], drawCounterClockwiseMeshes[2];
 
             uint32_t instanceID = 0;
-            for (const auto& instance : mGeometryInstanceData)
+            for (uint32_t i = 0; i < (uint32_t)mGeometryInstanceData.size(); i++)
             {
+                const auto& instance = mGeometryInstanceData[i];
                 if (instance.getType() != GeometryType::TriangleMesh) continue;
 
                 const auto& mesh = mMeshDesc[instance.geometryID];
                 bool use16Bit = mesh.use16BitIndices();
 
+                // The instance index range selects the LOD of the mesh.
                 DrawIndexedArguments draw;
-                draw.IndexCountPerInstance = mesh.indexCount;
+                draw.IndexCountPerInstance = getMeshInstanceIndexCount(i);
                 draw.InstanceCount = 1;
-                draw.StartIndexLocation = mesh.ibOffset * (use16Bit ? 2 : 1);
+                draw.StartIndexLocation = instance.ibOffset * (use16Bit ? 2 : 1);
                 draw.BaseVertexLocation = mesh.vbOffset;
                 draw.StartInstanceLocation = instanceID++;
 
@@ -2377,6 +2518,54 @@ namespace Falcor
         }
     }
 
+    void Scene::setMeshInstanceLOD(uint32_t instanceID, uint32_t lod)
+    {
+        checkArgument(instanceID < mGeometryInstanceData.size(), "'instanceID' ({}) is out of range.", instanceID);
+        auto& instance = mGeometryInstanceData[instanceID];
+        checkArgument(instance.getType() == GeometryType::TriangleMesh, "Geometry instance {} is not a triangle mesh instance.", instanceID);
+
+        const uint32_t meshID = instance.geometryID;
+        lod = std::min(lod, getMeshLODCount(meshID) - 1);
+        if (lod == getMeshInstanceLOD(instanceID)) return;
+
+        // Point the instance to the index range of the LOD. The draw arguments and BLASes are updated in update().
+        if (mMeshInstanceLODs.empty()) mMeshInstanceLODs.resize(mGeometryInstanceData.size(), 0);
+        mMeshInstanceLODs[instanceID] = lod;
+        instance.ibOffset = mMeshDesc[meshID].ibOffset + (lod > 0 ? getMeshLOD(meshID, lod).ibOffset : 0);
+        mMeshInstanceLODsChanged = true;
+    }
+
+    uint32_t Scene::getMeshInstanceLOD(uint32_t instanceID) const
+    {
+        checkArgument(instanceID < mGeometryInstanceData.size(), "'instanceID' ({}) is out of range.", instanceID);
+        return mMeshInstanceLODs.empty() ? 0 : mMeshInstanceLODs[instanceID];
+    }
+
+    uint32_t Scene::getMeshInstanceIndexCount(uint32_t instanceID) const
+    {
+        const uint32_t meshID = mGeometryInstanceData[instanceID].geometryID;
+        const uint32_t lod = getMeshInstanceLOD(instanceID);
+        return lod > 0 ? getMeshLOD(meshID, lod).indexCount : mMeshDesc[meshID].indexCount;
+    }
+
+    uint32_t Scene::getMeshRaytracingLOD(uint32_t meshID) const
+    {
+        // All instances of a mesh share its BLAS geometry. To keep hits consistent with the instance triangles,
+        // the instances must use the same LOD.
+        const auto& instanceIDs = mMeshIdToInstanceIds[meshID];
+        if (mMeshInstanceLODs.empty() || instanceIDs.empty()) return 0;
+
+        const uint32_t lod = mMeshInstanceLODs[instanceIDs[0]];
+        for (uint32_t instanceID : instanceIDs)
+        {
+            if (mMeshInstanceLODs[instanceID] != lod)
+            {
+                throw RuntimeError("Ray tracing requires all instances of mesh '{}' to use the same LOD.", mMeshNames[meshID]);
+            }
+        }
+        return lod;
+    }
+
     void Scene::initGeomDesc(RenderContext* pContext)
     {
         // This function initializes all geometry descs to prepare for BLAS build.
@@ -2489,9 +2678,12 @@ namespace Falcor
                         {
                             // The global index data is stored in a dword array.
                             // Each mesh specifies whether its indices are in 16-bit or 32-bit format.
+                            // The geometry uses the LOD selected for the mesh instances so that hits match the instance triangles.
                             ResourceFormat ibFormat = mesh.use16BitIndices() ? ResourceFormat::R16Uint : ResourceFormat::R32Uint;
-                            desc.content.triangles.indexData = pIb->getGpuAddress() + mesh.ibOffset * sizeof(uint32_t);
-                            desc.content.triangles.indexCount = mesh.indexCount;
+                            const uint32_t lod = getMeshRaytracingLOD(meshID);
+                            const uint32_t ibOffset = mesh.ibOffset + (lod > 0 ? getMeshLOD(meshID, lod).ibOffset : 0);
+                            desc.content.triangles.indexData = pIb->getGpuAddress() + ibOffset * sizeof(uint32_t);
+                            desc.content.triangles.indexCount = lod > 0 ? getMeshLOD(meshID, lod).indexCount : mesh.indexCount;
                             desc.content.triangles.indexFormat = ibFormat;
                         }
                         else
@@ -3689,6 +3881,13 @@ namespace Falcor
         d["vertexMemoryInBytes"] = vertexMemoryInBytes;
         d["geometryMemoryInBytes"] = geometryMemoryInBytes;
         d["animationMemoryInBytes"] = animationMemoryInBytes;
+        d["vertexCacheACMRBefore"] = vertexCacheACMRBefore;
+        d["vertexCacheACMRAfter"] = vertexCacheACMRAfter;
+        d["vertexCacheATVRBefore"] = vertexCacheATVRBefore;
+        d["vertexCacheATVRAfter"] = vertexCacheATVRAfter;
+        d["meshletCount"] = meshletCount;
+        d["meshLODCount"] = meshLODCount;
+        d["meshLODTriangleCount"] = meshLODTriangleCount;
 
         // Curve stats
         d["curveCount"] = curveCount;
@@ -3730,6 +3929,11 @@ namespace Falcor
         d["tlasCount"] = tlasCount;
         d["tlasMemoryInBytes"] = tlasMemoryInBytes;
         d["tlasScratchMemoryInBytes"] = tlasScratchMemoryInBytes;
+        d["blasSplitGroupCount"] = blasSplitGroupCount;
+        d["blasSplitResultGroupCount"] = blasSplitResultGroupCount;
+        d["blasSplitSubMeshCount"] = blasSplitSubMeshCount;
+        d["blasSplitCost"] = blasSplitCost;
+        d["blasSplitOverlap"] = blasSplitOverlap;
 
         // Light stats
         d["activeLightCount"] = activeLightCount;
@@ -3790,6 +3994,9 @@ namespace Falcor
         scene.def(kAddViewpoint.c_str(), pybind11::overload_cast<const float3&, const float3&, const float3&, uint32_t>(&Scene::addViewpoint), "position"_a, "target"_a, "up"_a, "cameraIndex"_a = 0); // add specified viewpoint
         scene.def(kRemoveViewpoint.c_str(), &Scene::removeViewpoint); // remove the selected viewpoint
         scene.def(kSelectViewpoint.c_str(), &Scene::selectViewpoint, "index"_a); // select a viewpoint by index
+        scene.def(kGetMeshLODCount.c_str(), &Scene::getMeshLODCount, "meshID"_a);
+        scene.def(kSetMeshInstanceLOD.c_str(), &Scene::setMeshInstanceLOD, "instanceID"_a, "lod"_a);
+        scene.def(kGetMeshInstanceLOD.c_str(), &Scene::getMeshInstanceLOD, "instanceID"_a);
 
         // RenderSettings
         ScriptBindings::SerializableStruct<Scene::RenderSettings> renderSettings(m, "SceneRenderSettings");
@@ -43,6 +43,7 @@
 #include "SDFs/SparseBrickSet/SDFSBS.h"
 #include "SDFs/SparseVoxelOctree/SDFSVO.h"
 #include "Utils/Math/AABB.h"
+#include "Utils/Geometry/MeshOptimizer.h"
 #include "Animation/AnimationController.h"
 #include "Animation/AnimatedVertexCache.h"
 #include "Displacement/DisplacementUpdateTask.slang"
@@ -133,6 +134,7 @@ namespace Falcor
             SDFGridConfigChanged        = 0x400000,     ///< SDF grid config changed.
             SDFGeometryChanged          = 0x800000,     ///< SDF grid geometry changed.
             MeshesChanged               = 0x1000000,    ///< Mesh data changed (skinning or vertex animations).
+            MeshLODsChanged             = 0x2000000,    ///< The selected LOD of mesh instances changed.
             All                         = -1
         };
 
@@ -257,6 +259,18 @@ namespace Falcor
             bool isDisplaced = false;           ///< True if group uses displacement mapping.
         };
 
+        /** Statistics of the splitting of large mesh groups into multiple BLASes.
+            Mesh groups above the triangle limit per BLAS are partitioned by the surface area heuristic, see SAHPartitioner.
+        */
+        struct MeshGroupSplitStats
+        {
+            uint32_t splitGroupCount = 0;       ///< Number of mesh groups that exceeded the triangle limit and were split.
+            uint32_t resultGroupCount = 0;      ///< Number of mesh groups that the split groups were partitioned into.
+            uint32_t subMeshCount = 0;          ///< Number of meshes added by splitting large meshes into sub-meshes.
+            float cost = 1.f;                   ///< Estimated ray traversal cost of the split groups relative to not splitting them, weighted by triangle count.
+            float overlap = 0.f;                ///< Estimated overlap between the split groups relative to their surface area, weighted by triangle count.
+        };
+
         /** Scene graph node.
         */
         struct Node
@@ -308,6 +322,20 @@ namespace Falcor
             std::vector<PackedStaticVertexData> meshStaticData;     ///< Vertex attributes for all meshes in packed format.
             std::vector<SkinningVertexData> meshSkinningData;       ///< Additional vertex attributes for skinned meshes.
 
+            MeshOptimizer::VertexCacheStats vertexCacheStatsBefore; ///< Vertex cache statistics of all meshes before optimization. Only set if built with SceneBuilder::Flags::OptimizeVertexCache.
+            MeshOptimizer::VertexCacheStats vertexCacheStatsAfter;  ///< Vertex cache statistics of all meshes after optimization. Only set if built with SceneBuilder::Flags::OptimizeVertexCache.
+            MeshGroupSplitStats meshGroupSplitStats;                ///< Statistics of the splitting of mesh groups above the triangle limit per BLAS.
+
+            // Meshlet data (only generated if built with SceneBuilder::Flags::GenerateMeshlets)
+            std::vector<MeshletDesc> meshletDesc;                   ///< List of meshlet descriptors, ordered by mesh.
+            std::vector<uint32_t> meshletOffsets;                   ///< Index of the first meshlet of each mesh, followed by the total meshlet count.
+            std::vector<uint32_t> meshletVertices;                  ///< Vertex indices for all meshlets, relative to the vertex offset of the mesh.
+            std::vector<uint32_t> meshletTriangles;                 ///< Triangles for all meshlets, each with three packed 8-bit meshlet-local vertex indices.
+
+            // Mesh LOD data (only generated if built with SceneBuilder::Flags::GenerateLODs)
+            std::vector<MeshLODDesc> meshLODDesc;                   ///< List of LOD descriptors, ordered by mesh and LOD. LOD 0 (the mesh itself) is not included.
+            std::vector<uint32_t> meshLODOffsets;                   ///< Index of the first LOD descriptor of each mesh, followed by the total LOD descriptor count.
+
             // Curve data
             std::vector<CurveDesc> curveDesc;                       ///< List of curve descriptors.
             std::vector<AABB> curveBBs;                             ///< List of curve bounding boxes in object space. Each curve consists of many segments, each with its own AABB. The bounding boxes here are the unions of those.
@@ -317,6 +345,11 @@ namespace Falcor
             std::vector<StaticCurveVertexData> curveStaticData;     ///< Vertex attributes for all curves.
             std::vector<CachedCurve> cachedCurves;                  ///< Vertex cache for dynamic (vertex animated) curves.
 
+            // Vertex cache streaming
+            bool streamVertexCaches = false;                        ///< True if vertex cache keyframes should be streamed from disk.
+            VertexCacheStreamingSettings vertexCacheStreamingSettings; ///< Settings for streaming vertex cache keyframes.
+            KeyframeFile::SharedPtr pVertexCacheKeyframeFile;       ///< Keyframes of the vertex caches stored next to the scene cache (optional). If set, the vertex caches only hold their first keyframe.
+
             // SDF grid data
             std::vector<SDFGrid::SharedPtr> sdfGrids;               ///< List of SDF grids.
             std::vector<SDFGridDesc> sdfGridDesc;                   ///< List of SDF grid descriptors.
@@ -346,6 +379,19 @@ namespace Falcor
             uint64_t geometryMemoryInBytes = 0;         ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives, instances etc.).
             uint64_t animationMemoryInBytes = 0;        ///< Total memory in bytes used by the animation system (transforms, skinning buffers).
 
+            // Vertex cache stats (only computed if the scene was built with SceneBuilder::Flags::OptimizeVertexCache)
+            double vertexCacheACMRBefore = 0.0;         ///< Average cache miss ratio (transformed vertices per triangle) of all meshes before optimization.
+            double vertexCacheACMRAfter = 0.0;          ///< Average cache miss ratio (transformed vertices per triangle) of all meshes after optimization.
+            double vertexCacheATVRBefore = 0.0;         ///< Average transformed vertex ratio (transformed vertices per vertex) of all meshes before optimization.
+            double vertexCacheATVRAfter = 0.0;          ///< Average transformed vertex ratio (transformed vertices per vertex) of all meshes after optimization.
+
+            // Meshlet stats
+            uint64_t meshletCount = 0;                  ///< Number of meshlets.
+
+            // Mesh LOD stats
+            uint64_t meshLODCount = 0;                  ///< Number of generated mesh LODs, excluding LOD 0.
+            uint64_t meshLODTriangleCount = 0;          ///< Total number of triangles in the generated mesh LODs.
+
             // Curve stats
             uint64_t curveCount = 0;                    ///< Number of curves.
             uint64_t curveInstanceCount = 0;            ///< Number of curve instances.
@@ -380,6 +426,11 @@ namespace Falcor
             uint64_t tlasCount = 0;                     ///< Number of TLASes.
             uint64_t tlasMemoryInBytes = 0;             ///< Total memory in bytes used by the TLASes.
             uint64_t tlasScratchMemoryInBytes = 0;      ///< Additional memory in bytes kept around for TLAS updates etc.
+            uint64_t blasSplitGroupCount = 0;           ///< Number of mesh groups that exceeded the triangle limit per BLAS and were split.
+            uint64_t blasSplitResultGroupCount = 0;     ///< Number of mesh groups that the split groups were partitioned into.
+            uint64_t blasSplitSubMeshCount = 0;         ///< Number of meshes added by splitting large meshes into sub-meshes.
+            double blasSplitCost = 1.0;                 ///< Estimated ray traversal cost of the split groups relative to not splitting them (1 = no improvement, lower is better).
+            double blasSplitOverlap = 0.0;              ///< Estimated overlap between the split groups relative to their surface area.
 
             // Light stats
             uint64_t activeLightCount = 0;              ///< Number of active lights.
@@ -649,6 +700,58 @@ namespace Falcor
         */
         const MeshDesc& getMesh(uint32_t meshID) const { return mMeshDesc[meshID]; }
 
+        /** Get the total number of meshlets.
+            Meshlets are only generated if the scene was built with SceneBuilder::Flags::GenerateMeshlets.
+        */
+        uint32_t getMeshletCount() const { return (uint32_t)mMeshletDesc.size(); }
+
+        /** Get the ID of the first meshlet of a mesh.
+            The meshlets of a mesh are stored consecutively.
+        */
+        uint32_t getMeshletOffset(uint32_t meshID) const { return mMeshletOffsets.empty() ? 0 : mMeshletOffsets[meshID]; }
+
+        /** Get the number of meshlets of a mesh.
+        */
+        uint32_t getMeshletCount(uint32_t meshID) const { return mMeshletOffsets.empty() ? 0 : mMeshletOffsets[meshID + 1] - mMeshletOffsets[meshID]; }
+
+        /** Get a meshlet desc.
+        */
+        const MeshletDesc& getMeshlet(uint32_t meshletID) const { return mMeshletDesc[meshletID]; }
+
+        /** Get the vertex indices of all meshlets. See MeshletDesc::vertexOffset.
+        */
+        const std::vector<uint32_t>& getMeshletVertices() const { return mMeshletVertices; }
+
+        /** Get the packed triangles of all meshlets. See MeshletDesc::triangleOffset.
+        */
+        const std::vector<uint32_t>& getMeshletTriangles() const { return mMeshletTriangles; }
+
+        /** Get the number of LODs of a mesh, including the full-resolution mesh at LOD 0.
+            LODs are only generated if the scene was built with SceneBuilder::Flags::GenerateLODs.
+        */
+        uint32_t getMeshLODCount(uint32_t meshID) const { return 1 + (mMeshLODOffsets.empty() ? 0 : mMeshLODOffsets[meshID + 1] - mMeshLODOffsets[meshID]); }
+
+        /** Get a mesh LOD desc.
+            \param[in] meshID Mesh ID.
+            \param[in] lod LOD index in the range [1, getMeshLODCount(meshID)).
+        */
+        const MeshLODDesc& getMeshLOD(uint32_t meshID, uint32_t lod) const { FALCOR_ASSERT(lod > 0 && lod < getMeshLODCount(meshID)); return mMeshLODDesc[mMeshLODOffsets[meshID] + lod - 1]; }
+
+        /** Select the LOD of a mesh instance. The change takes effect in the next call to update().
+            The LOD is used for rasterization and for all triangle lookups of the instance in shaders. For ray tracing,
+            the BLAS of a mesh is built from the LOD of its instances, so all instances of a mesh must use the same LOD
+            when the scene is ray traced.
+            \param[in] instanceID Geometry instance ID of a triangle mesh instance.
+            \param[in] lod LOD index, where LOD 0 is the full-resolution mesh. Indices past the last LOD of the mesh select the last LOD.
+        */
+        void setMeshInstanceLOD(uint32_t instanceID, uint32_t lod);
+
+        /** Get the selected LOD of a mesh instance.
+            \param[in] instanceID Geometry instance ID of a triangle mesh instance.
+            \return LOD index, where LOD 0 is the full-resolution mesh.
+        */
+        uint32_t getMeshInstanceLOD(uint32_t instanceID) const;
+
         /** Get the number of curves.
         */
         uint32_t getCurveCount() const { return (uint32_t)mCurveDesc.size(); }
@@ -812,6 +915,20 @@ namespace Falcor
         */
         const AABB& getCurveBounds(uint32_t curveID) const { return mCurveBBs[curveID]; }
 
+        /** Update the bounds of meshes whose vertices were animated on the CPU, see CpuVertexAnimation.
+            The object-space bounds of each mesh are recomputed from its vertex range and the scene bounds are updated.
+            \param[in] vertices Vertex data laid out like the scene's static vertex buffer, e.g. the output of CpuVertexAnimation::skinVertices().
+            \param[in] meshIDs IDs of the animated meshes.
+        */
+        void updateAnimatedMeshBounds(const std::vector<PackedStaticVertexData>& vertices, const std::vector<uint32_t>& meshIDs);
+
+        /** Update the bounds of curves whose vertices were animated on the CPU, see CpuVertexAnimation.
+            The object-space bounds of each curve are recomputed from its vertex range and the scene bounds are updated.
+            \param[in] vertices Vertex data laid out like the scene's curve vertex buffer, e.g. written by CpuVertexAnimation::interpolateCurveVertices().
+            \param[in] curveIDs IDs of the animated curves.
+        */
+        void updateAnimatedCurveBounds(const std::vector<StaticCurveVertexData>& vertices, const std::vector<uint32_t>& curveIDs);
+
         /** Get a list of all lights in the scene.
         */
         const std::vector<Light::SharedPtr>& getLights() const { return mLights; };
@@ -1078,6 +1195,14 @@ namespace Falcor
         */
         void createDrawList();
 
+        /** Get the number of indices of a mesh instance at its selected LOD.
+        */
+        uint32_t getMeshInstanceIndexCount(uint32_t instanceID) const;
+
+        /** Get the LOD used for ray tracing a mesh. This is the LOD selected for all its instances.
+        */
+        uint32_t getMeshRaytracingLOD(uint32_t meshID) const;
+
         /** Initialize geometry descs for each BLAS.
         */
         void initGeomDesc(RenderContext* pContext);
@@ -1171,6 +1296,14 @@ namespace Falcor
         std::vector<MeshDesc> mMeshDesc;                            ///< Copy of mesh data GPU buffer (mpMeshesBuffer).
         std::vector<MeshGroup> mMeshGroups;                         ///< Groups of meshes. Each group maps to a BLAS for ray tracing.
         std::vector<std::string> mMeshNames;                        ///< Mesh names, indxed by mesh ID
+        std::vector<MeshletDesc> mMeshletDesc;                      ///< Meshlets of all meshes, ordered by mesh.
+        std::vector<uint32_t> mMeshletOffsets;                      ///< Index of the first meshlet of each mesh, followed by the total meshlet count. Empty if there are no meshlets.
+        std::vector<uint32_t> mMeshletVertices;                     ///< Vertex indices for all meshlets.
+        std::vector<uint32_t> mMeshletTriangles;                    ///< Packed triangles for all meshlets.
+        std::vector<MeshLODDesc> mMeshLODDesc;                      ///< LODs of all meshes, ordered by mesh and LOD. LOD 0 is not included.
+        std::vector<uint32_t> mMeshLODOffsets;                      ///< Index of the first LOD desc of each mesh, followed by the total LOD desc count. Empty if there are no LODs.
+        std::vector<uint32_t> mMeshInstanceLODs;                    ///< Selected LOD of each geometry instance. Empty until a LOD is selected.
+        bool mMeshInstanceLODsChanged = false;                      ///< Flag indicating that the selected LOD of mesh instances changed since last frame.
         std::vector<Node> mSceneGraph;                              ///< For each index i, the array element indicates the parent node. Indices are in relation to mLocalToWorldMatrices.
 
         // Displacement mapping.
@@ -1215,8 +1348,9 @@ namespace Falcor
         std::vector<Light::SharedPtr> mLights;                      ///< All analytic lights. Note that not all may be active.
         std::vector<Light::SharedPtr> mActiveLights;                ///< All active analytic lights.
         std::vector<GridVolume::SharedPtr> mGridVolumes;            ///< All loaded grid volumes.
-        std::vector<Grid::SharedPtr> mGrids;                        ///< All loaded grids.
+        std::vector<Grid::SharedPtr> mGrids;                        ///< All loaded grids. Entries reserved for streamed grid sequences are nullptr until a frame is resident.
         std::unordered_map<Grid::SharedPtr, uint32_t> mGridIDs;     ///< Lookup table for grid IDs.
+        std::vector<std::array<uint32_t, (size_t)GridVolume::GridSlot::Count>> mStreamedGridIDs; ///< Grid IDs of the streamed grid sequences per grid volume and slot, rebound to the grid of the current frame.
         LightCollection::SharedPtr mpLightCollection;               ///< Class for managing emissive geometry. This is created lazily upon first use.
         EnvMap::SharedPtr mpEnvMap;                                 ///< Environment map or nullptr if not loaded.
         bool mEnvMapChanged = false;                                ///< Flag indicating that the environment map has changed since last frame.
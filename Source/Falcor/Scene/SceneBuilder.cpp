@@ -28,12 +28,20 @@
 #include "stdafx.h"
 #include "SceneBuilder.h"
 #include "SceneCache.h"
+#include "AssetCache.h"
 #include "Importer.h"
 #include "Curves/CurveConfig.h"
 #include "Utils/Math/MathConstants.slangh"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/TextureCache.h"
+#include "Utils/Geometry/MeshOptimizer.h"
+#include "Utils/Geometry/SAHPartitioner.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/TaskGraph.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/TimeReport.h"
 #include <mikktspace.h>
+#include <cstring>
 #include <filesystem>
 
 namespace Falcor
@@ -44,10 +52,166 @@ namespace Falcor
         // The target is max 16M triangles per BLAS (= approx 0.5GB post-compaction). Note that this is not a strict limit.
         const size_t kMaxTrianglesPerBLAS = 1ull << 24;
 
+        // Before partitioning a mesh group that exceeds the BLAS limit, meshes above this size are split into sub-meshes.
+        // This lets the partitioner separate large meshes that would otherwise make the resulting BLASes overlap.
+        const size_t kMaxTrianglesPerSubMesh = kMaxTrianglesPerBLAS / 8;
+
         // Texture coordinates for textured emissive materials are quantized for performance reasons.
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
 
+        // Resources accessed by the post-processing stages in getScene().
+        // These are used to build the dependencies between stages, see TaskGraph.
+        enum : TaskGraph::ResourceMask
+        {
+            kSceneGraph         = 1ull << 0,    ///< Internal scene graph.
+            kMeshes             = 1ull << 1,    ///< Mesh list.
+            kMeshGroups         = 1ull << 2,    ///< Mesh groups.
+            kMeshBuffers        = 1ull << 3,    ///< Global mesh index/vertex buffers.
+            kCurveInstances     = 1ull << 4,    ///< Instance lists of curves.
+            kCurveData          = 1ull << 5,    ///< Curve list (except instances).
+            kCurveBuffers       = 1ull << 6,    ///< Global curve index/vertex buffers.
+            kCachedGeometry     = 1ull << 7,    ///< Cached mesh and curve animation data.
+            kSDFGrids           = 1ull << 8,    ///< SDF grids, descs and instances.
+            kMaterials          = 1ull << 9,    ///< Material system.
+            kMaterialIDMap      = 1ull << 10,   ///< Material ID remapping after removing duplicate materials.
+            kVolumes            = 1ull << 11,   ///< Grid volumes and grids.
+            kAnimatables        = 1ull << 12,   ///< Node IDs of lights, cameras and volumes.
+            kDevice             = 1ull << 13,   ///< GPU device (render context).
+            kSceneGraphOutput   = 1ull << 14,   ///< Scene graph in the scene data.
+            kMeshOutput         = 1ull << 15,   ///< Mesh descs and names in the scene data.
+            kMeshBoundsOutput   = 1ull << 16,   ///< Mesh bounding boxes in the scene data.
+            kCurveOutput        = 1ull << 17,   ///< Curve descs in the scene data.
+            kCurveBoundsOutput  = 1ull << 18,   ///< Curve bounding boxes in the scene data.
+            kMeshletOutput      = 1ull << 19,   ///< Meshlets in the scene data.
+            kMeshLODs           = 1ull << 20,   ///< Mesh LOD indices and LOD descs in the scene data.
+        };
+
+        // Tolerances for detecting rigidly transformed copies of meshes with Flags::InstanceDuplicateMeshes.
+        // The position tolerance is relative to the size of the mesh, the normal tolerance is absolute.
+        const float kDuplicateMeshPositionTolerance = 1e-4f;
+        const float kDuplicateMeshNormalTolerance = 1e-3f;
+
+        // Maximum number of distinct meshes with the same topology and texture coordinates that are tested for duplicates of each other.
+        // This bounds the cost of buckets with many meshes that only differ in their positions.
+        const size_t kMaxDuplicateMeshCandidates = 16;
+
+        // Meshes with more faces are split into chunks of this size when merging duplicate vertices in parallel.
+        const uint32_t kVertexWeldChunkFaceCount = 1u << 16;
+
+        // Asset cache versions. Increment when the processing of the respective asset type changes.
+        const uint32_t kProcessedMeshCacheVersion = 2;
+        const uint32_t kTangentsCacheVersion = 1;
+
+        /** Helper for serializing asset cache entries.
+        */
+        class BlobWriter
+        {
+        public:
+            template<typename T>
+            void write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable<T>::value);
+                const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+                mData.insert(mData.end(), p, p + sizeof(T));
+            }
+
+            template<typename T>
+            void writeVector(const std::vector<T>& vec)
+            {
+                static_assert(std::is_trivially_copyable<T>::value);
+                write((uint64_t)vec.size());
+                const uint8_t* p = reinterpret_cast<const uint8_t*>(vec.data());
+                mData.insert(mData.end(), p, p + vec.size() * sizeof(T));
+            }
+
+            const std::vector<uint8_t>& getData() const { return mData; }
+
+        private:
+            std::vector<uint8_t> mData;
+        };
+
+        /** Helper for deserializing asset cache entries. Throws a RuntimeError if the entry is truncated.
+        */
+        class BlobReader
+        {
+        public:
+            BlobReader(const std::vector<uint8_t>& data) : mData(data) {}
+
+            template<typename T>
+            T read()
+            {
+                static_assert(std::is_trivially_copyable<T>::value);
+                T value;
+                readBytes(&value, sizeof(T));
+                return value;
+            }
+
+            template<typename T>
+            std::vector<T> readVector()
+            {
+                static_assert(std::is_trivially_copyable<T>::value);
+                uint64_t count = read<uint64_t>();
+                if (count > (mData.size() - mOffset) / sizeof(T)) throw RuntimeError("Asset cache entry is truncated.");
+                std::vector<T> vec(count);
+                readBytes(vec.data(), count * sizeof(T));
+                return vec;
+            }
+
+            bool isEnd() const { return mOffset == mData.size(); }
+
+        private:
+            void readBytes(void* dst, size_t size)
+            {
+                if (size > mData.size() - mOffset) throw RuntimeError("Asset cache entry is truncated.");
+                if (size > 0) std::memcpy(dst, mData.data() + mOffset, size);
+                mOffset += size;
+            }
+
+            const std::vector<uint8_t>& mData;
+            size_t mOffset = 0;
+        };
+
+        template<typename T>
+        void addMeshAttribute(AssetCache::KeyBuilder& builder, const SceneBuilder::Mesh& mesh, const SceneBuilder::Mesh::Attribute<T>& attribute)
+        {
+            using Frequency = SceneBuilder::Mesh::AttributeFrequency;
+            Frequency frequency = attribute.pData ? attribute.frequency : Frequency::None;
+            size_t count = 0;
+            switch (frequency)
+            {
+            case Frequency::Constant: count = 1; break;
+            case Frequency::Uniform: count = mesh.faceCount; break;
+            case Frequency::Vertex: count = mesh.vertexCount; break;
+            case Frequency::FaceVarying: count = 3 * (size_t)mesh.faceCount; break;
+            default: break;
+            }
+            builder.add(frequency);
+            builder.add((uint64_t)count);
+            builder.addData(attribute.pData, count * sizeof(T));
+        }
+
+        /** Compute the asset cache key of the tangents generated for a mesh.
+        */
+        AssetCache::Key computeTangentsKey(const SceneBuilder::Mesh& mesh)
+        {
+            AssetCache::KeyBuilder builder("Tangents", kTangentsCacheVersion);
+            builder.add(mesh.faceCount);
+            builder.add(mesh.vertexCount);
+            builder.addData(mesh.pIndices, mesh.indexCount * sizeof(uint32_t));
+            addMeshAttribute(builder, mesh, mesh.positions);
+            addMeshAttribute(builder, mesh, mesh.normals);
+            addMeshAttribute(builder, mesh, mesh.texCrds);
+            return builder.getKey();
+        }
+
+        void logTextureCacheStats(const TextureCache::Stats& start)
+        {
+            auto stats = TextureCache::getDefault()->getStats();
+            logInfo("Texture cache: {} hits ({:.3f} s), {} misses ({:.3f} s).",
+                stats.hits - start.hits, stats.hitTime - start.hitTime, stats.misses - start.misses, stats.missTime - start.missTime);
+        }
+
         int largestAxis(const float3& v)
         {
             if (v.x >= v.y && v.x >= v.z) return 0;
@@ -124,19 +288,105 @@ namespace Falcor
             if (isZero(v.normal) || isZero(v.tangent.xyz())) zeroCount++;
         }
 
-        bool compareVertices(const SceneBuilder::Mesh::Vertex& lhs, const SceneBuilder::Mesh::Vertex& rhs, float threshold = 1e-6f)
+        /** Hash table for merging duplicate vertices.
+            Vertices are merged if they have the same original vertex index and bitwise identical attributes
+            (negative and positive zero are treated as equal). Unique vertices are stored in order of first occurrence.
+        */
+        class VertexWelder
         {
-            using namespace glm;
-            if (lhs.position != rhs.position) return false; // Position need to be exact to avoid cracks
-            if (lhs.tangent.w != rhs.tangent.w) return false;
-            if (lhs.curveRadius != rhs.curveRadius) return false;
-            if (lhs.boneIDs != rhs.boneIDs) return false;
-            if (any(greaterThan(abs(lhs.normal - rhs.normal), float3(threshold)))) return false;
-            if (any(greaterThan(abs(lhs.tangent.xyz - rhs.tangent.xyz), float3(threshold)))) return false;
-            if (any(greaterThan(abs(lhs.texCrd - rhs.texCrd), float2(threshold)))) return false;
-            if (any(greaterThan(abs(lhs.boneWeights - rhs.boneWeights), float4(threshold)))) return false;
-            return true;
-        }
+        public:
+            struct Entry
+            {
+                SceneBuilder::Mesh::Vertex vertex;
+                uint32_t origIndex;
+            };
+            static_assert(sizeof(Entry) == 22 * sizeof(uint32_t), "Entry must not contain padding");
+
+            /** Reset the table.
+                \param[in] maxCount Maximum number of unique vertices that will be inserted.
+            */
+            void reset(size_t maxCount)
+            {
+                size_t slotCount = 16;
+                while (slotCount < 2 * maxCount) slotCount *= 2;
+                mSlots.assign(slotCount, Slot{ 0, kEmpty });
+                mEntries.clear();
+                mEntries.reserve(maxCount);
+                mFirstCorners.clear();
+                mFirstCorners.reserve(maxCount);
+            }
+
+            /** Insert a vertex unless an identical vertex exists.
+                \param[in] entry The vertex and its original vertex index.
+                \param[in] corner Index of the face corner (3 * face + vert) the vertex was created from.
+                \return Index of the unique vertex.
+            */
+            uint32_t insert(Entry entry, uint32_t corner)
+            {
+                canonicalize(entry);
+                const uint32_t hash = computeHash(entry);
+                const size_t mask = mSlots.size() - 1;
+                for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+                {
+                    Slot& s = mSlots[slot];
+                    if (s.index == kEmpty)
+                    {
+                        FALCOR_ASSERT(mEntries.size() < mEntries.capacity());
+                        s = { hash, (uint32_t)mEntries.size() };
+                        mEntries.push_back(entry);
+                        mFirstCorners.push_back(corner);
+                        return s.index;
+                    }
+                    if (s.hash == hash && std::memcmp(&mEntries[s.index], &entry, sizeof(Entry)) == 0) return s.index;
+                }
+            }
+
+            const std::vector<Entry>& getEntries() const { return mEntries; }
+            const std::vector<uint32_t>& getFirstCorners() const { return mFirstCorners; }
+
+        private:
+            static constexpr uint32_t kEmpty = 0xffffffff;
+
+            struct Slot
+            {
+                uint32_t hash;
+                uint32_t index;
+            };
+
+            static void canonicalize(Entry& entry)
+            {
+                auto canonicalizeZero = [](float& f)
+                {
+                    uint32_t bits;
+                    std::memcpy(&bits, &f, sizeof(bits));
+                    if (bits == 0x80000000u) f = 0.f;
+                };
+                auto& v = entry.vertex;
+                for (int i = 0; i < 3; i++) canonicalizeZero(v.position[i]);
+                for (int i = 0; i < 3; i++) canonicalizeZero(v.normal[i]);
+                for (int i = 0; i < 4; i++) canonicalizeZero(v.tangent[i]);
+                for (int i = 0; i < 2; i++) canonicalizeZero(v.texCrd[i]);
+                canonicalizeZero(v.curveRadius);
+                for (int i = 0; i < 4; i++) canonicalizeZero(v.boneWeights[i]);
+            }
+
+            static uint32_t computeHash(const Entry& entry)
+            {
+                // FNV-1a over 32-bit words followed by a 64-bit finalizer.
+                uint32_t words[sizeof(Entry) / sizeof(uint32_t)];
+                std::memcpy(words, &entry, sizeof(Entry));
+                uint64_t h = 0xcbf29ce484222325ull;
+                for (uint32_t w : words) h = (h ^ w) * 0x100000001b3ull;
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdull;
+                h ^= h >> 33;
+                return (uint32_t)h;
+            }
+
+            std::vector<Slot> mSlots;
+            std::vector<Entry> mEntries;
+            std::vector<uint32_t> mFirstCorners;
+        };
 
         std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
         {
@@ -152,9 +402,20 @@ namespace Falcor
             return indexData;
         }
 
+        /** Reorders per-vertex data so that element i moves to remap[i].
+        */
+        template<typename T>
+        void remapVertices(std::vector<T>& data, const std::vector<uint32_t>& remap)
+        {
+            FALCOR_ASSERT(data.size() == remap.size());
+            std::vector<T> remapped(data.size());
+            for (size_t i = 0; i < data.size(); i++) remapped[remap[i]] = data[i];
+            data = std::move(remapped);
+        }
+
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::UseMappedCache | SceneBuilder::Flags::ArchivalCache));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -169,6 +430,19 @@ namespace Falcor
     {
         mpFence = GpuFence::create();
         mSceneData.pMaterials = MaterialSystem::create();
+
+        // Processed assets and textures are cached individually whenever the scene cache is enabled.
+        // When rebuilding the cache, assets are reprocessed and the cache entries are refreshed.
+        if (is_set(flags, Flags::UseCache) || is_set(flags, Flags::RebuildCache))
+        {
+            mpAssetCache = AssetCache::getDefault();
+            mReadAssetCache = !is_set(flags, Flags::RebuildCache);
+            mAssetCacheStats = mpAssetCache->getStats();
+
+            // Texture cache entries are keyed by the file content, so they remain valid when rebuilding.
+            mSceneData.pMaterials->getTextureManager()->setTextureCache(TextureCache::getDefault());
+            mTextureCacheStats = TextureCache::getDefault()->getStats();
+        }
     }
 
     SceneBuilder::SharedPtr SceneBuilder::create(Flags flags)
@@ -202,7 +476,10 @@ namespace Falcor
         {
             try
             {
-                pBuilder->mpScene = Scene::create(SceneCache::readCache(pBuilder->mSceneCacheKey));
+                // The scene cache holds the vertex cache streaming settings the scene was built with.
+                auto sceneData = SceneCache::readCache(pBuilder->mSceneCacheKey);
+                pBuilder->mpScene = Scene::create(std::move(sceneData));
+                logTextureCacheStats(pBuilder->mTextureCacheStats);
                 return pBuilder;
             }
             catch (const std::exception& e)
@@ -211,7 +488,19 @@ namespace Falcor
             }
         }
 
-        pBuilder->import(path, instances);
+        // Make the asset cache available to loaders invoked during import (e.g. volume grids).
+        AssetCache::setActive(pBuilder->mpAssetCache, pBuilder->mReadAssetCache);
+        try
+        {
+            pBuilder->import(path, instances);
+        }
+        catch (...)
+        {
+            AssetCache::setActive(nullptr);
+            throw;
+        }
+        AssetCache::setActive(nullptr);
+
         return pBuilder;
     }
 
@@ -225,8 +514,19 @@ namespace Falcor
     {
         if (mpScene) return mpScene;
 
+        // Add any staged ingest batches.
+        commitIngestBatches();
+        {
+            std::lock_guard<std::mutex> lock(mIngestMutex);
+            if (!mSubmittedIngestBatches.empty())
+            {
+                throw RuntimeError("Ingest batch {} was never submitted, {} later batches can't be committed", mNextCommitSequenceNumber, mSubmittedIngestBatches.size());
+            }
+        }
+
         // Finish loading textures. This blocks until all textures are loaded and assigned.
         mpMaterialTextureLoader.reset();
+        if (mSceneData.pMaterials->getTextureManager()->getTextureCache()) logTextureCacheStats(mTextureCacheStats);
 
         // If no meshes were added, we create a dummy mesh to keep the scene generation working.
         // Scenes with no meshes can be useful for example when using volumes in isolation.
@@ -243,42 +543,61 @@ namespace Falcor
         }
 
         // Post-process the scene data.
+        // The post-processing and scene setup stages are executed as a task graph. Each stage declares
+        // the data it reads and writes, and stages with disjoint data run concurrently on the thread pool.
         TimeReport timeReport;
+        TaskGraph taskGraph;
 
         // Prepare displacement maps. This either removes them (if requested in build flags)
         // or makes sure that normal maps are removed if displacement is in use.
-        prepareDisplacementMaps();
-
-        prepareSceneGraph();
-        prepareMeshes();
-        removeUnusedMeshes();
-        flattenStaticMeshInstances();
-        pretransformStaticMeshes();
-        unifyTriangleWinding();
-        optimizeSceneGraph();
-        calculateMeshBoundingBoxes();
-        createMeshGroups();
-        optimizeGeometry();
-        sortMeshes();
-        createGlobalBuffers();
-        createCurveGlobalBuffers();
-        collectVolumeGrids();
-        removeDuplicateSDFGrids();
-
-        timeReport.measure("Post processing geometry");
-
-        optimizeMaterials();
-        removeDuplicateMaterials();
-        quantizeTexCoords();
-
-        timeReport.measure("Optimizing materials");
+        taskGraph.addTask("prepareDisplacementMaps", 0, kMaterials, [this]() { prepareDisplacementMaps(); });
+
+        taskGraph.addTask("prepareSceneGraph", kMeshes | kAnimatables, kSceneGraph, [this]() { prepareSceneGraph(); });
+        taskGraph.addTask("markDisplacedMeshes", kMaterials, kMeshes, [this]() { markDisplacedMeshes(); });
+        taskGraph.addTask("prepareMeshes", kCachedGeometry, kMeshes, [this]() { prepareMeshes(); });
+        taskGraph.addTask("removeUnusedMeshes", 0, kMeshes | kSceneGraph | kCachedGeometry, [this]() { removeUnusedMeshes(); });
+        taskGraph.addTask("instanceDuplicateMeshes", 0, kMeshes | kSceneGraph | kCachedGeometry, [this]() { instanceDuplicateMeshes(); });
+        taskGraph.addTask("flattenStaticMeshInstances", 0, kMeshes | kSceneGraph, [this]() { flattenStaticMeshInstances(); });
+        taskGraph.addTask("pretransformStaticMeshes", 0, kMeshes | kSceneGraph, [this]() { pretransformStaticMeshes(); });
+        taskGraph.addTask("unifyTriangleWinding", 0, kMeshes, [this]() { unifyTriangleWinding(); });
+        taskGraph.addTask("optimizeVertexCache", 0, kMeshes | kCachedGeometry, [this]() { optimizeVertexCache(); });
+        taskGraph.addTask("optimizeSceneGraph", 0, kSceneGraph | kMeshes | kCurveInstances | kSDFGrids | kAnimatables, [this]() { optimizeSceneGraph(); });
+        taskGraph.addTask("calculateMeshBoundingBoxes", 0, kMeshes, [this]() { calculateMeshBoundingBoxes(); });
+        taskGraph.addTask("createMeshGroups", 0, kMeshes | kMeshGroups, [this]() { createMeshGroups(); });
+        taskGraph.addTask("optimizeGeometry", 0, kMeshes | kMeshGroups | kSceneGraph, [this]() { optimizeGeometry(); });
+        taskGraph.addTask("sortMeshes", 0, kMeshes | kMeshGroups | kCachedGeometry, [this]() { sortMeshes(); });
+        taskGraph.addTask("createMeshlets", kMeshes, kMeshletOutput, [this]() { createMeshlets(); });
+        taskGraph.addTask("createMeshLODs", kMeshes, kMeshLODs, [this]() { createMeshLODs(); });
+        taskGraph.addTask("createGlobalBuffers", kCachedGeometry | kMeshLODs, kMeshes | kMeshBuffers, [this]() { createGlobalBuffers(); });
+        taskGraph.addTask("createCurveGlobalBuffers", 0, kCurveData | kCurveBuffers, [this]() { createCurveGlobalBuffers(); });
+        taskGraph.addTask("collectVolumeGrids", 0, kVolumes, [this]() { collectVolumeGrids(); });
+        taskGraph.addTask("removeDuplicateSDFGrids", 0, kSDFGrids | kSceneGraph, [this]() { removeDuplicateSDFGrids(); });
+
+        taskGraph.addTask("optimizeMaterials", 0, kMaterials | kDevice, [this]() { optimizeMaterials(); });
+        taskGraph.addTask("removeDuplicateMaterials", 0, kMaterials | kMaterialIDMap, [this]() { removeDuplicateMaterials(); });
+        taskGraph.addTask("remapMaterialIDs", kMaterialIDMap, kMeshes | kSDFGrids, [this]() { remapMaterialIDs(); });
+        taskGraph.addTask("quantizeTexCoords", kMaterials | kMeshes, kMeshBuffers, [this]() { quantizeTexCoords(); });
 
         // Prepare scene resources.
-        createSceneGraph();
-        createMeshData();
-        createMeshBoundingBoxes();
-        createCurveData();
-        calculateCurveBoundingBoxes();
+        taskGraph.addTask("createSceneGraph", kSceneGraph, kSceneGraphOutput, [this]() { createSceneGraph(); });
+        taskGraph.addTask("createMeshData", kMeshes, kMeshBuffers | kMeshOutput, [this]() { createMeshData(); });
+        taskGraph.addTask("createMeshBoundingBoxes", kMeshes, kMeshBoundsOutput, [this]() { createMeshBoundingBoxes(); });
+        taskGraph.addTask("createCurveData", kCurveData, kCurveOutput, [this]() { createCurveData(); });
+        taskGraph.addTask("calculateCurveBoundingBoxes", kCurveData | kCurveBuffers, kCurveBoundsOutput, [this]() { calculateCurveBoundingBoxes(); });
+
+        taskGraph.execute();
+        taskGraph.printToLog();
+
+        timeReport.measure("Post processing scene");
+
+        if (mpAssetCache)
+        {
+            auto stats = mpAssetCache->getStats();
+            logInfo("Asset cache: {} hits, {} misses, {} stores, {} evictions ({} entries, {:.1f} MB).",
+                stats.hits - mAssetCacheStats.hits, stats.misses - mAssetCacheStats.misses,
+                stats.stores - mAssetCacheStats.stores, stats.evictions - mAssetCacheStats.evictions,
+                stats.entryCount, stats.totalSize / (1024.0 * 1024.0));
+        }
 
         // Create instance data.
         uint32_t tlasInstanceIndex = 0;
@@ -288,12 +607,19 @@ namespace Falcor
         for (auto& sdfInstanceData : mSceneData.sdfGridInstances) sdfInstanceData.instanceIndex = tlasInstanceIndex++;
 
         mSceneData.useCompressedHitInfo = is_set(mFlags, Flags::UseCompressedHitInfo);
+        mSceneData.streamVertexCaches = is_set(mFlags, Flags::StreamVertexCaches);
+        mSceneData.vertexCacheStreamingSettings = mVertexCacheStreamingSettings;
 
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            auto format = is_set(mFlags, Flags::UseMappedCache) ? SceneCache::Format::Mapped : SceneCache::Format::Stream;
+            auto codec = is_set(mFlags, Flags::ArchivalCache) ? BlockCodec::LZ4HC : BlockCodec::LZ4;
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, format, codec);
             timeReport.measure("Writing cache");
+
+            // Stream the vertex cache keyframes from the keyframe file written next to the scene cache.
+            if (mSceneData.streamVertexCaches) mSceneData.pVertexCacheKeyframeFile = SceneCache::openKeyframeFile(mSceneCacheKey);
         }
 
         // Create the scene object.
@@ -314,6 +640,11 @@ namespace Falcor
     }
 
     uint32_t SceneBuilder::addTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial)
+    {
+        return addProcessedMesh(processTriangleMesh(pTriangleMesh, pMaterial));
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial) const
     {
         checkArgument(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
@@ -343,10 +674,79 @@ namespace Falcor
         mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
         mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
 
-        return addMesh(mesh);
+        return processMesh(mesh);
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh, MeshAttributeIndices* pAttributeIndices) const
+    {
+        // The asset cache only stores the processed mesh, so requests for the attribute indices always bypass it.
+        // Incomplete meshes are passed on to report the error.
+        if (!mpAssetCache || pAttributeIndices || !mesh.pIndices || !mesh.positions.pData || !mesh.pMaterial)
+        {
+            return processMeshUncached(mesh, pAttributeIndices);
+        }
+
+        // Compute the cache key from the mesh data and the settings affecting the result.
+        AssetCache::KeyBuilder builder("ProcessedMesh", kProcessedMeshCacheVersion);
+        builder.add(mesh.topology);
+        builder.add(mesh.faceCount);
+        builder.add(mesh.vertexCount);
+        builder.add(mesh.indexCount);
+        builder.addData(mesh.pIndices, mesh.indexCount * sizeof(uint32_t));
+        addMeshAttribute(builder, mesh, mesh.positions);
+        addMeshAttribute(builder, mesh, mesh.normals);
+        addMeshAttribute(builder, mesh, mesh.tangents);
+        addMeshAttribute(builder, mesh, mesh.texCrds);
+        addMeshAttribute(builder, mesh, mesh.curveRadii);
+        addMeshAttribute(builder, mesh, mesh.boneIDs);
+        addMeshAttribute(builder, mesh, mesh.boneWeights);
+        builder.add(mesh.pMaterial->getTextureTransform().getMatrix());
+        builder.add(mesh.useOriginalTangentSpace);
+        builder.add(mesh.mergeDuplicateVertices);
+        builder.add(mFlags & (Flags::UseOriginalTangentSpace | Flags::NonIndexedVertices | Flags::Force32BitIndices));
+        auto key = builder.getKey();
+
+        std::vector<uint8_t> data;
+        if (mReadAssetCache && mpAssetCache->load(key, data))
+        {
+            try
+            {
+                ProcessedMesh processedMesh;
+                processedMesh.name = mesh.name;
+                processedMesh.topology = mesh.topology;
+                processedMesh.pMaterial = mesh.pMaterial;
+                processedMesh.isFrontFaceCW = mesh.isFrontFaceCW;
+                processedMesh.skeletonNodeId = mesh.skeletonNodeId;
+
+                BlobReader reader(data);
+                processedMesh.indexCount = reader.read<uint64_t>();
+                processedMesh.use16BitIndices = reader.read<bool>();
+                processedMesh.indexData = reader.readVector<uint32_t>();
+                processedMesh.staticData = reader.readVector<StaticVertexData>();
+                processedMesh.skinningData = reader.readVector<SkinningVertexData>();
+                if (!reader.isEnd()) throw RuntimeError("Asset cache entry has unexpected size.");
+                return processedMesh;
+            }
+            catch (const RuntimeError& e)
+            {
+                logWarning("Failed to read cached mesh '{}', reprocessing it: {}", mesh.name, e.what());
+            }
+        }
+
+        auto processedMesh = processMeshUncached(mesh, nullptr);
+
+        BlobWriter writer;
+        writer.write(processedMesh.indexCount);
+        writer.write(processedMesh.use16BitIndices);
+        writer.writeVector(processedMesh.indexData);
+        writer.writeVector(processedMesh.staticData);
+        writer.writeVector(processedMesh.skinningData);
+        mpAssetCache->store(key, writer.getData().data(), writer.getData().size());
+
+        return processedMesh;
     }
 
-    SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices) const
+    SceneBuilder::ProcessedMesh SceneBuilder::processMeshUncached(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices) const
     {
         // This function preprocesses a mesh into the final runtime representation.
         // Note the function needs to be thread safe. The following steps are performed:
@@ -429,16 +829,10 @@ namespace Falcor
         }
 
         // Build new vertex/index buffers by merging identical vertices.
-        // The search is based on the topology defined by the original index buffer.
-        //
-        // A linked-list of vertices is built for each original vertex index.
-        // We iterate over all vertices and first check if a vertex is identical to any of the other vertices
-        // using the same original vertex index. If not, a new vertex is inserted and added to the list.
-        // The 'heads' array point to the first vertex in each list, and each vertex has an associated next-pointer.
-        // This ensures that adding to the linked lists do not require any dynamic memory allocation.
-        //
-        const uint32_t invalidIndex = 0xffffffff;
-        std::vector<std::pair<Mesh::Vertex, uint32_t>> vertices;
+        // Vertices are merged using hash tables, see VertexWelder. Large meshes are split into chunks of faces
+        // that are welded in parallel. The chunks are then merged in order, which gives the same deterministic
+        // result as welding all vertices serially, with vertices ordered by first occurrence.
+        std::vector<Mesh::Vertex> vertices;
         std::vector<uint32_t> indices(mesh.indexCount);
 
         if (pAttributeIndices)
@@ -448,56 +842,77 @@ namespace Falcor
 
         if (mesh.mergeDuplicateVertices)
         {
-            vertices.reserve(mesh.vertexCount);
+            const uint32_t chunkCount = div_round_up(mesh.faceCount, kVertexWeldChunkFaceCount);
+            std::vector<VertexWelder> chunks(chunkCount);
 
-            std::vector<uint32_t> heads(mesh.vertexCount, invalidIndex);
-
-            for (uint32_t face = 0; face < mesh.faceCount; face++)
+            Threading::parallelFor(0, chunkCount, [&](size_t begin, size_t end)
             {
-                for (uint32_t vert = 0; vert < 3; vert++)
+                for (size_t chunk = begin; chunk < end; chunk++)
                 {
-                    const Mesh::Vertex v = mesh.getVertex(face, vert);
-                    const uint32_t origIndex = mesh.pIndices[face * 3 + vert];
+                    const uint32_t firstFace = (uint32_t)chunk * kVertexWeldChunkFaceCount;
+                    const uint32_t lastFace = std::min(firstFace + kVertexWeldChunkFaceCount, mesh.faceCount);
+                    auto& welder = chunks[chunk];
+                    welder.reset(3 * (lastFace - firstFace));
 
-                    // Iterate over vertex list to check if it already exists.
-                    FALCOR_ASSERT(origIndex < heads.size());
-                    uint32_t index = heads[origIndex];
-                    bool found = false;
-
-                    while (index != invalidIndex)
+                    for (uint32_t face = firstFace; face < lastFace; face++)
                     {
-                        if (compareVertices(v, vertices[index].first))
+                        for (uint32_t vert = 0; vert < 3; vert++)
                         {
-                            found = true;
-                            break;
+                            const uint32_t origIndex = mesh.pIndices[face * 3 + vert];
+                            FALCOR_ASSERT(origIndex < mesh.vertexCount);
+                            indices[face * 3 + vert] = welder.insert({ mesh.getVertex(face, vert), origIndex }, face * 3 + vert);
                         }
-                        index = vertices[index].second;
                     }
+                }
+            }, 1);
 
-                    // Insert new vertex if we couldn't find it.
-                    if (!found)
-                    {
-                        FALCOR_ASSERT(vertices.size() < std::numeric_limits<uint32_t>::max());
-                        index = (uint32_t)vertices.size();
-                        vertices.push_back({ v, heads[origIndex] });
+            // Merge the chunks in order. A single chunk already holds the final result.
+            const VertexWelder* pResult = &chunks[0];
+            VertexWelder merged;
+            if (chunkCount > 1)
+            {
+                size_t maxCount = 0;
+                for (const auto& welder : chunks) maxCount += welder.getEntries().size();
+                merged.reset(maxCount);
 
-                        if (pAttributeIndices)
-                        {
-                            pAttributeIndices->push_back(mesh.getAttributeIndices(face, vert));
-                            FALCOR_ASSERT(vertices.size() == pAttributeIndices->size());
-                        }
+                std::vector<std::vector<uint32_t>> remaps(chunkCount);
+                for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+                {
+                    const auto& entries = chunks[chunk].getEntries();
+                    const auto& corners = chunks[chunk].getFirstCorners();
+                    remaps[chunk].resize(entries.size());
+                    for (size_t i = 0; i < entries.size(); i++) remaps[chunk][i] = merged.insert(entries[i], corners[i]);
+                }
 
-                        heads[origIndex] = index;
+                Threading::parallelFor(0, chunkCount, [&](size_t begin, size_t end)
+                {
+                    for (size_t chunk = begin; chunk < end; chunk++)
+                    {
+                        const size_t firstIndex = chunk * kVertexWeldChunkFaceCount * 3;
+                        const size_t lastIndex = std::min(firstIndex + kVertexWeldChunkFaceCount * 3, indices.size());
+                        for (size_t i = firstIndex; i < lastIndex; i++) indices[i] = remaps[chunk][indices[i]];
                     }
+                }, 1);
+
+                pResult = &merged;
+            }
+
+            const auto& entries = pResult->getEntries();
+            vertices.resize(entries.size());
+            for (size_t i = 0; i < entries.size(); i++) vertices[i] = entries[i].vertex;
 
-                    // Store new vertex index.
-                    indices[face * 3 + vert] = index;
+            if (pAttributeIndices)
+            {
+                for (uint32_t corner : pResult->getFirstCorners())
+                {
+                    pAttributeIndices->push_back(mesh.getAttributeIndices(corner / 3, corner % 3));
                 }
+                FALCOR_ASSERT(vertices.size() == pAttributeIndices->size());
             }
         }
         else
         {
-            vertices = { mesh.vertexCount, std::make_pair(Mesh::Vertex{}, invalidIndex) };
+            vertices.resize(mesh.vertexCount);
 
             for (uint32_t face = 0; face < mesh.faceCount; face++)
             {
@@ -507,7 +922,7 @@ namespace Falcor
                     const uint32_t index = mesh.getAttributeIndex(mesh.positions, face, vert);
 
                     FALCOR_ASSERT(index < vertices.size());
-                    vertices[index].first = v;
+                    vertices[index] = v;
 
                     if (pAttributeIndices)
                     {
@@ -536,7 +951,7 @@ namespace Falcor
         size_t zeroCount = 0;
         for (const auto& v : vertices)
         {
-            validateVertex(v.first, invalidCount, zeroCount);
+            validateVertex(v, invalidCount, zeroCount);
         }
         if (invalidCount > 0) logWarning("The mesh '{}' has inf/nan vertex attributes at {} vertices. Please fix the asset.", mesh.name, invalidCount);
         if (zeroCount > 0) logWarning("The mesh '{}' has zero-length normals/tangents at {} vertices. Please fix the asset.", mesh.name, zeroCount);
@@ -563,7 +978,7 @@ namespace Falcor
         {
             uint32_t index = isIndexed ? i : indices[i];
             FALCOR_ASSERT(index < vertices.size());
-            const Mesh::Vertex& v = vertices[index].first;
+            const Mesh::Vertex& v = vertices[index];
 
             StaticVertexData s;
             s.position = v.position;
@@ -590,7 +1005,28 @@ namespace Falcor
 
     void SceneBuilder::generateTangents(Mesh& mesh, std::vector<float4>& tangents) const
     {
-        tangents = MikkTSpaceWrapper::generateTangents(mesh);
+        // Look up the tangents in the asset cache. The mesh is only cached if it has all required attributes.
+        bool useCache = mpAssetCache && mesh.normals.pData && mesh.positions.pData && mesh.texCrds.pData && mesh.pIndices;
+        AssetCache::Key key;
+        bool cached = false;
+        if (useCache)
+        {
+            key = computeTangentsKey(mesh);
+            std::vector<uint8_t> data;
+            if (mReadAssetCache && mpAssetCache->load(key, data) && data.size() == mesh.indexCount * sizeof(float4))
+            {
+                tangents.resize(mesh.indexCount);
+                std::memcpy(tangents.data(), data.data(), data.size());
+                cached = true;
+            }
+        }
+
+        if (!cached)
+        {
+            tangents = MikkTSpaceWrapper::generateTangents(mesh);
+            if (useCache && !tangents.empty()) mpAssetCache->store(key, tangents.data(), tangents.size() * sizeof(float4));
+        }
+
         if (!tangents.empty())
         {
             FALCOR_ASSERT(tangents.size() == mesh.indexCount);
@@ -605,6 +1041,11 @@ namespace Falcor
     }
 
     uint32_t SceneBuilder::addProcessedMesh(const ProcessedMesh& mesh)
+    {
+        return addProcessedMesh(ProcessedMesh(mesh));
+    }
+
+    uint32_t SceneBuilder::addProcessedMesh(ProcessedMesh&& mesh)
     {
         const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
 
@@ -648,6 +1089,24 @@ namespace Falcor
         return (uint32_t)(mMeshes.size() - 1);
     }
 
+    void SceneBuilder::setLODSettings(const LODSettings& settings)
+    {
+        for (size_t i = 0; i < settings.targetRatios.size(); i++)
+        {
+            const float ratio = settings.targetRatios[i];
+            checkArgument(ratio > 0.f && ratio < 1.f, "LOD target ratio ({}) must be in the range (0, 1).", ratio);
+            checkArgument(i == 0 || ratio < settings.targetRatios[i - 1], "LOD target ratios must be decreasing.");
+        }
+        checkArgument(settings.maxError >= 0.f, "LOD max error ({}) must not be negative.", settings.maxError);
+        mLODSettings = settings;
+    }
+
+    void SceneBuilder::setVertexCacheStreamingSettings(const VertexCacheStreamingSettings& settings)
+    {
+        checkArgument(settings.memoryBudget > 0, "Vertex cache streaming memory budget must be positive.");
+        mVertexCacheStreamingSettings = settings;
+    }
+
     void SceneBuilder::setCachedMeshes(std::vector<CachedMesh>&& cachedMeshes)
     {
         mSceneData.cachedMeshes = std::move(cachedMeshes);
@@ -943,6 +1402,126 @@ namespace Falcor
         mMeshes[meshID].instances.push_back(nodeID);
     }
 
+    // Concurrent ingestion
+
+    uint32_t SceneBuilder::IngestBatch::addNode(const Node& node)
+    {
+        checkArgument(node.parent == kInvalidNode || node.parent < mNodes.size(), "Node '{}' parent ({}) is out of range", node.name, node.parent);
+        if (mNodes.size() >= std::numeric_limits<uint32_t>::max()) throw RuntimeError("Ingest batch has too many nodes");
+
+        mNodes.push_back(node);
+        return (uint32_t)(mNodes.size() - 1);
+    }
+
+    uint32_t SceneBuilder::IngestBatch::addMesh(const Mesh& mesh)
+    {
+        if (!mpBuilder) throw RuntimeError("Ingest batch {} was already submitted", mSequenceNumber);
+        return addProcessedMesh(mpBuilder->processMesh(mesh));
+    }
+
+    uint32_t SceneBuilder::IngestBatch::addTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial)
+    {
+        if (!mpBuilder) throw RuntimeError("Ingest batch {} was already submitted", mSequenceNumber);
+        return addProcessedMesh(mpBuilder->processTriangleMesh(pTriangleMesh, pMaterial));
+    }
+
+    uint32_t SceneBuilder::IngestBatch::addProcessedMesh(ProcessedMesh&& mesh)
+    {
+        checkArgument(mesh.pMaterial != nullptr, "Mesh '{}' has no material", mesh.name);
+        if (mMeshes.size() >= std::numeric_limits<uint32_t>::max()) throw RuntimeError("Ingest batch has too many meshes");
+
+        mMeshes.push_back(std::move(mesh));
+        return (uint32_t)(mMeshes.size() - 1);
+    }
+
+    void SceneBuilder::IngestBatch::addMaterial(const Material::SharedPtr& pMaterial)
+    {
+        checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
+        mMaterials.push_back(pMaterial);
+    }
+
+    void SceneBuilder::IngestBatch::addMeshInstance(uint32_t nodeID, uint32_t meshID)
+    {
+        checkArgument(nodeID < mNodes.size(), "'nodeID' ({}) is out of range", nodeID);
+        checkArgument(meshID < mMeshes.size(), "'meshID' ({}) is out of range", meshID);
+
+        mMeshInstances.emplace_back(nodeID, meshID);
+    }
+
+    SceneBuilder::IngestBatch SceneBuilder::beginIngestBatch(uint32_t parentNodeID)
+    {
+        uint32_t sequenceNumber = mNextIngestSequenceNumber.fetch_add(1, std::memory_order_relaxed);
+        if (sequenceNumber == std::numeric_limits<uint32_t>::max()) throw RuntimeError("Too many ingest batches");
+        return IngestBatch(this, sequenceNumber, parentNodeID);
+    }
+
+    void SceneBuilder::submitIngestBatch(IngestBatch&& batch)
+    {
+        // Submitting clears the builder of the batch, so a moved-from batch can't be submitted again.
+        if (!batch.mpBuilder) throw RuntimeError("Ingest batch {} was already submitted", batch.mSequenceNumber);
+        checkArgument(batch.mpBuilder == this, "Ingest batch was not created by this scene builder");
+
+        std::lock_guard<std::mutex> lock(mIngestMutex);
+        uint32_t sequenceNumber = batch.mSequenceNumber;
+        if (sequenceNumber < mNextCommitSequenceNumber || mSubmittedIngestBatches.count(sequenceNumber) > 0)
+        {
+            throw RuntimeError("Ingest batch {} was submitted more than once", sequenceNumber);
+        }
+        mSubmittedIngestBatches.emplace(sequenceNumber, std::move(batch));
+        batch.mpBuilder = nullptr;
+    }
+
+    std::vector<SceneBuilder::IngestBatchRanges> SceneBuilder::commitIngestBatches()
+    {
+        // Take the batches that continue the committed sequence without a gap. Batches after a missing
+        // sequence number stay staged, which makes the resulting IDs independent of the order in which
+        // the producer threads finished.
+        std::vector<IngestBatch> batches;
+        {
+            std::lock_guard<std::mutex> lock(mIngestMutex);
+            auto it = mSubmittedIngestBatches.begin();
+            while (it != mSubmittedIngestBatches.end() && it->first == mNextCommitSequenceNumber)
+            {
+                batches.push_back(std::move(it->second));
+                it = mSubmittedIngestBatches.erase(it);
+                mNextCommitSequenceNumber++;
+            }
+        }
+
+        std::vector<IngestBatchRanges> result;
+        result.reserve(batches.size());
+
+        for (auto& batch : batches)
+        {
+            IngestBatchRanges ranges;
+            ranges.sequenceNumber = batch.mSequenceNumber;
+            ranges.firstNodeID = getNodeCount();
+            ranges.nodeCount = batch.getNodeCount();
+            ranges.firstMeshID = (uint32_t)mMeshes.size();
+            ranges.meshCount = batch.getMeshCount();
+
+            for (const auto& pMaterial : batch.mMaterials) addMaterial(pMaterial);
+
+            for (const auto& node : batch.mNodes)
+            {
+                Node sceneNode = node;
+                sceneNode.parent = node.parent == kInvalidNode ? batch.mParentNodeID : ranges.firstNodeID + node.parent;
+                addNode(sceneNode);
+            }
+
+            for (auto& mesh : batch.mMeshes) addProcessedMesh(std::move(mesh));
+
+            for (const auto& [nodeID, meshID] : batch.mMeshInstances)
+            {
+                addMeshInstance(ranges.firstNodeID + nodeID, ranges.firstMeshID + meshID);
+            }
+
+            result.push_back(ranges);
+        }
+
+        return result;
+    }
+
     void SceneBuilder::addCurveInstance(uint32_t nodeID, uint32_t curveID)
     {
         checkArgument(nodeID < mSceneGraph.size(), "'nodeID' ({}) is out of range", nodeID);
@@ -1207,6 +1786,19 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::markDisplacedMeshes()
+    {
+        // Mark meshes using displaced or emissive materials.
+        // This is done early so that later mesh passes don't need access to the materials,
+        // which allows them to run concurrently with the material passes.
+        for (auto& mesh : mMeshes)
+        {
+            const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId);
+            mesh.isDisplaced = pMaterial->isDisplaced();
+            mesh.isEmissive = pMaterial->isEmissive();
+        }
+    }
+
     void SceneBuilder::prepareMeshes()
     {
         // Initialize any mesh properties that depend on the scene modifications to be finished.
@@ -1253,59 +1845,243 @@ namespace Falcor
         if (unusedCount > 0)
         {
             logWarning("Scene has {} unused meshes that will be removed.", unusedCount);
+            removeMeshesWithoutInstances();
+        }
+    }
 
-            const size_t meshCount = mMeshes.size();
-            MeshList meshes;
-            meshes.reserve(meshCount);
+    void SceneBuilder::removeMeshesWithoutInstances()
+    {
+        // Removes all meshes that are not referenced by any scene graph nodes,
+        // and updates the mesh IDs in the scene graph and the cached geometry.
 
-            for (uint32_t meshID = 0; meshID < (uint32_t)meshCount; meshID++)
-            {
-                auto& mesh = mMeshes[meshID];
-                if (mesh.instances.empty()) continue; // Skip unused meshes
+        const size_t meshCount = mMeshes.size();
+        MeshList meshes;
+        meshes.reserve(meshCount);
 
-                // Get new mesh ID.
-                const uint32_t newMeshID = (uint32_t)meshes.size();
+        for (uint32_t meshID = 0; meshID < (uint32_t)meshCount; meshID++)
+        {
+            auto& mesh = mMeshes[meshID];
+            if (mesh.instances.empty()) continue; // Skip unused meshes
 
-                // Update the mesh IDs in the scene graph nodes.
-                for (const auto nodeID : mesh.instances)
-                {
-                    FALCOR_ASSERT(nodeID < mSceneGraph.size());
-                    auto& node = mSceneGraph[nodeID];
-                    std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
-                }
+            // Get new mesh ID.
+            const uint32_t newMeshID = (uint32_t)meshes.size();
 
-                // Update the mesh IDs of cached meshes.
-                for (auto &cachedMesh : mSceneData.cachedMeshes)
-                {
-                    if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
-                }
-                for (auto& cache : mSceneData.cachedCurves)
+            // Update the mesh IDs in the scene graph nodes.
+            for (const auto nodeID : mesh.instances)
+            {
+                FALCOR_ASSERT(nodeID < mSceneGraph.size());
+                auto& node = mSceneGraph[nodeID];
+                std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+            }
+
+            // Update the mesh IDs of cached meshes.
+            for (auto &cachedMesh : mSceneData.cachedMeshes)
+            {
+                if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
+            }
+            for (auto& cache : mSceneData.cachedCurves)
+            {
+                if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
                 {
-                    if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
-                    {
-                        if (cache.geometryID == meshID) cache.geometryID = newMeshID;
-                    }
+                    if (cache.geometryID == meshID) cache.geometryID = newMeshID;
                 }
-
-                meshes.push_back(std::move(mesh));
             }
 
-            mMeshes = std::move(meshes);
+            meshes.push_back(std::move(mesh));
+        }
+
+        mMeshes = std::move(meshes);
 
-            // Validate scene graph.
-            FALCOR_ASSERT(mMeshes.size() == meshCount - unusedCount);
-            for (const auto& node : mSceneGraph)
-            {
-                for (uint32_t meshID : node.meshes) FALCOR_ASSERT(meshID < mMeshes.size());
-            }
+        // Validate scene graph.
+        FALCOR_ASSERT(mMeshes.size() <= meshCount);
+        for (const auto& node : mSceneGraph)
+        {
+            for (uint32_t meshID : node.meshes) FALCOR_ASSERT(meshID < mMeshes.size());
         }
     }
 
-    void SceneBuilder::flattenStaticMeshInstances()
+    void SceneBuilder::instanceDuplicateMeshes()
     {
-        // This function optionally flattens all instanced non-skinned mesh instances to
-        // separate non-instanced meshes by duplicating mesh data and composing transformations.
-        // The pass is disabled by default. Can lead to a large increase in memory use.
+        // This function optionally replaces meshes that are exact or rigidly transformed copies of another mesh
+        // by instances of that mesh. This is the converse of flattenStaticMeshInstances(). The instances are
+        // placed in new scene graph nodes holding the transform between the copies, so that the instanced
+        // meshes later go through the regular instanced BLAS path in createMeshGroups().
+        //
+        // The meshes are bucketed by a hash of their transform-invariant data (topology, material, indices and
+        // texture coordinates). Within a bucket, the rigid transform between two meshes is solved for from their
+        // positions and verified on all vertex positions, normals and tangents.
+
+        if (!is_set(mFlags, Flags::InstanceDuplicateMeshes)) return;
+        if (is_set(mFlags, Flags::FlattenStaticMeshInstances))
+        {
+            logWarning("SceneBuilder::instanceDuplicateMeshes() - Ignoring Flags::InstanceDuplicateMeshes as Flags::FlattenStaticMeshInstances is set.");
+            return;
+        }
+
+        // Hash the transform-invariant data of the meshes in parallel. Dynamic meshes are skipped.
+        std::vector<Hash128::MD> hashes(mMeshes.size());
+        std::vector<uint8_t> isCandidate(mMeshes.size(), 0);
+
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
+        {
+            std::vector<float4> vertexData;
+            for (size_t meshID = begin; meshID < end; meshID++)
+            {
+                const auto& mesh = mMeshes[meshID];
+                if (mesh.isDynamic() || mesh.instances.empty() || mesh.staticData.empty()) continue;
+                FALCOR_ASSERT(mesh.staticData.size() == mesh.vertexCount);
+
+                Hash128 hash;
+                const uint32_t header[] = { (uint32_t)mesh.topology, mesh.materialId, mesh.vertexCount, mesh.indexCount, mesh.use16BitIndices, mesh.isFrontFaceCW };
+                hash.update(header, sizeof(header));
+                hash.update(mesh.indexData.data(), mesh.indexData.size() * sizeof(uint32_t));
+
+                vertexData.resize(mesh.staticData.size());
+                for (size_t i = 0; i < vertexData.size(); i++)
+                {
+                    const auto& v = mesh.staticData[i];
+                    vertexData[i] = float4(v.texCrd, v.tangent.w, v.curveRadius);
+                }
+                hash.update(vertexData.data(), vertexData.size() * sizeof(float4));
+
+                hashes[meshID] = hash.final();
+                isCandidate[meshID] = 1;
+            }
+        }, 1);
+
+        // Bucket the meshes by hash, in order of mesh ID.
+        std::map<Hash128::MD, std::vector<uint32_t>> buckets;
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        {
+            if (isCandidate[meshID]) buckets[hashes[meshID]].push_back(meshID);
+        }
+
+        std::vector<const std::vector<uint32_t>*> duplicateBuckets;
+        for (const auto& [hash, meshIDs] : buckets)
+        {
+            if (meshIDs.size() > 1) duplicateBuckets.push_back(&meshIDs);
+        }
+        if (duplicateBuckets.empty()) return;
+
+        // Checks if a mesh is a rigidly transformed copy of another mesh in the same bucket and returns the transform.
+        auto isCopy = [&](const MeshSpec& src, const MeshSpec& dst, glm::mat4& transform)
+        {
+            // Guard against hash collisions.
+            if (src.topology != dst.topology || src.materialId != dst.materialId || src.isFrontFaceCW != dst.isFrontFaceCW) return false;
+            if (src.staticData.size() != dst.staticData.size() || src.indexCount != dst.indexCount || src.indexData != dst.indexData) return false;
+            for (size_t i = 0; i < src.staticData.size(); i++)
+            {
+                const auto& a = src.staticData[i];
+                const auto& b = dst.staticData[i];
+                if (a.texCrd != b.texCrd || a.tangent.w != b.tangent.w || a.curveRadius != b.curveRadius) return false;
+            }
+
+            // Exact copies get an identity transform.
+            bool isExact = true;
+            for (size_t i = 0; i < src.staticData.size() && isExact; i++)
+            {
+                const auto& a = src.staticData[i];
+                const auto& b = dst.staticData[i];
+                isExact = a.position == b.position && a.normal == b.normal && a.tangent == b.tangent;
+            }
+            if (isExact)
+            {
+                transform = glm::identity<glm::mat4>();
+                return true;
+            }
+
+            if (!MeshOptimizer::findRigidTransform(&src.staticData[0].position, &dst.staticData[0].position, sizeof(StaticVertexData),
+                src.staticData.size(), kDuplicateMeshPositionTolerance, transform)) return false;
+
+            const glm::mat3 rotation = (glm::mat3)transform;
+            for (size_t i = 0; i < src.staticData.size(); i++)
+            {
+                const auto& a = src.staticData[i];
+                const auto& b = dst.staticData[i];
+                if (glm::length(rotation * a.normal - b.normal) > kDuplicateMeshNormalTolerance) return false;
+                if (a.tangent.w != 0.f && glm::length(rotation * float3(a.tangent) - float3(b.tangent)) > kDuplicateMeshNormalTolerance) return false;
+            }
+            return true;
+        };
+
+        // Match the meshes in each bucket against the first distinct meshes of the bucket, in parallel over the buckets.
+        struct Match
+        {
+            uint32_t meshID;
+            glm::mat4 transform;
+        };
+        std::vector<std::optional<Match>> matches(mMeshes.size());
+
+        Threading::parallelFor(0, duplicateBuckets.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                std::vector<uint32_t> distinctMeshIDs;
+                for (uint32_t meshID : *duplicateBuckets[i])
+                {
+                    bool isDuplicate = false;
+                    for (uint32_t distinctMeshID : distinctMeshIDs)
+                    {
+                        glm::mat4 transform;
+                        if (isCopy(mMeshes[distinctMeshID], mMeshes[meshID], transform))
+                        {
+                            matches[meshID] = Match{ distinctMeshID, transform };
+                            isDuplicate = true;
+                            break;
+                        }
+                    }
+                    if (!isDuplicate && distinctMeshIDs.size() < kMaxDuplicateMeshCandidates) distinctMeshIDs.push_back(meshID);
+                }
+            }
+        }, 1);
+
+        // Replace the copies by instances of the matching mesh.
+        // Each instance of a copy is replaced by a child node with the transform from the matching mesh to the copy.
+        size_t duplicateCount = 0;
+        size_t savedMemory = 0;
+        std::set<uint32_t> instancedMeshIDs;
+
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        {
+            if (!matches[meshID]) continue;
+            const auto& match = *matches[meshID];
+
+            auto& mesh = mMeshes[meshID];
+            for (uint32_t nodeID : mesh.instances)
+            {
+                auto& node = mSceneGraph[nodeID];
+                auto it = std::find(node.meshes.begin(), node.meshes.end(), meshID);
+                FALCOR_ASSERT(it != node.meshes.end());
+                node.meshes.erase(it);
+
+                uint32_t instanceNodeID = nodeID;
+                if (match.transform != glm::identity<glm::mat4>())
+                {
+                    Node instanceNode{ mesh.name, match.transform };
+                    instanceNode.parent = nodeID;
+                    instanceNodeID = addNode(instanceNode);
+                }
+                addMeshInstance(instanceNodeID, match.meshID);
+            }
+            mesh.instances.clear();
+
+            duplicateCount++;
+            savedMemory += mesh.staticData.size() * sizeof(PackedStaticVertexData) + mesh.indexData.size() * sizeof(uint32_t);
+            instancedMeshIDs.insert(match.meshID);
+        }
+
+        if (duplicateCount == 0) return;
+
+        removeMeshesWithoutInstances();
+
+        logInfo("Replaced {} duplicate meshes by instances of {} meshes, saving {} of vertex and index data.", duplicateCount, instancedMeshIDs.size(), formatByteSize(savedMemory));
+    }
+
+    void SceneBuilder::flattenStaticMeshInstances()
+    {
+        // This function optionally flattens all instanced non-skinned mesh instances to
+        // separate non-instanced meshes by duplicating mesh data and composing transformations.
+        // The pass is disabled by default. Can lead to a large increase in memory use.
 
         if (!is_set(mFlags, Flags::FlattenStaticMeshInstances))
         {
@@ -1498,7 +2274,9 @@ namespace Falcor
         uint32_t identityNodeID = addNode(Node{ "Identity", glm::identity<glm::mat4>(), glm::identity<glm::mat4>() });
         auto& identityNode = mSceneGraph[identityNodeID];
 
-        size_t transformedMeshCount = 0;
+        // List of meshes and their transforms. The vertices are transformed in parallel after updating the scene graph.
+        std::vector<std::pair<uint32_t, glm::mat4>> transformedMeshes;
+
         for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
         {
             auto& mesh = mMeshes[meshID];
@@ -1532,6 +2310,28 @@ namespace Falcor
             {
                 FALCOR_ASSERT(!mesh.staticData.empty());
                 FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
+                transformedMeshes.push_back({ meshID, transform });
+            }
+
+            // Unlink mesh from its previous transform node.
+            // TODO: This will leave some nodes unused. We could run a separate pass to compact the node list.
+            FALCOR_ASSERT(mesh.instances.size() == 1);
+            auto& prevNode = mSceneGraph[mesh.instances[0]];
+            auto it = std::find(prevNode.meshes.begin(), prevNode.meshes.end(), meshID);
+            FALCOR_ASSERT(it != prevNode.meshes.end());
+            prevNode.meshes.erase(it);
+
+            // Link mesh to the identity transform node.
+            identityNode.meshes.push_back(meshID);
+            mesh.instances[0] = identityNodeID;
+        }
+
+        Threading::parallelFor(0, transformedMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto& [meshID, transform] = transformedMeshes[i];
+                auto& mesh = mMeshes[meshID];
 
                 glm::mat3 invTranspose3x3 = (glm::mat3)glm::transpose(glm::inverse(transform));
                 glm::mat3 transform3x3 = (glm::mat3)transform;
@@ -1542,29 +2342,15 @@ namespace Falcor
                     v.position = p.xyz;
                     v.normal = glm::normalize(invTranspose3x3 * v.normal);
                     v.tangent.xyz = glm::normalize(transform3x3 * v.tangent.xyz);
-                    // TODO: We should flip the sign of v.tangent.w if flippedWinding is true.
+                    // TODO: We should flip the sign of v.tangent.w if the transform flips the winding.
                     // Leaving that out for now for consistency with the shader code that needs the same fix.
 
                     v.curveRadius = glm::length(transform3x3 * float3(v.curveRadius, 0.f, 0.f));
                 }
-
-                transformedMeshCount++;
             }
+        }, 1);
 
-            // Unlink mesh from its previous transform node.
-            // TODO: This will leave some nodes unused. We could run a separate pass to compact the node list.
-            FALCOR_ASSERT(mesh.instances.size() == 1);
-            auto& prevNode = mSceneGraph[mesh.instances[0]];
-            auto it = std::find(prevNode.meshes.begin(), prevNode.meshes.end(), meshID);
-            FALCOR_ASSERT(it != prevNode.meshes.end());
-            prevNode.meshes.erase(it);
-
-            // Link mesh to the identity transform node.
-            identityNode.meshes.push_back(meshID);
-            mesh.instances[0] = identityNodeID;
-        }
-
-        if (transformedMeshCount > 0) logInfo("Pre-transformed {} static meshes to world space.", transformedMeshCount);
+        if (!transformedMeshes.empty()) logInfo("Pre-transformed {} static meshes to world space.", transformedMeshes.size());
     }
 
     void SceneBuilder::flipTriangleWinding(MeshSpec& mesh)
@@ -1632,38 +2418,131 @@ namespace Falcor
         // Note that this pass needs to run *after* pre-transformation of static meshes to world space,
         // as those transforms may flip the winding.
 
-        size_t flippedMeshCount = 0;
-        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        std::atomic<size_t> flippedMeshCount = 0;
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
         {
-            auto& mesh = mMeshes[meshID];
+            for (size_t meshID = begin; meshID < end; meshID++)
+            {
+                auto& mesh = mMeshes[meshID];
 
-            // Skip meshes that are already front face counter-clockwise.
-            if (mesh.isFrontFaceCW == false) continue;
+                // Skip meshes that are already front face counter-clockwise.
+                if (mesh.isFrontFaceCW == false) continue;
 
-            flipTriangleWinding(mesh);
-            FALCOR_ASSERT(!mesh.isFrontFaceCW);
+                flipTriangleWinding(mesh);
+                FALCOR_ASSERT(!mesh.isFrontFaceCW);
 
-            flippedMeshCount++;
-        }
+                flippedMeshCount++;
+            }
+        });
 
-        if (flippedMeshCount > 0) logInfo("Flipped triangle winding for {} out of {} meshes.", flippedMeshCount, mMeshes.size());
+        if (flippedMeshCount > 0) logInfo("Flipped triangle winding for {} out of {} meshes.", flippedMeshCount.load(), mMeshes.size());
     }
 
-    void SceneBuilder::calculateMeshBoundingBoxes()
+    void SceneBuilder::optimizeVertexCache()
     {
-        for (auto& mesh : mMeshes)
+        // This function reorders the triangles of each indexed triangle mesh for post-transform vertex cache
+        // efficiency, followed by reordering the vertices in order of first use for vertex fetch locality.
+        // The vertex cache efficiency before and after is reported in the log and in the scene stats.
+
+        if (!is_set(mFlags, Flags::OptimizeVertexCache)) return;
+
+        // Vertex animation caches store their data in mesh vertex order and need to be remapped with the mesh.
+        std::vector<std::vector<CachedMesh*>> cachedMeshes(mMeshes.size());
+        for (auto& cachedMesh : mSceneData.cachedMeshes) cachedMeshes[cachedMesh.meshID].push_back(&cachedMesh);
+
+        // Poly-tube vertices are written in curve order when animating curves, so only the triangles of these meshes are reordered.
+        std::vector<bool> keepVertexOrder(mMeshes.size(), false);
+        for (const auto& cachedCurve : mSceneData.cachedCurves)
         {
-            FALCOR_ASSERT(!mesh.staticData.empty());
-            FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
+            if (cachedCurve.tessellationMode != CurveTessellationMode::LinearSweptSphere) keepVertexOrder[cachedCurve.geometryID] = true;
+        }
+
+        std::vector<MeshOptimizer::VertexCacheStats> statsBefore(mMeshes.size());
+        std::vector<MeshOptimizer::VertexCacheStats> statsAfter(mMeshes.size());
+        std::atomic<size_t> optimizedMeshCount = 0;
 
-            AABB meshBB;
-            for (auto& v : mesh.staticData)
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
+        {
+            std::vector<uint32_t> indices;
+            for (size_t meshID = begin; meshID < end; meshID++)
             {
-                meshBB.include(v.position);
+                auto& mesh = mMeshes[meshID];
+
+                // Skip non-indexed meshes, there is nothing to reorder.
+                if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0) continue;
+
+                indices.resize(mesh.indexCount);
+                for (uint32_t i = 0; i < mesh.indexCount; i++) indices[i] = mesh.getIndex(i);
+
+                statsBefore[meshID] = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), mesh.vertexCount);
+                MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), mesh.vertexCount);
+
+                if (!keepVertexOrder[meshID])
+                {
+                    const auto remap = MeshOptimizer::computeVertexFetchRemap(indices.data(), indices.size(), mesh.vertexCount);
+                    for (auto& index : indices) index = remap[index];
+
+                    remapVertices(mesh.staticData, remap);
+                    if (mesh.hasSkinningData)
+                    {
+                        remapVertices(mesh.skinningData, remap);
+                        for (auto& s : mesh.skinningData) s.staticIndex = remap[s.staticIndex];
+                    }
+                    for (auto pCachedMesh : cachedMeshes[meshID])
+                    {
+                        for (auto& vertexData : pCachedMesh->vertexData) remapVertices(vertexData, remap);
+                    }
+                }
+
+                statsAfter[meshID] = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), mesh.vertexCount);
+
+                if (mesh.use16BitIndices)
+                {
+                    uint16_t* pIndices = reinterpret_cast<uint16_t*>(mesh.indexData.data());
+                    for (uint32_t i = 0; i < mesh.indexCount; i++) pIndices[i] = (uint16_t)indices[i];
+                }
+                else
+                {
+                    std::copy(indices.begin(), indices.end(), mesh.indexData.begin());
+                }
+
+                optimizedMeshCount++;
             }
+        }, 1);
 
-            mesh.boundingBox = meshBB;
+        MeshOptimizer::VertexCacheStats totalBefore;
+        MeshOptimizer::VertexCacheStats totalAfter;
+        for (size_t meshID = 0; meshID < mMeshes.size(); meshID++)
+        {
+            totalBefore += statsBefore[meshID];
+            totalAfter += statsAfter[meshID];
         }
+        mSceneData.vertexCacheStatsBefore = totalBefore;
+        mSceneData.vertexCacheStatsAfter = totalAfter;
+
+        logInfo("Optimized vertex cache for {} out of {} meshes: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}.",
+            optimizedMeshCount.load(), mMeshes.size(), totalBefore.getACMR(), totalAfter.getACMR(), totalBefore.getATVR(), totalAfter.getATVR());
+    }
+
+    void SceneBuilder::calculateMeshBoundingBoxes()
+    {
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t meshID = begin; meshID < end; meshID++)
+            {
+                auto& mesh = mMeshes[meshID];
+                FALCOR_ASSERT(!mesh.staticData.empty());
+                FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
+
+                AABB meshBB;
+                for (auto& v : mesh.staticData)
+                {
+                    meshBB.include(v.position);
+                }
+
+                mesh.boundingBox = meshBB;
+            }
+        });
     }
 
     void SceneBuilder::createMeshGroups()
@@ -1704,10 +2583,6 @@ namespace Falcor
             FALCOR_ASSERT(mesh.instances.size() == 1);
             uint32_t nodeID = mesh.instances[0];
 
-            // Mark displaced meshes.
-            const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId);
-            if (pMaterial->isDisplaced()) mesh.isDisplaced = true;
-
             if (mesh.isStatic && mesh.isDisplaced) staticDisplacedMeshes.push_back(meshID);
             else if (mesh.isStatic) staticMeshes.push_back(meshID);
             else if (!mesh.isStatic && mesh.isDisplaced) dynamicDisplacedMeshes.push_back(meshID);
@@ -1736,10 +2611,6 @@ namespace Falcor
             auto& mesh = mMeshes[meshID];
             if (mesh.instances.size() <= 1) continue; // Only processing instanced meshes here
 
-            // Mark displaced meshes.
-            const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId);
-            if (pMaterial->isDisplaced()) mesh.isDisplaced = true;
-
             instances inst(mesh.instances.begin(), mesh.instances.end());
             if (mesh.isDisplaced) displacedInstancesToMeshList[inst].push_back(meshID);
             else instancesToMeshList[inst].push_back(meshID);
@@ -1820,6 +2691,22 @@ namespace Falcor
         }
     }
 
+    SceneBuilder::MeshSpec SceneBuilder::createSplitMeshSpec(const MeshSpec& mesh, const std::string& name)
+    {
+        MeshSpec spec;
+        spec.name = name;
+        spec.topology = mesh.topology;
+        spec.materialId = mesh.materialId;
+        spec.isStatic = mesh.isStatic;
+        spec.isFrontFaceCW = mesh.isFrontFaceCW;
+        spec.isDisplaced = mesh.isDisplaced;
+        spec.isEmissive = mesh.isEmissive;
+        spec.instances = mesh.instances;
+        FALCOR_ASSERT(mesh.isDynamic() == false);
+        FALCOR_ASSERT(mesh.skinningVertexCount == 0);
+        return spec;
+    }
+
     std::pair<std::optional<uint32_t>, std::optional<uint32_t>> SceneBuilder::splitMesh(const uint32_t meshID, const int axis, const float pos)
     {
         // Splits a mesh by an axis-aligned plane.
@@ -1846,22 +2733,8 @@ namespace Falcor
         else if (mesh.boundingBox.minPoint[axis] >= pos) return { std::nullopt, meshID };
 
         // Setup mesh specs.
-        auto createSpec = [](const MeshSpec& mesh, const std::string& name)
-        {
-            MeshSpec spec;
-            spec.name = name;
-            spec.topology = mesh.topology;
-            spec.materialId = mesh.materialId;
-            spec.isStatic = mesh.isStatic;
-            spec.isFrontFaceCW = mesh.isFrontFaceCW;
-            spec.instances = mesh.instances;
-            FALCOR_ASSERT(mesh.isDynamic() == false);
-            FALCOR_ASSERT(mesh.skinningVertexCount == 0);
-            return spec;
-        };
-
-        MeshSpec leftMesh = createSpec(mesh, mesh.name + ".0");
-        MeshSpec rightMesh = createSpec(mesh, mesh.name + ".1");
+        MeshSpec leftMesh = createSplitMeshSpec(mesh, mesh.name + ".0");
+        MeshSpec rightMesh = createSplitMeshSpec(mesh, mesh.name + ".1");
 
         if (mesh.indexCount > 0) splitIndexedMesh(mesh, leftMesh, rightMesh, axis, pos);
         else splitNonIndexedMesh(mesh, leftMesh, rightMesh, axis, pos);
@@ -1895,13 +2768,54 @@ namespace Falcor
         return { meshID, rightMeshID };
     }
 
-    void SceneBuilder::splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos)
+    std::vector<SceneBuilder::MeshSpec> SceneBuilder::splitMeshIntoSubMeshes(const MeshSpec& mesh, size_t maxTriangleCount) const
+    {
+        // Splits a mesh recursively at the midpoint of the largest axis of each part's bounding box.
+        // This is used to break up large meshes into sub-meshes with tighter bounds before partitioning a mesh group.
+        // Unlike splitMesh(), the mesh list is not modified, so this can run in parallel for different meshes.
+
+        // Unsupported meshes are kept as is.
+        if (mesh.isDynamic() || mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0) return {};
+
+        std::vector<MeshSpec> parts;
+        std::vector<MeshSpec> pending;
+
+        // Split a mesh into two parts. Returns false if all triangles ended up on one side.
+        auto split = [&](const MeshSpec& src)
+        {
+            const int axis = largestAxis(src.boundingBox.extent());
+            const float pos = src.boundingBox.center()[axis];
+
+            MeshSpec leftMesh = createSplitMeshSpec(src, src.name + ".0");
+            MeshSpec rightMesh = createSplitMeshSpec(src, src.name + ".1");
+            splitIndexedMesh(src, leftMesh, rightMesh, axis, pos);
+            if (leftMesh.getTriangleCount() == 0 || rightMesh.getTriangleCount() == 0) return false;
+
+            pending.push_back(std::move(leftMesh));
+            pending.push_back(std::move(rightMesh));
+            return true;
+        };
+
+        if (mesh.getTriangleCount() <= maxTriangleCount || !split(mesh)) return {};
+
+        while (!pending.empty())
+        {
+            MeshSpec part = std::move(pending.back());
+            pending.pop_back();
+            if (part.getTriangleCount() <= maxTriangleCount || !split(part)) parts.push_back(std::move(part));
+        }
+
+        FALCOR_ASSERT(parts.size() >= 2);
+        return parts;
+    }
+
+    void SceneBuilder::splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const
     {
         FALCOR_ASSERT(mesh.indexCount > 0 && !mesh.indexData.empty());
 
         const uint32_t invalidIdx = uint32_t(-1);
-        std::vector<uint32_t> leftIndexMap(mesh.indexCount, invalidIdx);
-        std::vector<uint32_t> rightIndexMap(mesh.indexCount, invalidIdx);
+        std::vector<uint32_t> leftIndexMap(mesh.staticData.size(), invalidIdx);
+        std::vector<uint32_t> rightIndexMap(mesh.staticData.size(), invalidIdx);
 
         // Iterate over the triangles.
         const size_t triangleCount = mesh.getTriangleCount();
@@ -1956,7 +2870,7 @@ namespace Falcor
         finalizeMesh(rightMesh);
     }
 
-    void SceneBuilder::splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos)
+    void SceneBuilder::splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const
     {
         FALCOR_ASSERT(mesh.indexCount == 0 && mesh.indexData.empty());
         throw RuntimeError("SceneBuilder::splitNonIndexedMesh() not implemented");
@@ -2156,38 +3070,149 @@ namespace Falcor
         return leftList;
     }
 
-    void SceneBuilder::optimizeGeometry()
+    void SceneBuilder::splitMeshGroupsSAH(Scene::MeshGroupSplitStats& stats)
     {
-        // This function optimizes the geometry for raytracing performance and memory usage.
-        //
-        // There is a max triangles per group limit to reduce the worst-case memory requirements for BLAS builds.
-        // If the limit is exceeded, the geometry is split into multiple groups (BLASes).
-        // Splitting has performance implications for the traversal due to spatial overlap between the BLASes.
-        //
-        // To reduce the perf impact we may perform these steps:
-        //  - Split large mesh groups (BLASes) into multiple smaller ones.
-        //  - Split large meshes into smaller to reduce spatial overlap between BLASes.
-        //  - Sort meshes into BLASes based on spatial locality.
+        // This function partitions the mesh groups that exceed the triangle limit into smaller groups.
+        // Large meshes in these groups are first split into sub-meshes with tighter bounds. The meshes and sub-meshes
+        // are then partitioned by a binned SAH partitioner, which minimizes the estimated overlap between the groups.
+        // The mesh splitting runs in parallel over meshes, and the partitioning in parallel over mesh groups.
+
+        stats = {};
 
+        // Find the mesh groups to split. Groups with dynamic meshes are not supported.
+        std::vector<size_t> splitGroups;
+        for (size_t groupIdx = 0; groupIdx < mMeshGroups.size(); groupIdx++)
+        {
+            const auto& meshList = mMeshGroups[groupIdx].meshList;
+            bool isDynamic = std::any_of(meshList.begin(), meshList.end(), [this](uint32_t meshID) { return mMeshes[meshID].isDynamic(); });
+            if (!isDynamic && countTriangles(mMeshGroups[groupIdx]) > kMaxTrianglesPerBLAS) splitGroups.push_back(groupIdx);
+        }
+        if (splitGroups.empty()) return;
+
+        // Split the large meshes into sub-meshes in parallel.
+        std::vector<std::pair<size_t, uint32_t>> largeMeshes; // Pairs of group index and mesh ID.
+        for (size_t groupIdx : splitGroups)
+        {
+            for (uint32_t meshID : mMeshGroups[groupIdx].meshList)
+            {
+                if (mMeshes[meshID].getTriangleCount() > kMaxTrianglesPerSubMesh) largeMeshes.push_back({ groupIdx, meshID });
+            }
+        }
+
+        std::vector<std::vector<MeshSpec>> subMeshes(largeMeshes.size());
+        Threading::parallelFor(0, largeMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) subMeshes[i] = splitMeshIntoSubMeshes(mMeshes[largeMeshes[i].second], kMaxTrianglesPerSubMesh);
+        }, 1);
+
+        // Store the sub-meshes. The first sub-mesh replaces the mesh.
+        // The others are appended at the end of the mesh list and linked to the instances and the mesh group.
+        for (size_t i = 0; i < largeMeshes.size(); i++)
+        {
+            auto& parts = subMeshes[i];
+            if (parts.empty()) continue;
+
+            const auto [groupIdx, meshID] = largeMeshes[i];
+            logDebug("Mesh '{}' with {} triangles was split into {} sub-meshes.", mMeshes[meshID].name, mMeshes[meshID].getTriangleCount(), parts.size());
+
+            mMeshes[meshID] = std::move(parts[0]);
+            for (size_t j = 1; j < parts.size(); j++)
+            {
+                uint32_t subMeshID = (uint32_t)mMeshes.size();
+                for (auto nodeID : parts[j].instances) mSceneGraph.at(nodeID).meshes.push_back(subMeshID);
+                mMeshGroups[groupIdx].meshList.push_back(subMeshID);
+                mMeshes.push_back(std::move(parts[j]));
+            }
+            stats.subMeshCount += (uint32_t)(parts.size() - 1);
+        }
+
+        // Partition the mesh groups in parallel.
+        std::vector<SAHPartitioner::Partition> partitions(splitGroups.size());
+        Threading::parallelFor(0, splitGroups.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto& meshList = mMeshGroups[splitGroups[i]].meshList;
+                std::vector<SAHPartitioner::Item> items(meshList.size());
+                for (size_t j = 0; j < meshList.size(); j++)
+                {
+                    const auto& mesh = mMeshes[meshList[j]];
+                    items[j] = { mesh.boundingBox, mesh.getTriangleCount() };
+                }
+                partitions[i] = SAHPartitioner::partition(items.data(), items.size(), kMaxTrianglesPerBLAS);
+            }
+        }, 1);
+
+        // Replace the split mesh groups by the partitions, keeping the order of the groups.
         MeshGroupList optimizedGroups;
+        double totalCost = 0.0;
+        double totalOverlap = 0.0;
+        size_t totalTriangleCount = 0;
 
-        for (auto& meshGroup : mMeshGroups)
+        for (size_t groupIdx = 0, i = 0; groupIdx < mMeshGroups.size(); groupIdx++)
         {
-            //auto groups = splitMeshGroupSimple(meshGroup);
-            //auto groups = splitMeshGroupMedian(meshGroup);
-            auto groups = splitMeshGroupMidpointMeshes(meshGroup);
+            auto& meshGroup = mMeshGroups[groupIdx];
+            if (i == splitGroups.size() || splitGroups[i] != groupIdx)
+            {
+                optimizedGroups.push_back(std::move(meshGroup));
+                continue;
+            }
+
+            const auto& partition = partitions[i++];
+            const size_t triangleCount = countTriangles(meshGroup);
+
+            if (partition.groups.size() == 1)
+            {
+                // This happens if the group consists of a single mesh that could not be split.
+                logWarning("Mesh group with {} triangles could not be split, expect extraneous GPU memory usage.", triangleCount);
+                optimizedGroups.push_back(std::move(meshGroup));
+                continue;
+            }
 
-            if (groups.size() > 1) logWarning("SceneBuilder::optimizeGeometry() performance warning - Mesh group was split into {} groups.", groups.size());
+            for (const auto& group : partition.groups)
+            {
+                MeshGroup splitGroup{ std::vector<uint32_t>(), meshGroup.isStatic, meshGroup.isDisplaced };
+                for (uint32_t j : group) splitGroup.meshList.push_back(meshGroup.meshList[j]);
+                optimizedGroups.push_back(std::move(splitGroup));
+            }
+
+            logWarning("SceneBuilder::optimizeGeometry() performance warning - Mesh group with {} triangles was split into {} groups (estimated SAH cost {:.3f}, overlap {:.3f}).",
+                triangleCount, partition.groups.size(), partition.cost, partition.overlap);
 
-            optimizedGroups.insert(
-                optimizedGroups.end(),
-                std::make_move_iterator(groups.begin()),
-                std::make_move_iterator(groups.end()));
+            stats.splitGroupCount++;
+            stats.resultGroupCount += (uint32_t)partition.groups.size();
+            totalCost += partition.cost * triangleCount;
+            totalOverlap += partition.overlap * triangleCount;
+            totalTriangleCount += triangleCount;
+        }
+
+        if (totalTriangleCount > 0)
+        {
+            stats.cost = (float)(totalCost / totalTriangleCount);
+            stats.overlap = (float)(totalOverlap / totalTriangleCount);
         }
 
         mMeshGroups = std::move(optimizedGroups);
     }
 
+    void SceneBuilder::optimizeGeometry()
+    {
+        // This function optimizes the geometry for raytracing performance and memory usage.
+        //
+        // There is a max triangles per group limit to reduce the worst-case memory requirements for BLAS builds.
+        // If the limit is exceeded, the geometry is split into multiple groups (BLASes).
+        // Splitting has performance implications for the traversal due to spatial overlap between the BLASes.
+        //
+        // To reduce the perf impact we perform these steps:
+        //  - Split large meshes into smaller to reduce spatial overlap between BLASes.
+        //  - Sort meshes into BLASes based on spatial locality using the surface area heuristic.
+        //
+        // The simpler per-group alternatives splitMeshGroupSimple(), splitMeshGroupMedian() and
+        // splitMeshGroupMidpointMeshes() are kept for comparison.
+
+        splitMeshGroupsSAH(mSceneData.meshGroupSplitStats);
+    }
+
     void SceneBuilder::sortMeshes()
     {
         // This function sorts meshes by the order they are used in the mesh groups.
@@ -2233,6 +3258,175 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::createMeshlets()
+    {
+        // This function splits all meshes into meshlets. It runs after the mesh IDs and the index and vertex
+        // order of the meshes are final, but before the mesh data is moved to the global buffers.
+
+        if (!is_set(mFlags, Flags::GenerateMeshlets)) return;
+
+        std::vector<MeshOptimizer::MeshletList> meshletLists(mMeshes.size());
+
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
+        {
+            std::vector<uint32_t> indices;
+            for (size_t meshID = begin; meshID < end; meshID++)
+            {
+                const auto& mesh = mMeshes[meshID];
+                FALCOR_ASSERT(mesh.topology == Vao::Topology::TriangleList);
+
+                // Non-indexed meshes use implicit indices.
+                indices.resize(mesh.indexCount > 0 ? mesh.indexCount : mesh.vertexCount);
+                for (uint32_t i = 0; i < (uint32_t)indices.size(); i++) indices[i] = mesh.indexCount > 0 ? mesh.getIndex(i) : i;
+
+                const float3* pPositions = mesh.staticData.empty() ? nullptr : &mesh.staticData[0].position;
+                meshletLists[meshID] = MeshOptimizer::buildMeshlets(indices.data(), indices.size(), pPositions, sizeof(StaticVertexData), mesh.vertexCount);
+            }
+        }, 1);
+
+        // Compute the offsets of all meshes into the global meshlet arrays.
+        std::vector<size_t> vertexOffsets(mMeshes.size());
+        std::vector<size_t> triangleOffsets(mMeshes.size());
+        size_t meshletCount = 0;
+        size_t vertexCount = 0;
+        size_t triangleCount = 0;
+
+        mSceneData.meshletOffsets.resize(mMeshes.size() + 1);
+        for (size_t meshID = 0; meshID < mMeshes.size(); meshID++)
+        {
+            mSceneData.meshletOffsets[meshID] = (uint32_t)meshletCount;
+            vertexOffsets[meshID] = vertexCount;
+            triangleOffsets[meshID] = triangleCount;
+            meshletCount += meshletLists[meshID].meshlets.size();
+            vertexCount += meshletLists[meshID].vertices.size();
+            triangleCount += meshletLists[meshID].triangles.size();
+        }
+
+        if (meshletCount > std::numeric_limits<uint32_t>::max() ||
+            vertexCount > std::numeric_limits<uint32_t>::max() ||
+            triangleCount > std::numeric_limits<uint32_t>::max())
+        {
+            throw RuntimeError("Trying to build a scene that exceeds supported meshlet data size.");
+        }
+        mSceneData.meshletOffsets.back() = (uint32_t)meshletCount;
+
+        mSceneData.meshletDesc.resize(meshletCount);
+        mSceneData.meshletVertices.resize(vertexCount);
+        mSceneData.meshletTriangles.resize(triangleCount);
+
+        // Copy the meshlets into the global arrays.
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t meshID = begin; meshID < end; meshID++)
+            {
+                auto& list = meshletLists[meshID];
+                MeshletDesc* pDesc = mSceneData.meshletDesc.data() + mSceneData.meshletOffsets[meshID];
+                for (const auto& meshlet : list.meshlets)
+                {
+                    MeshletDesc& desc = *pDesc++;
+                    desc.boundsMin = meshlet.boundsMin;
+                    desc.boundsMax = meshlet.boundsMax;
+                    desc.vertexOffset = (uint32_t)(vertexOffsets[meshID] + meshlet.vertexOffset);
+                    desc.triangleOffset = (uint32_t)(triangleOffsets[meshID] + meshlet.triangleOffset);
+                    desc.coneAxis = meshlet.coneAxis;
+                    desc.coneCutoff = meshlet.coneCutoff;
+                    desc.coneApex = meshlet.coneApex;
+                    desc.counts = meshlet.vertexCount | (meshlet.triangleCount << 16);
+                }
+                std::copy(list.vertices.begin(), list.vertices.end(), mSceneData.meshletVertices.begin() + vertexOffsets[meshID]);
+                std::copy(list.triangles.begin(), list.triangles.end(), mSceneData.meshletTriangles.begin() + triangleOffsets[meshID]);
+                list = {};
+            }
+        });
+
+        logInfo("Created {} meshlets for {} meshes.", meshletCount, mMeshes.size());
+    }
+
+    void SceneBuilder::createMeshLODs()
+    {
+        // This function generates the LOD chains of the meshes. It runs after the mesh IDs and the index and vertex
+        // order of the meshes are final. The LODs reference the mesh vertices, and their indices are appended to the
+        // mesh indices when the global buffers are created.
+
+        if (!is_set(mFlags, Flags::GenerateLODs) || is_set(mFlags, Flags::NonIndexedVertices)) return;
+
+        const auto& targetRatios = mLODSettings.targetRatios;
+        const size_t lodCount = targetRatios.size();
+        if (lodCount == 0) return;
+
+        auto needsLODs = [this](const MeshSpec& mesh)
+        {
+            // Displaced meshes are intersected per triangle and emissive meshes define the mesh lights, so both are kept as is.
+            return mesh.topology == Vao::Topology::TriangleList && mesh.indexCount > 0 && !mesh.isDisplaced && !mesh.isEmissive &&
+                mesh.getTriangleCount() >= mLODSettings.minTriangleCount;
+        };
+
+        // Each LOD is simplified from LOD 0, so that its error is measured against the full-resolution mesh.
+        // This also makes the LODs of a mesh independent, which spreads the work of large meshes over multiple threads.
+        struct LOD
+        {
+            std::vector<uint32_t> indices;
+            float error = 0.f;
+        };
+        std::vector<LOD> lods(mMeshes.size() * lodCount);
+
+        Threading::parallelFor(0, lods.size(), [&](size_t begin, size_t end)
+        {
+            std::vector<uint32_t> indices;
+            for (size_t i = begin; i < end; i++)
+            {
+                const auto& mesh = mMeshes[i / lodCount];
+                if (!needsLODs(mesh)) continue;
+
+                indices.resize(mesh.indexCount);
+                for (uint32_t j = 0; j < mesh.indexCount; j++) indices[j] = mesh.getIndex(j);
+
+                const size_t targetIndexCount = (size_t)(mesh.getTriangleCount() * targetRatios[i % lodCount]) * 3;
+                auto& lod = lods[i];
+                lod.indices = MeshOptimizer::simplify(indices.data(), indices.size(), &mesh.staticData[0].position, sizeof(StaticVertexData), mesh.vertexCount,
+                    targetIndexCount, mLODSettings.maxError, &lod.error);
+                if (is_set(mFlags, Flags::OptimizeVertexCache)) MeshOptimizer::optimizeVertexCache(lod.indices.data(), lod.indices.size(), mesh.vertexCount);
+            }
+        }, 1);
+
+        // Keep the LODs that noticeably reduce the triangle count of the previous level. Simplification stops at the
+        // error limit, so the chain of a mesh ends at the first LOD that doesn't.
+        const float kMaxIndexCountRatio = 0.9f;
+
+        mMeshLODIndexData.resize(mMeshes.size());
+        mSceneData.meshLODOffsets.resize(mMeshes.size() + 1);
+        uint64_t lodTriangleCount = 0;
+
+        for (size_t meshID = 0; meshID < mMeshes.size(); meshID++)
+        {
+            const auto& mesh = mMeshes[meshID];
+            auto& indexData = mMeshLODIndexData[meshID];
+            mSceneData.meshLODOffsets[meshID] = (uint32_t)mSceneData.meshLODDesc.size();
+
+            size_t prevIndexCount = mesh.indexCount;
+            for (size_t lodIndex = 0; lodIndex < lodCount; lodIndex++)
+            {
+                auto& lod = lods[meshID * lodCount + lodIndex];
+                if (lod.indices.empty() || lod.indices.size() > prevIndexCount * kMaxIndexCountRatio) break;
+                prevIndexCount = lod.indices.size();
+
+                // The LOD indices use the same format as the mesh indices. Each LOD starts at a dword boundary.
+                MeshLODDesc desc = {};
+                desc.ibOffset = (uint32_t)(mesh.indexData.size() + indexData.size());
+                desc.indexCount = (uint32_t)lod.indices.size();
+                desc.error = lod.error;
+                mSceneData.meshLODDesc.push_back(desc);
+                lodTriangleCount += desc.getTriangleCount();
+
+                const auto packedIndices = mesh.use16BitIndices ? compact16BitIndices(lod.indices) : std::move(lod.indices);
+                indexData.insert(indexData.end(), packedIndices.begin(), packedIndices.end());
+            }
+        }
+        mSceneData.meshLODOffsets.back() = (uint32_t)mSceneData.meshLODDesc.size();
+
+        logInfo("Created {} LODs with {} triangles for {} meshes.", mSceneData.meshLODDesc.size(), lodTriangleCount, mMeshes.size());
+    }
+
     void SceneBuilder::createGlobalBuffers()
     {
         FALCOR_ASSERT(mSceneData.meshIndexData.empty());
@@ -2246,9 +3440,13 @@ namespace Falcor
         size_t totalStaticVertexCount = 0;
         size_t totalSkinningVertexCount = 0;
 
-        for (const auto& mesh : mMeshes)
+        // The LOD indices of each mesh are stored after the mesh indices.
+        mMeshLODIndexData.resize(mMeshes.size());
+
+        for (size_t meshID = 0; meshID < mMeshes.size(); meshID++)
         {
-            totalIndexDataCount += mesh.indexData.size();
+            const auto& mesh = mMeshes[meshID];
+            totalIndexDataCount += mesh.indexData.size() + mMeshLODIndexData[meshID].size();
             totalStaticVertexCount += mesh.staticData.size();
             totalSkinningVertexCount += mesh.skinningData.size();
             mSceneData.prevVertexCount += mesh.prevVertexCount;
@@ -2262,44 +3460,72 @@ namespace Falcor
             throw RuntimeError("Trying to build a scene that exceeds supported mesh data size.");
         }
 
-        mSceneData.meshIndexData.reserve(totalIndexDataCount);
-        mSceneData.meshStaticData.reserve(totalStaticVertexCount);
-        mSceneData.meshSkinningData.reserve(totalSkinningVertexCount);
+        // Compute the offsets of all meshes into the global buffers.
+        size_t indexDataCount = 0;
+        size_t staticVertexCount = 0;
+        size_t skinningVertexCount = 0;
 
-        // Copy all vertex and index data into the global buffers.
-        for (auto& mesh : mMeshes)
+        for (size_t meshID = 0; meshID < mMeshes.size(); meshID++)
         {
-            mesh.staticVertexOffset = (uint32_t)mSceneData.meshStaticData.size();
-            mesh.skinningVertexOffset = (uint32_t)mSceneData.meshSkinningData.size();
+            auto& mesh = mMeshes[meshID];
+            mesh.staticVertexOffset = (uint32_t)staticVertexCount;
+            mesh.skinningVertexOffset = (uint32_t)skinningVertexCount;
             mesh.prevVertexOffset = mesh.skinningVertexOffset;
-
-            // Insert the static vertex data in the global array.
-            // The vertices are automatically converted to their packed format in this step.
-            mSceneData.meshStaticData.insert(mSceneData.meshStaticData.end(), mesh.staticData.begin(), mesh.staticData.end());
+            staticVertexCount += mesh.staticData.size();
 
             if (isIndexed)
             {
-                mesh.indexOffset = (uint32_t)mSceneData.meshIndexData.size();
-                mSceneData.meshIndexData.insert(mSceneData.meshIndexData.end(), mesh.indexData.begin(), mesh.indexData.end());
+                mesh.indexOffset = (uint32_t)indexDataCount;
+                indexDataCount += mesh.indexData.size() + mMeshLODIndexData[meshID].size();
             }
 
             if (mesh.isSkinned())
             {
                 FALCOR_ASSERT(!mesh.skinningData.empty());
-                mSceneData.meshSkinningData.insert(mSceneData.meshSkinningData.end(), mesh.skinningData.begin(), mesh.skinningData.end());
+                skinningVertexCount += mesh.skinningData.size();
+            }
+        }
+
+        mSceneData.meshIndexData.resize(indexDataCount);
+        mSceneData.meshStaticData.resize(staticVertexCount);
+        mSceneData.meshSkinningData.resize(skinningVertexCount);
+
+        // Copy all vertex and index data into the global buffers.
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t meshID = begin; meshID < end; meshID++)
+            {
+                auto& mesh = mMeshes[meshID];
+
+                // Copy the static vertex data to the global array.
+                // The vertices are automatically converted to their packed format in this step.
+                std::copy(mesh.staticData.begin(), mesh.staticData.end(), mSceneData.meshStaticData.begin() + mesh.staticVertexOffset);
 
-                // Patch vertex index references.
-                for (uint32_t i = 0; i < mesh.skinningData.size(); ++i)
+                if (isIndexed)
                 {
-                    mSceneData.meshSkinningData[mesh.skinningVertexOffset + i].staticIndex += mesh.staticVertexOffset;
+                    const auto& lodIndexData = mMeshLODIndexData[meshID];
+                    auto it = std::copy(mesh.indexData.begin(), mesh.indexData.end(), mSceneData.meshIndexData.begin() + mesh.indexOffset);
+                    std::copy(lodIndexData.begin(), lodIndexData.end(), it);
                 }
-            }
 
-            // Free the mesh local data.
-            mesh.indexData.clear();
-            mesh.staticData.clear();
-            mesh.skinningData.clear();
-        }
+                if (mesh.isSkinned())
+                {
+                    std::copy(mesh.skinningData.begin(), mesh.skinningData.end(), mSceneData.meshSkinningData.begin() + mesh.skinningVertexOffset);
+
+                    // Patch vertex index references.
+                    for (uint32_t i = 0; i < mesh.skinningData.size(); ++i)
+                    {
+                        mSceneData.meshSkinningData[mesh.skinningVertexOffset + i].staticIndex += mesh.staticVertexOffset;
+                    }
+                }
+
+                // Free the mesh local data.
+                mesh.indexData.clear();
+                mesh.staticData.clear();
+                mesh.skinningData.clear();
+                mMeshLODIndexData[meshID].clear();
+            }
+        });
 
         // Initialize offsets for prev vertex data for vertex-animated meshes
         uint32_t prevOffset = (uint32_t)mSceneData.meshSkinningData.size();
@@ -2342,22 +3568,35 @@ namespace Falcor
             throw RuntimeError("Trying to build a scene that exceeds supported curve data size.");
         }
 
-        mSceneData.curveIndexData.reserve(totalIndexDataCount);
-        mSceneData.curveStaticData.reserve(totalStaticCurveVertexCount);
+        // Compute the offsets of all curves into the curve global buffers.
+        size_t indexDataCount = 0;
+        size_t staticCurveVertexCount = 0;
 
-        // Copy all curve vertex and index data into the curve global buffers.
         for (auto& curve : mCurves)
         {
-            curve.staticVertexOffset = (uint32_t)mSceneData.curveStaticData.size();
-            mSceneData.curveStaticData.insert(mSceneData.curveStaticData.end(), curve.staticData.begin(), curve.staticData.end());
+            curve.staticVertexOffset = (uint32_t)staticCurveVertexCount;
+            curve.indexOffset = (uint32_t)indexDataCount;
+            staticCurveVertexCount += curve.staticData.size();
+            indexDataCount += curve.indexData.size();
+        }
 
-            curve.indexOffset = (uint32_t)mSceneData.curveIndexData.size();
-            mSceneData.curveIndexData.insert(mSceneData.curveIndexData.end(), curve.indexData.begin(), curve.indexData.end());
+        mSceneData.curveIndexData.resize(totalIndexDataCount);
+        mSceneData.curveStaticData.resize(totalStaticCurveVertexCount);
 
-            // Free the curve local data.
-            curve.indexData.clear();
-            curve.staticData.clear();
-        }
+        // Copy all curve vertex and index data into the curve global buffers.
+        Threading::parallelFor(0, mCurves.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t curveID = begin; curveID < end; curveID++)
+            {
+                auto& curve = mCurves[curveID];
+                std::copy(curve.staticData.begin(), curve.staticData.end(), mSceneData.curveStaticData.begin() + curve.staticVertexOffset);
+                std::copy(curve.indexData.begin(), curve.indexData.end(), mSceneData.curveIndexData.begin() + curve.indexOffset);
+
+                // Free the curve local data.
+                curve.indexData.clear();
+                curve.staticData.clear();
+            }
+        });
     }
 
     void SceneBuilder::optimizeMaterials()
@@ -2378,24 +3617,33 @@ namespace Falcor
         // textures may be reduced to identical materials after optimization,
         // increasing the likelihood of finding duplicates here.
 
+        // The material IDs referenced by meshes and SDF grids are reassigned in remapMaterialIDs().
+
         if (is_set(mFlags, Flags::DontMergeMaterials)) return;
 
         std::vector<uint32_t> idMap;
         size_t removed = mSceneData.pMaterials->removeDuplicateMaterials(idMap);
 
-        // Reassign material IDs.
-        if (removed > 0)
+        if (removed > 0) mMaterialIDMap = std::move(idMap);
+    }
+
+    void SceneBuilder::remapMaterialIDs()
+    {
+        // Reassign material IDs after removing duplicate materials.
+
+        if (mMaterialIDMap.empty()) return;
+
+        for (auto& mesh : mMeshes)
         {
-            for (auto& mesh : mMeshes)
-            {
-                mesh.materialId = idMap[mesh.materialId];
-            }
+            mesh.materialId = mMaterialIDMap[mesh.materialId];
+        }
 
-            for (auto& sdfGridInstance : mSceneData.sdfGridInstances)
-            {
-                sdfGridInstance.materialID = idMap[sdfGridInstance.materialID];
-            }
+        for (auto& sdfGridInstance : mSceneData.sdfGridInstances)
+        {
+            sdfGridInstance.materialID = mMaterialIDMap[sdfGridInstance.materialID];
         }
+
+        mMaterialIDMap.clear();
     }
 
     void SceneBuilder::collectVolumeGrids()
@@ -2415,52 +3663,56 @@ namespace Falcor
         // Match texture coordinate quantization for textured emissives to format of PackedEmissiveTriangle.
         // This is to avoid mismatch when sampling and evaluating emissive triangles.
         // Note that non-emissive meshes are unmodified and use full precision texcoords.
-        for (auto& mesh : mMeshes)
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
         {
-            const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId)->toBasicMaterial();
-            if (pMaterial && pMaterial->getEmissiveTexture() != nullptr)
+            for (size_t meshID = begin; meshID < end; meshID++)
             {
-                // Quantize texture coordinates to fp16. Also track the bounds and max error.
-                float2 minTexCrd = float2(std::numeric_limits<float>::infinity());
-                float2 maxTexCrd = float2(-std::numeric_limits<float>::infinity());
-                float2 maxError = float2(0);
-
-                for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
+                const auto& mesh = mMeshes[meshID];
+                const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId)->toBasicMaterial();
+                if (pMaterial && pMaterial->getEmissiveTexture() != nullptr)
                 {
-                    auto& v = mSceneData.meshStaticData[mesh.staticVertexOffset + i];
-                    float2 texCrd = v.texCrd;
-                    minTexCrd = min(minTexCrd, texCrd);
-                    maxTexCrd = max(maxTexCrd, texCrd);
-                    v.texCrd = f16tof32(f32tof16(texCrd));
-                    maxError = max(maxError, abs(v.texCrd - texCrd));
-                }
+                    // Quantize texture coordinates to fp16. Also track the bounds and max error.
+                    float2 minTexCrd = float2(std::numeric_limits<float>::infinity());
+                    float2 maxTexCrd = float2(-std::numeric_limits<float>::infinity());
+                    float2 maxError = float2(0);
 
-                // Issue warning if quantization errors are too large.
-                float2 maxAbsCrd = max(abs(minTexCrd), abs(maxTexCrd));
-                if (maxAbsCrd.x > HLF_MAX || maxAbsCrd.y > HLF_MAX)
-                {
-                    logWarning("Texture coordinates for emissive textured mesh '{}' are outside the representable range, expect rendering errors.", mesh.name);
-                }
-                else
-                {
-                    // Compute maximum quantization error in texels.
-                    // The texcoords are used for all texture channels so taking the maximum dimensions.
-                    uint2 maxTexDim = pMaterial->getMaxTextureDimensions();
-                    maxError *= maxTexDim;
-                    float maxTexelError = std::max(maxError.x, maxError.y);
+                    for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
+                    {
+                        auto& v = mSceneData.meshStaticData[mesh.staticVertexOffset + i];
+                        float2 texCrd = v.texCrd;
+                        minTexCrd = min(minTexCrd, texCrd);
+                        maxTexCrd = max(maxTexCrd, texCrd);
+                        v.texCrd = f16tof32(f32tof16(texCrd));
+                        maxError = max(maxError, abs(v.texCrd - texCrd));
+                    }
 
-                    if (maxTexelError > kMaxTexelError)
+                    // Issue warning if quantization errors are too large.
+                    float2 maxAbsCrd = max(abs(minTexCrd), abs(maxTexCrd));
+                    if (maxAbsCrd.x > HLF_MAX || maxAbsCrd.y > HLF_MAX)
+                    {
+                        logWarning("Texture coordinates for emissive textured mesh '{}' are outside the representable range, expect rendering errors.", mesh.name);
+                    }
+                    else
                     {
-                        logWarning(
-                            "Texture coordinates for emissive textured mesh '{}' have a large quantization error of {} texels."
-                            "The coordinate range is [{},{}] x [{},{}] for maximum texture dimensions ({},{}).",
-                            mesh.name, maxTexelError,
-                            minTexCrd.x, maxTexCrd.x, minTexCrd.y, maxTexCrd.y, maxTexDim.x, maxTexDim.y
-                        );
+                        // Compute maximum quantization error in texels.
+                        // The texcoords are used for all texture channels so taking the maximum dimensions.
+                        uint2 maxTexDim = pMaterial->getMaxTextureDimensions();
+                        maxError *= maxTexDim;
+                        float maxTexelError = std::max(maxError.x, maxError.y);
+
+                        if (maxTexelError > kMaxTexelError)
+                        {
+                            logWarning(
+                                "Texture coordinates for emissive textured mesh '{}' have a large quantization error of {} texels."
+                                "The coordinate range is [{},{}] x [{},{}] for maximum texture dimensions ({},{}).",
+                                mesh.name, maxTexelError,
+                                minTexCrd.x, maxTexCrd.x, minTexCrd.y, maxTexCrd.y, maxTexDim.x, maxTexDim.y
+                            );
+                        }
                     }
                 }
             }
-        }
+        });
     }
 
     void SceneBuilder::removeDuplicateSDFGrids()
@@ -2502,49 +3754,56 @@ namespace Falcor
 
         auto& meshData = mSceneData.meshDesc;
         meshData.resize(mMeshes.size());
+        mSceneData.meshNames.resize(mMeshes.size());
 
         // Setup all mesh data.
-        for (uint32_t meshID = 0; meshID < mMeshes.size(); meshID++)
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t begin, size_t end)
         {
-            const auto& mesh = mMeshes[meshID];
-            meshData[meshID].materialID = mesh.materialId;
-            meshData[meshID].vbOffset = mesh.staticVertexOffset;
-            meshData[meshID].ibOffset = mesh.indexOffset;
-            meshData[meshID].vertexCount = mesh.vertexCount;
-            meshData[meshID].indexCount = mesh.indexCount;
-            meshData[meshID].skinningVbOffset = mesh.hasSkinningData ? mesh.skinningVertexOffset : 0;
-            meshData[meshID].prevVbOffset = mesh.isDynamic() ? mesh.prevVertexOffset : 0;
-            FALCOR_ASSERT(mesh.skinningVertexCount == 0 || mesh.skinningVertexCount == mesh.staticVertexCount);
-
-            mSceneData.meshNames.push_back(mesh.name);
-
-            uint32_t meshFlags = 0;
-            meshFlags |= mesh.use16BitIndices ? (uint32_t)MeshFlags::Use16BitIndices : 0;
-            meshFlags |= mesh.isSkinned() ? (uint32_t)MeshFlags::IsSkinned : 0;
-            meshFlags |= mesh.isFrontFaceCW ? (uint32_t)MeshFlags::IsFrontFaceCW : 0;
-            meshFlags |= mesh.isDisplaced ? (uint32_t)MeshFlags::IsDisplaced : 0;
-            meshFlags |= mesh.isAnimated ? (uint32_t)MeshFlags::IsAnimated : 0;
-            meshData[meshID].flags = meshFlags;
-
-            if (mesh.use16BitIndices) mSceneData.has16BitIndices = true;
-            else mSceneData.has32BitIndices = true;
-
-            if (mesh.isSkinned())
+            for (size_t meshID = begin; meshID < end; meshID++)
             {
-                // Dynamic (skinned) meshes can only be instanced if an explicit skeleton transform node is specified.
-                FALCOR_ASSERT(mesh.instances.size() == 1 || mesh.skeletonNodeID != kInvalidNode);
-
-                for (uint32_t i = 0; i < mesh.vertexCount; i++)
+                const auto& mesh = mMeshes[meshID];
+                meshData[meshID].materialID = mesh.materialId;
+                meshData[meshID].vbOffset = mesh.staticVertexOffset;
+                meshData[meshID].ibOffset = mesh.indexOffset;
+                meshData[meshID].vertexCount = mesh.vertexCount;
+                meshData[meshID].indexCount = mesh.indexCount;
+                meshData[meshID].skinningVbOffset = mesh.hasSkinningData ? mesh.skinningVertexOffset : 0;
+                meshData[meshID].prevVbOffset = mesh.isDynamic() ? mesh.prevVertexOffset : 0;
+                FALCOR_ASSERT(mesh.skinningVertexCount == 0 || mesh.skinningVertexCount == mesh.staticVertexCount);
+
+                mSceneData.meshNames[meshID] = mesh.name;
+
+                uint32_t meshFlags = 0;
+                meshFlags |= mesh.use16BitIndices ? (uint32_t)MeshFlags::Use16BitIndices : 0;
+                meshFlags |= mesh.isSkinned() ? (uint32_t)MeshFlags::IsSkinned : 0;
+                meshFlags |= mesh.isFrontFaceCW ? (uint32_t)MeshFlags::IsFrontFaceCW : 0;
+                meshFlags |= mesh.isDisplaced ? (uint32_t)MeshFlags::IsDisplaced : 0;
+                meshFlags |= mesh.isAnimated ? (uint32_t)MeshFlags::IsAnimated : 0;
+                meshData[meshID].flags = meshFlags;
+
+                if (mesh.isSkinned())
                 {
-                    SkinningVertexData& s = mSceneData.meshSkinningData[mesh.skinningVertexOffset + i];
+                    // Dynamic (skinned) meshes can only be instanced if an explicit skeleton transform node is specified.
+                    FALCOR_ASSERT(mesh.instances.size() == 1 || mesh.skeletonNodeID != kInvalidNode);
+
+                    for (uint32_t i = 0; i < mesh.vertexCount; i++)
+                    {
+                        SkinningVertexData& s = mSceneData.meshSkinningData[mesh.skinningVertexOffset + i];
 
-                    // The bind matrix is per mesh, so just take it from the first instance
-                    s.bindMatrixID = (uint32_t)mesh.instances[0];
+                        // The bind matrix is per mesh, so just take it from the first instance
+                        s.bindMatrixID = (uint32_t)mesh.instances[0];
 
-                    // If a skeleton's world transform node is not explicitly set, it is the same transform as the instance (Assimp behavior)
-                    s.skeletonMatrixID = mesh.skeletonNodeID == kInvalidNode ? (uint32_t)mesh.instances[0] : mesh.skeletonNodeID;
+                        // If a skeleton's world transform node is not explicitly set, it is the same transform as the instance (Assimp behavior)
+                        s.skeletonMatrixID = mesh.skeletonNodeID == kInvalidNode ? (uint32_t)mesh.instances[0] : mesh.skeletonNodeID;
+                    }
                 }
             }
+        });
+
+        for (const auto& mesh : mMeshes)
+        {
+            if (mesh.use16BitIndices) mSceneData.has16BitIndices = true;
+            else mSceneData.has32BitIndices = true;
         }
     }
 
@@ -2727,21 +3986,24 @@ namespace Falcor
     {
         // Calculate curve bounding boxes.
         mSceneData.curveBBs.resize(mCurves.size());
-        for (size_t i = 0; i < mCurves.size(); i++)
+        Threading::parallelFor(0, mCurves.size(), [&](size_t begin, size_t end)
         {
-            const auto& curve = mCurves[i];
-            AABB curveBB;
-
-            const auto* staticData = &mSceneData.curveStaticData[curve.staticVertexOffset];
-            for (uint32_t v = 0; v < curve.vertexCount; v++)
+            for (size_t i = begin; i < end; i++)
             {
-                float radius = staticData[v].radius;
-                curveBB.include(staticData[v].position - float3(radius));
-                curveBB.include(staticData[v].position + float3(radius));
-            }
+                const auto& curve = mCurves[i];
+                AABB curveBB;
 
-            mSceneData.curveBBs[i] = curveBB;
-        }
+                const auto* staticData = &mSceneData.curveStaticData[curve.staticVertexOffset];
+                for (uint32_t v = 0; v < curve.vertexCount; v++)
+                {
+                    float radius = staticData[v].radius;
+                    curveBB.include(staticData[v].position - float3(radius));
+                    curveBB.include(staticData[v].position + float3(radius));
+                }
+
+                mSceneData.curveBBs[i] = curveBB;
+            }
+        });
     }
 
     FALCOR_SCRIPT_BINDING(SceneBuilder)
@@ -2775,10 +4037,29 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("OptimizeVertexCache", SceneBuilder::Flags::OptimizeVertexCache);
+        flags.value("GenerateMeshlets", SceneBuilder::Flags::GenerateMeshlets);
+        flags.value("GenerateLODs", SceneBuilder::Flags::GenerateLODs);
+        flags.value("InstanceDuplicateMeshes", SceneBuilder::Flags::InstanceDuplicateMeshes);
+        flags.value("StreamVertexCaches", SceneBuilder::Flags::StreamVertexCaches);
+        flags.value("ArchivalCache", SceneBuilder::Flags::ArchivalCache);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
+        flags.value("UseMappedCache", SceneBuilder::Flags::UseMappedCache);
         ScriptBindings::addEnumBinaryOperators(flags);
 
+        ScriptBindings::SerializableStruct<SceneBuilder::LODSettings> lodSettings(m, "SceneBuilderLODSettings");
+#define field(f_) field(#f_, &SceneBuilder::LODSettings::f_)
+        lodSettings.field(targetRatios);
+        lodSettings.field(maxError);
+        lodSettings.field(minTriangleCount);
+#undef field
+
+        ScriptBindings::SerializableStruct<VertexCacheStreamingSettings> vertexCacheStreamingSettings(m, "VertexCacheStreamingSettings");
+#define field(f_) field(#f_, &VertexCacheStreamingSettings::f_)
+        vertexCacheStreamingSettings.field(memoryBudget);
+#undef field
+
         pybind11::class_<SceneBuilder, SceneBuilder::SharedPtr> sceneBuilder(m, "SceneBuilder");
         sceneBuilder.def_property_readonly("flags", &SceneBuilder::getFlags);
         sceneBuilder.def_property_readonly("materials", &SceneBuilder::getMaterials);
@@ -2791,6 +4072,8 @@ namespace Falcor
         sceneBuilder.def_property("envMap", &SceneBuilder::getEnvMap, &SceneBuilder::setEnvMap);
         sceneBuilder.def_property("selectedCamera", &SceneBuilder::getSelectedCamera, &SceneBuilder::setSelectedCamera);
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
+        sceneBuilder.def_property("lodSettings", &SceneBuilder::getLODSettings, &SceneBuilder::setLODSettings);
+        sceneBuilder.def_property("vertexCacheStreamingSettings", &SceneBuilder::getVertexCacheStreamingSettings, &SceneBuilder::setVertexCacheStreamingSettings);
         sceneBuilder.def("importScene", [] (SceneBuilder* pSceneBuilder, const std::filesystem::path& path, const pybind11::dict& dict, const std::vector<Transform>& instances) {
             SceneBuilder::InstanceMatrices instanceMatrices;
             for (const auto& instance : instances)
@@ -2825,5 +4108,32 @@ namespace Falcor
         sceneBuilder.def("addMeshInstance", &SceneBuilder::addMeshInstance);
         sceneBuilder.def("addSDFGridInstance", &SceneBuilder::addSDFGridInstance);
         sceneBuilder.def("addCustomPrimitive", &SceneBuilder::addCustomPrimitive);
+        sceneBuilder.def("beginIngestBatch", &SceneBuilder::beginIngestBatch, "parent"_a = SceneBuilder::kInvalidNode);
+        sceneBuilder.def("submitIngestBatch", [] (SceneBuilder* pSceneBuilder, SceneBuilder::IngestBatch& batch) {
+            pSceneBuilder->submitIngestBatch(std::move(batch));
+        }, "batch"_a);
+        sceneBuilder.def("commitIngestBatches", &SceneBuilder::commitIngestBatches);
+
+        pybind11::class_<SceneBuilder::IngestBatchRanges> ingestBatchRanges(m, "SceneBuilderIngestBatchRanges");
+        ingestBatchRanges.def_readonly("sequenceNumber", &SceneBuilder::IngestBatchRanges::sequenceNumber);
+        ingestBatchRanges.def_readonly("firstNodeID", &SceneBuilder::IngestBatchRanges::firstNodeID);
+        ingestBatchRanges.def_readonly("nodeCount", &SceneBuilder::IngestBatchRanges::nodeCount);
+        ingestBatchRanges.def_readonly("firstMeshID", &SceneBuilder::IngestBatchRanges::firstMeshID);
+        ingestBatchRanges.def_readonly("meshCount", &SceneBuilder::IngestBatchRanges::meshCount);
+
+        pybind11::class_<SceneBuilder::IngestBatch> ingestBatch(m, "SceneBuilderIngestBatch");
+        ingestBatch.def_property_readonly("sequenceNumber", &SceneBuilder::IngestBatch::getSequenceNumber);
+        ingestBatch.def_property_readonly("nodeCount", &SceneBuilder::IngestBatch::getNodeCount);
+        ingestBatch.def_property_readonly("meshCount", &SceneBuilder::IngestBatch::getMeshCount);
+        ingestBatch.def("addTriangleMesh", &SceneBuilder::IngestBatch::addTriangleMesh, "triangleMesh"_a, "material"_a);
+        ingestBatch.def("addMaterial", &SceneBuilder::IngestBatch::addMaterial, "material"_a);
+        ingestBatch.def("addNode", [] (SceneBuilder::IngestBatch& batch, const std::string& name, const Transform& transform, uint32_t parent) {
+            SceneBuilder::Node node;
+            node.name = name;
+            node.transform = transform.getMatrix();
+            node.parent = parent;
+            return batch.addNode(node);
+        }, "name"_a, "transform"_a = Transform(), "parent"_a = SceneBuilder::kInvalidNode);
+        ingestBatch.def("addMeshInstance", &SceneBuilder::IngestBatch::addMeshInstance, "nodeID"_a, "meshID"_a);
     }
 }
@@ -28,10 +28,14 @@
 #pragma once
 #include "Scene.h"
 #include "SceneCache.h"
+#include "AssetCache.h"
 #include "Transform.h"
 #include "TriangleMesh.h"
 #include "Material/MaterialTextureLoader.h"
 #include "VertexAttrib.slangh"
+#include <atomic>
+#include <map>
+#include <mutex>
 
 namespace Falcor
 {
@@ -64,9 +68,16 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            OptimizeVertexCache             = 0x20000,  ///< Reorder mesh triangles for post-transform vertex cache efficiency and mesh vertices for vertex fetch locality.
+            GenerateMeshlets                = 0x40000,  ///< Split meshes into meshlets (clusters of up to 64 vertices and 124 triangles) with bounds and normal cones.
+            GenerateLODs                    = 0x80000,  ///< Generate a chain of simplified levels of detail for each mesh, see LODSettings. The LOD of each mesh instance can be selected on the scene.
+            InstanceDuplicateMeshes         = 0x100000, ///< Replace meshes that are exact or rigidly transformed copies of another mesh by instances of that mesh. This is the converse of FlattenStaticMeshInstances, which takes precedence.
+            StreamVertexCaches              = 0x200000, ///< Keep vertex cache keyframes on disk and stream them through a ring of resident keyframes, see VertexCacheStreamingSettings. With the scene cache, the keyframes are stored next to the cache file.
 
+            ArchivalCache                   = 0x08000000, ///< Compress the scene cache with a slower, higher-ratio codec (LZ4HC). Decompression speed is unaffected.
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
+            UseMappedCache                  = 0x40000000, ///< Write the scene cache in the memory-mapped format with page-aligned raw geometry sections. Caches in either format can be read.
 
             Default = None
         };
@@ -312,6 +323,105 @@ namespace Falcor
             uint32_t parent = kInvalidNode;
         };
 
+        /** Settings for the mesh LOD generation, see Flags::GenerateLODs.
+            The LODs are simplified from the full-resolution mesh (LOD 0) by edge collapses. Vertices on mesh borders and
+            attribute seams are kept. Meshes with displaced or emissive materials don't get LODs.
+        */
+        struct LODSettings
+        {
+            std::vector<float> targetRatios = { 0.5f, 0.25f, 0.125f };  ///< Target triangle count of each LOD relative to LOD 0. Must be decreasing and in the range (0, 1).
+            float maxError = 0.01f;                                     ///< Maximum simplification error relative to the largest extent of the mesh bounding box.
+            uint32_t minTriangleCount = 64;                             ///< Meshes with fewer triangles don't get LODs.
+        };
+
+        /** Batch of scene data staged for concurrent ingestion, see beginIngestBatch().
+            Node and mesh IDs used with a batch are local to the batch. They are mapped to scene IDs when the batch is committed.
+            A single batch is not thread-safe, but any number of batches can be filled concurrently from different threads.
+        */
+        class FALCOR_API IngestBatch
+        {
+        public:
+            /** Get the sequence number of the batch. Batches are committed in order of their sequence numbers.
+            */
+            uint32_t getSequenceNumber() const { return mSequenceNumber; }
+
+            /** Get the scene node that nodes without a parent in this batch are attached to, or kInvalidNode if none.
+            */
+            uint32_t getParentNodeID() const { return mParentNodeID; }
+
+            /** Add a node.
+                \param[in] node The node. The parent is a node ID local to this batch, or kInvalidNode to attach the node to the parent node of the batch.
+                \return The node ID local to this batch.
+            */
+            uint32_t addNode(const Node& node);
+
+            /** Add a mesh. The mesh is pre-processed on the calling thread.
+                Note that the skeleton node ID of the mesh refers to a scene node, not to a node of this batch.
+                \param[in] mesh The mesh to add.
+                \return The mesh ID local to this batch.
+            */
+            uint32_t addMesh(const Mesh& mesh);
+
+            /** Add a triangle mesh. The mesh is pre-processed on the calling thread.
+                \param[in] pTriangleMesh The triangle mesh to add.
+                \param[in] pMaterial The material to use for the mesh.
+                \return The mesh ID local to this batch.
+            */
+            uint32_t addTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial);
+
+            /** Add a pre-processed mesh.
+                \param[in] mesh The pre-processed mesh (will be moved from).
+                \return The mesh ID local to this batch.
+            */
+            uint32_t addProcessedMesh(ProcessedMesh&& mesh);
+
+            /** Add a material. Materials of the meshes in the batch are added automatically, so this is only needed for other materials.
+                Material IDs are assigned when the batch is committed.
+                \param[in] pMaterial The material.
+            */
+            void addMaterial(const Material::SharedPtr& pMaterial);
+
+            /** Add a mesh instance to a node.
+                \param[in] nodeID Node ID local to this batch.
+                \param[in] meshID Mesh ID local to this batch.
+            */
+            void addMeshInstance(uint32_t nodeID, uint32_t meshID);
+
+            /** Get the number of nodes in the batch.
+            */
+            uint32_t getNodeCount() const { return (uint32_t)mNodes.size(); }
+
+            /** Get the number of meshes in the batch.
+            */
+            uint32_t getMeshCount() const { return (uint32_t)mMeshes.size(); }
+
+        private:
+            IngestBatch(const SceneBuilder* pBuilder, uint32_t sequenceNumber, uint32_t parentNodeID)
+                : mpBuilder(pBuilder), mSequenceNumber(sequenceNumber), mParentNodeID(parentNodeID) {}
+
+            const SceneBuilder* mpBuilder = nullptr;
+            uint32_t mSequenceNumber = 0;
+            uint32_t mParentNodeID = kInvalidNode;
+            std::vector<Material::SharedPtr> mMaterials;
+            std::vector<Node> mNodes;
+            std::vector<ProcessedMesh> mMeshes;
+            std::vector<std::pair<uint32_t, uint32_t>> mMeshInstances; ///< Pairs of local node and mesh ID.
+
+            friend class SceneBuilder;
+        };
+
+        /** Range of scene IDs assigned to the contents of a committed ingest batch.
+            The scene ID of a local node or mesh ID is the first ID of the range plus the local ID.
+        */
+        struct IngestBatchRanges
+        {
+            uint32_t sequenceNumber = 0;    ///< Sequence number of the batch.
+            uint32_t firstNodeID = 0;       ///< Scene ID of the first node of the batch.
+            uint32_t nodeCount = 0;         ///< Number of nodes in the batch.
+            uint32_t firstMeshID = 0;       ///< Scene ID of the first mesh of the batch.
+            uint32_t meshCount = 0;         ///< Number of meshes in the batch.
+        };
+
         using InstanceMatrices = std::vector<float4x4>;
 
         /** Create a new object
@@ -342,6 +452,24 @@ namespace Falcor
         */
         Flags getFlags() const { return mFlags; }
 
+        /** Set the mesh LOD settings. They are used if the scene is built with Flags::GenerateLODs.
+            Note that the settings are not part of the scene cache key. Use Flags::RebuildCache after changing them.
+        */
+        void setLODSettings(const LODSettings& settings);
+
+        /** Get the mesh LOD settings.
+        */
+        const LODSettings& getLODSettings() const { return mLODSettings; }
+
+        /** Set the vertex cache streaming settings. They are used if the scene is built with Flags::StreamVertexCaches.
+            The settings are stored in the scene cache, so scenes loaded from the cache use the settings they were built with.
+        */
+        void setVertexCacheStreamingSettings(const VertexCacheStreamingSettings& settings);
+
+        /** Get the vertex cache streaming settings.
+        */
+        const VertexCacheStreamingSettings& getVertexCacheStreamingSettings() const { return mVertexCacheStreamingSettings; }
+
         /** Set the render settings.
         */
         void setRenderSettings(const Scene::RenderSettings& renderSettings) { mSceneData.renderSettings = renderSettings; }
@@ -382,6 +510,15 @@ namespace Falcor
         */
         uint32_t addTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial);
 
+        /** Pre-process a triangle mesh into the data format that is used in the global scene buffers.
+            This is thread-safe and can be used to process meshes in parallel before adding them with addProcessedMesh().
+            Throws an exception if something went wrong.
+            \param pTriangleMesh The triangle mesh to pre-process.
+            \param pMaterial The material to use for the mesh.
+            \return The pre-processed mesh.
+        */
+        ProcessedMesh processTriangleMesh(const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial) const;
+
         /** Pre-process a mesh into the data format that is used in the global scene buffers.
             Throws an exception if something went wrong.
             \param mesh The mesh to pre-process.
@@ -402,6 +539,12 @@ namespace Falcor
         */
         uint32_t addProcessedMesh(const ProcessedMesh& mesh);
 
+        /** Add a pre-processed mesh.
+            \param mesh The pre-processed mesh (will be moved from).
+            \return The ID of the mesh in the scene. Note that all of the instances share the same mesh ID.
+        */
+        uint32_t addProcessedMesh(ProcessedMesh&& mesh);
+
         /** Set mesh vertex cache for animation.
             \param[in] cachedCurves The mesh vertex cache data (will be moved from).
         */
@@ -595,6 +738,32 @@ namespace Falcor
         */
         void addMeshInstance(uint32_t nodeID, uint32_t meshID);
 
+        // Concurrent ingestion
+
+        /** Begin a batch for adding scene data concurrently.
+            The batch can be filled on any thread and is added to the scene with submitIngestBatch() and commitIngestBatches().
+            This is thread-safe. Batches are committed in the order they were begun, so begin them in a fixed order
+            (e.g. one batch per work item before dispatching the work) for the scene to be deterministic.
+            \param[in] parentNodeID Scene node that the root nodes of the batch are attached to, or kInvalidNode.
+            \return The new batch.
+        */
+        IngestBatch beginIngestBatch(uint32_t parentNodeID = kInvalidNode);
+
+        /** Submit a filled batch. The batch is staged until commitIngestBatches() is called.
+            This is thread-safe. Throws an exception if the batch was already submitted.
+            \param[in] batch The batch (will be moved from).
+        */
+        void submitIngestBatch(IngestBatch&& batch);
+
+        /** Add submitted batches to the scene in order of their sequence numbers.
+            Only the batches following the last committed batch without a gap are added. Batches after a missing
+            sequence number stay staged until the missing batch is submitted.
+            Call this after all producer threads have submitted their batches. It is called implicitly by getScene(),
+            which throws an exception if batches are still staged afterwards.
+            \return The scene ID ranges assigned to the committed batches, in commit order.
+        */
+        std::vector<IngestBatchRanges> commitIngestBatches();
+
         /** Add a curve instance to a node.
         */
         void addCurveInstance(uint32_t nodeID, uint32_t curveID);
@@ -651,6 +820,7 @@ namespace Falcor
             bool isStatic = false;                  ///< True if mesh is non-instanced and static (not dynamic or animated).
             bool isFrontFaceCW = false;             ///< Indicate whether front-facing side has clockwise winding in object space.
             bool isDisplaced = false;               ///< True if mesh has displacement map.
+            bool isEmissive = false;                ///< True if mesh has an emissive material.
             bool isAnimated = false;                ///< True if mesh has vertex animations.
             AABB boundingBox;                       ///< Mesh bounding-box in object space.
             std::vector<uint32_t> instances;        ///< Node IDs of all instances of this mesh.
@@ -713,32 +883,59 @@ namespace Falcor
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
 
+        AssetCache::SharedPtr mpAssetCache;     ///< Cache for individual processed assets, or nullptr if disabled.
+        bool mReadAssetCache = false;           ///< True if existing asset cache entries should be used.
+        AssetCache::Stats mAssetCacheStats;     ///< Asset cache statistics at creation, used to log the statistics of this build.
+        TextureCache::Stats mTextureCacheStats; ///< Texture cache statistics at creation, used to log the statistics of this build.
+
         SceneGraph mSceneGraph;
         const Flags mFlags;
+        LODSettings mLODSettings;
+        VertexCacheStreamingSettings mVertexCacheStreamingSettings;
 
         MeshList mMeshes;
         MeshGroupList mMeshGroups; ///< Groups of meshes. Each group represents all the geometries in a BLAS for ray tracing.
+        std::vector<std::vector<uint32_t>> mMeshLODIndexData; ///< Packed indices of the LODs of each mesh, appended to the mesh indices in createGlobalBuffers().
 
         CurveList mCurves;
 
+        std::vector<uint32_t> mMaterialIDMap; ///< Mapping from old to new material IDs after removing duplicate materials, or empty if no materials were removed.
+
+        std::atomic<uint32_t> mNextIngestSequenceNumber = 0;            ///< Sequence number of the next ingest batch.
+        uint32_t mNextCommitSequenceNumber = 0;                         ///< Sequence number of the next ingest batch to commit.
+        std::map<uint32_t, IngestBatch> mSubmittedIngestBatches;        ///< Submitted ingest batches by sequence number.
+        std::mutex mIngestMutex;                                        ///< Mutex protecting mSubmittedIngestBatches and mNextCommitSequenceNumber.
+
         std::unique_ptr<MaterialTextureLoader> mpMaterialTextureLoader;
         GpuFence::SharedPtr mpFence;
 
         // Helpers
+        ProcessedMesh processMeshUncached(const Mesh& mesh, MeshAttributeIndices* pAttributeIndices) const;
         bool doesNodeHaveAnimation(uint32_t nodeID) const;
         void updateLinkedObjects(uint32_t oldNodeID, uint32_t newNodeID);
         bool collapseNodes(uint32_t parentNodeID, uint32_t childNodeID);
         bool mergeNodes(uint32_t dstNodeID, uint32_t srcNodeID);
         void flipTriangleWinding(MeshSpec& mesh);
         void updateSDFGridID(uint32_t oldID, uint32_t newID);
+        void removeMeshesWithoutInstances();
 
         /** Split a mesh by the given axis-aligned splitting plane.
             \return Pair of optional mesh IDs for the meshes on the left and right side, respectively.
         */
         std::pair<std::optional<uint32_t>, std::optional<uint32_t>> splitMesh(uint32_t meshID, const int axis, const float pos);
 
-        void splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
-        void splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
+        /** Create the spec of a part of a mesh that is split. Only the mesh properties are copied, not the geometry.
+        */
+        static MeshSpec createSplitMeshSpec(const MeshSpec& mesh, const std::string& name);
+
+        void splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const;
+        void splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const;
+
+        /** Split a mesh recursively at the midpoint of the largest axis until each part has at most the given number of triangles.
+            This does not modify the mesh list. The parts inherit the instances of the mesh.
+            \return List of parts, or an empty list if the mesh could not be split.
+        */
+        std::vector<MeshSpec> splitMeshIntoSubMeshes(const MeshSpec& mesh, size_t maxTriangleCount) const;
 
         // Mesh group helpers
         size_t countTriangles(const MeshGroup& meshGroup) const;
@@ -747,24 +944,31 @@ namespace Falcor
         MeshGroupList splitMeshGroupSimple(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMedian(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
+        void splitMeshGroupsSAH(Scene::MeshGroupSplitStats& stats);
 
         // Post processing
         void prepareDisplacementMaps();
         void prepareSceneGraph();
+        void markDisplacedMeshes();
         void prepareMeshes();
         void removeUnusedMeshes();
+        void instanceDuplicateMeshes();
         void flattenStaticMeshInstances();
         void optimizeSceneGraph();
         void pretransformStaticMeshes();
         void unifyTriangleWinding();
+        void optimizeVertexCache();
         void calculateMeshBoundingBoxes();
         void createMeshGroups();
         void optimizeGeometry();
         void sortMeshes();
+        void createMeshlets();
+        void createMeshLODs();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
         void optimizeMaterials();
         void removeDuplicateMaterials();
+        void remapMaterialIDs();
         void collectVolumeGrids();
         void quantizeTexCoords();
         void removeDuplicateSDFGrids();
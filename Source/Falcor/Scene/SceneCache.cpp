@@ -28,8 +28,9 @@
 #include "stdafx.h"
 #include "SceneCache.h"
 #include "Material/MaterialTextureLoader.h"
-
-#include <lz4_stream/lz4_stream.h>
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Image/TextureCache.h"
+#include "Utils/Threading.h"
 
 namespace Falcor
 {
@@ -38,25 +39,194 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 34;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
-        const size_t kBlockSize = 1 * 1024 * 1024;
+        /** Default maximum total size of all scene cache files.
+        */
+        const uint64_t kDefaultSizeLimit = 64ull * 1024 * 1024 * 1024;
 
         const char* kMagic = "FalcorS$";
         struct Header
         {
             uint8_t magic[8]{};
             uint32_t version{};
+            SceneCache::Format format{};
+            uint32_t hasKeyframeFile{};     ///< Non-zero if the vertex cache keyframes are stored in a separate keyframe file.
 
             bool isValid() const
             {
-                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
+                return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion &&
+                    (format == SceneCache::Format::Stream || format == SceneCache::Format::Mapped);
             }
         };
+
+        /** Extension of the keyframe file stored next to the scene cache file.
+        */
+        const std::string kKeyframeFileExtension = ".keyframes";
+
+        /** Returns true if the vertex cache keyframes are stored in a keyframe file instead of the scene cache file.
+            The scene cache file then only holds the first keyframe of each vertex cache.
+        */
+        bool hasKeyframeFile(const Scene::SceneData& sceneData)
+        {
+            return sceneData.streamVertexCaches && (!sceneData.cachedMeshes.empty() || !sceneData.cachedCurves.empty());
+        }
+
+        /** Alignment of sections in the mapped format.
+            Sections are page aligned so that they can be mapped and read without touching neighbouring data.
+        */
+        const uint64_t kSectionAlignment = 4096;
+
+        /** Granularity used when copying sections out of the memory mapping in parallel.
+        */
+        const size_t kSectionCopyGrainSize = 4 * 1024 * 1024;
+
+        enum class SectionCompression : uint32_t
+        {
+            None = 0,
+            Blocks = 1, ///< Compressed with BlockCompressedOutputStream.
+        };
+
+        /** Entry in the section table of the mapped format.
+        */
+        struct SectionDesc
+        {
+            uint64_t offset = 0;    ///< Offset of the section from the start of the file in bytes.
+            uint64_t size = 0;      ///< Size of the (possibly compressed) section in bytes.
+            SectionCompression compression = SectionCompression::None;
+            uint32_t reserved = 0;
+        };
+
+        /** Location of the section table. Stored directly after the header in the mapped format.
+            Section 0 always holds the serialized metadata, all other sections hold raw bulk data.
+        */
+        struct SectionTableDesc
+        {
+            uint64_t offset = 0;
+            uint64_t count = 0;
+        };
+
+        /** Writes bulk data into separate page-aligned sections of the cache file.
+        */
+        class SectionWriter
+        {
+        public:
+            SectionWriter(std::ostream& stream) : mStream(stream), mSections(1) {}
+
+            uint32_t addSection(const void* data, size_t size, SectionCompression compression)
+            {
+                mSections.push_back(writeSection(data, size, compression));
+                return (uint32_t)(mSections.size() - 1);
+            }
+
+            void setMetadata(const std::string& data, SectionCompression compression)
+            {
+                mSections[0] = writeSection(data.data(), data.size(), compression);
+            }
+
+            SectionTableDesc writeTable()
+            {
+                align();
+                SectionTableDesc table;
+                table.offset = (uint64_t)mStream.tellp();
+                table.count = mSections.size();
+                mStream.write(reinterpret_cast<const char*>(mSections.data()), mSections.size() * sizeof(SectionDesc));
+                return table;
+            }
+
+        private:
+            void align()
+            {
+                static const char zeros[kSectionAlignment] = {};
+                uint64_t offset = (uint64_t)mStream.tellp();
+                uint64_t padding = (kSectionAlignment - offset % kSectionAlignment) % kSectionAlignment;
+                mStream.write(zeros, padding);
+            }
+
+            SectionDesc writeSection(const void* data, size_t size, SectionCompression compression)
+            {
+                align();
+                SectionDesc desc;
+                desc.offset = (uint64_t)mStream.tellp();
+                desc.size = size;
+                desc.compression = compression;
+                mStream.write(reinterpret_cast<const char*>(data), size);
+                return desc;
+            }
+
+            std::ostream& mStream;
+            std::vector<SectionDesc> mSections;
+        };
+
+        /** Stream buffer reading directly from a memory range without copying it.
+        */
+        class MemoryStreamBuffer : public std::streambuf
+        {
+        public:
+            MemoryStreamBuffer(const uint8_t* data, size_t size)
+            {
+                char* p = const_cast<char*>(reinterpret_cast<const char*>(data));
+                setg(p, p, p + size);
+            }
+        };
+
+        /** Reads bulk data from the sections of a memory mapped cache file.
+        */
+        class SectionReader
+        {
+        public:
+            SectionReader(const MemoryMappedFile::SharedPtr& pFile, std::vector<SectionDesc> sections)
+                : mpFile(pFile)
+                , mSections(std::move(sections))
+            {
+                for (const auto& section : mSections)
+                {
+                    if (section.offset > mpFile->getSize() || section.size > mpFile->getSize() - section.offset)
+                    {
+                        throw RuntimeError("Scene cache section exceeds file size.");
+                    }
+                }
+            }
+
+            const SectionDesc& getSection(uint32_t index) const
+            {
+                if (index >= mSections.size()) throw RuntimeError("Invalid scene cache section index {}.", index);
+                return mSections[index];
+            }
+
+            const uint8_t* getData(const SectionDesc& section) const
+            {
+                return mpFile->getData() + section.offset;
+            }
+
+            template<typename T>
+            void read(uint32_t index, std::vector<T>& vec) const
+            {
+                const auto& section = getSection(index);
+                if (section.compression != SectionCompression::None) throw RuntimeError("Scene cache section {} is compressed, expected raw data.", index);
+                if (section.size % sizeof(T) != 0) throw RuntimeError("Scene cache section {} has invalid size.", index);
+                vec.resize(section.size / sizeof(T));
+                if (vec.empty()) return;
+
+                // Copy the section in large chunks on the thread pool. Each worker faults in its own range of the mapping,
+                // which keeps several reads in flight and makes the load bound by disk rather than by a single decoder thread.
+                mpFile->prefetch(section.offset, section.size);
+                const uint8_t* pSrc = getData(section);
+                uint8_t* pDst = reinterpret_cast<uint8_t*>(vec.data());
+                Threading::parallelFor(0, section.size, [&](size_t begin, size_t end)
+                {
+                    std::memcpy(pDst + begin, pSrc + begin, end - begin);
+                }, kSectionCopyGrainSize);
+            }
+
+        private:
+            MemoryMappedFile::SharedPtr mpFile;
+            std::vector<SectionDesc> mSections;
+        };
     }
 
     /** Wrapper around std::ostream to ease serialization of basic types.
@@ -64,7 +234,7 @@ namespace Falcor
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
+        OutputStream(std::ostream& stream, SectionWriter* pSections = nullptr) : mStream(stream), mpSections(pSections) {}
 
         void write(const void* data, size_t len)
         {
@@ -114,8 +284,27 @@ namespace Falcor
             if (hasValue) write(opt.value());
         }
 
+        /** Write a large array of raw data.
+            In the mapped format the array is stored in a separate page-aligned section and only the section index is written to the stream.
+            Otherwise the array is written inline, identical to write(vec).
+        */
+        template<typename T>
+        void writeBulk(const std::vector<T>& vec)
+        {
+            static_assert(std::is_trivially_copyable<T>::value);
+            if (mpSections)
+            {
+                write(mpSections->addSection(vec.data(), vec.size() * sizeof(T), SectionCompression::None));
+            }
+            else
+            {
+                write(vec);
+            }
+        }
+
     private:
         std::ostream& mStream;
+        SectionWriter* mpSections;
     };
 
     /** Wrapper around std::istream to ease serialization of basic types.
@@ -123,7 +312,7 @@ namespace Falcor
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(std::istream& stream, const SectionReader* pSections = nullptr) : mStream(stream), mpSections(pSections) {}
 
         void read(void* data, size_t len)
         {
@@ -182,13 +371,30 @@ namespace Falcor
             if (hasValue) opt = read<T>();
         }
 
+        /** Read a large array of raw data written with OutputStream::writeBulk().
+        */
+        template<typename T>
+        void readBulk(std::vector<T>& vec)
+        {
+            static_assert(std::is_trivially_copyable<T>::value);
+            if (mpSections)
+            {
+                mpSections->read(read<uint32_t>(), vec);
+            }
+            else
+            {
+                read(vec);
+            }
+        }
+
     private:
         std::istream& mStream;
+        const SectionReader* mpSections;
     };
 
     bool SceneCache::hasValidCache(const Key& key)
     {
-        auto cachePath = getCachePath(key);
+        auto cachePath = getDiskCache()->getEntryPath(getCacheName(key));
         if (!std::filesystem::exists(cachePath)) return false;
 
         // Open file.
@@ -198,41 +404,76 @@ namespace Falcor
         // Verify header.
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        if (fs.eof() || !header.isValid()) return false;
+
+        // The keyframe file is a separate cache entry that may have been evicted.
+        return !header.hasKeyframeFile || std::filesystem::exists(getDiskCache()->getEntryPath(getKeyframeFileName(key)));
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, Format format, BlockCodec codec)
     {
-        auto cachePath = getCachePath(key);
+        const auto& pDiskCache = getDiskCache();
+        auto cacheName = getCacheName(key);
+        auto cachePath = pDiskCache->getEntryPath(cacheName);
 
-        logInfo("Writing scene cache to '{}'.", cachePath);
+        logInfo("Writing scene cache to '{}' ({} format).", cachePath, format == Format::Mapped ? "mapped" : "stream");
 
-        // Create directories if not existing.
-        std::filesystem::create_directories(cachePath.parent_path());
+        // Vertex cache keyframes are written to their own entry first, so a committed scene cache never refers to missing keyframes.
+        if (hasKeyframeFile(sceneData)) writeKeyframeFile(sceneData, key);
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", cachePath);
+        // The cache is written to a temporary file that is renamed once complete. This allows multiple processes
+        // to share the cache directory without ever reading a partially written cache file.
+        auto tempPath = pDiskCache->createTempPath(cacheName);
+        try
+        {
+            // Open file.
+            std::ofstream fs(tempPath.c_str(), std::ios_base::binary);
+            if (!fs) throw RuntimeError("Failed to create scene cache file '{}'.", tempPath);
+
+            // Write header (uncompressed).
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            header.format = format;
+            header.hasKeyframeFile = hasKeyframeFile(sceneData) ? 1 : 0;
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            if (format == Format::Mapped)
+            {
+                writeMappedCache(fs, sceneData, codec);
+            }
+            else
+            {
+                // Write cache (compressed in parallel).
+                BlockCompressedOutputStream zs(fs, codec);
+                OutputStream stream(zs);
+                writeSceneData(stream, sceneData);
+                zs.close();
+            }
 
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.close();
+            if (fs.fail()) throw RuntimeError("Failed to write scene cache file to '{}'.", tempPath);
+        }
+        catch (...)
+        {
+            pDiskCache->discard(tempPath);
+            throw;
+        }
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
-        if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
+        if (!pDiskCache->commit(cacheName, tempPath)) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
     }
 
     Scene::SceneData SceneCache::readCache(const Key& key)
     {
-        auto cachePath = getCachePath(key);
+        const auto& pDiskCache = getDiskCache();
+        auto cacheName = getCacheName(key);
+        auto cachePath = pDiskCache->getEntryPath(cacheName);
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
+        // Mark the cache as recently used to protect it from eviction.
+        pDiskCache->touch(cacheName);
+
         // Open file.
         std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
         if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
@@ -242,20 +483,157 @@ namespace Falcor
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
         if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
+        Scene::SceneData sceneData;
+        if (header.format == Format::Mapped)
+        {
+            fs.close();
+            sceneData = readMappedCache(cachePath);
+        }
+        else
+        {
+            // Read cache (decompressed in parallel).
+            BlockCompressedInputStream zs(fs);
+            InputStream stream(zs);
+            sceneData = readSceneData(stream);
+            if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
+        }
+
+        if (header.hasKeyframeFile)
+        {
+            sceneData.pVertexCacheKeyframeFile = openKeyframeFile(key);
+            if (!sceneData.pVertexCacheKeyframeFile) throw RuntimeError("Missing keyframe file for scene cache file '{}'.", cachePath);
+        }
+
         return sceneData;
     }
 
-    std::filesystem::path SceneCache::getCachePath(const Key& key)
+    KeyframeFile::SharedPtr SceneCache::openKeyframeFile(const Key& key)
+    {
+        const auto& pDiskCache = getDiskCache();
+        auto name = getKeyframeFileName(key);
+        if (!pDiskCache->touch(name)) return nullptr;
+        return KeyframeFile::open(pDiskCache->getEntryPath(name));
+    }
+
+    void SceneCache::setSizeLimit(uint64_t sizeLimit)
+    {
+        getDiskCache()->setSizeLimit(sizeLimit);
+    }
+
+    uint64_t SceneCache::getSizeLimit()
+    {
+        return getDiskCache()->getSizeLimit();
+    }
+
+    void SceneCache::writeMappedCache(std::ostream& fs, const Scene::SceneData& sceneData, BlockCodec codec)
+    {
+        // Reserve space for the section table location, it is patched once all sections are written.
+        auto tableDescPos = fs.tellp();
+        SectionTableDesc tableDesc;
+        fs.write(reinterpret_cast<const char*>(&tableDesc), sizeof(tableDesc));
+
+        // Bulk data is written to the file directly as separate sections while serializing.
+        // The remaining scene data is small and stored compressed in the metadata section.
+        SectionWriter sections(fs);
+        std::ostringstream metadata;
+        {
+            BlockCompressedOutputStream zs(metadata, codec);
+            OutputStream stream(zs, &sections);
+            writeSceneData(stream, sceneData);
+            zs.close();
+        }
+        sections.setMetadata(metadata.str(), SectionCompression::Blocks);
+
+        tableDesc = sections.writeTable();
+        fs.seekp(tableDescPos);
+        fs.write(reinterpret_cast<const char*>(&tableDesc), sizeof(tableDesc));
+    }
+
+    Scene::SceneData SceneCache::readMappedCache(const std::filesystem::path& cachePath)
+    {
+        auto pFile = MemoryMappedFile::create(cachePath);
+        const uint8_t* pData = pFile->getData();
+        const size_t fileSize = pFile->getSize();
+
+        // Read section table.
+        SectionTableDesc tableDesc;
+        if (fileSize < sizeof(Header) + sizeof(tableDesc)) throw RuntimeError("Scene cache file '{}' is truncated.", cachePath);
+        std::memcpy(&tableDesc, pData + sizeof(Header), sizeof(tableDesc));
+        if (tableDesc.count == 0 || tableDesc.offset > fileSize || tableDesc.count > (fileSize - tableDesc.offset) / sizeof(SectionDesc))
+        {
+            throw RuntimeError("Invalid section table in scene cache file '{}'.", cachePath);
+        }
+        std::vector<SectionDesc> sectionDescs(tableDesc.count);
+        std::memcpy(sectionDescs.data(), pData + tableDesc.offset, tableDesc.count * sizeof(SectionDesc));
+        SectionReader sections(pFile, std::move(sectionDescs));
+
+        // Read metadata section, bulk data is read from the mapping on demand.
+        const auto& metadata = sections.getSection(0);
+        MemoryStreamBuffer buffer(sections.getData(metadata), metadata.size);
+        std::istream ms(&buffer);
+        if (metadata.compression == SectionCompression::Blocks)
+        {
+            BlockCompressedInputStream zs(ms);
+            InputStream stream(zs, &sections);
+            return readSceneData(stream);
+        }
+        else
+        {
+            InputStream stream(ms, &sections);
+            return readSceneData(stream);
+        }
+    }
+
+    const DiskCache::SharedPtr& SceneCache::getDiskCache()
+    {
+        static const DiskCache::SharedPtr pDiskCache = []()
+        {
+            uint64_t sizeLimit = kDefaultSizeLimit;
+            std::string value;
+            if (getEnvironmentVariable("FALCOR_SCENE_CACHE_SIZE_LIMIT", value))
+            {
+                try
+                {
+                    sizeLimit = (uint64_t)(std::stod(value) * 1024 * 1024 * 1024);
+                }
+                catch (const std::exception&)
+                {
+                    logWarning("Invalid FALCOR_SCENE_CACHE_SIZE_LIMIT '{}'. Using the default scene cache size limit.", value);
+                }
+            }
+            return DiskCache::create(getAppDataDirectory() / kDirectory, sizeLimit);
+        }();
+        return pDiskCache;
+    }
+
+    std::string SceneCache::getCacheName(const Key& key)
     {
-        std::stringstream ss;
-        ss << std::hex << std::setfill('0') << std::setw(2);
-        for (auto c : key) ss << (int)c;
-        return getAppDataDirectory() / kDirectory / ss.str();
+        return SHA1::toString(key);
+    }
+
+    std::string SceneCache::getKeyframeFileName(const Key& key)
+    {
+        return getCacheName(key) + kKeyframeFileExtension;
+    }
+
+    void SceneCache::writeKeyframeFile(const Scene::SceneData& sceneData, const Key& key)
+    {
+        const auto& pDiskCache = getDiskCache();
+        auto name = getKeyframeFileName(key);
+        auto tempPath = pDiskCache->createTempPath(name);
+        try
+        {
+            auto pFile = KeyframeFile::create(tempPath);
+            AnimatedVertexCache::writeKeyframes(*pFile, sceneData.cachedCurves, sceneData.cachedMeshes);
+            pFile->finish();
+        }
+        catch (...)
+        {
+            pDiskCache->discard(tempPath);
+            throw;
+        }
+
+        if (!pDiskCache->commit(name, tempPath)) throw RuntimeError("Failed to write keyframe file to '{}'.", pDiskCache->getEntryPath(name));
     }
 
     // SceneData
@@ -332,28 +710,40 @@ namespace Falcor
             stream.write(group.isStatic);
             stream.write(group.isDisplaced);
         }
+        // With a keyframe file, only the first keyframe of each vertex cache is stored in the scene cache file.
+        const bool keyframeFile = hasKeyframeFile(sceneData);
+        auto keyframeCount = [keyframeFile](const auto& vertexData) { return (uint32_t)(keyframeFile ? std::min<size_t>(vertexData.size(), 1) : vertexData.size()); };
         stream.write((uint32_t)sceneData.cachedMeshes.size());
         for (const auto& cachedMesh : sceneData.cachedMeshes)
         {
             stream.write(cachedMesh.meshID);
             stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            stream.write(keyframeCount(cachedMesh.vertexData));
+            for (uint32_t i = 0; i < keyframeCount(cachedMesh.vertexData); i++) stream.writeBulk(cachedMesh.vertexData[i]);
         }
         stream.write(sceneData.useCompressedHitInfo);
         stream.write(sceneData.has16BitIndices);
         stream.write(sceneData.has32BitIndices);
         stream.write(sceneData.meshDrawCount);
-        stream.write(sceneData.meshIndexData);
-        stream.write(sceneData.meshStaticData);
-        stream.write(sceneData.meshSkinningData);
+        stream.writeBulk(sceneData.meshIndexData);
+        stream.writeBulk(sceneData.meshStaticData);
+        stream.writeBulk(sceneData.meshSkinningData);
+        stream.write(sceneData.vertexCacheStatsBefore);
+        stream.write(sceneData.vertexCacheStatsAfter);
+        stream.write(sceneData.meshGroupSplitStats);
+        stream.writeBulk(sceneData.meshletDesc);
+        stream.writeBulk(sceneData.meshletOffsets);
+        stream.writeBulk(sceneData.meshletVertices);
+        stream.writeBulk(sceneData.meshletTriangles);
+        stream.writeBulk(sceneData.meshLODDesc);
+        stream.writeBulk(sceneData.meshLODOffsets);
 
         writeMarker(stream, "Curves");
         stream.write(sceneData.curveDesc);
         stream.write(sceneData.curveBBs);
         stream.write(sceneData.curveInstanceData);
-        stream.write(sceneData.curveIndexData);
-        stream.write(sceneData.curveStaticData);
+        stream.writeBulk(sceneData.curveIndexData);
+        stream.writeBulk(sceneData.curveStaticData);
 
         stream.write((uint32_t)sceneData.cachedCurves.size());
         for (const auto& cachedCurve : sceneData.cachedCurves)
@@ -362,14 +752,18 @@ namespace Falcor
             stream.write(cachedCurve.geometryID);
             stream.write(cachedCurve.timeSamples);
             stream.write(cachedCurve.indexData);
-            stream.write((uint32_t)cachedCurve.vertexData.size());
-            for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            stream.write(keyframeCount(cachedCurve.vertexData));
+            for (uint32_t i = 0; i < keyframeCount(cachedCurve.vertexData); i++) stream.writeBulk(cachedCurve.vertexData[i]);
         }
 
         writeMarker(stream, "CustomPrimitives");
         stream.write(sceneData.customPrimitiveDesc);
         stream.write(sceneData.customPrimitiveAABBs);
 
+        writeMarker(stream, "VertexCacheStreaming");
+        stream.write(sceneData.streamVertexCaches);
+        stream.write(sceneData.vertexCacheStreamingSettings);
+
         writeMarker(stream, "End");
     }
 
@@ -378,6 +772,9 @@ namespace Falcor
         Scene::SceneData sceneData;
         sceneData.pMaterials = MaterialSystem::create();
 
+        // Textures are not stored in the scene cache. Load them through the texture cache to skip decoding and mip generation.
+        sceneData.pMaterials->getTextureManager()->setTextureCache(TextureCache::getDefault());
+
         readMarker(stream, "Path");
         stream.read(sceneData.path);
 
@@ -459,22 +856,31 @@ namespace Falcor
             stream.read(cachedMesh.meshID);
             stream.read(cachedMesh.timeSamples);
             cachedMesh.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedMesh.vertexData) stream.read(data);
+            for (auto& data : cachedMesh.vertexData) stream.readBulk(data);
         }
         stream.read(sceneData.useCompressedHitInfo);
         stream.read(sceneData.has16BitIndices);
         stream.read(sceneData.has32BitIndices);
         stream.read(sceneData.meshDrawCount);
-        stream.read(sceneData.meshIndexData);
-        stream.read(sceneData.meshStaticData);
-        stream.read(sceneData.meshSkinningData);
+        stream.readBulk(sceneData.meshIndexData);
+        stream.readBulk(sceneData.meshStaticData);
+        stream.readBulk(sceneData.meshSkinningData);
+        stream.read(sceneData.vertexCacheStatsBefore);
+        stream.read(sceneData.vertexCacheStatsAfter);
+        stream.read(sceneData.meshGroupSplitStats);
+        stream.readBulk(sceneData.meshletDesc);
+        stream.readBulk(sceneData.meshletOffsets);
+        stream.readBulk(sceneData.meshletVertices);
+        stream.readBulk(sceneData.meshletTriangles);
+        stream.readBulk(sceneData.meshLODDesc);
+        stream.readBulk(sceneData.meshLODOffsets);
 
         readMarker(stream, "Curves");
         stream.read(sceneData.curveDesc);
         stream.read(sceneData.curveBBs);
         stream.read(sceneData.curveInstanceData);
-        stream.read(sceneData.curveIndexData);
-        stream.read(sceneData.curveStaticData);
+        stream.readBulk(sceneData.curveIndexData);
+        stream.readBulk(sceneData.curveStaticData);
 
         sceneData.cachedCurves.resize(stream.read<uint32_t>());
         for (auto& cachedCurve : sceneData.cachedCurves)
@@ -484,13 +890,17 @@ namespace Falcor
             stream.read(cachedCurve.timeSamples);
             stream.read(cachedCurve.indexData);
             cachedCurve.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedCurve.vertexData) stream.read(data);
+            for (auto& data : cachedCurve.vertexData) stream.readBulk(data);
         }
 
         readMarker(stream, "CustomPrimitives");
         stream.read(sceneData.customPrimitiveDesc);
         stream.read(sceneData.customPrimitiveAABBs);
 
+        readMarker(stream, "VertexCacheStreaming");
+        stream.read(sceneData.streamVertexCaches);
+        stream.read(sceneData.vertexCacheStreamingSettings);
+
         readMarker(stream, "End");
 
         pMaterialTextureLoader.reset();
@@ -813,7 +1223,9 @@ namespace Falcor
             stream.write((uint32_t)gridSequence.size());
             for (const auto& pGrid : gridSequence)
             {
-                uint32_t id = pGrid ? (uint32_t)std::distance(grids.begin(), std::find(grids.begin(), grids.end(), pGrid)) : uint32_t(-1);
+                // Streamed sequences only reference the resident grids of the scene.
+                auto it = std::find(grids.begin(), grids.end(), pGrid);
+                uint32_t id = pGrid && it != grids.end() ? (uint32_t)std::distance(grids.begin(), it) : uint32_t(-1);
                 stream.write(id);
             }
         }
@@ -821,6 +1233,13 @@ namespace Falcor
         stream.write(pGridVolume->mGridFrameCount);
         stream.write(pGridVolume->mBounds);
         stream.write(pGridVolume->mData);
+
+        stream.write(pGridVolume->mStreamingSettings);
+        for (const auto& streamed : pGridVolume->mStreamed)
+        {
+            stream.write(streamed.paths);
+            stream.write(streamed.gridname);
+        }
     }
 
     GridVolume::SharedPtr SceneCache::readGridVolume(InputStream& stream, const std::vector<Grid::SharedPtr>& grids)
@@ -846,6 +1265,15 @@ namespace Falcor
         stream.read(pGridVolume->mBounds);
         stream.read(pGridVolume->mData);
 
+        stream.read(pGridVolume->mStreamingSettings);
+        for (auto& streamed : pGridVolume->mStreamed)
+        {
+            stream.read(streamed.paths);
+            stream.read(streamed.gridname);
+            streamed.lastUse.resize(streamed.paths.size(), 0);
+            streamed.failed.resize(streamed.paths.size(), false);
+        }
+
         return pGridVolume;
     }
 
@@ -915,7 +1343,10 @@ namespace Falcor
         stream.write(pAnimation->mPostInfinityBehavior);
         stream.write(pAnimation->mInterpolationMode);
         stream.write(pAnimation->mEnableWarping);
-        stream.write(pAnimation->mKeyframes);
+        stream.write(pAnimation->mTimes);
+        stream.write(pAnimation->mTranslations);
+        stream.write(pAnimation->mScalings);
+        stream.write(pAnimation->mRotations);
     }
 
     Animation::SharedPtr SceneCache::readAnimation(InputStream& stream)
@@ -928,7 +1359,10 @@ namespace Falcor
         stream.read(pAnimation->mPostInfinityBehavior);
         stream.read(pAnimation->mInterpolationMode);
         stream.read(pAnimation->mEnableWarping);
-        stream.read(pAnimation->mKeyframes);
+        stream.read(pAnimation->mTimes);
+        stream.read(pAnimation->mTranslations);
+        stream.read(pAnimation->mScalings);
+        stream.read(pAnimation->mRotations);
         return pAnimation;
     }
 
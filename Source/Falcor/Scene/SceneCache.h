@@ -26,9 +26,12 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "Animation/KeyframeStream.h"
 #include "Material/BasicMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Utils/BlockCompressedStream.h"
 #include "Utils/CryptoUtils.h"
+#include "Utils/DiskCache.h"
 
 #include <filesystem>
 
@@ -43,6 +46,14 @@ namespace Falcor
     public:
         using Key = SHA1::MD;
 
+        /** Cache file format.
+        */
+        enum class Format : uint32_t
+        {
+            Stream = 0, ///< All scene data is serialized into a single block compressed stream.
+            Mapped = 1, ///< Section table with page-aligned raw sections for bulk geometry data. The file is memory mapped for reading and only the metadata is compressed.
+        };
+
         /** Check if there is a valid scene cache for a given cache key.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
@@ -50,22 +61,47 @@ namespace Falcor
         static bool hasValidCache(const Key& key);
 
         /** Write a scene cache.
+            If the scene data streams its vertex caches, the keyframes are written to a separate keyframe file next to the scene cache.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] format Cache file format.
+            \param[in] codec Codec used for compressing the cache. LZ4HC gives smaller archival caches at a higher write cost.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, Format format = Format::Stream, BlockCodec codec = BlockCodec::LZ4);
 
         /** Read a scene cache.
+            The file format is determined from the cache header.
             \param[in] key Cache key.
             \return Returns the loaded scene data.
         */
         static Scene::SceneData readCache(const Key& key);
 
+        /** Open the vertex cache keyframe file stored next to a scene cache.
+            The keyframe file is written by writeCache() if the scene data streams its vertex caches.
+            \param[in] key Cache key.
+            \return Returns the keyframe file, or nullptr if there is none.
+        */
+        static KeyframeFile::SharedPtr openKeyframeFile(const Key& key);
+
+        /** Set the maximum total size of all scene cache files in bytes.
+            Least recently used cache files are evicted once the limit is exceeded. The default limit is 64 GB and can be
+            overridden with the FALCOR_SCENE_CACHE_SIZE_LIMIT environment variable (in GB).
+        */
+        static void setSizeLimit(uint64_t sizeLimit);
+
+        static uint64_t getSizeLimit();
+
     private:
         class OutputStream;
         class InputStream;
 
-        static std::filesystem::path getCachePath(const Key& key);
+        static const DiskCache::SharedPtr& getDiskCache();
+        static std::string getCacheName(const Key& key);
+        static std::string getKeyframeFileName(const Key& key);
+        static void writeKeyframeFile(const Scene::SceneData& sceneData, const Key& key);
+
+        static void writeMappedCache(std::ostream& fs, const Scene::SceneData& sceneData, BlockCodec codec);
+        static Scene::SceneData readMappedCache(const std::filesystem::path& cachePath);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
         static Scene::SceneData readSceneData(InputStream& stream);
@@ -38,16 +38,16 @@ namespace Falcor
         return SharedPtr(new TriangleMesh());
     }
 
-    TriangleMesh::SharedPtr TriangleMesh::create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
+    TriangleMesh::SharedPtr TriangleMesh::create(VertexList vertices, IndexList indices, bool frontFaceCW)
     {
-        return SharedPtr(new TriangleMesh(vertices, indices, frontFaceCW));
+        return SharedPtr(new TriangleMesh(std::move(vertices), std::move(indices), frontFaceCW));
     }
 
     TriangleMesh::SharedPtr TriangleMesh::createDummy()
     {
         VertexList vertices = {{{0.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, 0.f}}};
         IndexList indices = {0, 0, 0};
-        return create(vertices, indices);
+        return create(std::move(vertices), std::move(indices));
     }
 
     TriangleMesh::SharedPtr TriangleMesh::createQuad(float2 size)
@@ -185,7 +185,7 @@ namespace Falcor
             }
         }
 
-        return create(vertices, indices);
+        return create(std::move(vertices), std::move(indices));
     }
 
     TriangleMesh::SharedPtr TriangleMesh::createFromFile(const std::filesystem::path& path, bool smoothNormals)
@@ -260,7 +260,7 @@ namespace Falcor
             }
         }
 
-        return create(vertices, indices);
+        return create(std::move(vertices), std::move(indices));
     }
 
     uint32_t TriangleMesh::addVertex(float3 position, float3 normal, float2 texCoord)
@@ -300,9 +300,9 @@ namespace Falcor
     TriangleMesh::TriangleMesh()
     {}
 
-    TriangleMesh::TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
-        : mVertices(vertices)
-        , mIndices(indices)
+    TriangleMesh::TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW)
+        : mVertices(std::move(vertices))
+        , mIndices(std::move(indices))
         , mFrontFaceCW(frontFaceCW)
     {}
 
@@ -60,7 +60,7 @@ namespace Falcor
             \param[in] frontFaceCW Triangle winding.
             \return Returns the triangle mesh.
         */
-        static SharedPtr create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW = false);
+        static SharedPtr create(VertexList vertices, IndexList indices, bool frontFaceCW = false);
 
         /** Creates a dummy mesh (single degenerate triangle).
             \return Returns the triangle mesh.
@@ -163,7 +163,7 @@ namespace Falcor
 
     private:
         TriangleMesh();
-        TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW);
+        TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW);
 
         std::string mName;
         std::vector<Vertex> mVertices;
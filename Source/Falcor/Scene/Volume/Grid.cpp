@@ -37,12 +37,16 @@
 #pragma warning(pop)
 #include <glm/gtc/type_ptr.hpp>
 #include "GridConverter.h"
+#include "Scene/AssetCache.h"
 
 
 namespace Falcor
 {
     namespace
     {
+        // Asset cache version of converted grids. Increment when the conversion changes.
+        const uint32_t kNanoVDBGridCacheVersion = 1;
+
         float3 cast(const nanovdb::Vec3f& v)
         {
             return float3(v[0], v[1], v[2]);
@@ -72,6 +76,16 @@ namespace Falcor
     }
 
     Grid::SharedPtr Grid::createFromFile(const std::filesystem::path& path, const std::string& gridname)
+    {
+        return loadFromFile(path, gridname, true);
+    }
+
+    Grid::SharedPtr Grid::createFromFileDeferred(const std::filesystem::path& path, const std::string& gridname)
+    {
+        return loadFromFile(path, gridname, false);
+    }
+
+    Grid::SharedPtr Grid::loadFromFile(const std::filesystem::path& path, const std::string& gridname, bool upload)
     {
         std::filesystem::path fullPath;
         if (!findFileInDataDirectories(path, fullPath))
@@ -82,11 +96,11 @@ namespace Falcor
 
         if (hasExtension(fullPath, "nvdb"))
         {
-            return createFromNanoVDBFile(fullPath, gridname);
+            return createFromNanoVDBFile(fullPath, gridname, upload);
         }
         else if (hasExtension(fullPath, "vdb"))
         {
-            return createFromOpenVDBFile(fullPath, gridname);
+            return createFromOpenVDBFile(fullPath, gridname, upload);
         }
         else
         {
@@ -185,7 +199,15 @@ namespace Falcor
         return glm::translate(float4x4(invAffine), -translation);
     }
 
-    Grid::Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    struct Grid::BrickConversion
+    {
+        using NanoVDBGridConverter = NanoVDBConverterBC4;
+        NanoVDBGridConverter converter;
+
+        BrickConversion(const nanovdb::FloatGrid* pFloatGrid) : converter(pFloatGrid) {}
+    };
+
+    Grid::Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, bool upload)
         : mGridHandle(std::move(gridHandle))
         , mpFloatGrid(mGridHandle.grid<float>())
         , mAccessor(mpFloatGrid->getAccessor())
@@ -195,6 +217,18 @@ namespace Falcor
             nanovdb::gridStats(*mpFloatGrid);
         }
 
+        mpBrickConversion = std::make_unique<BrickConversion>(mpFloatGrid);
+        mpBrickConversion->converter.convertBricks();
+
+        if (upload) uploadToDevice();
+    }
+
+    Grid::~Grid() = default;
+
+    void Grid::uploadToDevice()
+    {
+        if (isUploaded()) return;
+
         // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
         mpBuffer = Buffer::createStructured(
             sizeof(uint32_t),
@@ -203,11 +237,11 @@ namespace Falcor
             Buffer::CpuAccess::None,
             mGridHandle.data()
         );
-        using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert();
+        mBrickedGrid = mpBrickConversion->converter.createTextures();
+        mpBrickConversion.reset();
     }
 
-    Grid::SharedPtr Grid::createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname)
+    Grid::SharedPtr Grid::createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname, bool upload)
     {
         if (!nanovdb::io::hasGrid(path.string(), gridname))
         {
@@ -235,11 +269,30 @@ namespace Falcor
             return nullptr;
         }
 
-        return SharedPtr(new Grid(std::move(handle)));
+        return SharedPtr(new Grid(std::move(handle), upload));
     }
 
-    Grid::SharedPtr Grid::createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname)
+    Grid::SharedPtr Grid::createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname, bool upload)
     {
+        // Converting OpenVDB grids to NanoVDB is expensive. Look up the converted grid in the asset cache if enabled.
+        // When the cache is rebuilt, the grid is converted again and the entry is refreshed.
+        bool readAssetCache = true;
+        auto pAssetCache = AssetCache::getActive(&readAssetCache);
+        AssetCache::Key key;
+        if (pAssetCache)
+        {
+            key = AssetCache::KeyBuilder("NanoVDBGrid", kNanoVDBGridCacheVersion).addFile(path).add(gridname).getKey();
+            std::vector<uint8_t> data;
+            if (readAssetCache && pAssetCache->load(key, data))
+            {
+                auto buffer = nanovdb::HostBuffer::create(data.size());
+                std::memcpy(buffer.data(), data.data(), data.size());
+                nanovdb::GridHandle<nanovdb::HostBuffer> handle(std::move(buffer));
+                if (handle.grid<float>()) return SharedPtr(new Grid(std::move(handle), upload));
+                logWarning("Cached grid '{}' of '{}' is invalid, reconverting it.", gridname, path);
+            }
+        }
+
         openvdb::initialize();
 
         openvdb::io::File file(path.string());
@@ -278,7 +331,9 @@ namespace Falcor
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
         auto handle = nanovdb::openToNanoVDB(floatGrid);
 
-        return SharedPtr(new Grid(std::move(handle)));
+        if (pAssetCache) pAssetCache->store(key, handle.data(), handle.size());
+
+        return SharedPtr(new Grid(std::move(handle), upload));
     }
 
 
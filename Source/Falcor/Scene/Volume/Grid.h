@@ -45,6 +45,8 @@ namespace Falcor
     public:
         using SharedPtr = std::shared_ptr<Grid>;
 
+        ~Grid();
+
         /** Create a sphere voxel grid.
             \param[in] radius Radius of the sphere in world units.
             \param[in] voxelSize Size of a voxel in world units.
@@ -71,6 +73,23 @@ namespace Falcor
         */
         static SharedPtr createFromFile(const std::filesystem::path& path, const std::string& gridname);
 
+        /** Create a grid from a file without creating its GPU resources.
+            Unlike createFromFile(), this can be called from worker threads. The grid must be uploaded with uploadToDevice()
+            on the main thread before it is used for rendering.
+            \param[in] path File path of the grid. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return A new grid, or nullptr if the grid failed to load.
+        */
+        static SharedPtr createFromFileDeferred(const std::filesystem::path& path, const std::string& gridname);
+
+        /** Create the GPU resources of a grid created with createFromFileDeferred(). Does nothing if they already exist.
+        */
+        void uploadToDevice();
+
+        /** Check if the GPU resources of the grid exist.
+        */
+        bool isUploaded() const { return mpBuffer != nullptr; }
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -104,6 +123,10 @@ namespace Falcor
         */
         uint64_t getGridSizeInBytes() const;
 
+        /** Get the size of the NanoVDB grid in bytes as allocated in host memory.
+        */
+        uint64_t getHostSizeInBytes() const { return mGridHandle.size(); }
+
         /** Get the grid's bounds in world space.
         */
         AABB getWorldBounds() const;
@@ -127,10 +150,13 @@ namespace Falcor
         glm::mat4 getInvTransform() const;
 
     private:
-        Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        struct BrickConversion;
+
+        Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, bool upload = true);
 
-        static SharedPtr createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname);
-        static SharedPtr createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname);
+        static SharedPtr loadFromFile(const std::filesystem::path& path, const std::string& gridname, bool upload);
+        static SharedPtr createFromNanoVDBFile(const std::filesystem::path& path, const std::string& gridname, bool upload);
+        static SharedPtr createFromOpenVDBFile(const std::filesystem::path& path, const std::string& gridname, bool upload);
 
         // Host data.
         nanovdb::GridHandle<nanovdb::HostBuffer> mGridHandle;
@@ -139,6 +165,7 @@ namespace Falcor
         // Device data.
         Buffer::SharedPtr mpBuffer;
         BrickedGrid mBrickedGrid;
+        std::unique_ptr<BrickConversion> mpBrickConversion; ///< Bricks converted in host memory, pending upload.
 
         friend class SceneCache;
     };
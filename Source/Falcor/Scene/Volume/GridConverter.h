@@ -49,8 +49,18 @@ namespace Falcor
         NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
+        /** Convert the grid to bricks and create the textures.
+        */
         BrickedGrid convert();
 
+        /** Convert the grid to bricks in host memory. This does not use the GPU and can be called from any thread.
+        */
+        void convertBricks();
+
+        /** Create the textures from bricks converted with convertBricks().
+        */
+        BrickedGrid createTextures();
+
     private:
         const static uint kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int kBC4Compress = kBitsPerTexel == 4;
@@ -270,6 +280,13 @@ namespace Falcor
 
     template <typename TexelType, unsigned int kBitsPerTexel> typename
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert()
+    {
+        convertBricks();
+        return createTextures();
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertBricks()
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
         auto range = NumericRange<int>(0, mLeafDim[0].z);
@@ -277,7 +294,11 @@ namespace Falcor
         for (int mip = 1; mip < 4; ++mip) computeMip(mip);
         double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
         logInfo("converted in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
+    }
 
+    template <typename TexelType, unsigned int kBitsPerTexel> typename
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::createTextures()
+    {
         BrickedGrid bricks;
         bricks.range = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
         bricks.indirection = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "GridVolume.h"
+#include "Utils/Timing/CpuTimer.h"
 #include <filesystem>
 
 namespace Falcor
@@ -44,6 +45,8 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+        const uint64_t kMinStreamingMemoryBudget = uint64_t(1) << 20;
+        const uint32_t kInvalidGridIndex = std::numeric_limits<uint32_t>::max();
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -78,6 +81,41 @@ namespace Falcor
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
         }
 
+        if (isStreaming())
+        {
+            if (auto group = widget.group("Streaming"))
+            {
+                uint32_t residentCount = 0;
+                uint32_t gridCount = 0;
+                for (size_t slotIndex = 0; slotIndex < mGrids.size(); ++slotIndex)
+                {
+                    if (mStreamed[slotIndex].paths.empty()) continue;
+                    gridCount += (uint32_t)mGrids[slotIndex].size();
+                    residentCount += (uint32_t)std::count_if(mGrids[slotIndex].begin(), mGrids[slotIndex].end(), [](const auto& grid) { return grid != nullptr; });
+                }
+
+                const auto& stats = mStreamingStats;
+                std::ostringstream oss;
+                oss << "Resident grids: " << residentCount << " / " << gridCount << std::endl
+                    << "Resident memory: " << formatByteSize(getStreamedSizeInBytes()) << std::endl
+                    << "Hits: " << stats.hits << std::endl
+                    << "Stalls: " << stats.stalls << " (" << std::fixed << std::setprecision(2) << stats.stallTime << " ms)" << std::endl
+                    << "Loads: " << stats.loads << std::endl
+                    << "Evictions: " << stats.evictions << std::endl;
+                group.text(oss.str());
+
+                auto settings = mStreamingSettings;
+                uint64_t budgetMB = settings.memoryBudget >> 20;
+                bool changed = group.var("Memory budget (MB)", budgetMB, kMinStreamingMemoryBudget >> 20, std::numeric_limits<uint64_t>::max() >> 20);
+                changed |= group.var("Prefetch time (s)", settings.prefetchTime, 0.0, std::numeric_limits<double>::max(), 0.1);
+                if (changed)
+                {
+                    settings.memoryBudget = budgetMB << 20;
+                    setStreamingSettings(settings);
+                }
+            }
+        }
+
         if (const auto& densityGrid = getDensityGrid())
         {
             if (auto group = widget.group("Density Grid")) densityGrid->renderUI(group);
@@ -125,6 +163,12 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
     {
+        if (mStreamingSettings.enabled)
+        {
+            setStreamedSequence(slot, paths, gridname);
+            return (uint32_t)paths.size();
+        }
+
         GridSequence grids;
         for (const auto& path : paths)
         {
@@ -173,7 +217,10 @@ namespace Falcor
         uint32_t slotIndex = (uint32_t)slot;
         FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
 
-        if (mGrids[slotIndex] != grids)
+        bool wasStreamed = !mStreamed[slotIndex].paths.empty();
+        mStreamed[slotIndex] = {};
+
+        if (wasStreamed || mGrids[slotIndex] != grids)
         {
             mGrids[slotIndex] = grids;
             updateSequence();
@@ -210,18 +257,33 @@ namespace Falcor
     std::vector<Grid::SharedPtr> GridVolume::getAllGrids() const
     {
         std::set<Grid::SharedPtr> uniqueGrids;
-        for (const auto& grids : mGrids)
+        for (size_t slotIndex = 0; slotIndex < mGrids.size(); ++slotIndex)
         {
+            const auto& grids = mGrids[slotIndex];
+            if (!mStreamed[slotIndex].paths.empty())
+            {
+                if (const auto& grid = getGrid((GridSlot)slotIndex)) uniqueGrids.insert(grid);
+                continue;
+            }
             std::copy_if(grids.begin(), grids.end(), std::inserter(uniqueGrids, uniqueGrids.begin()), [] (const auto& grid) { return grid != nullptr; });
         }
         return std::vector<Grid::SharedPtr>(uniqueGrids.begin(), uniqueGrids.end());
     }
 
     void GridVolume::setGridFrame(uint32_t gridFrame)
+    {
+        // Manual frame changes (script/UI) have no inherent direction, guess it from the shortest way around the sequence.
+        uint32_t delta = (gridFrame + mGridFrameCount - mGridFrame) % mGridFrameCount;
+        changeGridFrame(gridFrame, delta <= mGridFrameCount / 2);
+    }
+
+    void GridVolume::changeGridFrame(uint32_t gridFrame, bool playbackForward)
     {
         if (mGridFrame != gridFrame)
         {
+            mPlaybackForward = playbackForward;
             mGridFrame = gridFrame;
+            updateStreaming(true);
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -243,8 +305,48 @@ namespace Falcor
         if (mPlaybackEnabled && frameCount > 0)
         {
             uint32_t frameIndex = (uint32_t)std::floor(std::max(0.0, currentTime) * mFrameRate) % frameCount;
-            setGridFrame(frameIndex);
+            // Playback always advances forward, also when wrapping around to the start of the sequence.
+            changeGridFrame(frameIndex, true);
+        }
+
+        // Pick up grids that finished loading in the meantime.
+        updateStreaming();
+    }
+
+    void GridVolume::setStreamingSettings(const StreamingSettings& settings)
+    {
+        checkArgument(settings.memoryBudget >= kMinStreamingMemoryBudget, "'memoryBudget' must be at least {}.", formatByteSize(kMinStreamingMemoryBudget));
+        checkArgument(settings.prefetchTime >= 0.0, "'prefetchTime' must be non-negative.");
+
+        mStreamingSettings = settings;
+        updateStreaming();
+    }
+
+    bool GridVolume::isStreaming() const
+    {
+        return std::any_of(mStreamed.begin(), mStreamed.end(), [](const auto& streamed) { return !streamed.paths.empty(); });
+    }
+
+    bool GridVolume::isStreaming(GridSlot slot) const
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        return !mStreamed[slotIndex].paths.empty();
+    }
+
+    uint64_t GridVolume::getStreamedSizeInBytes() const
+    {
+        uint64_t size = 0;
+        for (size_t slotIndex = 0; slotIndex < mGrids.size(); ++slotIndex)
+        {
+            if (mStreamed[slotIndex].paths.empty()) continue;
+            for (const auto& grid : mGrids[slotIndex])
+            {
+                if (grid) size += grid->getGridSizeInBytes() + grid->getHostSizeInBytes();
+            }
         }
+        return size;
     }
 
     void GridVolume::setDensityScale(float densityScale)
@@ -319,6 +421,237 @@ namespace Falcor
         }
     }
 
+    void GridVolume::setStreamedSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname)
+    {
+        uint32_t slotIndex = (uint32_t)slot;
+        FALCOR_ASSERT(slotIndex >= 0 && slotIndex < (uint32_t)GridSlot::Count);
+
+        auto& streamed = mStreamed[slotIndex];
+        streamed = {};
+        streamed.paths = paths;
+        streamed.gridname = gridname;
+        streamed.lastUse.resize(paths.size(), 0);
+        streamed.failed.resize(paths.size(), false);
+
+        mGrids[slotIndex] = GridSequence(paths.size());
+        updateSequence();
+        updateStreaming();
+        updateBounds();
+        markUpdates(UpdateFlags::GridsChanged);
+    }
+
+    std::vector<uint32_t> GridVolume::getStreamingWindow() const
+    {
+        // Estimate the size of a frame from the resident grids.
+        uint64_t frameSize = 0;
+        for (size_t slotIndex = 0; slotIndex < mGrids.size(); ++slotIndex)
+        {
+            if (mStreamed[slotIndex].paths.empty()) continue;
+            uint64_t size = 0;
+            uint64_t count = 0;
+            for (const auto& grid : mGrids[slotIndex])
+            {
+                if (!grid) continue;
+                size += grid->getGridSizeInBytes() + grid->getHostSizeInBytes();
+                count++;
+            }
+            if (count > 0) frameSize += size / count;
+        }
+
+        // The window starts at the current frame and continues in playback direction for the prefetch time, limited by the memory budget.
+        // Without a size estimate, i.e. if no grid could be loaded yet, nothing is prefetched.
+        uint64_t frameCount = (uint64_t)std::ceil(mStreamingSettings.prefetchTime * mFrameRate) + 1;
+        frameCount = frameSize > 0 ? std::min(frameCount, std::max(mStreamingSettings.memoryBudget / frameSize, (uint64_t)1)) : 1;
+        frameCount = std::min(frameCount, (uint64_t)mGridFrameCount);
+
+        std::vector<uint32_t> window;
+        window.reserve(frameCount);
+        for (uint32_t i = 0; i < (uint32_t)frameCount; ++i)
+        {
+            uint32_t offset = mPlaybackForward ? i : mGridFrameCount - i;
+            window.push_back((mGridFrame + offset) % mGridFrameCount);
+        }
+        return window;
+    }
+
+    void GridVolume::updateStreaming(bool frameChanged)
+    {
+        if (!isStreaming()) return;
+
+        mStreamingUpdate++;
+
+        // Make the grids of the current frame resident first, waiting for them to load if necessary.
+        // Their sizes seed the frame size estimate of the streaming window, so the first window also respects the memory budget.
+        bool stalled = false;
+        bool currentChanged = false;
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)mGrids.size(); ++slotIndex)
+        {
+            auto& streamed = mStreamed[slotIndex];
+            if (streamed.paths.empty()) continue;
+
+            uint32_t currentIndex = std::min(mGridFrame, (uint32_t)mGrids[slotIndex].size() - 1);
+            if (!mGrids[slotIndex][currentIndex] && !streamed.failed[currentIndex])
+            {
+                auto it = streamed.pending.find(currentIndex);
+                if (it == streamed.pending.end() || it->second.task.isRunning()) stalled = true;
+                makeResident(slotIndex, currentIndex);
+                if (mGrids[slotIndex][currentIndex]) currentChanged = true;
+            }
+            streamed.lastUse[currentIndex] = mStreamingUpdate;
+        }
+
+        // Let the scene bind grids that became resident outside of a frame change.
+        if (currentChanged && !frameChanged) markUpdates(UpdateFlags::GridsChanged);
+
+        const auto window = getStreamingWindow();
+
+        // Map the frames of the window to the grids of each slot. Shorter sequences hold their last grid.
+        std::array<std::vector<uint32_t>, (size_t)GridSlot::Count> gridWindows;
+        for (size_t slotIndex = 0; slotIndex < mGrids.size(); ++slotIndex)
+        {
+            if (mStreamed[slotIndex].paths.empty()) continue;
+            auto& gridWindow = gridWindows[slotIndex];
+            for (uint32_t frame : window)
+            {
+                uint32_t gridIndex = std::min(frame, (uint32_t)mGrids[slotIndex].size() - 1);
+                if (std::find(gridWindow.begin(), gridWindow.end(), gridIndex) == gridWindow.end()) gridWindow.push_back(gridIndex);
+            }
+        }
+
+        for (uint32_t slotIndex = 0; slotIndex < (uint32_t)mGrids.size(); ++slotIndex)
+        {
+            auto& streamed = mStreamed[slotIndex];
+            if (streamed.paths.empty()) continue;
+
+            auto& grids = mGrids[slotIndex];
+            const auto& gridWindow = gridWindows[slotIndex];
+            auto isInWindow = [&gridWindow](uint32_t gridIndex) { return std::find(gridWindow.begin(), gridWindow.end(), gridIndex) != gridWindow.end(); };
+
+            // Upload the grids that finished loading and drop the loads that fell out of the window.
+            for (auto it = streamed.pending.begin(); it != streamed.pending.end();)
+            {
+                if (!isInWindow(it->first))
+                {
+                    // Running loads keep their own reference to the grid, which has no GPU resources yet, so dropping them is safe.
+                    it = streamed.pending.erase(it);
+                    continue;
+                }
+                if (it->second.task.isRunning())
+                {
+                    ++it;
+                    continue;
+                }
+                uint32_t gridIndex = (it++)->first;
+                makeResident(slotIndex, gridIndex);
+            }
+
+            // Start loading the upcoming grids on worker threads.
+            // Without a thread pool, grids are only loaded on demand.
+            if (Threading::getThreadCount() > 0)
+            {
+                for (uint32_t gridIndex : gridWindow)
+                {
+                    if (grids[gridIndex] || streamed.failed[gridIndex] || streamed.pending.count(gridIndex) > 0) continue;
+
+                    PendingGrid pending;
+                    pending.pGrid = std::make_shared<Grid::SharedPtr>();
+                    pending.task = Threading::dispatchTask([path = streamed.paths[gridIndex], gridname = streamed.gridname, pGrid = pending.pGrid]()
+                    {
+                        *pGrid = Grid::createFromFileDeferred(path, gridname);
+                    });
+                    streamed.pending.emplace(gridIndex, std::move(pending));
+                }
+            }
+        }
+
+        if (frameChanged)
+        {
+            if (stalled)
+            {
+                mStreamingStats.stalls++;
+                mStreamingStats.stallTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+            }
+            else
+            {
+                mStreamingStats.hits++;
+            }
+        }
+
+        // Evict the least recently used grids outside the window until the resident grids fit in the memory budget.
+        uint64_t size = getStreamedSizeInBytes();
+        while (size > mStreamingSettings.memoryBudget)
+        {
+            uint32_t lruSlot = 0;
+            uint32_t lruIndex = kInvalidGridIndex;
+            for (uint32_t slotIndex = 0; slotIndex < (uint32_t)mGrids.size(); ++slotIndex)
+            {
+                const auto& streamed = mStreamed[slotIndex];
+                if (streamed.paths.empty()) continue;
+
+                const auto& grids = mGrids[slotIndex];
+                const auto& gridWindow = gridWindows[slotIndex];
+                for (uint32_t gridIndex = 0; gridIndex < (uint32_t)grids.size(); ++gridIndex)
+                {
+                    if (!grids[gridIndex] || std::find(gridWindow.begin(), gridWindow.end(), gridIndex) != gridWindow.end()) continue;
+                    if (lruIndex == kInvalidGridIndex || streamed.lastUse[gridIndex] < mStreamed[lruSlot].lastUse[lruIndex])
+                    {
+                        lruSlot = slotIndex;
+                        lruIndex = gridIndex;
+                    }
+                }
+            }
+            if (lruIndex == kInvalidGridIndex) break;
+
+            auto& grid = mGrids[lruSlot][lruIndex];
+            size -= grid->getGridSizeInBytes() + grid->getHostSizeInBytes();
+            grid = nullptr;
+            mStreamingStats.evictions++;
+        }
+    }
+
+    void GridVolume::makeResident(uint32_t slotIndex, uint32_t gridIndex)
+    {
+        auto& streamed = mStreamed[slotIndex];
+        auto& grid = mGrids[slotIndex][gridIndex];
+        FALCOR_ASSERT(!grid);
+
+        Grid::SharedPtr pGrid;
+        try
+        {
+            auto it = streamed.pending.find(gridIndex);
+            if (it != streamed.pending.end())
+            {
+                auto pending = std::move(it->second);
+                streamed.pending.erase(it);
+                pending.task.finish();
+                pGrid = *pending.pGrid;
+            }
+            else
+            {
+                pGrid = Grid::createFromFileDeferred(streamed.paths[gridIndex], streamed.gridname);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to load grid '{}' from '{}': {}", streamed.gridname, streamed.paths[gridIndex], e.what());
+        }
+
+        if (!pGrid)
+        {
+            // Don't try to load the grid again, the frame stays empty like with keepEmpty.
+            streamed.failed[gridIndex] = true;
+            return;
+        }
+
+        // GPU resources are created on the main thread.
+        pGrid->uploadToDevice();
+        grid = pGrid;
+        streamed.lastUse[gridIndex] = mStreamingUpdate;
+        mStreamingStats.loads++;
+    }
+
     void GridVolume::updateSequence()
     {
         mGridFrameCount = 1;
@@ -364,6 +697,13 @@ namespace Falcor
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Animatable)
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Grid)
 
+        ScriptBindings::SerializableStruct<GridVolume::StreamingSettings> streamingSettings(m, "GridVolumeStreamingSettings");
+#define field(f_) field(#f_, &GridVolume::StreamingSettings::f_)
+        streamingSettings.field(enabled);
+        streamingSettings.field(memoryBudget);
+        streamingSettings.field(prefetchTime);
+#undef field
+
         pybind11::class_<GridVolume, Animatable, GridVolume::SharedPtr> volume(m, "GridVolume");
         volume.def_property("name", &GridVolume::getName, &GridVolume::setName);
         volume.def_property("gridFrame", &GridVolume::getGridFrame, &GridVolume::setGridFrame);
@@ -378,6 +718,8 @@ namespace Falcor
         volume.def_property("anisotropy", &GridVolume::getAnisotropy, &GridVolume::setAnisotropy);
         volume.def_property("emissionMode", &GridVolume::getEmissionMode, &GridVolume::setEmissionMode);
         volume.def_property("emissionTemperature", &GridVolume::getEmissionTemperature, &GridVolume::setEmissionTemperature);
+        volume.def_property("streamingSettings", &GridVolume::getStreamingSettings, &GridVolume::setStreamingSettings);
+        volume.def_property_readonly("streaming", pybind11::overload_cast<>(&GridVolume::isStreaming, pybind11::const_));
         volume.def(pybind11::init(&GridVolume::create), "name"_a);
         volume.def("loadGrid", &GridVolume::loadGrid, "slot"_a, "path"_a, "gridname"_a);
         volume.def("loadGridSequence",
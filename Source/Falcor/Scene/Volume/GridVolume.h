@@ -29,8 +29,10 @@
 #include "Grid.h"
 #include "GridVolumeData.slang"
 #include "Scene/Animation/Animatable.h"
+#include "Utils/Threading.h"
 
 #include <filesystem>
+#include <map>
 
 namespace Falcor
 {
@@ -39,6 +41,8 @@ namespace Falcor
         The emission is defined by an emission voxel grid and additional parameters.
         Grids are stored in grid slots (density, emission) and can either be static, using one grid per slot,
         or dynamic, using a sequence of grids per slot.
+        Grid sequences loaded from files can optionally be streamed, in which case only a window of frames
+        starting at the current frame is resident and the upcoming frames are loaded on worker threads.
     */
     class FALCOR_API GridVolume : public Animatable
     {
@@ -68,6 +72,26 @@ namespace Falcor
             Count // Must be last
         };
 
+        /** Settings for streaming grid sequences.
+        */
+        struct StreamingSettings
+        {
+            bool enabled = false;                                   ///< Stream grid sequences loaded with loadGridSequence() instead of loading all frames up front.
+            uint64_t memoryBudget = 2ull * 1024 * 1024 * 1024;      ///< Memory budget in bytes for the resident frames of all grid slots.
+            double prefetchTime = 1.0;                              ///< Playback time in seconds to load ahead of the current frame.
+        };
+
+        /** Grid sequence streaming statistics.
+        */
+        struct StreamingStats
+        {
+            uint64_t hits = 0;          ///< Number of frame switches where the grids were resident or loaded in time.
+            uint64_t stalls = 0;        ///< Number of frame switches that waited for grids to load.
+            uint64_t loads = 0;         ///< Number of grids loaded.
+            uint64_t evictions = 0;     ///< Number of grids evicted.
+            double stallTime = 0.0;     ///< Total time in ms spent waiting for grids to load.
+        };
+
         /** Specifies how emission is rendered.
         */
         enum class EmissionMode
@@ -113,6 +137,7 @@ namespace Falcor
 
         /** Load a sequence of grids from files to a grid slot.
             Note: This will replace any existing grid sequence for that slot.
+            If streaming is enabled, the grids are loaded on demand and frames that cannot be loaded are always kept empty.
             \param[in] slot Grid slot.
             \param[in] paths File paths of the grids. Can also include a full path or relative path from a data directory.
             \param[in] gridname Name of the grid to load.
@@ -136,6 +161,7 @@ namespace Falcor
         void setGridSequence(GridSlot slot, const GridSequence& grids);
 
         /** Get the grid sequence for the specified slot.
+            Note: For streamed sequences, frames that are not resident are empty (nullptr).
         */
         const GridSequence& getGridSequence(GridSlot slot) const;
 
@@ -149,6 +175,7 @@ namespace Falcor
         const Grid::SharedPtr& getGrid(GridSlot slot) const;
 
         /** Get a list of all grids used for this volume.
+            Note: For streamed sequences, only the grid of the current frame is included.
         */
         std::vector<Grid::SharedPtr> getAllGrids() const;
 
@@ -182,9 +209,35 @@ namespace Falcor
         bool isPlaybackEnabled() const { return mPlaybackEnabled; }
 
         /** Update the selected grid frame based on global time in seconds.
+            This also picks up the grids of streamed sequences that finished loading.
         */
         void updatePlayback(double curentTime);
 
+        /** Set the grid sequence streaming settings.
+            The settings apply to sequences loaded after this call. The memory budget and prefetch time also apply to sequences that are already streamed.
+        */
+        void setStreamingSettings(const StreamingSettings& settings);
+
+        /** Get the grid sequence streaming settings.
+        */
+        const StreamingSettings& getStreamingSettings() const { return mStreamingSettings; }
+
+        /** Check if any of the grid slots holds a streamed sequence.
+        */
+        bool isStreaming() const;
+
+        /** Check if the specified grid slot holds a streamed sequence.
+        */
+        bool isStreaming(GridSlot slot) const;
+
+        /** Get the grid sequence streaming statistics.
+        */
+        const StreamingStats& getStreamingStats() const { return mStreamingStats; }
+
+        /** Get the size in bytes of the resident grids of streamed sequences, including both host and device memory.
+        */
+        uint64_t getStreamedSizeInBytes() const;
+
         /** Set the density grid.
         */
         void setDensityGrid(const Grid::SharedPtr& densityGrid) { setGrid(GridSlot::Density, densityGrid); };
@@ -262,6 +315,27 @@ namespace Falcor
     private:
         GridVolume(const std::string& name);
 
+        struct PendingGrid
+        {
+            Threading::Task task;
+            std::shared_ptr<Grid::SharedPtr> pGrid;         ///< Grid written by the task.
+        };
+
+        struct StreamedSequence
+        {
+            std::vector<std::filesystem::path> paths;       ///< File paths of the grids. Empty if the slot is not streamed.
+            std::string gridname;
+            std::vector<uint64_t> lastUse;                  ///< Last streaming update that used each grid.
+            std::vector<bool> failed;                       ///< Grids that failed to load.
+            std::map<uint32_t, PendingGrid> pending;        ///< Grids being loaded on worker threads.
+        };
+
+        void changeGridFrame(uint32_t gridFrame, bool playbackForward);
+        void setStreamedSequence(GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname);
+        void updateStreaming(bool frameChanged = false);
+        void makeResident(uint32_t slotIndex, uint32_t gridIndex);
+        std::vector<uint32_t> getStreamingWindow() const;
+
         void updateSequence();
         void updateBounds();
 
@@ -274,10 +348,17 @@ namespace Falcor
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
         bool mPlaybackEnabled = false;
+        bool mPlaybackForward = true;
         AABB mBounds;
         GridVolumeData mData;
         mutable UpdateFlags mUpdates = UpdateFlags::None;
 
+        // Streaming
+        StreamingSettings mStreamingSettings;
+        StreamingStats mStreamingStats;
+        std::array<StreamedSequence, (size_t)GridSlot::Count> mStreamed;
+        uint64_t mStreamingUpdate = 0;
+
         friend class SceneCache;
     };
 
@@ -0,0 +1,448 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "BlockCompressedStream.h"
+#include "Utils/Threading.h"
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <deque>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kHeaderMagic[4] = { 'F', 'B', 'C', 'S' };
+        const char kFooterMagic[4] = { 'F', 'B', 'C', 'E' };
+
+        struct StreamHeader
+        {
+            char magic[4]{};
+            BlockCodec codec = BlockCodec::LZ4;
+            uint32_t blockSize = 0;
+            uint32_t reserved = 0;
+        };
+
+        /** Header of a single block frame.
+            A frame with rawSize == 0 terminates the block sequence.
+            If compressedSize == rawSize the block is stored uncompressed.
+        */
+        struct FrameHeader
+        {
+            uint32_t rawSize = 0;
+            uint32_t compressedSize = 0;
+        };
+
+        /** Footer written after the block index.
+        */
+        struct StreamFooter
+        {
+            uint64_t blockCount = 0;
+            uint64_t rawSize = 0;
+            char magic[4]{};
+            uint32_t reserved = 0;
+        };
+
+        struct Block
+        {
+            std::vector<char> raw;
+            std::vector<char> compressed;
+            uint32_t compressedSize = 0;
+            Threading::Task task;
+        };
+
+        /** Number of blocks kept in flight per worker thread.
+        */
+        const size_t kBlocksPerThread = 2;
+
+        size_t getMaxBlocksInFlight()
+        {
+            return std::max<size_t>(Threading::getThreadCount(), 1) * kBlocksPerThread;
+        }
+
+        void compressBlock(Block& block, BlockCodec codec)
+        {
+            int rawSize = (int)block.raw.size();
+            block.compressed.resize(LZ4_compressBound(rawSize));
+            int compressedSize = 0;
+            switch (codec)
+            {
+            case BlockCodec::LZ4:
+                compressedSize = LZ4_compress_default(block.raw.data(), block.compressed.data(), rawSize, (int)block.compressed.size());
+                break;
+            case BlockCodec::LZ4HC:
+                compressedSize = LZ4_compress_HC(block.raw.data(), block.compressed.data(), rawSize, (int)block.compressed.size(), LZ4HC_CLEVEL_DEFAULT);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+            }
+            if (compressedSize <= 0) throw RuntimeError("Failed to compress block.");
+
+            // Store incompressible blocks as raw data.
+            if (compressedSize >= rawSize)
+            {
+                block.compressed.clear();
+                block.compressedSize = (uint32_t)rawSize;
+            }
+            else
+            {
+                block.compressedSize = (uint32_t)compressedSize;
+            }
+        }
+
+        void decompressBlock(Block& block)
+        {
+            if (block.compressedSize == block.raw.size())
+            {
+                std::memcpy(block.raw.data(), block.compressed.data(), block.raw.size());
+                return;
+            }
+            int size = LZ4_decompress_safe(block.compressed.data(), block.raw.data(), (int)block.compressedSize, (int)block.raw.size());
+            if (size != (int)block.raw.size()) throw RuntimeError("Failed to decompress block.");
+        }
+    }
+
+    // BlockCompressedOutputStream
+
+    class BlockCompressedOutputStream::Buffer : public std::streambuf
+    {
+    public:
+        Buffer(std::ostream& stream, BlockCodec codec, size_t blockSize)
+            : mStream(stream)
+            , mCodec(codec)
+            , mBlockSize(blockSize)
+        {
+            checkArgument(blockSize > 0 && blockSize <= (size_t)LZ4_MAX_INPUT_SIZE, "'blockSize' ({}) is out of range.", blockSize);
+
+            StreamHeader header;
+            std::memcpy(header.magic, kHeaderMagic, sizeof(header.magic));
+            header.codec = codec;
+            header.blockSize = (uint32_t)blockSize;
+            writeRaw(&header, sizeof(header));
+
+            startBlock();
+        }
+
+        void close()
+        {
+            if (mClosed) return;
+            mClosed = true;
+
+            submitBlock();
+            while (!mPending.empty()) writeFront();
+
+            FrameHeader terminator;
+            writeRaw(&terminator, sizeof(terminator));
+
+            // Write the index of frame offsets relative to the stream start, followed by the footer.
+            writeRaw(mFrameOffsets.data(), mFrameOffsets.size() * sizeof(uint64_t));
+            StreamFooter footer;
+            footer.blockCount = mFrameOffsets.size();
+            footer.rawSize = mRawSize;
+            std::memcpy(footer.magic, kFooterMagic, sizeof(footer.magic));
+            writeRaw(&footer, sizeof(footer));
+        }
+
+        uint64_t getRawSize() const { return mRawSize + (pptr() - pbase()); }
+        uint64_t getCompressedSize() const { return mCompressedSize; }
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            if (mClosed) return traits_type::eof();
+            submitBlock();
+            startBlock();
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            std::streamsize written = 0;
+            while (written < n)
+            {
+                if (pptr() == epptr() && traits_type::eq_int_type(overflow(traits_type::eof()), traits_type::eof())) break;
+                std::streamsize count = std::min<std::streamsize>(n - written, epptr() - pptr());
+                std::memcpy(pptr(), s + written, (size_t)count);
+                pbump((int)count);
+                written += count;
+            }
+            return written;
+        }
+
+    private:
+        void writeRaw(const void* data, size_t size)
+        {
+            mStream.write(reinterpret_cast<const char*>(data), size);
+            mCompressedSize += size;
+        }
+
+        void startBlock()
+        {
+            mpCurrent = std::make_shared<Block>();
+            mpCurrent->raw.resize(mBlockSize);
+            setp(mpCurrent->raw.data(), mpCurrent->raw.data() + mBlockSize);
+        }
+
+        void submitBlock()
+        {
+            size_t size = pptr() - pbase();
+            setp(nullptr, nullptr);
+            if (size == 0) return;
+
+            auto pBlock = mpCurrent;
+            mpCurrent = nullptr;
+            pBlock->raw.resize(size);
+            mRawSize += size;
+
+            if (Threading::getThreadCount() > 0)
+            {
+                BlockCodec codec = mCodec;
+                pBlock->task = Threading::dispatchTask([pBlock, codec]() { compressBlock(*pBlock, codec); });
+            }
+            else
+            {
+                compressBlock(*pBlock, mCodec);
+            }
+            mPending.push_back(pBlock);
+
+            // Write out finished blocks in order and bound the number of blocks in flight.
+            while (!mPending.empty() && (mPending.size() > getMaxBlocksInFlight() || !isPending(*mPending.front()))) writeFront();
+        }
+
+        static bool isPending(Block& block)
+        {
+            return block.task.isValid() && block.task.isRunning();
+        }
+
+        void writeFront()
+        {
+            auto pBlock = mPending.front();
+            mPending.pop_front();
+            if (pBlock->task.isValid()) pBlock->task.finish();
+
+            mFrameOffsets.push_back(mCompressedSize);
+            FrameHeader frame;
+            frame.rawSize = (uint32_t)pBlock->raw.size();
+            frame.compressedSize = pBlock->compressedSize;
+            writeRaw(&frame, sizeof(frame));
+            if (pBlock->compressed.empty()) writeRaw(pBlock->raw.data(), pBlock->raw.size());
+            else writeRaw(pBlock->compressed.data(), pBlock->compressedSize);
+        }
+
+        std::ostream& mStream;
+        BlockCodec mCodec;
+        size_t mBlockSize;
+
+        std::shared_ptr<Block> mpCurrent;
+        std::deque<std::shared_ptr<Block>> mPending;
+        std::vector<uint64_t> mFrameOffsets;
+        uint64_t mRawSize = 0;
+        uint64_t mCompressedSize = 0;
+        bool mClosed = false;
+    };
+
+    BlockCompressedOutputStream::BlockCompressedOutputStream(std::ostream& stream, BlockCodec codec, size_t blockSize)
+        : std::ostream(nullptr)
+        , mpBuffer(std::make_unique<Buffer>(stream, codec, blockSize))
+    {
+        rdbuf(mpBuffer.get());
+        exceptions(std::ios::badbit);
+    }
+
+    BlockCompressedOutputStream::~BlockCompressedOutputStream()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception& e)
+        {
+            logError("Failed to close block compressed stream: {}", e.what());
+        }
+    }
+
+    void BlockCompressedOutputStream::close()
+    {
+        mpBuffer->close();
+    }
+
+    uint64_t BlockCompressedOutputStream::getRawSize() const
+    {
+        return mpBuffer->getRawSize();
+    }
+
+    uint64_t BlockCompressedOutputStream::getCompressedSize() const
+    {
+        return mpBuffer->getCompressedSize();
+    }
+
+    // BlockCompressedInputStream
+
+    class BlockCompressedInputStream::Buffer : public std::streambuf
+    {
+    public:
+        Buffer(std::istream& stream)
+            : mStream(stream)
+        {
+            StreamHeader header;
+            readRaw(&header, sizeof(header));
+            if (std::memcmp(header.magic, kHeaderMagic, sizeof(header.magic)) != 0) throw RuntimeError("Invalid block compressed stream header.");
+            if (header.codec != BlockCodec::LZ4 && header.codec != BlockCodec::LZ4HC) throw RuntimeError("Unknown block codec {}.", (uint32_t)header.codec);
+            mBlockSize = header.blockSize;
+        }
+
+        ~Buffer()
+        {
+            // Make sure no task references a block anymore.
+            for (auto& pBlock : mPending)
+            {
+                try
+                {
+                    if (pBlock->task.isValid()) pBlock->task.finish();
+                }
+                catch (...) {}
+            }
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+            mpCurrent = nullptr;
+            readFrames();
+            if (mPending.empty()) return traits_type::eof();
+
+            mpCurrent = mPending.front();
+            mPending.pop_front();
+            if (mpCurrent->task.isValid()) mpCurrent->task.finish();
+
+            // Keep the pipeline full while the consumer works on the current block.
+            readFrames();
+
+            char* p = mpCurrent->raw.data();
+            setg(p, p, p + mpCurrent->raw.size());
+            return traits_type::to_int_type(*gptr());
+        }
+
+        std::streamsize xsgetn(char* s, std::streamsize n) override
+        {
+            std::streamsize read = 0;
+            while (read < n)
+            {
+                if (gptr() == egptr() && traits_type::eq_int_type(underflow(), traits_type::eof())) break;
+                std::streamsize count = std::min<std::streamsize>(n - read, egptr() - gptr());
+                std::memcpy(s + read, gptr(), (size_t)count);
+                gbump((int)count);
+                read += count;
+            }
+            return read;
+        }
+
+    private:
+        void readRaw(void* data, size_t size)
+        {
+            mStream.read(reinterpret_cast<char*>(data), size);
+            if ((size_t)mStream.gcount() != size) throw RuntimeError("Unexpected end of block compressed stream.");
+        }
+
+        void readFrames()
+        {
+            while (!mEnd && mPending.size() < getMaxBlocksInFlight())
+            {
+                FrameHeader frame;
+                readRaw(&frame, sizeof(frame));
+                if (frame.rawSize == 0)
+                {
+                    readIndex();
+                    mEnd = true;
+                    break;
+                }
+                if (frame.rawSize > mBlockSize || frame.compressedSize > (uint32_t)LZ4_compressBound((int)frame.rawSize))
+                {
+                    throw RuntimeError("Invalid frame in block compressed stream.");
+                }
+
+                auto pBlock = std::make_shared<Block>();
+                pBlock->compressed.resize(frame.compressedSize);
+                pBlock->compressedSize = frame.compressedSize;
+                pBlock->raw.resize(frame.rawSize);
+                readRaw(pBlock->compressed.data(), frame.compressedSize);
+                mBlockCount++;
+                mRawSize += frame.rawSize;
+
+                if (Threading::getThreadCount() > 0)
+                {
+                    pBlock->task = Threading::dispatchTask([pBlock]() { decompressBlock(*pBlock); });
+                }
+                else
+                {
+                    decompressBlock(*pBlock);
+                }
+                mPending.push_back(pBlock);
+            }
+        }
+
+        void readIndex()
+        {
+            // Frames are read sequentially, the index is only used to check that the stream is complete.
+            std::vector<uint64_t> frameOffsets(mBlockCount);
+            readRaw(frameOffsets.data(), frameOffsets.size() * sizeof(uint64_t));
+            StreamFooter footer;
+            readRaw(&footer, sizeof(footer));
+            if (std::memcmp(footer.magic, kFooterMagic, sizeof(footer.magic)) != 0 || footer.blockCount != mBlockCount || footer.rawSize != mRawSize)
+            {
+                throw RuntimeError("Block compressed stream is corrupt.");
+            }
+        }
+
+        std::istream& mStream;
+        uint32_t mBlockSize = 0;
+
+        std::shared_ptr<Block> mpCurrent;
+        std::deque<std::shared_ptr<Block>> mPending;
+        uint64_t mBlockCount = 0;
+        uint64_t mRawSize = 0;
+        bool mEnd = false;
+    };
+
+    BlockCompressedInputStream::BlockCompressedInputStream(std::istream& stream)
+        : std::istream(nullptr)
+        , mpBuffer(std::make_unique<Buffer>(stream))
+    {
+        rdbuf(mpBuffer.get());
+        exceptions(std::ios::badbit);
+    }
+
+    BlockCompressedInputStream::~BlockCompressedInputStream() = default;
+}
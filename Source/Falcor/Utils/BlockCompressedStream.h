@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <iostream>
+#include <memory>
+
+namespace Falcor
+{
+    /** Codec used to compress the blocks of a block compressed stream.
+    */
+    enum class BlockCodec : uint32_t
+    {
+        LZ4 = 0,    ///< Fast compression and decompression.
+        LZ4HC = 1,  ///< Slower, higher-ratio compression. Decompression is as fast as LZ4.
+    };
+
+    /** Output stream compressing data in independent fixed-size blocks.
+        Each block is compressed as a separate task on the global thread pool, so compression scales with the number of cores.
+        Blocks are written in order as frames with a small header, followed by an index of frame offsets.
+        If the thread pool is not running, blocks are compressed on the calling thread.
+    */
+    class FALCOR_API BlockCompressedOutputStream : public std::ostream
+    {
+    public:
+        static const size_t kDefaultBlockSize = 1024 * 1024;
+
+        /** Constructor.
+            \param[in] stream Stream receiving the compressed data.
+            \param[in] codec Codec used for compressing blocks.
+            \param[in] blockSize Size of uncompressed blocks in bytes.
+        */
+        BlockCompressedOutputStream(std::ostream& stream, BlockCodec codec = BlockCodec::LZ4, size_t blockSize = kDefaultBlockSize);
+
+        /** Destructor. Closes the stream if it was not closed before.
+        */
+        ~BlockCompressedOutputStream();
+
+        /** Compress and write all remaining data and write the block index.
+            Exceptions from compression tasks are rethrown. No data can be written after closing the stream.
+        */
+        void close();
+
+        /** Get the number of uncompressed bytes written to the stream so far.
+        */
+        uint64_t getRawSize() const;
+
+        /** Get the number of compressed bytes written to the underlying stream so far.
+        */
+        uint64_t getCompressedSize() const;
+
+    private:
+        class Buffer;
+        std::unique_ptr<Buffer> mpBuffer;
+    };
+
+    /** Input stream decompressing data written by BlockCompressedOutputStream.
+        Frames are read from the underlying stream ahead of the consumer and decompressed in parallel on the global thread pool.
+        The block index at the end of the stream is used to verify that the stream is complete.
+    */
+    class FALCOR_API BlockCompressedInputStream : public std::istream
+    {
+    public:
+        /** Constructor. Throws a RuntimeError if the stream does not start with a valid header.
+            \param[in] stream Stream providing the compressed data.
+        */
+        BlockCompressedInputStream(std::istream& stream);
+
+        ~BlockCompressedInputStream();
+
+    private:
+        class Buffer;
+        std::unique_ptr<Buffer> mpBuffer;
+    };
+}
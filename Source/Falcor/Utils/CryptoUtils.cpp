@@ -29,9 +29,39 @@
 #include "CryptoUtils.h"
 
 #include <openssl/sha.h>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HASH128_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASH128_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 namespace Falcor
 {
+    namespace
+    {
+        std::string toHexString(const uint8_t* data, size_t size)
+        {
+            static const char kDigits[] = "0123456789abcdef";
+            std::string str(size * 2, '0');
+            for (size_t i = 0; i < size; i++)
+            {
+                str[i * 2] = kDigits[data[i] >> 4];
+                str[i * 2 + 1] = kDigits[data[i] & 0xf];
+            }
+            return str;
+        }
+    }
+
+    // SHA1
+
     SHA1::SHA1()
     {
         mpCtx = malloc(sizeof(SHA_CTX));
@@ -61,4 +91,369 @@ namespace Falcor
         ::SHA1(reinterpret_cast<const unsigned char*>(data), len, md.data());
         return md;
     }
+
+    std::string SHA1::toString(const MD& md)
+    {
+        return toHexString(md.data(), md.size());
+    }
+
+    // Hash128
+
+    namespace
+    {
+        // The accumulate and scramble steps follow the structure of XXH3, which maps well to 64-bit SIMD lanes.
+        const size_t kStripeSize = 64;
+        const size_t kStripesPerBlock = 16;
+        const size_t kBlockSize = kStripeSize * kStripesPerBlock;
+        const size_t kLaneCount = kStripeSize / sizeof(uint64_t);
+
+        const uint64_t kPrime32_1 = 0x9e3779b1ull;
+        const uint64_t kPrime64_1 = 0x9e3779b185ebca87ull;
+        const uint64_t kPrime64_2 = 0xc2b2ae3d27d4eb4full;
+
+        const uint64_t kTreeSeed = 0x46616c636f725472ull;
+
+        // Stripe s of a block uses kSecret[s .. s + 7] as key, the scramble step uses kSecret[16 .. 23].
+        alignas(32) const uint64_t kSecret[kStripesPerBlock + kLaneCount] =
+        {
+            0x16fb36e82e57dddbull, 0x22f72a1adb5a8348ull, 0xb7f3c670918bb6bfull, 0x13ba9a34cd45c50cull,
+            0xf62ae20ab74dc29eull, 0x0c7ce51a14cd8013ull, 0xd3cfad8890113871ull, 0x14e4896d13f91054ull,
+            0xaa2c32548b856a0eull, 0xa491070fca2686bfull, 0xd0ac269739eafe63ull, 0xc32c54fcc05b9a45ull,
+            0x0cb5cd7000f1a5ecull, 0xd01a94a469b6be45ull, 0x6ada1c745fce06d8ull, 0x7b339405e9fcbe31ull,
+            0x56420e38f926bebcull, 0x78266fe717958812ull, 0xb41cbd0abd71a333ull, 0x59760ac878c99329ull,
+            0x2e8992b2b56bcb97ull, 0x06d8581c0c76de7cull, 0x2831825d5ab82043ull, 0x32393bc8882a4985ull,
+        };
+
+        const uint64_t kInitAcc[kLaneCount] =
+        {
+            0x000000009e3779b1ull, 0x9e3779b185ebca87ull, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull,
+            0x85ebca77c2b2ae63ull, 0x0000000085ebca77ull, 0x27d4eb2f165667c5ull, 0x00000000c2b2ae3dull,
+        };
+
+        uint64_t load64(const uint8_t* p)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        uint64_t mulFold64(uint64_t a, uint64_t b)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            uint64_t hi;
+            uint64_t lo = _umul128(a, b, &hi);
+            return lo ^ hi;
+#elif defined(__SIZEOF_INT128__)
+            __uint128_t product = (__uint128_t)a * b;
+            return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+            uint64_t aLo = a & 0xffffffff, aHi = a >> 32, bLo = b & 0xffffffff, bHi = b >> 32;
+            uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+            uint64_t cross = (ll >> 32) + (hl & 0xffffffff) + lh;
+            uint64_t lo = (cross << 32) | (ll & 0xffffffff);
+            uint64_t hi = hh + (hl >> 32) + (cross >> 32);
+            return lo ^ hi;
+#endif
+        }
+
+        uint64_t avalanche(uint64_t h)
+        {
+            h ^= h >> 37;
+            h *= 0x165667919e3779f9ull;
+            h ^= h >> 32;
+            return h;
+        }
+
+        /** Accumulate one stripe of 64 bytes into the accumulators.
+        */
+        void accumulateStripe(uint64_t* acc, const uint8_t* p, const uint64_t* key)
+        {
+#if defined(HASH128_AVX2)
+            for (size_t i = 0; i < kLaneCount; i += 4)
+            {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i * sizeof(uint64_t)));
+                __m256i k = _mm256_xor_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + i)));
+                __m256i product = _mm256_mul_epu32(k, _mm256_srli_epi64(k, 32));
+                __m256i swapped = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+                a = _mm256_add_epi64(a, _mm256_add_epi64(product, swapped));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), a);
+            }
+#elif defined(HASH128_SSE2)
+            for (size_t i = 0; i < kLaneCount; i += 2)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * sizeof(uint64_t)));
+                __m128i k = _mm_xor_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + i)));
+                __m128i product = _mm_mul_epu32(k, _mm_srli_epi64(k, 32));
+                __m128i swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+                a = _mm_add_epi64(a, _mm_add_epi64(product, swapped));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), a);
+            }
+#else
+            for (size_t i = 0; i < kLaneCount; i++)
+            {
+                uint64_t v = load64(p + i * sizeof(uint64_t));
+                uint64_t k = v ^ key[i];
+                acc[i ^ 1] += v;
+                acc[i] += (k & 0xffffffff) * (k >> 32);
+            }
+#endif
+        }
+
+        /** Scramble the accumulators at the end of each block.
+        */
+        void scramble(uint64_t* acc, const uint64_t* key)
+        {
+#if defined(HASH128_AVX2)
+            const __m256i prime = _mm256_set1_epi32((int)kPrime32_1);
+            for (size_t i = 0; i < kLaneCount; i += 4)
+            {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+                a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+                a = _mm256_xor_si256(a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + i)));
+                __m256i lo = _mm256_mul_epu32(a, prime);
+                __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32)));
+            }
+#elif defined(HASH128_SSE2)
+            const __m128i prime = _mm_set1_epi32((int)kPrime32_1);
+            for (size_t i = 0; i < kLaneCount; i += 2)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+                a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+                a = _mm_xor_si128(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + i)));
+                __m128i lo = _mm_mul_epu32(a, prime);
+                __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), _mm_add_epi64(lo, _mm_slli_epi64(hi, 32)));
+            }
+#else
+            for (size_t i = 0; i < kLaneCount; i++)
+            {
+                uint64_t a = acc[i];
+                a ^= a >> 47;
+                a ^= key[i];
+                acc[i] = a * kPrime32_1;
+            }
+#endif
+        }
+
+        void accumulateBlocks(uint64_t* acc, const uint8_t* p, size_t blockCount)
+        {
+            for (size_t b = 0; b < blockCount; b++, p += kBlockSize)
+            {
+                for (size_t s = 0; s < kStripesPerBlock; s++) accumulateStripe(acc, p + s * kStripeSize, kSecret + s);
+                scramble(acc, kSecret + kStripesPerBlock);
+            }
+        }
+
+        /** Hash state of a single leaf, i.e. a chunk of data or the sequence of chunk digests.
+            Full blocks are accumulated as soon as they are available, the remainder is kept in a buffer.
+        */
+        struct Leaf
+        {
+            uint64_t acc[kLaneCount];
+            uint64_t seed = 0;
+            uint64_t length = 0;
+            uint8_t buffer[kBlockSize];
+            size_t bufferSize = 0;
+
+            explicit Leaf(uint64_t seed_ = 0) { reset(seed_); }
+
+            void reset(uint64_t seed_)
+            {
+                seed = seed_;
+                for (size_t i = 0; i < kLaneCount; i++) acc[i] = kInitAcc[i] ^ seed;
+                length = 0;
+                bufferSize = 0;
+            }
+
+            void update(const uint8_t* p, size_t len)
+            {
+                length += len;
+                if (bufferSize > 0)
+                {
+                    size_t count = std::min(len, kBlockSize - bufferSize);
+                    std::memcpy(buffer + bufferSize, p, count);
+                    bufferSize += count;
+                    p += count;
+                    len -= count;
+                    if (bufferSize < kBlockSize) return;
+                    accumulateBlocks(acc, buffer, 1);
+                    bufferSize = 0;
+                }
+                size_t blockCount = len / kBlockSize;
+                accumulateBlocks(acc, p, blockCount);
+                p += blockCount * kBlockSize;
+                len -= blockCount * kBlockSize;
+                std::memcpy(buffer, p, len);
+                bufferSize = len;
+            }
+
+            Hash128::MD final() const
+            {
+                uint64_t tailAcc[kLaneCount];
+                std::memcpy(tailAcc, acc, sizeof(acc));
+
+                // Accumulate the remaining full stripes and the zero padded last stripe.
+                // The padding is disambiguated by the length, which is mixed into the digest.
+                size_t stripeCount = bufferSize / kStripeSize;
+                for (size_t s = 0; s < stripeCount; s++) accumulateStripe(tailAcc, buffer + s * kStripeSize, kSecret + s);
+                size_t remainder = bufferSize % kStripeSize;
+                if (remainder > 0)
+                {
+                    uint8_t lastStripe[kStripeSize] = {};
+                    std::memcpy(lastStripe, buffer + stripeCount * kStripeSize, remainder);
+                    accumulateStripe(tailAcc, lastStripe, kSecret + stripeCount);
+                }
+
+                uint64_t lo = length * kPrime64_1;
+                uint64_t hi = ~length * kPrime64_2;
+                for (size_t i = 0; i < kLaneCount; i += 2)
+                {
+                    lo += mulFold64(tailAcc[i] ^ kSecret[i], tailAcc[i + 1] ^ kSecret[i + 1]);
+                    hi += mulFold64(tailAcc[i] ^ kSecret[i + 9], tailAcc[i + 1] ^ kSecret[i + 10]);
+                }
+                lo = avalanche(lo);
+                hi = avalanche(hi);
+
+                Hash128::MD md;
+                std::memcpy(md.data(), &lo, sizeof(lo));
+                std::memcpy(md.data() + sizeof(lo), &hi, sizeof(hi));
+                return md;
+            }
+        };
+
+        Hash128::MD hashChunk(const uint8_t* p, size_t len)
+        {
+            Leaf leaf;
+            leaf.update(p, len);
+            return leaf.final();
+        }
+
+        /** Combine the chunk digests of an input larger than a single chunk.
+        */
+        Hash128::MD hashRoot(const std::vector<Hash128::MD>& chunkDigests, uint64_t totalLength)
+        {
+            Leaf root(kTreeSeed);
+            for (const auto& md : chunkDigests) root.update(md.data(), md.size());
+            root.update(reinterpret_cast<const uint8_t*>(&totalLength), sizeof(totalLength));
+            return root.final();
+        }
+    }
+
+    struct Hash128::State
+    {
+        Leaf chunk;
+        std::vector<MD> chunkDigests;
+        uint64_t totalLength = 0;
+    };
+
+    Hash128::Hash128()
+        : mpState(std::make_unique<State>())
+    {}
+
+    Hash128::~Hash128() = default;
+
+    void Hash128::update(const void* data, size_t len)
+    {
+        auto p = reinterpret_cast<const uint8_t*>(data);
+        auto& state = *mpState;
+        state.totalLength += len;
+        while (len > 0)
+        {
+            // Only close a full chunk once more data arrives, so that inputs of at most one chunk are hashed as a single leaf.
+            if (state.chunk.length == kChunkSize)
+            {
+                state.chunkDigests.push_back(state.chunk.final());
+                state.chunk.reset(0);
+            }
+            size_t count = std::min(len, size_t(kChunkSize - state.chunk.length));
+            state.chunk.update(p, count);
+            p += count;
+            len -= count;
+        }
+    }
+
+    Hash128::MD Hash128::final()
+    {
+        auto& state = *mpState;
+        MD md;
+        if (state.chunkDigests.empty())
+        {
+            md = state.chunk.final();
+        }
+        else
+        {
+            state.chunkDigests.push_back(state.chunk.final());
+            md = hashRoot(state.chunkDigests, state.totalLength);
+        }
+        state.chunk.reset(0);
+        state.chunkDigests.clear();
+        state.totalLength = 0;
+        return md;
+    }
+
+    Hash128::MD Hash128::compute(const void* data, size_t len)
+    {
+        auto p = reinterpret_cast<const uint8_t*>(data);
+        if (len <= kChunkSize) return hashChunk(p, len);
+
+        std::vector<MD> chunkDigests((len + kChunkSize - 1) / kChunkSize);
+        for (size_t i = 0; i < chunkDigests.size(); i++)
+        {
+            size_t offset = i * kChunkSize;
+            chunkDigests[i] = hashChunk(p + offset, std::min(kChunkSize, len - offset));
+        }
+        return hashRoot(chunkDigests, len);
+    }
+
+    Hash128::MD Hash128::computeParallel(const void* data, size_t len)
+    {
+        auto p = reinterpret_cast<const uint8_t*>(data);
+        if (len <= kChunkSize) return hashChunk(p, len);
+
+        std::vector<MD> chunkDigests((len + kChunkSize - 1) / kChunkSize);
+        Threading::parallelFor(0, chunkDigests.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                size_t offset = i * kChunkSize;
+                chunkDigests[i] = hashChunk(p + offset, std::min(kChunkSize, len - offset));
+            }
+        }, 1);
+        return hashRoot(chunkDigests, len);
+    }
+
+    std::string Hash128::toString(const MD& md)
+    {
+        return toHexString(md.data(), md.size());
+    }
+
+    FALCOR_SCRIPT_BINDING(Hash128)
+    {
+        // Run a function on the contents of a contiguous Python buffer (e.g. bytes or a numpy array).
+        auto withBuffer = [](const pybind11::buffer& buffer, auto func)
+        {
+            pybind11::buffer_info info = buffer.request();
+            size_t stride = info.itemsize;
+            for (auto i = info.ndim; i-- > 0;)
+            {
+                checkArgument((size_t)info.strides[i] == stride, "Buffer must be contiguous.");
+                stride *= info.shape[i];
+            }
+            pybind11::gil_scoped_release release;
+            return func(info.ptr, info.size * info.itemsize);
+        };
+
+        pybind11::class_<Hash128> hash128(m, "Hash128");
+        hash128.def(pybind11::init<>());
+        hash128.def("update", [withBuffer](Hash128& self, const pybind11::buffer& data) {
+            withBuffer(data, [&self](const void* p, size_t len) { self.update(p, len); });
+        }, "data"_a);
+        hash128.def("final", [](Hash128& self) { return Hash128::toString(self.final()); });
+        hash128.def_static("compute", [withBuffer](const pybind11::buffer& data) {
+            return Hash128::toString(withBuffer(data, [](const void* p, size_t len) { return Hash128::computeParallel(p, len); }));
+        }, "data"_a);
+    }
 }
@@ -28,6 +28,8 @@
 #pragma once
 #include <array>
 #include <cstdint>
+#include <memory>
+#include <string>
 
 namespace Falcor
 {
@@ -59,7 +61,70 @@ namespace Falcor
         */
         static MD compute(const void* data, size_t len);
 
+        /** Convert a message digest to a lower case hex string.
+            \param[in] md Message digest.
+            \return Returns a string of 40 hex digits.
+        */
+        static std::string toString(const MD& md);
+
     private:
         void* mpCtx;
     };
+
+    /** Helper to compute a fast 128-bit non-cryptographic hash.
+        This is intended for keying caches on large amounts of data (e.g. full asset contents), where
+        the throughput of SHA-1 is the bottleneck. It must not be used where collision resistance
+        against malicious input is required.
+
+        The data is processed in SIMD-friendly stripes. Inputs larger than a chunk (kChunkSize) are split
+        into fixed-size chunks that are hashed independently and combined in order by a root hash.
+        The digest therefore only depends on the data, and computeParallel() returns the same digest
+        as compute() and the streaming interface.
+    */
+    class FALCOR_API Hash128
+    {
+    public:
+        using MD = std::array<uint8_t, 16>; ///< Message digest.
+
+        static constexpr size_t kChunkSize = 1024 * 1024; ///< Size of the chunks that are hashed independently.
+
+        Hash128();
+        ~Hash128();
+
+        /** Update hash using the given data.
+            \param[in] data Data to hash.
+            \param[in] len Length of data in bytes.
+        */
+        void update(const void* data, size_t len);
+
+        /** Return final message digest.
+            The hash is reset afterwards and can be used to hash new data.
+            \return Returns the message digest.
+        */
+        MD final();
+
+        /** Compute hash over the given data.
+            \param[in] data Data to hash.
+            \param[in] len Length of data in bytes.
+            \return Returns the message digest.
+        */
+        static MD compute(const void* data, size_t len);
+
+        /** Compute hash over the given data, hashing chunks in parallel on the thread pool.
+            \param[in] data Data to hash.
+            \param[in] len Length of data in bytes.
+            \return Returns the message digest, identical to the one returned by compute().
+        */
+        static MD computeParallel(const void* data, size_t len);
+
+        /** Convert a message digest to a lower case hex string.
+            \param[in] md Message digest.
+            \return Returns a string of 32 hex digits.
+        */
+        static std::string toString(const MD& md);
+
+    private:
+        struct State;
+        std::unique_ptr<State> mpState;
+    };
 };
@@ -0,0 +1,267 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "DiskCache.h"
+#include <atomic>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Prefix of temporary files. The entry name is kept as suffix, so temporary files have the same extension.
+        */
+        const std::string kTempPrefix = ".tmp.";
+
+        /** When evicting, entries are removed until the total size drops below this fraction of the size limit.
+            This avoids evicting on every commit once the cache is full.
+        */
+        const double kEvictionTarget = 0.9;
+
+        /** Temporary files older than this are left over from crashed processes and are removed.
+        */
+        const auto kStaleTempFileAge = std::chrono::hours(24);
+
+        bool isTempFile(const std::filesystem::path& path)
+        {
+            return path.filename().string().rfind(kTempPrefix, 0) == 0;
+        }
+    }
+
+    DiskCache::SharedPtr DiskCache::create(const std::filesystem::path& directory, uint64_t sizeLimit)
+    {
+        return SharedPtr(new DiskCache(directory, sizeLimit));
+    }
+
+    DiskCache::DiskCache(const std::filesystem::path& directory, uint64_t sizeLimit)
+        : mDirectory(directory)
+        , mSizeLimit(sizeLimit)
+    {
+        std::filesystem::create_directories(mDirectory);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        scanDirectory();
+        evict();
+    }
+
+    std::filesystem::path DiskCache::getEntryPath(const std::string& name) const
+    {
+        return mDirectory / name;
+    }
+
+    bool DiskCache::touch(const std::string& name)
+    {
+        auto path = getEntryPath(name);
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(path, ec);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(name);
+        if (ec)
+        {
+            // The entry may have been evicted by another process.
+            if (it != mEntries.end())
+            {
+                mTotalSize -= it->second.size;
+                mEntries.erase(it);
+            }
+            return false;
+        }
+
+        // Update the modification time so that other processes see the use.
+        auto now = std::filesystem::file_time_type::clock::now();
+        std::filesystem::last_write_time(path, now, ec);
+
+        if (it == mEntries.end()) it = mEntries.insert({ name, Entry{} }).first;
+        mTotalSize = mTotalSize - it->second.size + size;
+        it->second = { size, now };
+        return true;
+    }
+
+    std::filesystem::path DiskCache::createTempPath(const std::string& name) const
+    {
+        // Temporary names need to be unique across all processes sharing the directory.
+        static const uint64_t processId = ((uint64_t)std::random_device()() << 32) | std::random_device()();
+        static std::atomic<uint64_t> counter = 0;
+        return mDirectory / fmt::format("{}{:016x}.{}.{}", kTempPrefix, processId, counter++, name);
+    }
+
+    bool DiskCache::commit(const std::string& name, const std::filesystem::path& tempPath)
+    {
+        FALCOR_ASSERT(isTempFile(tempPath));
+        auto path = getEntryPath(name);
+
+        // Renaming is atomic. It replaces an existing entry, or fails on Windows if the entry is in use.
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            discard(tempPath);
+            if (!std::filesystem::exists(path))
+            {
+                logWarning("Failed to commit cache entry '{}': {}", path, ec.message());
+                return false;
+            }
+        }
+
+        if (!touch(name)) return false;
+
+        // Never evict the new entry itself, even if it exceeds the size limit on its own.
+        std::lock_guard<std::mutex> lock(mMutex);
+        evict(name);
+        return true;
+    }
+
+    void DiskCache::discard(const std::filesystem::path& tempPath)
+    {
+        FALCOR_ASSERT(isTempFile(tempPath));
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+    }
+
+    void DiskCache::remove(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::error_code ec;
+        std::filesystem::remove(getEntryPath(name), ec);
+        auto it = mEntries.find(name);
+        if (it != mEntries.end())
+        {
+            mTotalSize -= it->second.size;
+            mEntries.erase(it);
+        }
+    }
+
+    void DiskCache::setSizeLimit(uint64_t sizeLimit)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mSizeLimit = sizeLimit;
+        evict();
+    }
+
+    uint64_t DiskCache::getSizeLimit() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mSizeLimit;
+    }
+
+    void DiskCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        scanDirectory();
+        for (const auto& [name, entry] : mEntries)
+        {
+            std::error_code ec;
+            std::filesystem::remove(getEntryPath(name), ec);
+        }
+        mEntries.clear();
+        mTotalSize = 0;
+    }
+
+    DiskCache::Stats DiskCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Stats stats;
+        stats.evictions = mEvictions;
+        stats.entryCount = mEntries.size();
+        stats.totalSize = mTotalSize;
+        return stats;
+    }
+
+    void DiskCache::scanDirectory()
+    {
+        // Rebuild the index from the directory to pick up entries added or removed by other processes.
+        // The modification time is the last use time, unless this process has seen a more recent use.
+        std::map<std::string, Entry> entries;
+        uint64_t totalSize = 0;
+        const auto now = std::filesystem::file_time_type::clock::now();
+
+        std::error_code ec;
+        for (auto it = std::filesystem::directory_iterator(mDirectory, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+        {
+            std::error_code fileEc;
+            if (!it->is_regular_file(fileEc)) continue;
+
+            const auto& path = it->path();
+            auto lastWriteTime = it->last_write_time(fileEc);
+            if (fileEc) continue;
+
+            if (isTempFile(path))
+            {
+                if (now - lastWriteTime > kStaleTempFileAge) std::filesystem::remove(path, fileEc);
+                continue;
+            }
+
+            Entry entry;
+            entry.size = it->file_size(fileEc);
+            if (fileEc) continue;
+            entry.lastUse = lastWriteTime;
+
+            auto name = path.filename().string();
+            auto known = mEntries.find(name);
+            if (known != mEntries.end()) entry.lastUse = std::max(entry.lastUse, known->second.lastUse);
+
+            entries[name] = entry;
+            totalSize += entry.size;
+        }
+
+        mEntries = std::move(entries);
+        mTotalSize = totalSize;
+    }
+
+    void DiskCache::evict(const std::string& keepName)
+    {
+        if (mTotalSize <= mSizeLimit) return;
+
+        // Other processes may have added or evicted entries since the last scan.
+        scanDirectory();
+        if (mTotalSize <= mSizeLimit) return;
+
+        std::vector<std::pair<std::filesystem::file_time_type, std::string>> order;
+        order.reserve(mEntries.size());
+        for (const auto& [name, entry] : mEntries) order.push_back({ entry.lastUse, name });
+        std::sort(order.begin(), order.end());
+
+        const uint64_t targetSize = (uint64_t)(mSizeLimit * kEvictionTarget);
+        for (const auto& [lastUse, name] : order)
+        {
+            if (mTotalSize <= targetSize) break;
+            if (name == keepName) continue;
+
+            // Removing fails on Windows if the entry is in use by another process. Skip it in that case.
+            std::error_code ec;
+            std::filesystem::remove(getEntryPath(name), ec);
+            if (ec) continue;
+
+            auto it = mEntries.find(name);
+            mTotalSize -= it->second.size;
+            mEntries.erase(it);
+            mEvictions++;
+        }
+    }
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Falcor
+{
+    /** Size-bounded directory of cache files that can be shared between processes.
+        Entries are files in the cache directory identified by their name. New entries are written to a temporary
+        file and atomically renamed into place on commit, so readers in other processes never see partially written
+        entries. The file modification time serves as the last use time, which makes the least recently used
+        order visible to all processes sharing the directory. Once the total size exceeds the size limit,
+        least recently used entries are evicted.
+        All functions are thread safe.
+    */
+    class FALCOR_API DiskCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<DiskCache>;
+
+        struct Stats
+        {
+            uint64_t evictions = 0;     ///< Number of entries evicted by this object.
+            uint64_t entryCount = 0;    ///< Current number of entries.
+            uint64_t totalSize = 0;     ///< Current total size of all entries in bytes.
+        };
+
+        /** Create a disk cache.
+            \param[in] directory Cache directory. Created if it does not exist.
+            \param[in] sizeLimit Maximum total size of all entries in bytes.
+            \return New object.
+        */
+        static SharedPtr create(const std::filesystem::path& directory, uint64_t sizeLimit);
+
+        /** Get the path of an entry. The entry may not exist.
+            \param[in] name Entry name.
+        */
+        std::filesystem::path getEntryPath(const std::string& name) const;
+
+        /** Mark an entry as used.
+            \param[in] name Entry name.
+            \return Returns true if the entry exists.
+        */
+        bool touch(const std::string& name);
+
+        /** Create a unique temporary path for writing a new entry.
+            The file is created by the caller and passed to commit() or discard() once written.
+            The temporary path has the same extension as the entry name.
+            \param[in] name Entry name.
+            \return Temporary file path in the cache directory.
+        */
+        std::filesystem::path createTempPath(const std::string& name) const;
+
+        /** Atomically move a written temporary file into place as an entry.
+            If an entry with the same name was committed concurrently, one of the two files is kept.
+            Least recently used entries are evicted if the size limit is exceeded.
+            \param[in] name Entry name.
+            \param[in] tempPath Temporary file created with createTempPath().
+            \return Returns true if successful.
+        */
+        bool commit(const std::string& name, const std::filesystem::path& tempPath);
+
+        /** Delete a temporary file that is not committed.
+        */
+        void discard(const std::filesystem::path& tempPath);
+
+        /** Remove an entry.
+        */
+        void remove(const std::string& name);
+
+        /** Set the maximum total size of all entries in bytes. Evicts entries if necessary.
+        */
+        void setSizeLimit(uint64_t sizeLimit);
+
+        uint64_t getSizeLimit() const;
+
+        /** Remove all entries.
+        */
+        void clear();
+
+        Stats getStats() const;
+
+        const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+    private:
+        DiskCache(const std::filesystem::path& directory, uint64_t sizeLimit);
+
+        struct Entry
+        {
+            uint64_t size = 0;
+            std::filesystem::file_time_type lastUse;
+        };
+
+        void scanDirectory();
+        void evict(const std::string& keepName = {});
+
+        std::filesystem::path mDirectory;
+        uint64_t mSizeLimit;
+
+        mutable std::mutex mMutex;
+        std::map<std::string, Entry> mEntries;
+        uint64_t mTotalSize = 0;
+        uint64_t mEvictions = 0;
+    };
+}
@@ -0,0 +1,828 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+
+namespace Falcor
+{
+    namespace MeshOptimizer
+    {
+        namespace
+        {
+            const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+            // Scoring parameters from Forsyth's paper.
+            const float kCacheDecayPower = 1.5f;
+            const float kLastTriangleScore = 0.75f;
+            const float kValenceBoostScale = 2.f;
+            const float kValenceBoostPower = 0.5f;
+
+            // Normal cones with a half-angle above acos(kMinConeDot) are disabled.
+            const float kMinConeDot = 0.1f;
+
+            // Edge collapses that rotate a triangle normal by more than acos(kMinNormalDot) are rejected.
+            const float kMinNormalDot = 0.25f;
+
+            // Points whose distance from the line through the centroid and the farthest point is below this fraction
+            // of the farthest distance are considered collinear when solving for rigid transforms.
+            const float kMinFrameExtent = 1e-3f;
+
+            // Absolute error allowed for each point in findRigidTransform(), relative to the point's largest coordinate magnitude.
+            // This accounts for the float precision of positions that were transformed far from the origin.
+            const float kPositionPrecision = 8.f * std::numeric_limits<float>::epsilon();
+
+            void validateTriangleList(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount)
+            {
+                if (indexCount % 3 != 0) throw RuntimeError("MeshOptimizer: Index count ({}) is not a multiple of three.", indexCount);
+                if (indexCount > 0 && !pIndices) throw RuntimeError("MeshOptimizer: Index buffer is missing.");
+                for (size_t i = 0; i < indexCount; i++)
+                {
+                    if (pIndices[i] >= vertexCount) throw RuntimeError("MeshOptimizer: Vertex index {} is out of range ({} vertices).", pIndices[i], vertexCount);
+                }
+            }
+
+            /** Precomputed vertex scores.
+            */
+            class VertexScoreTable
+            {
+            public:
+                VertexScoreTable(uint32_t cacheSize)
+                    : mCacheScores(cacheSize)
+                {
+                    // The vertices of the last triangle get a fixed score regardless of their order, so that
+                    // the algorithm does not favor one of the edges of the previous triangle.
+                    for (uint32_t i = 0; i < cacheSize; i++)
+                    {
+                        mCacheScores[i] = i < 3 ? kLastTriangleScore : std::pow(1.f - (float)(i - 3) / (cacheSize - 3), kCacheDecayPower);
+                    }
+                    for (uint32_t i = 1; i < kValenceTableSize; i++) mValenceScores[i] = computeValenceScore(i);
+                }
+
+                /** Computes the score of a vertex from its position in the LRU cache and its number of remaining triangles.
+                */
+                float getScore(int32_t cachePosition, uint32_t liveTriangleCount) const
+                {
+                    // Vertices without remaining triangles are never used again.
+                    if (liveTriangleCount == 0) return -1.f;
+
+                    float score = cachePosition >= 0 ? mCacheScores[cachePosition] : 0.f;
+                    score += liveTriangleCount < kValenceTableSize ? mValenceScores[liveTriangleCount] : computeValenceScore(liveTriangleCount);
+                    return score;
+                }
+
+            private:
+                static const uint32_t kValenceTableSize = 32;
+
+                /** Boost vertices with few remaining triangles to finish them off and avoid isolated triangles.
+                */
+                static float computeValenceScore(uint32_t liveTriangleCount)
+                {
+                    return kValenceBoostScale * std::pow((float)liveTriangleCount, -kValenceBoostPower);
+                }
+
+                std::vector<float> mCacheScores;
+                float mValenceScores[kValenceTableSize] = {};
+            };
+
+            const float3& getPosition(const float3* pPositions, size_t positionStride, uint32_t index)
+            {
+                return *reinterpret_cast<const float3*>(reinterpret_cast<const uint8_t*>(pPositions) + index * positionStride);
+            }
+
+            float3 computeCentroid(const float3* pPositions, size_t positionStride, size_t count)
+            {
+                double sum[3] = {};
+                for (size_t i = 0; i < count; i++)
+                {
+                    const float3& p = getPosition(pPositions, positionStride, (uint32_t)i);
+                    for (int j = 0; j < 3; j++) sum[j] += p[j];
+                }
+                return float3((float)(sum[0] / count), (float)(sum[1] / count), (float)(sum[2] / count));
+            }
+
+            float maxAbsComponent(const float3& v)
+            {
+                return std::max(std::max(std::abs(v.x), std::abs(v.y)), std::abs(v.z));
+            }
+
+            /** Computes the bounding box and normal cone of a meshlet.
+            */
+            void computeMeshletBounds(Meshlet& meshlet, const MeshletList& list, const float3* pPositions, size_t positionStride)
+            {
+                auto getVertex = [&](uint32_t localIndex) -> const float3& { return getPosition(pPositions, positionStride, list.vertices[meshlet.vertexOffset + localIndex]); };
+                auto getCorner = [&](uint32_t triangle, uint32_t corner) -> const float3& { return getVertex((list.triangles[meshlet.triangleOffset + triangle] >> (8 * corner)) & 0xff); };
+
+                meshlet.boundsMin = meshlet.boundsMax = getVertex(0);
+                for (uint32_t i = 1; i < meshlet.vertexCount; i++)
+                {
+                    meshlet.boundsMin = glm::min(meshlet.boundsMin, getVertex(i));
+                    meshlet.boundsMax = glm::max(meshlet.boundsMax, getVertex(i));
+                }
+                const float3 center = (meshlet.boundsMin + meshlet.boundsMax) * 0.5f;
+
+                // By default the normal cone is disabled.
+                meshlet.coneAxis = float3(0.f);
+                meshlet.coneCutoff = 1.f;
+                meshlet.coneApex = center;
+
+                // The cone axis is the average of the normals of the non-degenerate triangles.
+                struct Plane
+                {
+                    float3 normal;
+                    float3 point;
+                };
+                std::vector<Plane> planes;
+                planes.reserve(meshlet.triangleCount);
+                float3 normalSum = float3(0.f);
+                for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+                {
+                    const float3 n = glm::cross(getCorner(t, 1) - getCorner(t, 0), getCorner(t, 2) - getCorner(t, 0));
+                    const float len = glm::length(n);
+                    if (!(len > 0.f)) continue;
+                    planes.push_back({ n / len, getCorner(t, 0) });
+                    normalSum += planes.back().normal;
+                }
+                const float sumLength = glm::length(normalSum);
+                if (!(sumLength > 0.f)) return;
+                const float3 axis = normalSum / sumLength;
+
+                // The cone angle is given by the normal deviating the most from the axis.
+                // Cone culling is ineffective for wide cones, so these are disabled.
+                float minDot = 1.f;
+                for (const auto& plane : planes) minDot = std::min(minDot, glm::dot(plane.normal, axis));
+                if (minDot <= kMinConeDot) return;
+
+                // Place the apex on the axis behind the center such that all triangle planes face away from it.
+                // For each triangle, this is the point where the axis intersects the plane of the triangle.
+                float maxT = 0.f;
+                for (const auto& plane : planes) maxT = std::max(maxT, glm::dot(center - plane.point, plane.normal) / glm::dot(axis, plane.normal));
+
+                meshlet.coneAxis = axis;
+                meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+                meshlet.coneApex = center - axis * maxT;
+            }
+
+            /** Symmetric quadric error matrix. Accumulates the weighted squared distances to a set of planes.
+            */
+            struct Quadric
+            {
+                double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+                double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+                double c = 0.0;
+                double weight = 0.0;
+
+                /** Adds the plane dot(n, p) + d = 0. The normal must be normalized.
+                */
+                void addPlane(const float3& n, float d, double w)
+                {
+                    a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+                    a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+                    b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+                    c += w * d * d;
+                    weight += w;
+                }
+
+                Quadric& operator+=(const Quadric& other)
+                {
+                    a00 += other.a00; a01 += other.a01; a02 += other.a02;
+                    a11 += other.a11; a12 += other.a12; a22 += other.a22;
+                    b0 += other.b0; b1 += other.b1; b2 += other.b2;
+                    c += other.c;
+                    weight += other.weight;
+                    return *this;
+                }
+
+                /** Returns the weighted RMS distance of a point to the planes.
+                */
+                float getError(const float3& p) const
+                {
+                    if (!(weight > 0.0)) return 0.f;
+                    const double x = p.x, y = p.y, z = p.z;
+                    const double e = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                        + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+                    return (float)std::sqrt(std::max(e, 0.0) / weight);
+                }
+            };
+        }
+
+        VertexCacheStats analyzeVertexCache(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+        {
+            validateTriangleList(pIndices, indexCount, vertexCount);
+            if (cacheSize == 0) throw RuntimeError("MeshOptimizer: Cache size must be larger than zero.");
+
+            VertexCacheStats stats;
+            stats.triangleCount = indexCount / 3;
+
+            // A vertex is in the FIFO cache if less than 'cacheSize' vertices have been inserted since it was inserted.
+            // The timestamps start at cacheSize + 1 so that all vertices are initially considered outside the cache.
+            std::vector<uint64_t> timestamps(vertexCount, 0);
+            std::vector<bool> referenced(vertexCount, false);
+            uint64_t timestamp = cacheSize + 1;
+
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                const uint32_t index = pIndices[i];
+                if (timestamp - timestamps[index] > cacheSize)
+                {
+                    timestamps[index] = timestamp++;
+                    stats.transformedVertexCount++;
+                }
+                if (!referenced[index])
+                {
+                    referenced[index] = true;
+                    stats.vertexCount++;
+                }
+            }
+
+            return stats;
+        }
+
+        void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+        {
+            validateTriangleList(pIndices, indexCount, vertexCount);
+            if (cacheSize <= 3) throw RuntimeError("MeshOptimizer: Cache size must be larger than three.");
+
+            const size_t triangleCount = indexCount / 3;
+            if (triangleCount <= 1) return;
+            if (triangleCount > kInvalidIndex) throw RuntimeError("MeshOptimizer: Too many triangles ({}).", triangleCount);
+
+            // Build the vertex-to-triangle adjacency. The first 'liveTriangleCounts[v]' entries of each vertex list
+            // hold the triangles that have not been emitted yet. A triangle is listed once per corner referencing the vertex.
+            std::vector<uint32_t> liveTriangleCounts(vertexCount, 0);
+            for (size_t i = 0; i < indexCount; i++) liveTriangleCounts[pIndices[i]]++;
+
+            std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+            for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangleCounts[v];
+
+            std::vector<uint32_t> adjacency(indexCount);
+            {
+                std::vector<size_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (size_t i = 0; i < indexCount; i++) adjacency[fill[pIndices[i]]++] = (uint32_t)(i / 3);
+            }
+
+            // Compute the initial scores.
+            const VertexScoreTable scoreTable(cacheSize);
+            std::vector<int32_t> cachePositions(vertexCount, -1);
+            std::vector<float> vertexScores(vertexCount);
+            for (uint32_t v = 0; v < vertexCount; v++) vertexScores[v] = scoreTable.getScore(-1, liveTriangleCounts[v]);
+
+            std::vector<float> triangleScores(triangleCount);
+            uint32_t bestTriangle = kInvalidIndex;
+            float bestScore = -1.f;
+            for (size_t t = 0; t < triangleCount; t++)
+            {
+                const uint32_t* tri = pIndices + 3 * t;
+                triangleScores[t] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+                if (triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    bestTriangle = (uint32_t)t;
+                }
+            }
+
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> output(indexCount);
+            std::vector<uint32_t> cache;
+            std::vector<uint32_t> newCache;
+            cache.reserve(cacheSize + 3);
+            newCache.reserve(cacheSize + 3);
+            size_t nextTriangle = 0;
+
+            for (size_t outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++)
+            {
+                // If none of the triangles touching the cache are left, continue with the next remaining triangle in input order.
+                // This keeps the algorithm linear instead of searching all triangles for the best score.
+                if (bestTriangle == kInvalidIndex)
+                {
+                    while (emitted[nextTriangle]) nextTriangle++;
+                    bestTriangle = (uint32_t)nextTriangle;
+                }
+
+                const uint32_t tri[3] = { pIndices[3 * bestTriangle + 0], pIndices[3 * bestTriangle + 1], pIndices[3 * bestTriangle + 2] };
+                FALCOR_ASSERT(!emitted[bestTriangle]);
+                emitted[bestTriangle] = true;
+                for (uint32_t j = 0; j < 3; j++) output[3 * outputTriangle + j] = tri[j];
+
+                // Remove the triangle from the live lists of its vertices.
+                for (uint32_t v : tri)
+                {
+                    uint32_t* list = adjacency.data() + adjacencyOffsets[v];
+                    uint32_t& count = liveTriangleCounts[v];
+                    for (uint32_t k = 0; k < count; k++)
+                    {
+                        if (list[k] == bestTriangle)
+                        {
+                            std::swap(list[k], list[count - 1]);
+                            count--;
+                            break;
+                        }
+                    }
+                }
+
+                // Update the LRU cache. The vertices of the emitted triangle move to the front.
+                newCache.clear();
+                for (uint32_t v : tri)
+                {
+                    if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+                }
+                for (uint32_t v : cache)
+                {
+                    if (v != tri[0] && v != tri[1] && v != tri[2]) newCache.push_back(v);
+                }
+
+                // Update the scores of all vertices that were in or moved out of the cache.
+                for (size_t j = 0; j < newCache.size(); j++)
+                {
+                    const uint32_t v = newCache[j];
+                    cachePositions[v] = j < cacheSize ? (int32_t)j : -1;
+                    vertexScores[v] = scoreTable.getScore(cachePositions[v], liveTriangleCounts[v]);
+                }
+
+                // Update the scores of the remaining triangles of these vertices and pick the best one.
+                bestTriangle = kInvalidIndex;
+                bestScore = -1.f;
+                for (uint32_t v : newCache)
+                {
+                    const uint32_t* list = adjacency.data() + adjacencyOffsets[v];
+                    for (uint32_t k = 0; k < liveTriangleCounts[v]; k++)
+                    {
+                        const uint32_t t = list[k];
+                        const uint32_t* adjTri = pIndices + 3 * (size_t)t;
+                        triangleScores[t] = vertexScores[adjTri[0]] + vertexScores[adjTri[1]] + vertexScores[adjTri[2]];
+                        if (triangleScores[t] > bestScore || (triangleScores[t] == bestScore && t < bestTriangle))
+                        {
+                            bestScore = triangleScores[t];
+                            bestTriangle = t;
+                        }
+                    }
+                }
+
+                if (newCache.size() > cacheSize) newCache.resize(cacheSize);
+                std::swap(cache, newCache);
+            }
+
+            std::copy(output.begin(), output.end(), pIndices);
+        }
+
+        std::vector<uint32_t> computeVertexFetchRemap(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount)
+        {
+            std::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+            uint32_t nextVertex = 0;
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                const uint32_t index = pIndices[i];
+                if (index >= vertexCount) throw RuntimeError("MeshOptimizer: Vertex index {} is out of range ({} vertices).", index, vertexCount);
+                if (remap[index] == kInvalidIndex) remap[index] = nextVertex++;
+            }
+
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                if (remap[v] == kInvalidIndex) remap[v] = nextVertex++;
+            }
+
+            FALCOR_ASSERT(nextVertex == vertexCount);
+            return remap;
+        }
+
+        MeshletList buildMeshlets(const uint32_t* pIndices, size_t indexCount, const float3* pPositions, size_t positionStride, uint32_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles)
+        {
+            validateTriangleList(pIndices, indexCount, vertexCount);
+            if (maxVertices < 3 || maxVertices > kMaxMeshletVertices) throw RuntimeError("MeshOptimizer: Meshlet vertex limit ({}) is out of range.", maxVertices);
+            if (maxTriangles < 1 || maxTriangles > 0xffff) throw RuntimeError("MeshOptimizer: Meshlet triangle limit ({}) is out of range.", maxTriangles);
+            if (indexCount > 0 && !pPositions) throw RuntimeError("MeshOptimizer: Vertex positions are missing.");
+
+            const size_t triangleCount = indexCount / 3;
+            if (triangleCount > kInvalidIndex) throw RuntimeError("MeshOptimizer: Too many triangles ({}).", triangleCount);
+
+            MeshletList list;
+            if (triangleCount == 0) return list;
+
+            // Build the vertex-to-triangle adjacency with the live triangles first, as in optimizeVertexCache().
+            std::vector<uint32_t> liveTriangleCounts(vertexCount, 0);
+            for (size_t i = 0; i < indexCount; i++) liveTriangleCounts[pIndices[i]]++;
+
+            std::vector<size_t> adjacencyOffsets(vertexCount + 1, 0);
+            for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangleCounts[v];
+
+            std::vector<uint32_t> adjacency(indexCount);
+            {
+                std::vector<size_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (size_t i = 0; i < indexCount; i++) adjacency[fill[pIndices[i]]++] = (uint32_t)(i / 3);
+            }
+
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> localIndices(vertexCount, kInvalidIndex);   // Meshlet-local index of each vertex in the current meshlet.
+            std::vector<uint32_t> candidates;                                   // Live triangles adjacent to the current meshlet.
+            size_t nextSeed = 0;
+
+            Meshlet meshlet;
+
+            auto finishMeshlet = [&]()
+            {
+                for (uint32_t i = 0; i < meshlet.vertexCount; i++) localIndices[list.vertices[meshlet.vertexOffset + i]] = kInvalidIndex;
+                computeMeshletBounds(meshlet, list, pPositions, positionStride);
+                list.meshlets.push_back(meshlet);
+
+                meshlet = {};
+                meshlet.vertexOffset = (uint32_t)list.vertices.size();
+                meshlet.triangleOffset = (uint32_t)list.triangles.size();
+                candidates.clear();
+            };
+
+            auto countNewVertices = [&](uint32_t t)
+            {
+                const uint32_t* tri = pIndices + 3 * (size_t)t;
+                uint32_t count = 0;
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    const bool duplicate = (j > 0 && tri[j] == tri[0]) || (j > 1 && tri[j] == tri[1]);
+                    if (localIndices[tri[j]] == kInvalidIndex && !duplicate) count++;
+                }
+                return count;
+            };
+
+            for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+            {
+                // Pick the first adjacent triangle adding the fewest new vertices that still fits.
+                // Emitted triangles are removed from the candidates on the way.
+                uint32_t bestTriangle = kInvalidIndex;
+                uint32_t bestNewVertices = 4;
+                size_t liveCandidateCount = 0;
+                for (size_t i = 0; i < candidates.size(); i++)
+                {
+                    const uint32_t t = candidates[i];
+                    if (emitted[t]) continue;
+                    candidates[liveCandidateCount++] = t;
+                    if (bestNewVertices == 0) continue;
+
+                    const uint32_t newVertices = countNewVertices(t);
+                    if (newVertices < bestNewVertices && meshlet.vertexCount + newVertices <= maxVertices)
+                    {
+                        bestTriangle = t;
+                        bestNewVertices = newVertices;
+                    }
+                }
+                candidates.resize(liveCandidateCount);
+
+                // If there is none, start a new meshlet from the next unassigned triangle in index order.
+                if (bestTriangle == kInvalidIndex)
+                {
+                    if (meshlet.triangleCount > 0) finishMeshlet();
+                    while (emitted[nextSeed]) nextSeed++;
+                    bestTriangle = (uint32_t)nextSeed;
+                }
+
+                // Add the triangle.
+                emitted[bestTriangle] = true;
+                const uint32_t* tri = pIndices + 3 * (size_t)bestTriangle;
+                uint32_t packed = 0;
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    const uint32_t v = tri[j];
+                    if (localIndices[v] == kInvalidIndex)
+                    {
+                        localIndices[v] = meshlet.vertexCount++;
+                        list.vertices.push_back(v);
+
+                        // The remaining triangles of new vertices become candidates.
+                        const uint32_t* adj = adjacency.data() + adjacencyOffsets[v];
+                        candidates.insert(candidates.end(), adj, adj + liveTriangleCounts[v]);
+                    }
+                    packed |= localIndices[v] << (8 * j);
+
+                    // Remove the triangle from the live list of the vertex.
+                    uint32_t* adj = adjacency.data() + adjacencyOffsets[v];
+                    uint32_t& count = liveTriangleCounts[v];
+                    for (uint32_t k = 0; k < count; k++)
+                    {
+                        if (adj[k] == bestTriangle)
+                        {
+                            std::swap(adj[k], adj[count - 1]);
+                            count--;
+                            break;
+                        }
+                    }
+                }
+                FALCOR_ASSERT(meshlet.vertexCount <= maxVertices);
+                list.triangles.push_back(packed);
+                meshlet.triangleCount++;
+
+                if (meshlet.triangleCount == maxTriangles) finishMeshlet();
+            }
+
+            if (meshlet.triangleCount > 0) finishMeshlet();
+            return list;
+        }
+
+        std::vector<uint32_t> simplify(const uint32_t* pIndices, size_t indexCount, const float3* pPositions, size_t positionStride, uint32_t vertexCount,
+            size_t targetIndexCount, float targetError, float* pResultError)
+        {
+            validateTriangleList(pIndices, indexCount, vertexCount);
+            if (indexCount > 0 && !pPositions) throw RuntimeError("MeshOptimizer: Vertex positions are missing.");
+            if (!(targetError >= 0.f)) throw RuntimeError("MeshOptimizer: Target error ({}) must not be negative.", targetError);
+
+            std::vector<uint32_t> indices(pIndices, pIndices + indexCount);
+            if (pResultError) *pResultError = 0.f;
+            if (indices.size() <= targetIndexCount) return indices;
+
+            // Normalize the positions so that the errors are relative to the mesh extent.
+            std::vector<float3> positions(vertexCount);
+            float3 boundsMin = float3(std::numeric_limits<float>::max());
+            float3 boundsMax = float3(-std::numeric_limits<float>::max());
+            for (uint32_t index : indices)
+            {
+                boundsMin = glm::min(boundsMin, getPosition(pPositions, positionStride, index));
+                boundsMax = glm::max(boundsMax, getPosition(pPositions, positionStride, index));
+            }
+            const float extent = std::max(std::max(boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y), boundsMax.z - boundsMin.z);
+            const float scale = extent > 0.f ? 1.f / extent : 1.f;
+            for (uint32_t index : indices) positions[index] = (getPosition(pPositions, positionStride, index) - boundsMin) * scale;
+
+            // Lock the vertices on edges that are not shared by exactly two triangles.
+            std::vector<bool> locked(vertexCount, false);
+            {
+                std::vector<uint64_t> edges;
+                edges.reserve(indices.size());
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        const uint32_t a = indices[i + j];
+                        const uint32_t b = indices[i + (j + 1) % 3];
+                        edges.push_back(((uint64_t)std::min(a, b) << 32) | std::max(a, b));
+                    }
+                }
+                std::sort(edges.begin(), edges.end());
+
+                for (size_t i = 0; i < edges.size();)
+                {
+                    size_t j = i + 1;
+                    while (j < edges.size() && edges[j] == edges[i]) j++;
+                    if (j - i != 2)
+                    {
+                        locked[(uint32_t)(edges[i] >> 32)] = true;
+                        locked[(uint32_t)edges[i]] = true;
+                    }
+                    i = j;
+                }
+            }
+
+            // Accumulate the area-weighted triangle planes at the vertices.
+            std::vector<Quadric> quadrics(vertexCount);
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const float3& p0 = positions[indices[i]];
+                const float3 n = glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+                const float len = glm::length(n);
+                if (!(len > 0.f)) continue;
+
+                const float3 normal = n / len;
+                const float d = -glm::dot(normal, p0);
+                for (uint32_t j = 0; j < 3; j++) quadrics[indices[i + j]].addPlane(normal, d, 0.5 * len);
+            }
+
+            struct Collapse
+            {
+                uint32_t source;
+                uint32_t target;
+                float error;
+            };
+
+            std::vector<Collapse> collapses;
+            std::vector<size_t> adjacencyOffsets(vertexCount + 1);
+            std::vector<uint32_t> adjacency;
+            std::vector<bool> touched(vertexCount);
+            std::vector<bool> removed;
+            std::vector<uint32_t> sourceNeighbors, targetNeighbors, commonNeighbors;
+            size_t liveIndexCount = indices.size();
+            float resultError = 0.f;
+
+            // Each pass collapses edges in order of increasing error. A vertex takes part in at most one collapse per pass,
+            // so that the vertex adjacency only needs to be rebuilt between passes.
+            while (liveIndexCount > targetIndexCount)
+            {
+                const size_t triangleCount = indices.size() / 3;
+
+                // Find the cheapest collapse direction of each edge. Interior edges with consistent winding are visited
+                // twice, so only the direction with the smaller first index is considered.
+                collapses.clear();
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        const uint32_t a = indices[i + j];
+                        const uint32_t b = indices[i + (j + 1) % 3];
+                        if (a >= b || (locked[a] && locked[b])) continue;
+
+                        Quadric q = quadrics[a];
+                        q += quadrics[b];
+                        const float errorA = locked[a] ? std::numeric_limits<float>::infinity() : q.getError(positions[b]);
+                        const float errorB = locked[b] ? std::numeric_limits<float>::infinity() : q.getError(positions[a]);
+                        const Collapse collapse = errorA <= errorB ? Collapse{ a, b, errorA } : Collapse{ b, a, errorB };
+                        if (collapse.error <= targetError) collapses.push_back(collapse);
+                    }
+                }
+                if (collapses.empty()) break;
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+                // Build the vertex-to-triangle adjacency.
+                std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+                for (uint32_t index : indices) adjacencyOffsets[index + 1]++;
+                for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+                adjacency.resize(indices.size());
+                {
+                    std::vector<size_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                    for (size_t i = 0; i < indices.size(); i++) adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+                }
+
+                std::fill(touched.begin(), touched.end(), false);
+                removed.assign(triangleCount, false);
+                size_t collapseCount = 0;
+
+                for (const auto& collapse : collapses)
+                {
+                    if (liveIndexCount <= targetIndexCount) break;
+
+                    const uint32_t source = collapse.source;
+                    const uint32_t target = collapse.target;
+                    if (touched[source] || touched[target]) continue;
+
+                    const uint32_t* adjBegin = adjacency.data() + adjacencyOffsets[source];
+                    const uint32_t* adjEnd = adjacency.data() + adjacencyOffsets[source + 1];
+
+                    // Reject the collapse if it would make the mesh non-manifold, i.e. if the two vertices share
+                    // neighbors other than the opposite vertices of the triangles on the collapsed edge.
+                    auto gatherNeighbors = [&](uint32_t v, std::vector<uint32_t>& neighbors)
+                    {
+                        neighbors.clear();
+                        for (size_t k = adjacencyOffsets[v]; k < adjacencyOffsets[v + 1]; k++)
+                        {
+                            if (removed[adjacency[k]]) continue;
+                            const uint32_t* tri = indices.data() + 3 * (size_t)adjacency[k];
+                            for (uint32_t j = 0; j < 3; j++)
+                            {
+                                if (tri[j] != v) neighbors.push_back(tri[j]);
+                            }
+                        }
+                        std::sort(neighbors.begin(), neighbors.end());
+                        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+                    };
+                    gatherNeighbors(source, sourceNeighbors);
+                    gatherNeighbors(target, targetNeighbors);
+                    commonNeighbors.clear();
+                    std::set_intersection(sourceNeighbors.begin(), sourceNeighbors.end(), targetNeighbors.begin(), targetNeighbors.end(), std::back_inserter(commonNeighbors));
+
+                    // Reject the collapse if it flips or folds over any of the remaining triangles.
+                    uint32_t sharedTriangleCount = 0;
+                    bool flips = false;
+                    for (const uint32_t* t = adjBegin; t != adjEnd && !flips; t++)
+                    {
+                        const uint32_t* tri = indices.data() + 3 * (size_t)*t;
+                        if (removed[*t]) continue;
+                        if (tri[0] == target || tri[1] == target || tri[2] == target)
+                        {
+                            sharedTriangleCount++;
+                            continue;
+                        }
+
+                        float3 p[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+                        const float3 oldNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+                        for (uint32_t j = 0; j < 3; j++)
+                        {
+                            if (tri[j] == source) p[j] = positions[target];
+                        }
+                        const float3 newNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+                        flips = glm::dot(oldNormal, newNormal) <= kMinNormalDot * glm::length(oldNormal) * glm::length(newNormal);
+                    }
+                    if (flips || commonNeighbors.size() != sharedTriangleCount) continue;
+
+                    // Move the triangles over to the target vertex and remove the ones that collapse.
+                    for (const uint32_t* t = adjBegin; t != adjEnd; t++)
+                    {
+                        if (removed[*t]) continue;
+                        uint32_t* tri = indices.data() + 3 * (size_t)*t;
+                        for (uint32_t j = 0; j < 3; j++)
+                        {
+                            if (tri[j] == source) tri[j] = target;
+                        }
+                        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+                        {
+                            removed[*t] = true;
+                            liveIndexCount -= 3;
+                        }
+                    }
+
+                    quadrics[target] += quadrics[source];
+                    touched[source] = touched[target] = true;
+                    resultError = std::max(resultError, collapse.error);
+                    collapseCount++;
+                }
+
+                // Compact the index buffer.
+                size_t writeIndex = 0;
+                for (size_t t = 0; t < triangleCount; t++)
+                {
+                    if (removed[t]) continue;
+                    for (uint32_t j = 0; j < 3; j++) indices[writeIndex++] = indices[3 * t + j];
+                }
+                indices.resize(writeIndex);
+                FALCOR_ASSERT(indices.size() == liveIndexCount);
+
+                if (collapseCount == 0) break;
+            }
+
+            if (pResultError) *pResultError = resultError;
+            return indices;
+        }
+
+        bool findRigidTransform(const float3* pSrcPositions, const float3* pDstPositions, size_t positionStride, size_t count, float tolerance, glm::mat4& transform)
+        {
+            if (count == 0) return false;
+            if (!pSrcPositions || !pDstPositions) throw RuntimeError("MeshOptimizer: Position buffer is missing.");
+            if (count > std::numeric_limits<uint32_t>::max()) throw RuntimeError("MeshOptimizer: Point count ({}) is too large.", count);
+
+            auto getSrc = [&](size_t i) -> const float3& { return getPosition(pSrcPositions, positionStride, (uint32_t)i); };
+            auto getDst = [&](size_t i) -> const float3& { return getPosition(pDstPositions, positionStride, (uint32_t)i); };
+
+            const float3 srcCentroid = computeCentroid(pSrcPositions, positionStride, count);
+            const float3 dstCentroid = computeCentroid(pDstPositions, positionStride, count);
+
+            // The first frame axis points to the source point farthest from the centroid,
+            // the second axis to the point farthest from the line along the first axis.
+            size_t a = 0;
+            float radius = 0.f;
+            for (size_t i = 0; i < count; i++)
+            {
+                float d = glm::length(getSrc(i) - srcCentroid);
+                if (d > radius) { radius = d; a = i; }
+            }
+            if (!(radius > 0.f)) return false;
+
+            const float3 srcAxis = (getSrc(a) - srcCentroid) / radius;
+            size_t b = 0;
+            float maxExtent = 0.f;
+            for (size_t i = 0; i < count; i++)
+            {
+                float d = glm::length(glm::cross(getSrc(i) - srcCentroid, srcAxis));
+                if (d > maxExtent) { maxExtent = d; b = i; }
+            }
+            if (maxExtent < kMinFrameExtent * radius) return false;
+
+            // Build orthonormal frames from the same two points in both lists.
+            // The rotation maps the source frame onto the destination frame.
+            auto computeFrame = [](const float3& centroid, const float3& pa, const float3& pb)
+            {
+                float3 u = glm::normalize(pa - centroid);
+                float3 v = pb - centroid;
+                v = glm::normalize(v - glm::dot(v, u) * u);
+                return glm::mat3(u, v, glm::cross(u, v));
+            };
+            if (glm::length(glm::cross(getDst(a) - dstCentroid, getDst(b) - dstCentroid)) < kMinFrameExtent * radius * radius) return false;
+
+            const glm::mat3 srcFrame = computeFrame(srcCentroid, getSrc(a), getSrc(b));
+            const glm::mat3 dstFrame = computeFrame(dstCentroid, getDst(a), getDst(b));
+            const glm::mat3 rotation = dstFrame * glm::transpose(srcFrame);
+            const float3 translation = dstCentroid - rotation * srcCentroid;
+
+            // Verify the transform on all points.
+            const float maxError = tolerance * radius;
+            for (size_t i = 0; i < count; i++)
+            {
+                const float3& src = getSrc(i);
+                const float3& dst = getDst(i);
+                const float error = glm::length(rotation * src + translation - dst);
+                if (!(error <= maxError + kPositionPrecision * (maxAbsComponent(src) + maxAbsComponent(dst)))) return false;
+            }
+
+            transform = glm::mat4(rotation);
+            transform[3] = float4(translation, 1.f);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,183 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Utility functions for optimizing the layout of indexed triangle meshes.
+    */
+    namespace MeshOptimizer
+    {
+        /** Default size of the simulated post-transform vertex cache.
+        */
+        static constexpr uint32_t kDefaultVertexCacheSize = 16;
+
+        /** Default meshlet size limits. These match the recommended mesh shader output sizes.
+        */
+        static constexpr uint32_t kDefaultMeshletMaxVertices = 64;
+        static constexpr uint32_t kDefaultMeshletMaxTriangles = 124;
+
+        /** Maximum number of vertices in a meshlet. The meshlet-local vertex indices are stored in 8 bits.
+        */
+        static constexpr uint32_t kMaxMeshletVertices = 256;
+
+        /** Statistics of the post-transform vertex cache efficiency of a mesh.
+        */
+        struct VertexCacheStats
+        {
+            uint64_t triangleCount = 0;             ///< Number of triangles.
+            uint64_t vertexCount = 0;               ///< Number of vertices referenced by the index buffer.
+            uint64_t transformedVertexCount = 0;    ///< Number of vertex shader invocations, i.e. the number of cache misses.
+
+            /** Average cache miss ratio (transformed vertices per triangle). The best possible value is around 0.5, the worst is 3.
+            */
+            double getACMR() const { return triangleCount > 0 ? (double)transformedVertexCount / triangleCount : 0.0; }
+
+            /** Average transformed vertex ratio (transformed vertices per vertex). The best possible value is 1.
+            */
+            double getATVR() const { return vertexCount > 0 ? (double)transformedVertexCount / vertexCount : 0.0; }
+
+            VertexCacheStats& operator+=(const VertexCacheStats& other)
+            {
+                triangleCount += other.triangleCount;
+                vertexCount += other.vertexCount;
+                transformedVertexCount += other.transformedVertexCount;
+                return *this;
+            }
+        };
+
+        /** Meshlet, i.e. a cluster of triangles with a small number of unique vertices.
+        */
+        struct Meshlet
+        {
+            uint32_t vertexOffset = 0;      ///< Offset of the first vertex in MeshletList::vertices.
+            uint32_t triangleOffset = 0;    ///< Offset of the first triangle in MeshletList::triangles.
+            uint32_t vertexCount = 0;       ///< Number of vertices.
+            uint32_t triangleCount = 0;     ///< Number of triangles.
+
+            float3 boundsMin = float3(0.f); ///< Minimum of the bounding box of the vertices.
+            float3 boundsMax = float3(0.f); ///< Maximum of the bounding box of the vertices.
+
+            /** Normal cone for backface culling. The meshlet is backfacing as seen from point p if
+                dot(normalize(coneApex - p), coneAxis) >= coneCutoff.
+                If the triangle normals are too spread out, the axis is zero and the cutoff is one so that the test always fails.
+            */
+            float3 coneAxis = float3(0.f);  ///< Normal cone axis.
+            float coneCutoff = 1.f;         ///< Sine of the normal cone half-angle.
+            float3 coneApex = float3(0.f);  ///< Normal cone apex.
+        };
+
+        /** List of meshlets of a mesh.
+        */
+        struct MeshletList
+        {
+            std::vector<Meshlet> meshlets;
+            std::vector<uint32_t> vertices;     ///< Mesh vertex indices referenced by the meshlets.
+            std::vector<uint32_t> triangles;    ///< Triangles with three 8-bit meshlet-local vertex indices packed in bits 0-7, 8-15 and 16-23.
+        };
+
+        /** Simulate a FIFO post-transform vertex cache for a triangle list.
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices. Must be a multiple of three.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \param[in] cacheSize Number of entries in the simulated cache.
+            \return Cache statistics.
+        */
+        FALCOR_API VertexCacheStats analyzeVertexCache(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultVertexCacheSize);
+
+        /** Reorder the triangles of a triangle list for post-transform vertex cache efficiency.
+            This uses the greedy algorithm by Tom Forsyth ("Linear-Speed Vertex Cache Optimisation", 2006) with an LRU cache model.
+            The winding of the individual triangles is preserved.
+            \param[in,out] pIndices Triangle list indices, reordered in place.
+            \param[in] indexCount Number of indices. Must be a multiple of three.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \param[in] cacheSize Number of entries in the modeled cache.
+        */
+        FALCOR_API void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultVertexCacheSize);
+
+        /** Compute a vertex order that improves vertex fetch locality.
+            Vertices are numbered in order of first use in the index buffer. Unreferenced vertices are placed last in their original order.
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \return Remapping table from old to new vertex index with vertexCount entries.
+        */
+        FALCOR_API std::vector<uint32_t> computeVertexFetchRemap(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount);
+
+        /** Split a triangle list into meshlets.
+            The meshlets are grown greedily from the first unassigned triangle in index order by adding adjacent triangles
+            that add the fewest new vertices. The triangle order and winding within a meshlet follows the input, so it
+            is best to optimize the mesh with optimizeVertexCache() first.
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices. Must be a multiple of three.
+            \param[in] pPositions Pointer to the position of the first vertex.
+            \param[in] positionStride Distance in bytes between consecutive positions.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \param[in] maxVertices Maximum number of vertices per meshlet, in the range [3, kMaxMeshletVertices].
+            \param[in] maxTriangles Maximum number of triangles per meshlet, in the range [1, 65535].
+            \return List of meshlets.
+        */
+        FALCOR_API MeshletList buildMeshlets(const uint32_t* pIndices, size_t indexCount, const float3* pPositions, size_t positionStride, uint32_t vertexCount,
+            uint32_t maxVertices = kDefaultMeshletMaxVertices, uint32_t maxTriangles = kDefaultMeshletMaxTriangles);
+
+        /** Simplify a triangle list by collapsing edges in order of their quadric error
+            (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997).
+            Vertices are collapsed onto one of their neighbors, so the result references a subset of the input vertices.
+            Vertices on open or non-manifold edges are never removed. Since attribute seams (e.g. UV seams) split
+            the mesh into separate vertices, this preserves seams as well as the mesh borders.
+            \param[in] pIndices Triangle list indices.
+            \param[in] indexCount Number of indices. Must be a multiple of three.
+            \param[in] pPositions Pointer to the position of the first vertex.
+            \param[in] positionStride Distance in bytes between consecutive positions.
+            \param[in] vertexCount Number of vertices. All indices must be smaller than this.
+            \param[in] targetIndexCount Number of indices to reduce the mesh to. The result has more indices if the error limit is reached first.
+            \param[in] targetError Maximum error, relative to the largest extent of the mesh bounding box.
+            \param[out] pResultError Optional. Error of the result, relative to the largest extent of the mesh bounding box.
+            \return Indices of the simplified triangle list.
+        */
+        FALCOR_API std::vector<uint32_t> simplify(const uint32_t* pIndices, size_t indexCount, const float3* pPositions, size_t positionStride, uint32_t vertexCount,
+            size_t targetIndexCount, float targetError, float* pResultError = nullptr);
+
+        /** Find the rigid transform (rotation and translation) that maps a list of points onto another list of points
+            with the same number of points in corresponding order, e.g. the vertices of two copies of a mesh.
+            The rotation is solved for from the centroid and two vertices of the source points, and then verified on all points.
+            Reflections are not supported.
+            \param[in] pSrcPositions Pointer to the first source position.
+            \param[in] pDstPositions Pointer to the first destination position.
+            \param[in] positionStride Distance in bytes between consecutive positions in both lists.
+            \param[in] count Number of points.
+            \param[in] tolerance Maximum distance between a transformed source point and the destination point, relative to the largest distance of the source points from their centroid.
+            \param[out] transform Transform from source to destination space. Only valid if the function returns true.
+            \return True if the points are related by a rigid transform within the tolerance. False if not, or if the source points are collinear.
+        */
+        FALCOR_API bool findRigidTransform(const float3* pSrcPositions, const float3* pDstPositions, size_t positionStride, size_t count, float tolerance, glm::mat4& transform);
+    }
+}
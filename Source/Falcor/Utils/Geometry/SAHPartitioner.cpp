@@ -0,0 +1,272 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "SAHPartitioner.h"
+#include <numeric>
+
+namespace Falcor
+{
+    namespace SAHPartitioner
+    {
+        namespace
+        {
+            struct Bin
+            {
+                AABB bounds;
+                uint64_t triangleCount = 0;
+                uint32_t itemCount = 0;
+            };
+
+            /** Candidate split. Items with a centroid bin index <= binIndex along the axis go to the left side.
+            */
+            struct Split
+            {
+                int axis = -1;
+                uint32_t binIndex = 0;
+                uint64_t groupCount = 0;
+                double cost = 0.0;
+
+                bool isBetterThan(const Split& other) const
+                {
+                    if (other.axis < 0) return true;
+                    if (groupCount != other.groupCount) return groupCount < other.groupCount;
+                    return cost < other.cost;
+                }
+            };
+
+            /** Node of the top-down partitioning.
+            */
+            struct Node
+            {
+                std::vector<uint32_t> items;
+                uint64_t triangleCount = 0;
+            };
+
+            uint64_t getMinGroupCount(uint64_t triangleCount, uint64_t maxTriangleCount)
+            {
+                return std::max<uint64_t>(1, div_round_up(triangleCount, maxTriangleCount));
+            }
+
+            uint32_t getBinIndex(float centroid, float minCentroid, float binScale, uint32_t binCount)
+            {
+                return std::min(binCount - 1, (uint32_t)std::max(0.f, (centroid - minCentroid) * binScale));
+            }
+
+            /** Returns true if two boxes overlap. Boxes that only touch do not overlap.
+                Axes along which either box is flat are ignored, so that coplanar geometry (e.g. floor tiles) is considered overlapping.
+            */
+            bool overlaps(const AABB& a, const AABB& b, AABB& intersection)
+            {
+                intersection = a;
+                intersection.intersection(b);
+                if (!intersection.valid()) return false;
+
+                const float3 e = intersection.extent();
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    bool flat = a.extent()[axis] == 0.f || b.extent()[axis] == 0.f;
+                    if (!flat && e[axis] <= 0.f) return false;
+                }
+                return true;
+            }
+
+            /** Find the best binned SAH split of a node.
+                \return The split, or a split with axis = -1 if all item centroids fall into the same bin.
+            */
+            Split findSplit(const Item* pItems, const Node& node, uint64_t maxTriangleCount, uint32_t binCount, std::vector<Bin>& bins, std::vector<Bin>& rightBins)
+            {
+                AABB centroidBounds;
+                for (uint32_t i : node.items) centroidBounds.include(pItems[i].bounds.center());
+                const float3 centroidExtent = centroidBounds.extent();
+
+                Split best;
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    if (!(centroidExtent[axis] > 0.f)) continue;
+                    const float binScale = binCount / centroidExtent[axis];
+
+                    std::fill(bins.begin(), bins.end(), Bin());
+                    for (uint32_t i : node.items)
+                    {
+                        const Item& item = pItems[i];
+                        Bin& bin = bins[getBinIndex(item.bounds.center()[axis], centroidBounds.minPoint[axis], binScale, binCount)];
+                        bin.bounds.include(item.bounds);
+                        bin.triangleCount += item.triangleCount;
+                        bin.itemCount++;
+                    }
+
+                    // Sweep from the right to accumulate the right side of each candidate plane.
+                    rightBins[binCount - 1] = bins[binCount - 1];
+                    for (uint32_t b = binCount - 1; b > 0; b--)
+                    {
+                        rightBins[b - 1] = rightBins[b];
+                        rightBins[b - 1].bounds.include(bins[b - 1].bounds);
+                        rightBins[b - 1].triangleCount += bins[b - 1].triangleCount;
+                        rightBins[b - 1].itemCount += bins[b - 1].itemCount;
+                    }
+
+                    // Sweep from the left and evaluate the plane between bin b and b + 1.
+                    Bin left;
+                    for (uint32_t b = 0; b + 1 < binCount; b++)
+                    {
+                        left.bounds.include(bins[b].bounds);
+                        left.triangleCount += bins[b].triangleCount;
+                        left.itemCount += bins[b].itemCount;
+
+                        const Bin& right = rightBins[b + 1];
+                        if (left.itemCount == 0 || right.itemCount == 0) continue;
+
+                        Split split;
+                        split.axis = axis;
+                        split.binIndex = b;
+                        split.groupCount = getMinGroupCount(left.triangleCount, maxTriangleCount) + getMinGroupCount(right.triangleCount, maxTriangleCount);
+                        split.cost = (double)left.bounds.area() * left.triangleCount + (double)right.bounds.area() * right.triangleCount;
+                        if (split.isBetterThan(best)) best = split;
+                    }
+                }
+
+                return best;
+            }
+        }
+
+        Partition partition(const Item* pItems, size_t itemCount, uint64_t maxTriangleCount, uint32_t binCount)
+        {
+            checkArgument(maxTriangleCount > 0, "'maxTriangleCount' must be larger than zero.");
+            checkArgument(binCount >= 2 && binCount <= 256, "'binCount' ({}) must be in the range [2, 256].", binCount);
+            checkArgument(itemCount <= std::numeric_limits<uint32_t>::max(), "'itemCount' ({}) is too large.", itemCount);
+
+            Partition result;
+            if (itemCount == 0) return result;
+
+            Node root;
+            root.items.resize(itemCount);
+            std::iota(root.items.begin(), root.items.end(), 0u);
+            for (size_t i = 0; i < itemCount; i++)
+            {
+                checkArgument(pItems[i].bounds.valid(), "Item {} has an invalid bounding box.", i);
+                root.triangleCount += pItems[i].triangleCount;
+            }
+
+            std::vector<Bin> bins(binCount);
+            std::vector<Bin> rightBins(binCount);
+
+            // Split the nodes depth first. The right child is pushed first so that the groups are output in left-to-right order.
+            std::vector<Node> stack;
+            stack.push_back(std::move(root));
+            while (!stack.empty())
+            {
+                Node node = std::move(stack.back());
+                stack.pop_back();
+
+                if (node.triangleCount <= maxTriangleCount || node.items.size() == 1)
+                {
+                    std::sort(node.items.begin(), node.items.end());
+                    result.groups.push_back(std::move(node.items));
+                    continue;
+                }
+
+                Node left, right;
+                Split split = findSplit(pItems, node, maxTriangleCount, binCount, bins, rightBins);
+                if (split.axis >= 0)
+                {
+                    // Recompute the bin mapping of the chosen axis to partition the items.
+                    AABB centroidBounds;
+                    for (uint32_t i : node.items) centroidBounds.include(pItems[i].bounds.center());
+                    const float binScale = binCount / centroidBounds.extent()[split.axis];
+
+                    for (uint32_t i : node.items)
+                    {
+                        uint32_t b = getBinIndex(pItems[i].bounds.center()[split.axis], centroidBounds.minPoint[split.axis], binScale, binCount);
+                        Node& dst = b <= split.binIndex ? left : right;
+                        dst.items.push_back(i);
+                        dst.triangleCount += pItems[i].triangleCount;
+                    }
+                }
+                else
+                {
+                    // All centroids coincide. Fall back on splitting at the median in terms of triangle count.
+                    for (uint32_t i : node.items)
+                    {
+                        const bool toLeft = left.items.empty() || (left.triangleCount + pItems[i].triangleCount <= node.triangleCount / 2 && right.items.empty());
+                        Node& dst = toLeft ? left : right;
+                        dst.items.push_back(i);
+                        dst.triangleCount += pItems[i].triangleCount;
+                    }
+                }
+                FALCOR_ASSERT(!left.items.empty() && !right.items.empty());
+
+                stack.push_back(std::move(right));
+                stack.push_back(std::move(left));
+            }
+
+            evaluate(pItems, itemCount, result);
+            return result;
+        }
+
+        void evaluate(const Item* pItems, size_t itemCount, Partition& partition)
+        {
+            AABB totalBounds;
+            uint64_t totalTriangleCount = 0;
+            std::vector<AABB> groupBounds(partition.groups.size());
+            double groupCost = 0.0;
+
+            for (size_t g = 0; g < partition.groups.size(); g++)
+            {
+                uint64_t triangleCount = 0;
+                for (uint32_t i : partition.groups[g])
+                {
+                    checkArgument(i < itemCount, "Item index {} is out of range.", i);
+                    groupBounds[g].include(pItems[i].bounds);
+                    triangleCount += pItems[i].triangleCount;
+                }
+                if (groupBounds[g].valid()) groupCost += (double)groupBounds[g].area() * triangleCount;
+                totalBounds.include(groupBounds[g]);
+                totalTriangleCount += triangleCount;
+            }
+
+            partition.cost = 1.0;
+            partition.overlap = 0.0;
+
+            const double totalArea = totalBounds.valid() ? totalBounds.area() : 0.0;
+            if (totalArea <= 0.0) return;
+
+            if (totalTriangleCount > 0) partition.cost = groupCost / (totalArea * totalTriangleCount);
+
+            double overlapArea = 0.0;
+            for (size_t a = 0; a < groupBounds.size(); a++)
+            {
+                for (size_t b = a + 1; b < groupBounds.size(); b++)
+                {
+                    AABB intersection;
+                    if (overlaps(groupBounds[a], groupBounds[b], intersection)) overlapArea += intersection.area();
+                }
+            }
+            partition.overlap = overlapArea / totalArea;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Utils/Math/AABB.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Utility functions for partitioning geometry into groups (e.g. BLASes) using the surface area heuristic (SAH).
+    */
+    namespace SAHPartitioner
+    {
+        /** Default number of bins per axis used to evaluate split candidates.
+        */
+        static constexpr uint32_t kDefaultBinCount = 16;
+
+        /** Item to partition, e.g. a mesh or a part of a mesh.
+        */
+        struct Item
+        {
+            AABB bounds;                ///< Bounding box of the item.
+            uint64_t triangleCount = 0; ///< Number of triangles in the item.
+        };
+
+        /** Partition of a list of items into groups.
+        */
+        struct Partition
+        {
+            std::vector<std::vector<uint32_t>> groups;  ///< Item indices of each group.
+
+            /** Estimated ray traversal cost relative to keeping all items in a single group.
+                This is the sum of area(group) * triangleCount(group) over all groups divided by the same term for the union of the items.
+                A value of 1 means the groups fully overlap, lower values are better.
+            */
+            double cost = 1.0;
+
+            /** Estimated overlap between the groups. This is the summed surface area of the intersections
+                of all pairs of group bounding boxes relative to the surface area of the union of the items.
+            */
+            double overlap = 0.0;
+        };
+
+        /** Partition items into groups with at most a given number of triangles each.
+            The items are split recursively top-down. At each level the split plane is chosen among binned candidates
+            along all three axes by the surface area heuristic, preferring the candidates that allow for the smallest
+            number of groups. Items are not split, so an item with more than the maximum number of triangles is placed in a group by itself.
+            \param[in] pItems Items to partition.
+            \param[in] itemCount Number of items.
+            \param[in] maxTriangleCount Maximum number of triangles per group. Must be larger than zero.
+            \param[in] binCount Number of bins per axis, in the range [2, 256].
+            \return Partition with the item indices sorted within each group.
+        */
+        FALCOR_API Partition partition(const Item* pItems, size_t itemCount, uint64_t maxTriangleCount, uint32_t binCount = kDefaultBinCount);
+
+        /** Evaluate the estimated cost and overlap of a partition.
+            \param[in] pItems Items referenced by the partition.
+            \param[in] itemCount Number of items.
+            \param[in,out] partition Partition whose cost and overlap are updated.
+        */
+        FALCOR_API void evaluate(const Item* pItems, size_t itemCount, Partition& partition);
+    }
+}
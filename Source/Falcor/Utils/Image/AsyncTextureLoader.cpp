@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "AsyncTextureLoader.h"
 #include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
 
 namespace Falcor
 {
@@ -46,21 +47,29 @@ namespace Falcor
         terminateWorkers();
 
         gpDevice->flushAndSync();
+        storePendingTextures();
     }
 
     std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback)
     {
         std::lock_guard<std::mutex> lock(mMutex);
-        mLoadRequestQueue.push(LoadRequest{path, generateMipLevels, loadAsSrgb, bindFlags, callback });
+        mLoadRequestQueue.push(LoadRequest{path, generateMipLevels, loadAsSrgb, bindFlags, callback, mpTextureCache });
         mCondition.notify_one();
         return mLoadRequestQueue.back().promise.get_future();
     }
 
+    void AsyncTextureLoader::setTextureCache(const TextureCache::SharedPtr& pTextureCache)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mpTextureCache = pTextureCache;
+    }
+
     void AsyncTextureLoader::runWorkers(size_t threadCount)
     {
         // Create a barrier to synchronize worker threads before issuing a global flush.
         mFlushBarrier = std::make_shared<Barrier>(threadCount, [&]() {
             gpDevice->flushAndSync();
+            storePendingTextures();
             mFlushPending = false;
             mUploadCounter = 0;
             });
@@ -106,7 +115,28 @@ namespace Falcor
             lock.unlock();
 
             // Load the textures (this part is running in parallel).
-            Texture::SharedPtr pTexture = Texture::createFromFile(request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+            // Look up the texture cache first if enabled. Missing textures are queued for storing at the next flush.
+            Texture::SharedPtr pTexture;
+            std::filesystem::path fullPath;
+            if (request.pTextureCache && findFileInDataDirectories(request.path, fullPath) && TextureCache::isCacheable(fullPath))
+            {
+                TextureCache::Key key;
+                pTexture = request.pTextureCache->load(fullPath, request.generateMipLevels, request.loadAsSRGB, request.bindFlags, key);
+                if (!pTexture)
+                {
+                    CpuTimer timer;
+                    timer.update();
+                    pTexture = Texture::createFromFile(fullPath, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+                    timer.update();
+
+                    std::lock_guard<std::mutex> pendingLock(mMutex);
+                    mPendingStores.push_back({ request.pTextureCache, key, pTexture, request.bindFlags, timer.delta() });
+                }
+            }
+            else
+            {
+                pTexture = Texture::createFromFile(request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+            }
             request.promise.set_value(pTexture);
 
             if (request.callback)
@@ -129,6 +159,21 @@ namespace Falcor
         }
     }
 
+    void AsyncTextureLoader::storePendingTextures()
+    {
+        // This is called while all workers are synchronized, so reading back texture data from the GPU is safe.
+        std::vector<PendingStore> pendingStores;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            pendingStores.swap(mPendingStores);
+        }
+
+        for (const auto& pending : pendingStores)
+        {
+            pending.pTextureCache->store(pending.key, pending.pTexture, pending.bindFlags, pending.loadTime);
+        }
+    }
+
     void AsyncTextureLoader::terminateWorkers()
     {
         {
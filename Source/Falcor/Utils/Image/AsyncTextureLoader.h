@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "TextureCache.h"
 #include <future>
 
 namespace Falcor
@@ -65,10 +66,17 @@ namespace Falcor
             LoadCallback callback = {}
         );
 
+        /** Set the texture cache used for subsequent load requests.
+            Textures missing in the cache are stored at the next GPU flush, as reading back texture data is not safe while other workers upload.
+            \param[in] pTextureCache Texture cache, or nullptr to disable caching.
+        */
+        void setTextureCache(const TextureCache::SharedPtr& pTextureCache);
+
     private:
         void runWorkers(size_t threadCount);
         void runWorker();
         void terminateWorkers();
+        void storePendingTextures();
 
         struct LoadRequest
         {
@@ -77,9 +85,19 @@ namespace Falcor
             bool loadAsSRGB;
             Resource::BindFlags bindFlags;
             LoadCallback callback;
+            TextureCache::SharedPtr pTextureCache;
             std::promise<Texture::SharedPtr> promise;
         };
 
+        struct PendingStore
+        {
+            TextureCache::SharedPtr pTextureCache;
+            TextureCache::Key key;
+            Texture::SharedPtr pTexture;
+            Resource::BindFlags bindFlags;
+            double loadTime;
+        };
+
         std::mutex mMutex;                          ///< Mutex for synchronizing access to shared resources.
         std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
         std::shared_ptr<Barrier> mFlushBarrier;     ///< Barrier for flushing the GPU to upload textures.
@@ -87,6 +105,8 @@ namespace Falcor
 
         // Internal state. Do not access outside of critical section.
         std::queue<LoadRequest> mLoadRequestQueue;  ///< Texture loading request queue.
+        TextureCache::SharedPtr mpTextureCache;     ///< Texture cache used for new load requests.
+        std::vector<PendingStore> mPendingStores;   ///< Loaded textures waiting to be stored in the texture cache.
 
         bool mTerminate = false;                    ///< Flag to terminate worker threads.
         bool mFlushPending = false;                 ///< Flag to indicate a GPU flush is pending.
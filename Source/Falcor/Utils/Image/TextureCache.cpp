@@ -0,0 +1,272 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "TextureCache.h"
+#include "ImageIO.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Texture cache directory (subdirectory in the application data directory).
+        */
+        const std::string kDirectory = "NVIDIA/Falcor/TextureCache";
+
+        /** Cache version. Increment when the texture loading or the entry format changes.
+        */
+        const uint32_t kVersion = 1;
+
+        // Uncompressed entries use a simple container holding the texture data of all mip levels.
+        // Compressed entries are DDS files.
+        const std::string kRawExtension = ".tex";
+        const std::string kCompressedExtension = ".dds";
+
+        const char kMagic[4] = { 'F', 'T', 'C', 'E' };
+
+        struct RawHeader
+        {
+            char magic[4]{};
+            uint32_t version = 0;
+            ResourceFormat format = ResourceFormat::Unknown;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mipCount = 0;
+            uint64_t dataSize = 0;
+        };
+
+        const size_t kFileReadChunkSize = 4 * 1024 * 1024;
+
+        /** Check if a texture is stored BC7 compressed when compression is enabled.
+            Only 8-bit color formats are compressed. The base level needs to be a multiple of the block size,
+            as ImageIO::saveToDDS() would otherwise crop the texture.
+        */
+        bool isCompressible(const Texture::SharedPtr& pTexture)
+        {
+            ResourceFormat format = pTexture->getFormat();
+            FormatType type = getFormatType(format);
+            return (type == FormatType::Unorm || type == FormatType::UnormSrgb) && getNumChannelBits(format, 0) == 8 &&
+                getFormatChannelCount(format) >= 3 && pTexture->getWidth() % 4 == 0 && pTexture->getHeight() % 4 == 0;
+        }
+
+        /** Check if textures requested with the given bind flags may be stored BC7 compressed.
+            This must be based on the requested bind flags, as the created texture can have additional flags (e.g. RenderTarget for mip generation).
+        */
+        bool allowsCompression(Resource::BindFlags bindFlags)
+        {
+            return bindFlags == Resource::BindFlags::ShaderResource;
+        }
+    }
+
+    TextureCache::SharedPtr TextureCache::create(const std::filesystem::path& directory, uint64_t sizeLimit, bool compress)
+    {
+        return SharedPtr(new TextureCache(directory, sizeLimit, compress));
+    }
+
+    const TextureCache::SharedPtr& TextureCache::getDefault()
+    {
+        static SharedPtr pDefault = create(getAppDataDirectory() / kDirectory);
+        return pDefault;
+    }
+
+    TextureCache::TextureCache(const std::filesystem::path& directory, uint64_t sizeLimit, bool compress)
+        : mpDiskCache(DiskCache::create(directory, sizeLimit))
+        , mCompress(compress)
+    {
+    }
+
+    Texture::SharedPtr TextureCache::load(const std::filesystem::path& fullPath, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, Key& key)
+    {
+        CpuTimer timer;
+        timer.update();
+
+        // Compute the key from the file content and the load settings.
+        SHA1 sha1;
+        sha1.update(&kVersion, sizeof(kVersion));
+        sha1.update(&generateMipLevels, sizeof(generateMipLevels));
+        sha1.update(&loadAsSrgb, sizeof(loadAsSrgb));
+        sha1.update(&bindFlags, sizeof(bindFlags));
+        sha1.update(&mCompress, sizeof(mCompress));
+        {
+            Hash128 hash;
+            std::ifstream fs(fullPath, std::ios::binary);
+            std::vector<char> buffer(kFileReadChunkSize);
+            while (fs)
+            {
+                fs.read(buffer.data(), buffer.size());
+                hash.update(buffer.data(), (size_t)fs.gcount());
+            }
+            auto md = hash.final();
+            sha1.update(md.data(), md.size());
+        }
+        key = sha1.final();
+
+        // Look up the entry. Compressed entries are only created if compression is enabled and the bind flags allow it.
+        auto name = SHA1::toString(key);
+        Texture::SharedPtr pTexture;
+        if (mCompress && allowsCompression(bindFlags) && mpDiskCache->touch(name + kCompressedExtension))
+        {
+            pTexture = ImageIO::loadTextureFromDDS(mpDiskCache->getEntryPath(name + kCompressedExtension), loadAsSrgb);
+        }
+        else if (mpDiskCache->touch(name + kRawExtension))
+        {
+            pTexture = loadRaw(mpDiskCache->getEntryPath(name + kRawExtension), bindFlags);
+        }
+
+        timer.update();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (pTexture)
+        {
+            // Refer to the original image file, the source path is used to identify textures (e.g. in the scene cache).
+            pTexture->setSourcePath(fullPath);
+            mStats.hits++;
+            mStats.hitTime += timer.delta();
+        }
+        else
+        {
+            mStats.misses++;
+            mStats.missTime += timer.delta();
+        }
+        return pTexture;
+    }
+
+    void TextureCache::store(const Key& key, const Texture::SharedPtr& pTexture, Resource::BindFlags bindFlags, double loadTime)
+    {
+        CpuTimer timer;
+        timer.update();
+
+        if (pTexture && pTexture->getType() == Resource::Type::Texture2D && pTexture->getArraySize() == 1)
+        {
+            // Write the entry to a temporary file that is committed once complete.
+            auto name = SHA1::toString(key);
+            bool compress = mCompress && allowsCompression(bindFlags) && isCompressible(pTexture);
+            name += compress ? kCompressedExtension : kRawExtension;
+
+            auto tempPath = mpDiskCache->createTempPath(name);
+            if (compress ? storeCompressed(tempPath, pTexture) : storeRaw(tempPath, pTexture))
+            {
+                mpDiskCache->commit(name, tempPath);
+            }
+            else
+            {
+                mpDiskCache->discard(tempPath);
+                logWarning("Failed to store texture '{}' in the texture cache.", pTexture->getSourcePath());
+            }
+        }
+
+        timer.update();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.missTime += loadTime + timer.delta();
+    }
+
+    Texture::SharedPtr TextureCache::loadFromFile(const std::filesystem::path& fullPath, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags)
+    {
+        if (!isCacheable(fullPath)) return Texture::createFromFile(fullPath, generateMipLevels, loadAsSrgb, bindFlags);
+
+        Key key;
+        if (auto pTexture = load(fullPath, generateMipLevels, loadAsSrgb, bindFlags, key)) return pTexture;
+
+        CpuTimer timer;
+        timer.update();
+        auto pTexture = Texture::createFromFile(fullPath, generateMipLevels, loadAsSrgb, bindFlags);
+        timer.update();
+
+        store(key, pTexture, bindFlags, timer.delta());
+        return pTexture;
+    }
+
+    bool TextureCache::isCacheable(const std::filesystem::path& fullPath)
+    {
+        return !hasExtension(fullPath, "dds");
+    }
+
+    TextureCache::Stats TextureCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    Texture::SharedPtr TextureCache::loadRaw(const std::filesystem::path& path, Resource::BindFlags bindFlags) const
+    {
+        std::ifstream fs(path, std::ios::binary);
+        RawHeader header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) return nullptr;
+
+        std::vector<uint8_t> data(header.dataSize);
+        fs.read(reinterpret_cast<char*>(data.data()), data.size());
+        if ((uint64_t)fs.gcount() != header.dataSize) return nullptr;
+
+        return Texture::create2D(header.width, header.height, header.format, 1, header.mipCount, data.data(), bindFlags);
+    }
+
+    bool TextureCache::storeRaw(const std::filesystem::path& path, const Texture::SharedPtr& pTexture) const
+    {
+        // Read back all mip levels. The data is tightly packed, which is the layout expected when creating the texture.
+        auto pContext = gpDevice->getRenderContext();
+        std::vector<std::vector<uint8_t>> mips(pTexture->getMipCount());
+        RawHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.format = pTexture->getFormat();
+        header.width = pTexture->getWidth();
+        header.height = pTexture->getHeight();
+        header.mipCount = pTexture->getMipCount();
+        for (uint32_t mip = 0; mip < header.mipCount; mip++)
+        {
+            mips[mip] = pContext->readTextureSubresource(pTexture.get(), pTexture->getSubresourceIndex(0, mip));
+            header.dataSize += mips[mip].size();
+        }
+
+        std::ofstream fs(path, std::ios::binary);
+        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& mip : mips) fs.write(reinterpret_cast<const char*>(mip.data()), mip.size());
+        return (bool)fs;
+    }
+
+    bool TextureCache::storeCompressed(const std::filesystem::path& path, const Texture::SharedPtr& pTexture) const
+    {
+        // The mip chain is regenerated while compressing, so only the base level is read back.
+        try
+        {
+            auto pContext = gpDevice->getRenderContext();
+            auto data = pContext->readTextureSubresource(pTexture.get(), pTexture->getSubresourceIndex(0, 0));
+            auto pBitmap = Bitmap::create(pTexture->getWidth(), pTexture->getHeight(), pTexture->getFormat(), data.data());
+            ImageIO::saveToDDS(path, *pBitmap, ImageIO::CompressionMode::BC7, pTexture->getMipCount() > 1);
+            return true;
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("{}", e.what());
+            return false;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/Texture.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/DiskCache.h"
+#include <filesystem>
+#include <mutex>
+
+namespace Falcor
+{
+    /** On-disk cache of textures loaded from image files.
+        Entries hold the final texture data including the full mip chain, so loading a cached texture skips image
+        decoding, format conversion and mip generation. Entries are keyed by a hash of the image file content and the
+        load settings. Optionally, 8-bit color textures are stored BC7 compressed using ImageIO::saveToDDS().
+        The cache directory is managed by a DiskCache and can be shared by concurrent processes.
+        All functions are thread safe, except for store() which reads back the texture data from the GPU.
+    */
+    class FALCOR_API TextureCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TextureCache>;
+        using Key = SHA1::MD;
+
+        static const uint64_t kDefaultSizeLimit = 32ull * 1024 * 1024 * 1024;
+
+        struct Stats
+        {
+            uint64_t hits = 0;          ///< Number of textures loaded from the cache.
+            uint64_t misses = 0;        ///< Number of textures loaded from image files.
+            double hitTime = 0.0;       ///< Total time spent loading textures from the cache in seconds.
+            double missTime = 0.0;      ///< Total time spent loading textures from image files and storing them in the cache in seconds.
+        };
+
+        /** Create a texture cache.
+            \param[in] directory Cache directory. Created if it does not exist.
+            \param[in] sizeLimit Maximum total size of all entries in bytes.
+            \param[in] compress Store 8-bit color textures BC7 compressed. This reduces the cache size and GPU memory at the cost of quality.
+            \return New object.
+        */
+        static SharedPtr create(const std::filesystem::path& directory, uint64_t sizeLimit = kDefaultSizeLimit, bool compress = false);
+
+        /** Get the default texture cache located in the application data directory.
+            The cache is created on first use.
+        */
+        static const SharedPtr& getDefault();
+
+        /** Load a texture from the cache.
+            On a miss, the caller is expected to load the texture from the image file and pass it to store().
+            \param[in] fullPath Full path of the image file.
+            \param[in] generateMipLevels Whether the full mip-chain should be generated.
+            \param[in] loadAsSrgb Load the texture as sRGB format if supported, otherwise linear color.
+            \param[in] bindFlags The bind flags for the texture resource.
+            \param[out] key Cache key of the texture.
+            \return The cached texture, or nullptr if the texture is not cached.
+        */
+        Texture::SharedPtr load(const std::filesystem::path& fullPath, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, Key& key);
+
+        /** Store a texture in the cache. This reads back the texture data from the GPU and must not be called concurrently with other GPU work.
+            \param[in] key Cache key returned by load().
+            \param[in] pTexture Texture loaded from the image file, or nullptr if loading failed.
+            \param[in] bindFlags The bind flags passed to load(). The created texture may have additional bind flags (e.g. for mip generation).
+            \param[in] loadTime Time spent loading the texture from the image file in seconds. Used for statistics only.
+        */
+        void store(const Key& key, const Texture::SharedPtr& pTexture, Resource::BindFlags bindFlags, double loadTime);
+
+        /** Load a texture through the cache. The texture is loaded from the image file and stored in the cache on a miss.
+            This must not be called concurrently with other GPU work. See Texture::createFromFile() for a description of the arguments.
+        */
+        Texture::SharedPtr loadFromFile(const std::filesystem::path& fullPath, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags);
+
+        /** Check if a texture file can be cached. DDS files are loaded directly and bypass the cache.
+        */
+        static bool isCacheable(const std::filesystem::path& fullPath);
+
+        Stats getStats() const;
+
+        const DiskCache::SharedPtr& getDiskCache() const { return mpDiskCache; }
+
+    private:
+        TextureCache(const std::filesystem::path& directory, uint64_t sizeLimit, bool compress);
+
+        Texture::SharedPtr loadRaw(const std::filesystem::path& path, Resource::BindFlags bindFlags) const;
+        bool storeRaw(const std::filesystem::path& path, const Texture::SharedPtr& pTexture) const;
+        bool storeCompressed(const std::filesystem::path& path, const Texture::SharedPtr& pTexture) const;
+
+        DiskCache::SharedPtr mpDiskCache;
+        bool mCompress;
+
+        mutable std::mutex mMutex;
+        Stats mStats;
+    };
+}
@@ -156,7 +156,9 @@ namespace Falcor
             mAsyncTextureLoader.loadFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags, callback);
 #else
             // Load texture from main thread.
-            Texture::SharedPtr pTexture = Texture::createFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
+            Texture::SharedPtr pTexture = mpTextureCache
+                ? mpTextureCache->loadFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags)
+                : Texture::createFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
 
             // Add new texture desc.
             TextureDesc desc = { TextureState::Loaded, pTexture };
@@ -182,6 +184,19 @@ namespace Falcor
         return handle;
     }
 
+    void TextureManager::setTextureCache(const TextureCache::SharedPtr& pTextureCache)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mpTextureCache = pTextureCache;
+        mAsyncTextureLoader.setTextureCache(pTextureCache);
+    }
+
+    TextureCache::SharedPtr TextureManager::getTextureCache() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mpTextureCache;
+    }
+
     void TextureManager::waitForTextureLoading(const TextureHandle& handle)
     {
         if (!handle) return;
@@ -106,6 +106,16 @@ namespace Falcor
         */
         TextureHandle loadTexture(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource, bool async = true);
 
+        /** Set the texture cache used for loading textures from files.
+            \param[in] pTextureCache Texture cache, or nullptr to disable caching.
+        */
+        void setTextureCache(const TextureCache::SharedPtr& pTextureCache);
+
+        /** Get the texture cache used for loading textures from files.
+            \return The texture cache, or nullptr if caching is disabled.
+        */
+        TextureCache::SharedPtr getTextureCache() const;
+
         /** Wait for a requested texture to load.
             If the handle is valid, the call blocks until the texture is loaded (or failed to load).
             \param[in] handle Texture handle.
@@ -184,6 +194,7 @@ namespace Falcor
         std::map<TextureKey, TextureHandle> mKeyToHandle;           ///< Map from texture key to handle.
         std::map<const Texture*, TextureHandle> mTextureToHandle;   ///< Map from texture ptr to handle.
 
+        TextureCache::SharedPtr mpTextureCache;                     ///< Texture cache, or nullptr if caching is disabled.
         AsyncTextureLoader mAsyncTextureLoader;                     ///< Utility for asynchronous texture loading.
         size_t mLoadRequestsInProgress = 0;                         ///< Number of load requests currently in progress.
 
@@ -37,6 +37,7 @@ namespace Falcor
         std::filesystem::path sLogFilePath;
 
 #if FALCOR_ENABLE_LOGGER
+        std::mutex sMutex; ///< Serializes output from multiple threads.
         bool sInitialized = false;
         FILE* sLogFile = nullptr;
 
@@ -123,6 +124,7 @@ namespace Falcor
         if (level <= sVerbosity)
         {
             std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+            std::lock_guard<std::mutex> lock(sMutex);
 
             // Write to console.
             if (is_set(sOutputs, OutputFlags::Console))
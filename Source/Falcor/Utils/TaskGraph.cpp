@@ -0,0 +1,212 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "TaskGraph.h"
+#include "Threading.h"
+#include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <atomic>
+
+namespace Falcor
+{
+    uint32_t TaskGraph::addTask(const std::string& name, ResourceMask reads, ResourceMask writes, std::function<void(void)> func)
+    {
+        uint32_t index = (uint32_t)mTasks.size();
+
+        Task task;
+        task.name = name;
+        task.reads = reads;
+        task.writes = writes;
+        task.func = std::move(func);
+
+        // Add edges from all previous tasks with conflicting resource accesses.
+        for (uint32_t i = 0; i < index; i++)
+        {
+            auto& prev = mTasks[i];
+            bool conflict = (writes & (prev.reads | prev.writes)) != 0 || (reads & prev.writes) != 0;
+            if (conflict)
+            {
+                prev.successors.push_back(index);
+                task.dependencyCount++;
+            }
+        }
+
+        mTasks.push_back(std::move(task));
+        return index;
+    }
+
+    void TaskGraph::execute()
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        auto getTime = [startTime]()
+        {
+            std::chrono::duration<double> duration = CpuTimer::getCurrentTimePoint() - startTime;
+            return duration.count();
+        };
+
+        for (auto& task : mTasks) task.executed = false;
+
+        if (Threading::getThreadCount() == 0)
+        {
+            for (auto& task : mTasks)
+            {
+                task.startTime = getTime();
+                task.func();
+                task.duration = getTime() - task.startTime;
+                task.executed = true;
+            }
+            mTotalTime = getTime();
+            return;
+        }
+
+        struct State
+        {
+            std::vector<std::atomic<uint32_t>> remainingDependencies;
+            std::mutex mutex;
+            std::condition_variable condition;
+            size_t pendingCount = 0;        ///< Number of dispatched but not finished tasks.
+            std::exception_ptr pException;
+        } state;
+
+        state.remainingDependencies = std::vector<std::atomic<uint32_t>>(mTasks.size());
+        for (size_t i = 0; i < mTasks.size(); i++) state.remainingDependencies[i] = mTasks[i].dependencyCount;
+
+        std::function<void(uint32_t)> dispatch = [&](uint32_t index)
+        {
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (state.pException) return;
+                state.pendingCount++;
+            }
+
+            Threading::dispatchTask([&, index]()
+            {
+                auto& task = mTasks[index];
+                std::exception_ptr pException;
+
+                task.startTime = getTime();
+                try
+                {
+                    task.func();
+                }
+                catch (...)
+                {
+                    pException = std::current_exception();
+                }
+                task.duration = getTime() - task.startTime;
+                task.executed = true;
+
+                if (!pException)
+                {
+                    for (uint32_t successor : task.successors)
+                    {
+                        if (--state.remainingDependencies[successor] == 0) dispatch(successor);
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (pException && !state.pException) state.pException = pException;
+                if (--state.pendingCount == 0) state.condition.notify_all();
+            });
+        };
+
+        for (uint32_t i = 0; i < (uint32_t)mTasks.size(); i++)
+        {
+            if (mTasks[i].dependencyCount == 0) dispatch(i);
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.condition.wait(lock, [&state]() { return state.pendingCount == 0; });
+        }
+
+        mTotalTime = getTime();
+
+        if (state.pException) std::rethrow_exception(state.pException);
+    }
+
+    std::vector<uint32_t> TaskGraph::computeCriticalPath() const
+    {
+        // Tasks are stored in topological order, so the longest path can be found in a single pass.
+        std::vector<double> finishTime(mTasks.size(), 0.0);
+        std::vector<uint32_t> predecessor(mTasks.size(), uint32_t(-1));
+
+        for (uint32_t i = 0; i < (uint32_t)mTasks.size(); i++)
+        {
+            finishTime[i] += mTasks[i].duration;
+            for (uint32_t successor : mTasks[i].successors)
+            {
+                if (finishTime[i] > finishTime[successor])
+                {
+                    finishTime[successor] = finishTime[i];
+                    predecessor[successor] = i;
+                }
+            }
+        }
+
+        std::vector<uint32_t> path;
+        if (mTasks.empty()) return path;
+
+        uint32_t index = (uint32_t)std::distance(finishTime.begin(), std::max_element(finishTime.begin(), finishTime.end()));
+        while (index != uint32_t(-1))
+        {
+            path.push_back(index);
+            index = predecessor[index];
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    double TaskGraph::getCriticalPathTime() const
+    {
+        double time = 0.0;
+        for (uint32_t index : computeCriticalPath()) time += mTasks[index].duration;
+        return time;
+    }
+
+    void TaskGraph::printToLog() const
+    {
+        double totalTaskTime = 0.0;
+        for (const auto& task : mTasks)
+        {
+            if (!task.executed) continue;
+            logInfo(padStringToLength(task.name + ":", 35) + " " + std::to_string(task.duration) + " s (started at " + std::to_string(task.startTime) + " s)");
+            totalTaskTime += task.duration;
+        }
+
+        std::string criticalPath;
+        for (uint32_t index : computeCriticalPath())
+        {
+            criticalPath += (criticalPath.empty() ? "" : " -> ") + mTasks[index].name;
+        }
+
+        logInfo("Critical path ({} s): {}", getCriticalPathTime(), criticalPath);
+        logInfo("Total task time {} s, wall clock time {} s.", totalTaskTime, mTotalTime);
+    }
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Executes a set of tasks with data dependencies on the global thread pool.
+
+        Each task declares the set of resources it reads and writes as a bit mask. The meaning of the
+        bits is defined by the user. A task depends on all previously added tasks with conflicting
+        accesses (read-after-write, write-after-read and write-after-write), so the result of executing
+        the graph is the same as executing the tasks serially in the order they were added.
+        Independent tasks are executed concurrently.
+    */
+    class FALCOR_API TaskGraph
+    {
+    public:
+        using ResourceMask = uint64_t;
+
+        /** Add a task to the graph.
+            \param[in] name Name of the task, used in the timing report.
+            \param[in] reads Mask of resources the task reads.
+            \param[in] writes Mask of resources the task writes.
+            \param[in] func Function executing the task.
+            \return Index of the task.
+        */
+        uint32_t addTask(const std::string& name, ResourceMask reads, ResourceMask writes, std::function<void(void)> func);
+
+        /** Execute all tasks and wait for them to finish.
+            If a task throws, no further tasks are started and the first exception is rethrown once all running tasks have finished.
+            If the thread pool is not running, the tasks are executed serially on the calling thread.
+        */
+        void execute();
+
+        /** Prints the duration of each task and the critical path of the last execution to the log.
+        */
+        void printToLog() const;
+
+        /** Returns the wall clock time of the last execution in seconds.
+        */
+        double getTotalTime() const { return mTotalTime; }
+
+        /** Returns the duration of the critical path of the last execution in seconds.
+            This is the lower bound of the execution time for the measured task durations.
+        */
+        double getCriticalPathTime() const;
+
+    private:
+        struct Task
+        {
+            std::string name;
+            ResourceMask reads = 0;
+            ResourceMask writes = 0;
+            std::function<void(void)> func;
+            std::vector<uint32_t> successors;
+            uint32_t dependencyCount = 0;
+
+            double startTime = 0.0;         ///< Start time relative to start of execution in seconds.
+            double duration = 0.0;          ///< Duration in seconds.
+            bool executed = false;
+        };
+
+        std::vector<uint32_t> computeCriticalPath() const;
+
+        std::vector<Task> mTasks;
+        double mTotalTime = 0.0;
+    };
+}
@@ -27,68 +27,393 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "Threading.h"
+#include <atomic>
+#include <deque>
 
 namespace Falcor
 {
+    struct Threading::Task::State
+    {
+        std::function<void(void)> func;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool done = false;
+        std::exception_ptr pException;
+        std::vector<std::shared_ptr<State>> continuations;
+    };
+
     namespace
     {
+        using TaskStatePtr = std::shared_ptr<Threading::Task::State>;
+
+        struct Worker
+        {
+            std::thread thread;
+            std::mutex mutex;
+            std::deque<TaskStatePtr> queue;
+        };
+
         struct ThreadingData
         {
             bool initialized = false;
-            std::vector<std::thread> threads;
-            uint32_t current;
+            bool stop = false;
+            std::vector<std::unique_ptr<Worker>> workers;
+            std::atomic<uint32_t> current = 0;
+
+            std::mutex sleepMutex;
+            std::condition_variable wakeCondition;      ///< Signaled when new tasks are queued.
+            std::condition_variable finishCondition;    ///< Signaled when the last active task finished.
+
+            std::atomic<uint64_t> pendingTasks = 0;     ///< Tasks queued but not yet picked up.
+            std::atomic<uint64_t> activeTasks = 0;      ///< Tasks dispatched but not yet finished.
+            std::atomic<uint64_t> tasksDispatched = 0;
+            std::atomic<uint64_t> tasksExecuted = 0;
+            std::atomic<uint64_t> steals = 0;
+            std::atomic<uint64_t> idleTimeNs = 0;
         } gData;
+
+        thread_local int32_t tWorkerIndex = -1;
+
+        void enqueue(const TaskStatePtr& pState)
+        {
+            uint32_t workerCount = (uint32_t)gData.workers.size();
+            uint32_t index = tWorkerIndex >= 0 ? (uint32_t)tWorkerIndex : gData.current.fetch_add(1) % workerCount;
+
+            gData.activeTasks++;
+            gData.tasksDispatched++;
+
+            // Count the task before publishing it so that the counter never drops below zero when a worker picks it up right away.
+            gData.pendingTasks++;
+            {
+                Worker& worker = *gData.workers[index];
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.queue.push_back(pState);
+            }
+
+            {
+                // Take the lock to avoid losing the wakeup of a worker that is about to go to sleep.
+                std::lock_guard<std::mutex> lock(gData.sleepMutex);
+            }
+            gData.wakeCondition.notify_one();
+        }
+
+        /** Pop a task from the worker's own queue (LIFO) or steal one from another worker's queue (FIFO).
+        */
+        TaskStatePtr acquireTask(uint32_t workerIndex)
+        {
+            uint32_t workerCount = (uint32_t)gData.workers.size();
+
+            {
+                Worker& worker = *gData.workers[workerIndex];
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                if (!worker.queue.empty())
+                {
+                    TaskStatePtr pState = std::move(worker.queue.back());
+                    worker.queue.pop_back();
+                    gData.pendingTasks--;
+                    return pState;
+                }
+            }
+
+            for (uint32_t i = 1; i < workerCount; i++)
+            {
+                Worker& victim = *gData.workers[(workerIndex + i) % workerCount];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.queue.empty())
+                {
+                    TaskStatePtr pState = std::move(victim.queue.front());
+                    victim.queue.pop_front();
+                    gData.pendingTasks--;
+                    gData.steals++;
+                    return pState;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void execute(const TaskStatePtr& pState)
+        {
+            try
+            {
+                pState->func();
+            }
+            catch (...)
+            {
+                pState->pException = std::current_exception();
+            }
+            pState->func = nullptr;
+
+            std::vector<TaskStatePtr> continuations;
+            {
+                std::lock_guard<std::mutex> lock(pState->mutex);
+                pState->done = true;
+                continuations = std::move(pState->continuations);
+            }
+            pState->condition.notify_all();
+
+            for (const auto& pContinuation : continuations) enqueue(pContinuation);
+
+            gData.tasksExecuted++;
+            if (--gData.activeTasks == 0)
+            {
+                std::lock_guard<std::mutex> lock(gData.sleepMutex);
+                gData.finishCondition.notify_all();
+            }
+        }
+
+        void workerMain(uint32_t workerIndex)
+        {
+            tWorkerIndex = (int32_t)workerIndex;
+
+            while (true)
+            {
+                if (TaskStatePtr pState = acquireTask(workerIndex))
+                {
+                    execute(pState);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(gData.sleepMutex);
+                if (gData.stop) break;
+                auto startTime = CpuTimer::getCurrentTimePoint();
+                gData.wakeCondition.wait(lock, [] { return gData.stop || gData.pendingTasks > 0; });
+                auto endTime = CpuTimer::getCurrentTimePoint();
+                gData.idleTimeNs += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+            }
+
+            tWorkerIndex = -1;
+        }
+
+        TaskStatePtr createTaskState(const std::function<void(void)>& func)
+        {
+            auto pState = std::make_shared<Threading::Task::State>();
+            pState->func = func;
+            return pState;
+        }
     }
 
     void Threading::start(uint32_t threadCount)
     {
         if (gData.initialized) return;
 
-        gData.threads.resize(threadCount);
+        threadCount = std::max(threadCount, 1u);
+        gData.stop = false;
+        gData.workers.resize(threadCount);
+        for (auto& pWorker : gData.workers) pWorker = std::make_unique<Worker>();
+        for (uint32_t i = 0; i < threadCount; i++) gData.workers[i]->thread = std::thread(workerMain, i);
         gData.initialized = true;
     }
 
     void Threading::shutdown()
     {
-        for (auto& t : gData.threads)
+        if (!gData.initialized) return;
+
+        finish();
+
         {
-            if (t.joinable()) t.join();
+            std::lock_guard<std::mutex> lock(gData.sleepMutex);
+            gData.stop = true;
         }
+        gData.wakeCondition.notify_all();
 
+        for (auto& pWorker : gData.workers)
+        {
+            if (pWorker->thread.joinable()) pWorker->thread.join();
+        }
+
+        gData.workers.clear();
         gData.initialized = false;
     }
 
+    void Threading::finish()
+    {
+        if (!gData.initialized) return;
+        FALCOR_ASSERT(!isWorkerThread());
+
+        std::unique_lock<std::mutex> lock(gData.sleepMutex);
+        gData.finishCondition.wait(lock, [] { return gData.activeTasks == 0; });
+    }
+
+    uint32_t Threading::getThreadCount()
+    {
+        return gData.initialized ? (uint32_t)gData.workers.size() : 0;
+    }
+
+    bool Threading::isWorkerThread()
+    {
+        return tWorkerIndex >= 0;
+    }
+
     Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
     {
         FALCOR_ASSERT(gData.initialized);
 
-        std::thread& t = gData.threads[gData.current];
-        if (t.joinable()) t.join();
-        t = std::thread(func);
-        gData.current = (gData.current + 1) % gData.threads.size();
+        auto pState = createTaskState(func);
+        enqueue(pState);
+        return Task(pState);
+    }
 
-        return Task();
+    size_t Threading::getChunkSize(size_t count, size_t grainSize)
+    {
+        if (grainSize > 0) return grainSize;
+        // Use a few chunks per thread to balance the load when chunks take different amounts of time.
+        size_t chunkCount = std::max<size_t>(getThreadCount(), 1) * 4;
+        return std::max<size_t>((count + chunkCount - 1) / chunkCount, 1);
     }
 
-    void Threading::finish()
+    void Threading::parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize)
+    {
+        if (begin >= end) return;
+
+        size_t chunkSize = getChunkSize(end - begin, grainSize);
+        size_t chunkCount = (end - begin + chunkSize - 1) / chunkSize;
+
+        if (!gData.initialized || chunkCount == 1)
+        {
+            func(begin, end);
+            return;
+        }
+
+        // Shared state of the loop. Helper tasks may start after the loop has completed,
+        // so they only access the function once they have successfully claimed a chunk.
+        struct Loop
+        {
+            std::atomic<size_t> nextChunk = 0;
+            std::atomic<size_t> completedChunks = 0;
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::exception_ptr pException;
+        };
+        auto pLoop = std::make_shared<Loop>();
+
+        auto runChunks = [pLoop, &func, begin, end, chunkSize, chunkCount]()
+        {
+            size_t chunk;
+            while ((chunk = pLoop->nextChunk.fetch_add(1)) < chunkCount)
+            {
+                size_t b = begin + chunk * chunkSize;
+                size_t e = std::min(b + chunkSize, end);
+                try
+                {
+                    func(b, e);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(pLoop->mutex);
+                    if (!pLoop->pException) pLoop->pException = std::current_exception();
+                }
+                if (pLoop->completedChunks.fetch_add(1) + 1 == chunkCount)
+                {
+                    std::lock_guard<std::mutex> lock(pLoop->mutex);
+                    pLoop->condition.notify_all();
+                }
+            }
+        };
+
+        size_t helperCount = std::min<size_t>(chunkCount - 1, gData.workers.size());
+        for (size_t i = 0; i < helperCount; i++) enqueue(createTaskState(runChunks));
+
+        runChunks();
+
+        {
+            std::unique_lock<std::mutex> lock(pLoop->mutex);
+            pLoop->condition.wait(lock, [&] { return pLoop->completedChunks == chunkCount; });
+        }
+
+        if (pLoop->pException) std::rethrow_exception(pLoop->pException);
+    }
+
+    Threading::Stats Threading::getStats()
     {
-        for (auto& t : gData.threads)
+        Stats stats;
+        stats.threadCount = getThreadCount();
+        for (const auto& pWorker : gData.workers)
         {
-            if (t.joinable()) t.join();
+            std::lock_guard<std::mutex> lock(pWorker->mutex);
+            stats.queueDepth += pWorker->queue.size();
         }
+        stats.activeTasks = gData.activeTasks;
+        stats.tasksDispatched = gData.tasksDispatched;
+        stats.tasksExecuted = gData.tasksExecuted;
+        stats.steals = gData.steals;
+        stats.idleTime = gData.idleTimeNs * 1.0e-9;
+        return stats;
     }
 
-    Threading::Task::Task()
+    void Threading::resetStats()
     {
+        gData.tasksDispatched = 0;
+        gData.tasksExecuted = 0;
+        gData.steals = 0;
+        gData.idleTimeNs = 0;
     }
 
     bool Threading::Task::isRunning()
     {
-        FALCOR_UNIMPLEMENTED();
+        if (!mpState) return false;
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        return !mpState->done;
     }
 
     void Threading::Task::finish()
     {
-        FALCOR_UNIMPLEMENTED();
+        if (!mpState) return;
+
+        // Execute other tasks while waiting to avoid deadlocks when waiting from within a task.
+        if (isWorkerThread())
+        {
+            while (isRunning())
+            {
+                if (TaskStatePtr pOther = acquireTask((uint32_t)tWorkerIndex))
+                {
+                    execute(pOther);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mpState->mutex);
+                mpState->condition.wait_for(lock, std::chrono::milliseconds(1), [this] { return mpState->done; });
+            }
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(mpState->mutex);
+            mpState->condition.wait(lock, [this] { return mpState->done; });
+        }
+
+        if (mpState->pException) std::rethrow_exception(mpState->pException);
+    }
+
+    Threading::Task Threading::Task::then(const std::function<void(void)>& func)
+    {
+        FALCOR_ASSERT(gData.initialized);
+
+        auto pContinuation = createTaskState(func);
+        if (mpState)
+        {
+            std::lock_guard<std::mutex> lock(mpState->mutex);
+            if (!mpState->done)
+            {
+                mpState->continuations.push_back(pContinuation);
+                return Task(pContinuation);
+            }
+        }
+        enqueue(pContinuation);
+        return Task(pContinuation);
+    }
+
+    FALCOR_SCRIPT_BINDING(Threading)
+    {
+        pybind11::class_<Threading::Stats> stats(m, "ThreadingStats");
+        stats.def_readonly("threadCount", &Threading::Stats::threadCount);
+        stats.def_readonly("queueDepth", &Threading::Stats::queueDepth);
+        stats.def_readonly("activeTasks", &Threading::Stats::activeTasks);
+        stats.def_readonly("tasksDispatched", &Threading::Stats::tasksDispatched);
+        stats.def_readonly("tasksExecuted", &Threading::Stats::tasksExecuted);
+        stats.def_readonly("steals", &Threading::Stats::steals);
+        stats.def_readonly("idleTime", &Threading::Stats::idleTime);
+
+        pybind11::class_<Threading> threading(m, "Threading");
+        threading.def_property_readonly_static("stats", [](pybind11::object) { return Threading::getStats(); });
+        threading.def_static("resetStats", &Threading::resetStats);
     }
 }
@@ -1,5 +1,5 @@
 /***************************************************************************
- # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
  #
  # Redistribution and use in source and binary forms, with or without
  # modification, are permitted provided that the following conditions
@@ -29,34 +29,76 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
 
 namespace Falcor
 {
+    /** Global work-stealing thread pool.
+
+        Each worker thread owns a task deque. Workers pop tasks from the back of their own deque
+        and steal from the front of other workers' deques when they run out of work.
+        Tasks dispatched from a worker thread are pushed to that worker's deque, tasks dispatched
+        from other threads are distributed round-robin over all deques.
+    */
     class FALCOR_API Threading
     {
     public:
         const static uint32_t kDefaultThreadCount = 16;
 
-        /** Handle to a dispatched task
-
-            TODO: Implementation
+        /** Handle to a dispatched task.
         */
-        class Task
+        class FALCOR_API Task
         {
         public:
-            /** Check if task is still executing
+            /** Create an empty task handle.
+            */
+            Task() = default;
+
+            /** Check if the handle refers to a dispatched task.
+            */
+            bool isValid() const { return mpState != nullptr; }
+
+            /** Check if task is still pending or executing.
             */
             bool isRunning();
 
-            /** Wait for task to finish executing
+            /** Wait for task to finish executing.
+                When called from a worker thread, the calling thread executes other pending tasks while waiting.
+                If the task threw an exception, the exception is rethrown.
             */
             void finish();
 
+            /** Schedule a continuation to run once this task has finished executing.
+                If the task has already finished, the continuation is dispatched immediately.
+                \param[in] func Function to run.
+                \return Handle to the continuation task.
+            */
+            Task then(const std::function<void(void)>& func);
+
+            struct State;
+
         private:
-            Task();
+            Task(const std::shared_ptr<State>& pState) : mpState(pState) {}
+            std::shared_ptr<State> mpState;
             friend class Threading;
         };
 
+        /** Thread pool statistics.
+        */
+        struct Stats
+        {
+            uint32_t threadCount = 0;       ///< Number of worker threads.
+            uint64_t queueDepth = 0;        ///< Number of tasks currently waiting in the queues.
+            uint64_t activeTasks = 0;       ///< Number of tasks dispatched but not yet finished.
+            uint64_t tasksDispatched = 0;   ///< Total number of tasks dispatched.
+            uint64_t tasksExecuted = 0;     ///< Total number of tasks executed.
+            uint64_t steals = 0;            ///< Total number of tasks stolen from another worker's queue.
+            double idleTime = 0.0;          ///< Accumulated time in seconds worker threads spent waiting for work.
+        };
+
         /** Initializes the global thread pool
             \param[in] threadCount Number of threads in the pool
         */
@@ -74,10 +116,81 @@ namespace Falcor
         */
         static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
 
+        /** Returns the number of worker threads in the pool or 0 if the pool is not running.
+        */
+        static uint32_t getThreadCount();
+
+        /** Returns true if the calling thread is one of the pool's worker threads.
+        */
+        static bool isWorkerThread();
+
         /** Starts a task on an available thread.
             \return Handle to the task
         */
         static Task dispatchTask(const std::function<void(void)>& func);
+
+        /** Execute a function over a range of indices in parallel.
+            The range is split into chunks of at least grainSize indices. The calling thread participates in
+            executing the chunks and returns once all chunks are done. If the thread pool is not running,
+            the function is executed serially on the calling thread.
+            \param[in] begin First index.
+            \param[in] end One past the last index.
+            \param[in] func Function called as func(chunkBegin, chunkEnd) for each chunk.
+            \param[in] grainSize Minimum number of indices per chunk. If 0, a chunk size is chosen based on the thread count.
+        */
+        static void parallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize = 0);
+
+        /** Execute a reduction over a range of indices in parallel.
+            The range is split into chunks the same way as in parallelFor(). Each chunk is mapped to a partial
+            result, and the partial results are combined in chunk order. The result is therefore deterministic
+            for a given range, grain size and thread count, even for non-associative operations like floating-point addition.
+            \param[in] begin First index.
+            \param[in] end One past the last index.
+            \param[in] identity Identity value of the reduction.
+            \param[in] map Function called as map(chunkBegin, chunkEnd) returning the partial result of a chunk.
+            \param[in] reduce Function called as reduce(a, b) combining two partial results.
+            \param[in] grainSize Minimum number of indices per chunk. If 0, a chunk size is chosen based on the thread count.
+            \return The reduced value.
+        */
+        template<typename T, typename MapFunc, typename ReduceFunc>
+        static T parallelReduce(size_t begin, size_t end, const T& identity, MapFunc map, ReduceFunc reduce, size_t grainSize = 0)
+        {
+            if (begin >= end) return identity;
+
+            size_t chunkSize = getChunkSize(end - begin, grainSize);
+            size_t chunkCount = (end - begin + chunkSize - 1) / chunkSize;
+            // Wrap the partial results to avoid the std::vector<bool> specialization, which is not safe for concurrent writes.
+            struct Partial { T value; };
+            std::vector<Partial> partials(chunkCount, Partial{ identity });
+
+            parallelFor(0, chunkCount, [&](size_t chunkBegin, size_t chunkEnd)
+            {
+                for (size_t i = chunkBegin; i < chunkEnd; i++)
+                {
+                    size_t b = begin + i * chunkSize;
+                    size_t e = std::min(b + chunkSize, end);
+                    partials[i].value = map(b, e);
+                }
+            }, 1);
+
+            T result = identity;
+            for (const auto& partial : partials) result = reduce(result, partial.value);
+            return result;
+        }
+
+        /** Returns the chunk size used for splitting a range in parallelFor() and parallelReduce().
+            \param[in] count Number of indices in the range.
+            \param[in] grainSize Minimum number of indices per chunk. If 0, a chunk size is chosen based on the thread count.
+        */
+        static size_t getChunkSize(size_t count, size_t grainSize = 0);
+
+        /** Returns the current thread pool statistics.
+        */
+        static Stats getStats();
+
+        /** Resets the accumulated counters of the thread pool statistics.
+        */
+        static void resetStats();
     };
 
     /** Simple thread barrier class.
@@ -478,6 +478,7 @@ namespace Mogwai
     {
         if (mOptions.useSceneCache) buildFlags |= SceneBuilder::Flags::UseCache;
         if (mOptions.rebuildSceneCache) buildFlags |= SceneBuilder::Flags::RebuildCache;
+        if (mOptions.useMappedSceneCache) buildFlags |= SceneBuilder::Flags::UseMappedCache;
 
         while (true)
         {
@@ -712,6 +713,7 @@ int main(int argc, char** argv)
     args::ValueFlag<uint32_t> heightFlag(parser, "pixels", "Initial window height.", {"height"});
     args::Flag useSceneCacheFlag(parser, "", "Use scene cache to improve scene load times.", {'c', "use-cache"});
     args::Flag rebuildSceneCacheFlag(parser, "", "Rebuild the scene cache.", {"rebuild-cache"});
+    args::Flag mappedSceneCacheFlag(parser, "", "Write the scene cache in the memory-mapped format.", {"mapped-cache"});
     args::Flag generateShaderDebugInfo(parser, "", "Generate shader debug info.", {'d', "debug-shaders"});
     args::Flag enableDebugLayer(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
 
@@ -767,6 +769,7 @@ int main(int argc, char** argv)
     if (silentFlag) options.silentMode = true;
     if (useSceneCacheFlag) options.useSceneCache = true;
     if (rebuildSceneCacheFlag) options.rebuildSceneCache = true;
+    if (mappedSceneCacheFlag) options.useMappedSceneCache = true;
     if (generateShaderDebugInfo) options.generateShaderDebugInfo = true;
 
     try
@@ -75,6 +75,7 @@ namespace Mogwai
             bool silentMode = false;
             bool useSceneCache = false;
             bool rebuildSceneCache = false;
+            bool useMappedSceneCache = false;
             bool generateShaderDebugInfo = false;
         };
 
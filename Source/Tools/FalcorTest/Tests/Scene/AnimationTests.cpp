@@ -0,0 +1,172 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Creates an animation with random keyframes at unit time intervals.
+        */
+        Animation::SharedPtr createRandomAnimation(std::mt19937& rng, size_t keyframeCount, Animation::InterpolationMode mode)
+        {
+            std::uniform_real_distribution<float> dist(-1.f, 1.f);
+            auto pAnimation = Animation::create("test", 0, (double)keyframeCount);
+            pAnimation->setInterpolationMode(mode);
+            for (size_t i = 0; i < keyframeCount; i++)
+            {
+                Animation::Keyframe keyframe;
+                keyframe.time = (double)i;
+                keyframe.translation = float3(dist(rng), dist(rng), dist(rng));
+                keyframe.scaling = float3(dist(rng), dist(rng), dist(rng)) + 2.f;
+                keyframe.rotation = glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng)));
+                pAnimation->addKeyframe(keyframe);
+            }
+            return pAnimation;
+        }
+
+        void testRandomAccess(CPUUnitTestContext& ctx, Animation::InterpolationMode mode)
+        {
+            std::mt19937 rng;
+            const size_t keyframeCount = 1000;
+            auto pAnimation = createRandomAnimation(rng, keyframeCount, mode);
+
+            // Evaluate in playback order.
+            std::vector<double> times;
+            for (double time = -10.0; time < keyframeCount + 10.0; time += 0.37) times.push_back(time);
+            std::vector<glm::mat4> expected;
+            for (double time : times) expected.push_back(pAnimation->animate(time));
+
+            // Evaluate in random order, as when scrubbing, which must not depend on the previously evaluated time.
+            std::vector<size_t> order(times.size());
+            for (size_t i = 0; i < order.size(); i++) order[i] = i;
+            std::shuffle(order.begin(), order.end(), rng);
+            for (size_t i : order)
+            {
+                EXPECT(pAnimation->animate(times[i]) == expected[i]) << "time = " << times[i];
+            }
+        }
+    }
+
+    CPU_TEST(Animation_Keyframes)
+    {
+        auto pAnimation = Animation::create("test", 0, 10.0);
+        for (double time : { 5.0, 1.0, 8.0, 3.0 })
+        {
+            Animation::Keyframe keyframe;
+            keyframe.time = time;
+            keyframe.translation = float3((float)time);
+            pAnimation->addKeyframe(keyframe);
+        }
+        EXPECT_EQ(pAnimation->getKeyframeCount(), 4);
+
+        // Replace an existing keyframe.
+        Animation::Keyframe keyframe;
+        keyframe.time = 3.0;
+        keyframe.translation = float3(-1.f);
+        pAnimation->addKeyframe(keyframe);
+        EXPECT_EQ(pAnimation->getKeyframeCount(), 4);
+        EXPECT(pAnimation->getKeyframe(3.0).translation == float3(-1.f));
+        EXPECT(pAnimation->getKeyframe(8.0).translation == float3(8.f));
+
+        EXPECT(pAnimation->doesKeyframeExists(1.0));
+        EXPECT(!pAnimation->doesKeyframeExists(2.0));
+
+        bool caught = false;
+        try
+        {
+            pAnimation->getKeyframe(2.0);
+        }
+        catch (const ArgumentError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+
+        // Keyframes must be sorted by time for the translation to be reproduced exactly at each keyframe.
+        for (double time : { 1.0, 3.0, 5.0, 8.0 })
+        {
+            glm::mat4 transform = pAnimation->animate(time);
+            EXPECT(float3(transform[3]) == pAnimation->getKeyframe(time).translation) << "time = " << time;
+        }
+    }
+
+    CPU_TEST(Animation_RandomAccessLinear)
+    {
+        testRandomAccess(ctx, Animation::InterpolationMode::Linear);
+    }
+
+    CPU_TEST(Animation_RandomAccessHermite)
+    {
+        testRandomAccess(ctx, Animation::InterpolationMode::Hermite);
+    }
+
+    CPU_TEST(Animation_Batch)
+    {
+        // Mix interpolation modes, infinity behaviors, warping and keyframe counts, including Hermite animations with too few
+        // keyframes and linear extrapolation, so batches of both modes, partial batches and the scalar fallback are all used.
+        std::mt19937 rng;
+        const Animation::Behavior behaviors[] = { Animation::Behavior::Constant, Animation::Behavior::Linear, Animation::Behavior::Cycle, Animation::Behavior::Oscillate };
+        const size_t keyframeCounts[] = { 1, 2, 3, 10, 50 };
+
+        std::vector<Animation::SharedPtr> animations;
+        std::vector<uint32_t> animationIDs;
+        for (uint32_t i = 0; i < 103; i++)
+        {
+            auto mode = (i % 2) ? Animation::InterpolationMode::Hermite : Animation::InterpolationMode::Linear;
+            auto pAnimation = createRandomAnimation(rng, keyframeCounts[i % 5], mode);
+            pAnimation->setNodeID(i);
+            pAnimation->setPreInfinityBehavior(behaviors[i % 4]);
+            pAnimation->setPostInfinityBehavior(behaviors[(i / 4) % 4]);
+            pAnimation->setEnableWarping(i % 3 == 0);
+            animations.push_back(pAnimation);
+            animationIDs.push_back(i);
+        }
+
+        std::vector<float4x4> matrices(animations.size());
+        for (double time : { -3.3, 0.0, 0.5, 1.7, 9.25, 30.1, 120.9 })
+        {
+            Animation::animateBatch(animations, animationIDs.data(), animationIDs.size(), time, matrices);
+            for (size_t i = 0; i < animations.size(); i++)
+            {
+                glm::mat4 expected = animations[i]->animate(time);
+                for (int c = 0; c < 4; c++)
+                {
+                    for (int r = 0; r < 4; r++)
+                    {
+                        EXPECT_LE(std::abs(matrices[i][c][r] - expected[c][r]), 1e-5f * std::max(1.f, std::abs(expected[c][r])))
+                            << "animation = " << i << ", time = " << time << ", element = [" << c << "][" << r << "]";
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/AssetCache.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::filesystem::path createTempDirectory()
+        {
+            std::random_device rd;
+            auto path = std::filesystem::temp_directory_path() / fmt::format("FalcorAssetCacheTest{:08x}", rd());
+            std::filesystem::remove_all(path);
+            return path;
+        }
+
+        AssetCache::Key makeKey(uint32_t i)
+        {
+            return AssetCache::KeyBuilder("Test", 1).add(i).getKey();
+        }
+    }
+
+    CPU_TEST(AssetCache_StoreLoad)
+    {
+        auto directory = createTempDirectory();
+        {
+            auto pCache = AssetCache::create(directory);
+
+            std::vector<uint8_t> data;
+            EXPECT(!pCache->load(makeKey(0), data));
+
+            std::vector<uint8_t> payload(1000);
+            for (size_t i = 0; i < payload.size(); i++) payload[i] = (uint8_t)(i * 7);
+            pCache->store(makeKey(0), payload.data(), payload.size());
+
+            EXPECT(pCache->load(makeKey(0), data));
+            EXPECT(data == payload);
+            EXPECT(!pCache->load(makeKey(1), data));
+
+            auto stats = pCache->getStats();
+            EXPECT_EQ(stats.hits, 1);
+            EXPECT_EQ(stats.misses, 2);
+            EXPECT_EQ(stats.stores, 1);
+            EXPECT_EQ(stats.entryCount, 1);
+
+            // A new cache object on the same directory picks up the existing entries.
+            auto pCache2 = AssetCache::create(directory);
+            EXPECT_EQ(pCache2->getStats().entryCount, 1);
+            EXPECT(pCache2->load(makeKey(0), data));
+            EXPECT(data == payload);
+        }
+        std::filesystem::remove_all(directory);
+    }
+
+    CPU_TEST(AssetCache_Eviction)
+    {
+        auto directory = createTempDirectory();
+        {
+            const size_t kEntrySize = 1000;
+            auto pCache = AssetCache::create(directory, 10 * kEntrySize);
+
+            std::vector<uint8_t> payload(kEntrySize);
+            std::vector<uint8_t> data;
+            for (uint32_t i = 0; i < 20; i++)
+            {
+                pCache->store(makeKey(i), payload.data(), payload.size());
+                // Keep the first entry in use.
+                EXPECT(pCache->load(makeKey(0), data));
+            }
+
+            auto stats = pCache->getStats();
+            EXPECT_GT(stats.evictions, 0);
+            EXPECT_LE(stats.totalSize, pCache->getSizeLimit());
+            EXPECT(pCache->load(makeKey(0), data));
+            EXPECT(!pCache->load(makeKey(1), data));
+            EXPECT(pCache->load(makeKey(19), data));
+
+            pCache->clear();
+            EXPECT_EQ(pCache->getStats().entryCount, 0);
+            EXPECT(!pCache->load(makeKey(19), data));
+        }
+        std::filesystem::remove_all(directory);
+    }
+}
@@ -0,0 +1,318 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/CpuVertexAnimation.h"
+#include "glm/gtx/transform.hpp"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        float3 randomFloat3(std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> dist(-1.f, 1.f);
+            return float3(dist(rng), dist(rng), dist(rng));
+        }
+
+        StaticVertexData createRandomVertex(std::mt19937& rng)
+        {
+            StaticVertexData v;
+            v.position = randomFloat3(rng);
+            v.normal = glm::normalize(randomFloat3(rng) + float3(0.f, 0.f, 2.f));
+            v.tangent = float4(glm::normalize(randomFloat3(rng) + float3(2.f, 0.f, 0.f)), 1.f);
+            v.texCrd = float2(rng() % 100, rng() % 100);
+            v.curveRadius = 0.f;
+            return v;
+        }
+
+        /** Creates a random affine matrix.
+        */
+        glm::mat4 createRandomMatrix(std::mt19937& rng)
+        {
+            glm::mat4 m = glm::translate(randomFloat3(rng)) * glm::rotate(randomFloat3(rng).x * 3.f, glm::normalize(randomFloat3(rng) + 0.1f));
+            return m * glm::scale(float3(1.5f) + randomFloat3(rng) * 0.5f);
+        }
+
+        struct SkinningScene
+        {
+            std::vector<PackedStaticVertexData> staticData;
+            std::vector<SkinningVertexData> skinningData;
+
+            // Matrices per node.
+            std::vector<float4x4> skinning;
+            std::vector<float4x4> invTransposeSkinning;
+            std::vector<float4x4> world;
+            std::vector<float4x4> invTransposeWorld;
+            std::vector<float4x4> meshBind;
+            std::vector<float4x4> meshInvBind;
+
+            SkinningScene(std::mt19937& rng, size_t vertexCount, uint32_t nodeCount)
+            {
+                for (uint32_t i = 0; i < nodeCount; i++)
+                {
+                    skinning.push_back(createRandomMatrix(rng));
+                    world.push_back(createRandomMatrix(rng));
+                    meshBind.push_back(createRandomMatrix(rng));
+                    invTransposeSkinning.push_back(glm::transpose(glm::inverse(skinning.back())));
+                    invTransposeWorld.push_back(glm::transpose(glm::inverse(world.back())));
+                    meshInvBind.push_back(glm::inverse(meshBind.back()));
+                }
+
+                // Skin every other vertex.
+                std::uniform_real_distribution<float> dist(0.f, 1.f);
+                for (size_t i = 0; i < vertexCount; i++)
+                {
+                    staticData.push_back(PackedStaticVertexData(createRandomVertex(rng)));
+                    if (i % 2 == 0) continue;
+
+                    SkinningVertexData s;
+                    s.boneID = uint4(rng() % nodeCount, rng() % nodeCount, rng() % nodeCount, rng() % nodeCount);
+                    s.boneWeight = float4(dist(rng), dist(rng), dist(rng), dist(rng));
+                    s.boneWeight /= s.boneWeight.x + s.boneWeight.y + s.boneWeight.z + s.boneWeight.w;
+                    s.staticIndex = (uint32_t)i;
+                    s.bindMatrixID = rng() % nodeCount;
+                    s.skeletonMatrixID = rng() % nodeCount;
+                    skinningData.push_back(s);
+                }
+            }
+
+            CpuVertexAnimation::SkinningMatrices getMatrices() const
+            {
+                CpuVertexAnimation::SkinningMatrices matrices;
+                matrices.pSkinning = skinning.data();
+                matrices.pInvTransposeSkinning = invTransposeSkinning.data();
+                matrices.pWorld = world.data();
+                matrices.pInvTransposeWorld = invTransposeWorld.data();
+                matrices.pMeshBind = meshBind.data();
+                matrices.pMeshInvBind = meshInvBind.data();
+                return matrices;
+            }
+        };
+
+        /** Skins the vertices with the same matrix operations as Skinning.slang.
+            The shader uses row vectors, so all matrix products are transposed here.
+        */
+        void skinReference(const SkinningScene& scene, std::vector<PackedStaticVertexData>& skinnedVertices)
+        {
+            for (const auto& s : scene.skinningData)
+            {
+                glm::mat4 bone = scene.skinning[s.boneID.x] * s.boneWeight.x + scene.skinning[s.boneID.y] * s.boneWeight.y +
+                    scene.skinning[s.boneID.z] * s.boneWeight.z + scene.skinning[s.boneID.w] * s.boneWeight.w;
+                glm::mat4 boneMat = scene.meshInvBind[s.bindMatrixID] * glm::transpose(scene.invTransposeWorld[s.skeletonMatrixID]) * bone * scene.meshBind[s.bindMatrixID];
+
+                glm::mat4 invTransposeBone = scene.invTransposeSkinning[s.boneID.x] * s.boneWeight.x + scene.invTransposeSkinning[s.boneID.y] * s.boneWeight.y +
+                    scene.invTransposeSkinning[s.boneID.z] * s.boneWeight.z + scene.invTransposeSkinning[s.boneID.w] * s.boneWeight.w;
+                glm::mat4 invTransposeMat = glm::transpose(scene.world[s.skeletonMatrixID]) * invTransposeBone;
+
+                StaticVertexData v = scene.staticData[s.staticIndex].unpack();
+                v.position = float3(boneMat * float4(v.position, 1.f));
+                v.tangent = float4(glm::mat3(boneMat) * float3(v.tangent), v.tangent.w);
+                v.normal = glm::transpose(glm::mat3(invTransposeMat)) * v.normal;
+                skinnedVertices[s.staticIndex].pack(v);
+            }
+        }
+
+        bool isClose(const float3& a, const float3& b, float tolerance)
+        {
+            return glm::all(glm::lessThanEqual(glm::abs(a - b), float3(tolerance * std::max(1.f, glm::length(b)))));
+        }
+
+        bool isClose(const std::vector<PackedStaticVertexData>& result, const std::vector<PackedStaticVertexData>& expected)
+        {
+            if (result.size() != expected.size()) return false;
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                StaticVertexData r = result[i].unpack();
+                StaticVertexData e = expected[i].unpack();
+                if (!isClose(r.position, e.position, 1e-4f) || !isClose(r.normal, e.normal, 1e-2f) ||
+                    !isClose(float3(r.tangent), float3(e.tangent), 1e-2f) || r.tangent.w != e.tangent.w || r.texCrd != e.texCrd) return false;
+            }
+            return true;
+        }
+    }
+
+    CPU_TEST(CpuVertexAnimation_Interpolation)
+    {
+        const std::vector<double> timeSamples = { 1.0, 2.0, 4.0 };
+        const auto kConstant = Animation::Behavior::Constant;
+        const auto kCycle = Animation::Behavior::Cycle;
+
+        auto info = CpuVertexAnimation::calculateInterpolation(3.0, timeSamples, kConstant, kConstant);
+        EXPECT(info.keyframeIndices == uint2(1, 2));
+        EXPECT_EQ(info.t, 0.5f);
+
+        info = CpuVertexAnimation::calculateInterpolation(0.5, timeSamples, kConstant, kConstant);
+        EXPECT(info.keyframeIndices == uint2(0, 0));
+        EXPECT_EQ(info.t, 0.f);
+
+        info = CpuVertexAnimation::calculateInterpolation(0.5, timeSamples, kCycle, kConstant);
+        EXPECT(info.keyframeIndices == uint2(2, 0));
+        EXPECT_EQ(info.t, 0.5f);
+
+        info = CpuVertexAnimation::calculateInterpolation(5.0, timeSamples, kConstant, kConstant);
+        EXPECT(info.keyframeIndices == uint2(1, 2));
+        EXPECT_EQ(info.t, 1.f);
+
+        info = CpuVertexAnimation::calculateInterpolation(5.5, timeSamples, kConstant, kCycle);
+        EXPECT(info.keyframeIndices == uint2(0, 1));
+        EXPECT_EQ(info.t, 0.5f);
+    }
+
+    CPU_TEST(CpuVertexAnimation_SkinningTranslation)
+    {
+        std::mt19937 rng;
+        SkinningScene scene(rng, 100, 3);
+        scene.skinning = { glm::mat4(1.f), glm::translate(float3(1.f, 2.f, 3.f)), glm::translate(float3(-1.f, 0.f, 0.f)) };
+        for (size_t i = 0; i < scene.skinning.size(); i++)
+        {
+            scene.invTransposeSkinning[i] = glm::transpose(glm::inverse(scene.skinning[i]));
+            scene.world[i] = scene.invTransposeWorld[i] = scene.meshBind[i] = scene.meshInvBind[i] = glm::mat4(1.f);
+        }
+        for (auto& s : scene.skinningData)
+        {
+            s.boneID = uint4(1, 2, 0, 0);
+            s.boneWeight = float4(0.25f, 0.75f, 0.f, 0.f);
+        }
+
+        std::vector<PackedStaticVertexData> result = scene.staticData;
+        AABB bounds = CpuVertexAnimation::skinVertices(scene.staticData.data(), scene.skinningData.data(), scene.skinningData.size(), scene.getMatrices(), result.data());
+
+        AABB expectedBounds;
+        const float3 offset(-0.5f, 0.5f, 0.75f);
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            StaticVertexData r = result[i].unpack();
+            StaticVertexData s = scene.staticData[i].unpack();
+            if (i % 2 == 0)
+            {
+                // Vertices that are not skinned are not written.
+                EXPECT(r.position == s.position);
+                continue;
+            }
+            EXPECT(isClose(r.position, s.position + offset, 1e-6f)) << "vertex " << i;
+            EXPECT(isClose(r.normal, s.normal, 1e-3f)) << "vertex " << i;
+            EXPECT(isClose(float3(r.tangent), float3(s.tangent), 1e-3f)) << "vertex " << i;
+            EXPECT(r.texCrd == s.texCrd);
+            expectedBounds.include(r.position);
+        }
+        EXPECT(bounds.minPoint == expectedBounds.minPoint && bounds.maxPoint == expectedBounds.maxPoint);
+    }
+
+    CPU_TEST(CpuVertexAnimation_SkinningMatchesReference)
+    {
+        std::mt19937 rng;
+        SkinningScene scene(rng, 10000, 20);
+
+        std::vector<PackedStaticVertexData> expected = scene.staticData;
+        skinReference(scene, expected);
+
+        std::vector<PackedStaticVertexData> result = scene.staticData;
+        CpuVertexAnimation::skinVertices(scene.staticData.data(), scene.skinningData.data(), scene.skinningData.size(), scene.getMatrices(), result.data());
+        EXPECT(isClose(result, expected));
+    }
+
+    CPU_TEST(CpuVertexAnimation_MeshCache)
+    {
+        std::mt19937 rng;
+        const size_t vertexCount = 5000;
+
+        CachedMesh cache;
+        cache.timeSamples = { 1.0, 2.0 };
+        cache.vertexData.resize(2);
+        std::vector<PackedStaticVertexData> vertices;
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            StaticVertexData v = createRandomVertex(rng);
+            cache.vertexData[0].push_back(PackedStaticVertexData(v));
+            v.position += float3(1.f, 0.f, 0.f);
+            cache.vertexData[1].push_back(PackedStaticVertexData(v));
+            v.texCrd = float2(-1.f);
+            vertices.push_back(PackedStaticVertexData(v));
+        }
+
+        auto info = CpuVertexAnimation::calculateInterpolation(1.25, cache.timeSamples, Animation::Behavior::Constant, Animation::Behavior::Constant);
+        AABB bounds = CpuVertexAnimation::interpolateMeshVertices(cache, info, vertices.data());
+
+        AABB expectedBounds;
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            StaticVertexData r = vertices[i].unpack();
+            StaticVertexData v0 = cache.vertexData[0][i].unpack();
+            EXPECT(isClose(r.position, v0.position + float3(0.25f, 0.f, 0.f), 1e-6f)) << "vertex " << i;
+            EXPECT(isClose(r.normal, v0.normal, 1e-3f)) << "vertex " << i;
+            EXPECT(r.texCrd == float2(-1.f));
+            expectedBounds.include(r.position);
+        }
+        EXPECT(bounds.minPoint == expectedBounds.minPoint && bounds.maxPoint == expectedBounds.maxPoint);
+    }
+
+    CPU_TEST(CpuVertexAnimation_CurveCache)
+    {
+        std::mt19937 rng;
+        const size_t vertexCount = 5000;
+
+        CachedCurve cache;
+        cache.timeSamples = { 1.0, 2.0, 3.0 };
+        cache.vertexData.resize(3);
+        std::vector<StaticCurveVertexData> vertices(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            float3 p = randomFloat3(rng);
+            for (size_t k = 0; k < 3; k++) cache.vertexData[k].push_back({ p + float3(0.f, (float)k, 0.f) });
+            vertices[i].radius = 0.1f;
+        }
+
+        auto info = CpuVertexAnimation::calculateInterpolation(2.5, cache.timeSamples, Animation::Behavior::Constant, Animation::Behavior::Constant);
+        AABB bounds = CpuVertexAnimation::interpolateCurveVertices(cache, info, vertices.data());
+
+        AABB expectedBounds;
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            EXPECT(isClose(vertices[i].position, cache.vertexData[0][i].position + float3(0.f, 1.5f, 0.f), 1e-6f)) << "vertex " << i;
+            expectedBounds.include(AABB(vertices[i].position - 0.1f, vertices[i].position + 0.1f));
+        }
+        EXPECT(bounds.minPoint == expectedBounds.minPoint && bounds.maxPoint == expectedBounds.maxPoint);
+    }
+
+    CPU_TEST(CpuVertexAnimation_SkinningBounds)
+    {
+        // Enough vertices for the bounds to be reduced over several tasks.
+        std::mt19937 rng;
+        SkinningScene scene(rng, 5000, 20);
+
+        std::vector<PackedStaticVertexData> result = scene.staticData;
+        AABB bounds = CpuVertexAnimation::skinVertices(scene.staticData.data(), scene.skinningData.data(), scene.skinningData.size(), scene.getMatrices(), result.data());
+
+        AABB expected;
+        for (const auto& s : scene.skinningData) expected.include(result[s.staticIndex].position);
+        EXPECT(bounds.valid());
+        EXPECT(bounds.minPoint == expected.minPoint);
+        EXPECT(bounds.maxPoint == expected.maxPoint);
+    }
+}
@@ -0,0 +1,182 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridVolume.h"
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996)
+#include <nanovdb/util/IO.h>
+#pragma warning(pop)
+#include <random>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kGridname[] = "sphere_fog";
+        const double kFrameRate = 1.0;
+        const double kPrefetchTime = 2.0;
+        const uint32_t kWindowSize = 3;     ///< Frames in the streaming window at the frame rate and prefetch time above.
+        const uint32_t kBudgetFrames = 4;   ///< Frames fitting in the memory budget.
+
+        std::filesystem::path createTempDirectory()
+        {
+            std::random_device rd;
+            auto path = std::filesystem::temp_directory_path() / fmt::format("FalcorGridVolumeStreamingTest{:08x}", rd());
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+            return path;
+        }
+
+        std::vector<uint32_t> getExpectedWindow(uint32_t frame, uint32_t frameCount, bool forward)
+        {
+            std::vector<uint32_t> window;
+            for (uint32_t i = 0; i < kWindowSize; i++) window.push_back((frame + (forward ? i : frameCount - i)) % frameCount);
+            return window;
+        }
+
+        bool isResident(const GridVolume::SharedPtr& pVolume, uint32_t frame)
+        {
+            return pVolume->getGridSequence(GridVolume::GridSlot::Density)[frame] != nullptr;
+        }
+
+        /** Pick up finished loads until all frames of the window are resident.
+            \return True if the window became resident before the timeout.
+        */
+        bool waitForWindow(const GridVolume::SharedPtr& pVolume, const std::vector<uint32_t>& window)
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            while (CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) < 10000.0)
+            {
+                // Playback is disabled, so this only updates the streaming state.
+                pVolume->updatePlayback(0.0);
+                if (std::all_of(window.begin(), window.end(), [&](uint32_t frame) { return isResident(pVolume, frame); })) return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return false;
+        }
+    }
+
+    GPU_TEST(GridVolumeStreaming)
+    {
+        if (Threading::getThreadCount() == 0) throw SkippingTestException("Grid prefetching requires worker threads.");
+
+        // All frames use the same grid, so the streaming window is limited by the memory budget in whole frames.
+        auto pSphere = Grid::createSphere(1.f, 1.f / 32.f);
+        const uint64_t frameSize = pSphere->getGridSizeInBytes() + pSphere->getHostSizeInBytes();
+        const uint64_t memoryBudget = std::max(kBudgetFrames * frameSize, uint64_t(1) << 20);
+        const uint32_t frameCount = (uint32_t)(memoryBudget / frameSize) + 4;
+
+        auto directory = createTempDirectory();
+        std::vector<std::filesystem::path> paths;
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            paths.push_back(directory / fmt::format("sphere{:03d}.nvdb", i));
+            nanovdb::io::writeGrid(paths.back().string(), pSphere->getGridHandle());
+        }
+
+        {
+            auto pVolume = GridVolume::create("Sphere");
+            pVolume->setFrameRate(kFrameRate);
+            pVolume->setStreamingSettings({ true, memoryBudget, kPrefetchTime });
+            EXPECT_EQ(pVolume->loadGridSequence(GridVolume::GridSlot::Density, paths, kGridname), frameCount);
+            EXPECT(pVolume->isStreaming(GridVolume::GridSlot::Density));
+            EXPECT(isResident(pVolume, 0));
+            EXPECT_EQ(pVolume->getStreamingStats().loads, 1);
+
+            auto window = getExpectedWindow(0, frameCount, true);
+            EXPECT(waitForWindow(pVolume, window));
+
+            // Switches to a frame of the resident window count as hits and keep the rest of the window resident.
+            // Eviction must only drop frames outside the window and keep the resident grids within the budget.
+            auto step = [&](uint32_t frame, bool forward, bool expectHit)
+            {
+                const auto stats = pVolume->getStreamingStats();
+                const auto prevWindow = window;
+                window = getExpectedWindow(frame, frameCount, forward);
+
+                pVolume->setGridFrame(frame);
+                EXPECT_EQ(pVolume->getGridFrame(), frame);
+                EXPECT(isResident(pVolume, frame)) << "frame " << frame;
+                for (uint32_t f : window)
+                {
+                    bool wasResident = std::find(prevWindow.begin(), prevWindow.end(), f) != prevWindow.end();
+                    if (wasResident) EXPECT(isResident(pVolume, f)) << "frame " << frame << ", window frame " << f;
+                }
+                EXPECT_LE(pVolume->getStreamedSizeInBytes(), memoryBudget) << "frame " << frame;
+
+                const auto& newStats = pVolume->getStreamingStats();
+                if (expectHit)
+                {
+                    EXPECT_EQ(newStats.hits, stats.hits + 1) << "frame " << frame;
+                    EXPECT_EQ(newStats.stalls, stats.stalls) << "frame " << frame;
+                    EXPECT_EQ(newStats.loads, stats.loads) << "frame " << frame;
+                }
+                else
+                {
+                    EXPECT_EQ(newStats.hits, stats.hits) << "frame " << frame;
+                    EXPECT_EQ(newStats.stalls, stats.stalls + 1) << "frame " << frame;
+                    EXPECT_EQ(newStats.loads, stats.loads + 1) << "frame " << frame;
+                }
+
+                EXPECT(waitForWindow(pVolume, window)) << "frame " << frame;
+                EXPECT_LE(pVolume->getStreamedSizeInBytes(), memoryBudget) << "frame " << frame;
+            };
+
+            // Play forward through the sequence and wrap around to the first frame.
+            for (uint32_t i = 1; i <= frameCount; i++) step(i % frameCount, true, true);
+
+            // All frames were visited with room for fewer, so grids were evicted and loaded again.
+            const auto forwardStats = pVolume->getStreamingStats();
+            EXPECT_GT(forwardStats.evictions, 0);
+            EXPECT_GT(forwardStats.loads, frameCount);
+
+            // Play backward, wrapping around to the last frame. The first frame behind the window may not be resident.
+            step(frameCount - 1, false, isResident(pVolume, frameCount - 1));
+            for (uint32_t i = frameCount - 1; i-- > 0;) step(i, false, true);
+
+            // Jump to a frame that is not resident, which stalls until its grid is loaded.
+            uint32_t current = pVolume->getGridFrame();
+            uint32_t jumpFrame = 0;
+            while (jumpFrame < frameCount && isResident(pVolume, jumpFrame)) jumpFrame++;
+            EXPECT_LT(jumpFrame, frameCount);
+            if (jumpFrame < frameCount) step(jumpFrame, (jumpFrame + frameCount - current) % frameCount <= frameCount / 2, false);
+
+            // Playback always advances forward, even for a jump that is shorter backwards.
+            current = pVolume->getGridFrame();
+            uint32_t playbackFrame = (current + frameCount / 2 + 1) % frameCount;
+            pVolume->setPlaybackEnabled(true);
+            pVolume->updatePlayback(playbackFrame / kFrameRate);
+            pVolume->setPlaybackEnabled(false);
+            EXPECT_EQ(pVolume->getGridFrame(), playbackFrame);
+            EXPECT(waitForWindow(pVolume, getExpectedWindow(playbackFrame, frameCount, true)));
+            EXPECT_LE(pVolume->getStreamedSizeInBytes(), memoryBudget);
+        }
+        std::filesystem::remove_all(directory);
+    }
+}
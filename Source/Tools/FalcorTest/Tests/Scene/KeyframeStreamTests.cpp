@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/KeyframeStream.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kValuesPerKeyframe = 1024;
+
+        /** Keyframe stream over keyframes filled with their own index, uploading to slots in host memory.
+        */
+        struct TestStream
+        {
+            std::vector<std::vector<uint32_t>> slots;
+            std::unique_ptr<KeyframeStream> pStream;
+
+            TestStream(uint32_t keyframeCount, uint32_t slotCount)
+            {
+                auto pFile = KeyframeFile::create();
+                std::vector<uint32_t> chunkIDs;
+                for (uint32_t i = 0; i < keyframeCount; i++)
+                {
+                    std::vector<uint32_t> data(kValuesPerKeyframe, i);
+                    chunkIDs.push_back(pFile->addChunk(data.data(), data.size() * sizeof(uint32_t)));
+                }
+
+                slots.resize(slotCount);
+                pStream = std::make_unique<KeyframeStream>(pFile, std::move(chunkIDs), slotCount, [this](uint32_t slot, const void* pData, size_t size)
+                {
+                    slots[slot].resize(size / sizeof(uint32_t));
+                    std::memcpy(slots[slot].data(), pData, size);
+                });
+            }
+
+            bool holds(uint32_t slot, uint32_t keyframe) const
+            {
+                return slots[slot].size() == kValuesPerKeyframe && std::all_of(slots[slot].begin(), slots[slot].end(), [keyframe](uint32_t v) { return v == keyframe; });
+            }
+        };
+    }
+
+    CPU_TEST(KeyframeFile_Chunks)
+    {
+        auto pFile = KeyframeFile::create();
+
+        std::vector<std::vector<uint8_t>> chunks;
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            chunks.emplace_back(i * 100 + 1);
+            for (size_t j = 0; j < chunks.back().size(); j++) chunks.back()[j] = uint8_t(i + j);
+            EXPECT_EQ(pFile->addChunk(chunks.back().data(), chunks.back().size()), i);
+        }
+
+        // Read in reverse order to test seeking.
+        uint64_t totalSize = 0;
+        for (uint32_t i = 10; i-- > 0;)
+        {
+            EXPECT_EQ(pFile->getChunkSize(i), chunks[i].size());
+            std::vector<uint8_t> data(pFile->getChunkSize(i));
+            pFile->readChunk(i, data.data());
+            EXPECT(data == chunks[i]) << "chunk " << i;
+            totalSize += chunks[i].size();
+        }
+        EXPECT_EQ(pFile->getSize(), totalSize);
+    }
+
+    CPU_TEST(KeyframeFile_Reopen)
+    {
+        const auto path = getTempFilePath();
+
+        std::vector<std::vector<uint8_t>> chunks;
+        {
+            auto pFile = KeyframeFile::create(path);
+            for (uint32_t i = 0; i < 10; i++)
+            {
+                chunks.emplace_back(i * 100 + 1, uint8_t(i));
+                pFile->addChunk(chunks.back().data(), chunks.back().size());
+            }
+
+            // Unfinished files have no chunk table and cannot be opened.
+            bool caught = false;
+            try
+            {
+                KeyframeFile::open(path);
+            }
+            catch (const RuntimeError&)
+            {
+                caught = true;
+            }
+            EXPECT(caught);
+
+            pFile->finish();
+        }
+
+        // The file is kept and can be read after reopening.
+        auto pFile = KeyframeFile::open(path);
+        EXPECT_EQ(pFile->getChunkCount(), 10u);
+        for (uint32_t i = 0; i < pFile->getChunkCount(); i++)
+        {
+            std::vector<uint8_t> data(pFile->getChunkSize(i));
+            pFile->readChunk(i, data.data());
+            EXPECT(data == chunks[i]) << "chunk " << i;
+        }
+
+        bool caught = false;
+        try
+        {
+            pFile->addChunk(chunks[0].data(), chunks[0].size());
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+
+        pFile.reset();
+        std::filesystem::remove(path);
+    }
+
+    CPU_TEST(KeyframeStream_Playback)
+    {
+        const uint32_t keyframeCount = 16;
+        TestStream stream(keyframeCount, 4);
+        EXPECT_EQ(stream.pStream->getSlotCount(), 4u);
+
+        // Play forward twice through the looping sequence, then backward.
+        const uint32_t stepCount = 2 * keyframeCount;
+        for (uint32_t step = 0; step < 2 * stepCount; step++)
+        {
+            const bool forward = step < stepCount;
+            uint32_t i = forward ? step % keyframeCount : (keyframeCount - 1) - step % keyframeCount;
+            uint2 keyframes(i, (i + 1) % keyframeCount);
+
+            uint2 slots = stream.pStream->acquire(keyframes, forward, true);
+            EXPECT(stream.holds(slots.x, keyframes.x)) << "step " << step;
+            EXPECT(stream.holds(slots.y, keyframes.y)) << "step " << step;
+            EXPECT_EQ(stream.pStream->getSlot(keyframes.x), slots.x);
+            EXPECT_EQ(stream.pStream->getSlot(keyframes.y), slots.y);
+        }
+
+        // Every keyframe is requested again in the following step, so at least one of two requests hits.
+        const auto& stats = stream.pStream->getStats();
+        EXPECT_EQ(stats.requests, 4 * stepCount);
+        EXPECT_EQ(stats.hits + stats.stalls, stats.requests);
+        EXPECT_GE(stats.hits, 2 * stepCount - 1);
+        EXPECT_EQ(stats.uploadedBytes, stats.uploads * kValuesPerKeyframe * sizeof(uint32_t));
+    }
+
+    CPU_TEST(KeyframeStream_Eviction)
+    {
+        const uint32_t keyframeCount = 8;
+        TestStream stream(keyframeCount, 2);
+
+        // With two slots nothing is prefetched and every step replaces the least recently used keyframe.
+        for (uint32_t i = 0; i + 1 < keyframeCount; i++)
+        {
+            uint2 slots = stream.pStream->acquire(uint2(i, i + 1), true, false);
+            EXPECT(stream.holds(slots.x, i));
+            EXPECT(stream.holds(slots.y, i + 1));
+            EXPECT_NE(slots.x, slots.y);
+            if (i > 0) EXPECT_EQ(stream.pStream->getSlot(i - 1), KeyframeStream::kInvalidSlot);
+        }
+
+        const auto& stats = stream.pStream->getStats();
+        EXPECT_EQ(stats.uploads, keyframeCount);
+        EXPECT_EQ(stats.stalls, keyframeCount);
+        EXPECT_EQ(stats.hits, keyframeCount - 2);
+
+        // Jumping to a keyframe that is not resident stalls.
+        stream.pStream->acquire(uint2(0, 0), true, false);
+        EXPECT(stream.holds(stream.pStream->getSlot(0), 0));
+        EXPECT_EQ(stats.stalls, keyframeCount + 1);
+    }
+}
@@ -0,0 +1,112 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        void addNodes(SceneBuilder::IngestBatch& batch, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                SceneBuilder::Node node;
+                node.name = "Batch" + std::to_string(batch.getSequenceNumber()) + "Node" + std::to_string(i);
+                node.parent = i > 0 ? i - 1 : SceneBuilder::kInvalidNode;
+                batch.addNode(node);
+            }
+        }
+
+        bool submitThrows(SceneBuilder& builder, SceneBuilder::IngestBatch& batch)
+        {
+            try
+            {
+                builder.submitIngestBatch(std::move(batch));
+            }
+            catch (const RuntimeError&)
+            {
+                return true;
+            }
+            return false;
+        }
+    }
+
+    GPU_TEST(SceneBuilderIngestBatchOrder)
+    {
+        SceneBuilder::SharedPtr pBuilder = SceneBuilder::create(SceneBuilder::Flags::None);
+
+        auto batch0 = pBuilder->beginIngestBatch();
+        auto batch1 = pBuilder->beginIngestBatch();
+        auto batch2 = pBuilder->beginIngestBatch();
+        EXPECT_EQ(batch0.getSequenceNumber(), 0u);
+        EXPECT_EQ(batch1.getSequenceNumber(), 1u);
+        EXPECT_EQ(batch2.getSequenceNumber(), 2u);
+
+        addNodes(batch0, 2);
+        addNodes(batch1, 3);
+        addNodes(batch2, 4);
+
+        // Submit out of order with batch 1 missing. Only batch 0 can be committed.
+        pBuilder->submitIngestBatch(std::move(batch2));
+        pBuilder->submitIngestBatch(std::move(batch0));
+
+        auto ranges = pBuilder->commitIngestBatches();
+        EXPECT_EQ(ranges.size(), 1u);
+        if (ranges.size() != 1) return;
+        EXPECT_EQ(ranges[0].sequenceNumber, 0u);
+        EXPECT_EQ(ranges[0].firstNodeID, 0u);
+        EXPECT_EQ(ranges[0].nodeCount, 2u);
+        EXPECT_EQ(pBuilder->getNodeCount(), 2u);
+
+        // Committing again without the missing batch doesn't add anything.
+        EXPECT(pBuilder->commitIngestBatches().empty());
+        EXPECT_EQ(pBuilder->getNodeCount(), 2u);
+
+        // Submitting the missing batch commits the remaining batches in sequence order.
+        pBuilder->submitIngestBatch(std::move(batch1));
+        ranges = pBuilder->commitIngestBatches();
+        EXPECT_EQ(ranges.size(), 2u);
+        if (ranges.size() != 2) return;
+        EXPECT_EQ(ranges[0].sequenceNumber, 1u);
+        EXPECT_EQ(ranges[0].firstNodeID, 2u);
+        EXPECT_EQ(ranges[0].nodeCount, 3u);
+        EXPECT_EQ(ranges[1].sequenceNumber, 2u);
+        EXPECT_EQ(ranges[1].firstNodeID, 5u);
+        EXPECT_EQ(ranges[1].nodeCount, 4u);
+        EXPECT_EQ(pBuilder->getNodeCount(), 9u);
+
+        // Submitted batches can't be submitted again, neither before nor after they are committed.
+        auto batch3 = pBuilder->beginIngestBatch();
+        pBuilder->submitIngestBatch(std::move(batch3));
+        EXPECT(submitThrows(*pBuilder, batch3));
+        EXPECT(submitThrows(*pBuilder, batch1));
+        EXPECT_EQ(pBuilder->commitIngestBatches().size(), 1u);
+        EXPECT(submitThrows(*pBuilder, batch3));
+    }
+}
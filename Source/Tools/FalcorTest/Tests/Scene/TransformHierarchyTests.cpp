@@ -0,0 +1,305 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/TransformHierarchy.h"
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidNode = TransformHierarchy::kInvalidNode;
+
+        /** Creates a random affine matrix.
+        */
+        glm::mat4 createRandomMatrix(std::mt19937& rng)
+        {
+            std::uniform_real_distribution<float> dist(-1.f, 1.f);
+            glm::mat4 m;
+            for (int c = 0; c < 4; c++)
+            {
+                for (int r = 0; r < 3; r++) m[c][r] = dist(rng) + (c == r ? 2.f : 0.f);
+                m[c][3] = c == 3 ? 1.f : 0.f;
+            }
+            return m;
+        }
+
+        /** Creates a forest of characters with a chain of bones each, similar to a crowd scene.
+        */
+        std::vector<uint32_t> createCrowd(uint32_t characterCount, uint32_t bonesPerCharacter, uint32_t chainLength)
+        {
+            std::vector<uint32_t> parents;
+            parents.push_back(kInvalidNode);
+            for (uint32_t c = 0; c < characterCount; c++)
+            {
+                uint32_t rootID = (uint32_t)parents.size();
+                parents.push_back(0);
+                for (uint32_t b = 0; b < bonesPerCharacter; b++)
+                {
+                    uint32_t nodeID = (uint32_t)parents.size();
+                    parents.push_back(b % chainLength == 0 ? rootID : nodeID - 1);
+                }
+            }
+            return parents;
+        }
+
+        struct MatrixData
+        {
+            std::vector<glm::mat4> local;
+            std::vector<glm::mat4> localToBindSpace;
+            std::vector<glm::mat4> global;
+            std::vector<glm::mat4> invTransposeGlobal;
+            std::vector<glm::mat4> skinning;
+            std::vector<glm::mat4> invTransposeSkinning;
+
+            MatrixData(size_t nodeCount, std::mt19937& rng)
+                : global(nodeCount), invTransposeGlobal(nodeCount), skinning(nodeCount), invTransposeSkinning(nodeCount)
+            {
+                for (size_t i = 0; i < nodeCount; i++)
+                {
+                    local.push_back(createRandomMatrix(rng));
+                    localToBindSpace.push_back(createRandomMatrix(rng));
+                }
+            }
+
+            TransformHierarchy::Matrices getMatrices(bool skinned)
+            {
+                TransformHierarchy::Matrices matrices;
+                matrices.pLocal = local.data();
+                matrices.pGlobal = global.data();
+                matrices.pInvTransposeGlobal = invTransposeGlobal.data();
+                if (skinned)
+                {
+                    matrices.pLocalToBindSpace = localToBindSpace.data();
+                    matrices.pSkinning = skinning.data();
+                    matrices.pInvTransposeSkinning = invTransposeSkinning.data();
+                }
+                return matrices;
+            }
+        };
+
+        /** Reference implementation, updating the nodes serially in node order with glm.
+        */
+        void updateReference(const std::vector<uint32_t>& parents, MatrixData& data, std::vector<bool>& changed, bool updateAll, bool skinned)
+        {
+            for (size_t i = 0; i < parents.size(); i++)
+            {
+                if (parents[i] != kInvalidNode) changed[i] = changed[i] || changed[parents[i]];
+                if (!changed[i] && !updateAll) continue;
+
+                data.global[i] = data.local[i];
+                if (parents[i] != kInvalidNode) data.global[i] = data.global[parents[i]] * data.global[i];
+                data.invTransposeGlobal[i] = glm::transpose(glm::inverse(data.global[i]));
+
+                if (skinned)
+                {
+                    data.skinning[i] = data.global[i] * data.localToBindSpace[i];
+                    data.invTransposeSkinning[i] = glm::transpose(glm::inverse(data.skinning[i]));
+                }
+            }
+        }
+
+        bool isBitwiseEqual(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b)
+        {
+            return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(glm::mat4)) == 0;
+        }
+
+        std::vector<uint32_t> createRandomNodes(size_t count, float probability, std::mt19937& rng)
+        {
+            std::bernoulli_distribution dist(probability);
+            std::vector<uint32_t> nodes;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (dist(rng)) nodes.push_back((uint32_t)i);
+            }
+            std::shuffle(nodes.begin(), nodes.end(), rng);
+            return nodes;
+        }
+
+        std::vector<bool> createFlags(size_t count, const std::vector<uint32_t>& nodes)
+        {
+            std::vector<bool> flags(count);
+            for (uint32_t nodeID : nodes) flags[nodeID] = true;
+            return flags;
+        }
+    }
+
+    CPU_TEST(TransformHierarchy_Levels)
+    {
+        TransformHierarchy empty(std::vector<uint32_t>{});
+        EXPECT_EQ(empty.getNodeCount(), 0);
+        EXPECT_EQ(empty.getLevelCount(), 0);
+
+        TransformHierarchy hierarchy({ kInvalidNode, 0, 1, kInvalidNode, 3, 0, 2 });
+        EXPECT_EQ(hierarchy.getNodeCount(), 7);
+        EXPECT_EQ(hierarchy.getLevelCount(), 4);
+
+        // Small crowd where all levels are updated one at a time.
+        TransformHierarchy crowd(createCrowd(10, 20, 5));
+        EXPECT_EQ(crowd.getLevelCount(), 7);
+        EXPECT_EQ(crowd.getSplitLevel(), 7);
+
+        // Large crowd where the characters are updated in parallel.
+        TransformHierarchy largeCrowd(createCrowd(100, 20, 5));
+        EXPECT_EQ(largeCrowd.getLevelCount(), 7);
+        EXPECT_EQ(largeCrowd.getSplitLevel(), 1);
+
+        // Parents must precede their children.
+        bool caught = false;
+        try
+        {
+            TransformHierarchy invalid({ 1, kInvalidNode });
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+
+    CPU_TEST(TransformHierarchy_MatchesGlm)
+    {
+        std::mt19937 rng(1);
+        const auto parents = createCrowd(50, 40, 8);
+        const size_t nodeCount = parents.size();
+        TransformHierarchy hierarchy(parents);
+        EXPECT_EQ(hierarchy.getSplitLevel(), 2);
+
+        for (bool skinned : { false, true })
+        {
+            MatrixData expected(nodeCount, rng);
+            MatrixData result = expected;
+
+            // Full update followed by partial updates with a few changed nodes.
+            for (int frame = 0; frame < 4; frame++)
+            {
+                bool updateAll = frame == 0;
+                std::vector<uint32_t> changedNodes = createRandomNodes(nodeCount, 0.02f, rng);
+                std::vector<bool> expectedChanged = createFlags(nodeCount, changedNodes);
+                std::vector<bool> resultChanged(nodeCount);
+                for (uint32_t nodeID : changedNodes) expected.local[nodeID] = result.local[nodeID] = createRandomMatrix(rng);
+
+                updateReference(parents, expected, expectedChanged, updateAll, skinned);
+                hierarchy.update(result.getMatrices(skinned), changedNodes, resultChanged, updateAll);
+
+                EXPECT(resultChanged == expectedChanged);
+                EXPECT(isBitwiseEqual(result.global, expected.global));
+                EXPECT(isBitwiseEqual(result.invTransposeGlobal, expected.invTransposeGlobal));
+                EXPECT(isBitwiseEqual(result.skinning, expected.skinning));
+                EXPECT(isBitwiseEqual(result.invTransposeSkinning, expected.invTransposeSkinning));
+            }
+        }
+    }
+
+    CPU_TEST(TransformHierarchy_Propagation)
+    {
+        // Crowd with 100 characters and chains of 5 bones, so the characters are updated as subtrees.
+        std::mt19937 rng(1);
+        const auto parents = createCrowd(100, 20, 5);
+        const size_t nodeCount = parents.size();
+        TransformHierarchy hierarchy(parents);
+        EXPECT_EQ(hierarchy.getSplitLevel(), 1);
+
+        MatrixData expected(nodeCount, rng);
+        MatrixData result = expected;
+        std::vector<bool> expectedChanged(nodeCount);
+        std::vector<bool> resultChanged(nodeCount);
+        updateReference(parents, expected, expectedChanged, true, true);
+        hierarchy.update(result.getMatrices(true), {}, resultChanged, true);
+        EXPECT(resultChanged == expectedChanged);
+        EXPECT(isBitwiseEqual(result.global, expected.global));
+
+        // Change a bone in the middle of a chain (repeated), a character root and one of its bones, and the last bone of a chain.
+        // Node 1 is the root of the first character and its bones are nodes 2 to 21, node 22 is the root of the second character.
+        const std::vector<uint32_t> changedNodes = { 4, 22, 4, 25, 21 };
+        for (int frame = 0; frame < 2; frame++)
+        {
+            std::fill(expectedChanged.begin(), expectedChanged.end(), false);
+            std::fill(resultChanged.begin(), resultChanged.end(), false);
+            for (uint32_t nodeID : changedNodes)
+            {
+                expectedChanged[nodeID] = true;
+                expected.local[nodeID] = result.local[nodeID] = createRandomMatrix(rng);
+            }
+
+            updateReference(parents, expected, expectedChanged, false, true);
+            hierarchy.update(result.getMatrices(true), changedNodes, resultChanged, false);
+
+            // Bones 2 to 6 form a chain, so only bones 5 and 6 follow bone 4.
+            EXPECT(!resultChanged[1] && !resultChanged[3]);
+            EXPECT(resultChanged[4] && resultChanged[5] && resultChanged[6]);
+            EXPECT(!resultChanged[7]);
+            EXPECT(resultChanged[21] && !resultChanged[20]);
+            for (uint32_t nodeID = 22; nodeID <= 42; nodeID++) EXPECT(resultChanged[nodeID]) << "nodeID = " << nodeID;
+            EXPECT(!resultChanged[43]);
+
+            EXPECT(resultChanged == expectedChanged);
+            EXPECT(isBitwiseEqual(result.global, expected.global));
+            EXPECT(isBitwiseEqual(result.invTransposeGlobal, expected.invTransposeGlobal));
+            EXPECT(isBitwiseEqual(result.skinning, expected.skinning));
+            EXPECT(isBitwiseEqual(result.invTransposeSkinning, expected.invTransposeSkinning));
+        }
+    }
+
+    CPU_TEST(TransformHierarchyThroughput)
+    {
+        // Crowd with 200 characters and 100 animated bones each. Increase the character count to benchmark larger crowds.
+        const uint32_t kCharacterCount = 200;
+        std::mt19937 rng(1);
+        const auto parents = createCrowd(kCharacterCount, 100, 10);
+        const size_t nodeCount = parents.size();
+        TransformHierarchy hierarchy(parents);
+
+        MatrixData expected(nodeCount, rng);
+        MatrixData result = expected;
+        std::vector<uint32_t> changedNodes(nodeCount);
+        for (uint32_t i = 0; i < (uint32_t)nodeCount; i++) changedNodes[i] = i;
+        std::vector<bool> expectedChanged(nodeCount, true);
+        std::vector<bool> resultChanged(nodeCount);
+
+        const int kIterations = 10;
+        double referenceTime = 0.0;
+        double hierarchyTime = 0.0;
+        for (int i = 0; i < kIterations; i++)
+        {
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            updateReference(parents, expected, expectedChanged, false, true);
+            auto t1 = CpuTimer::getCurrentTimePoint();
+            hierarchy.update(result.getMatrices(true), changedNodes, resultChanged, false);
+            auto t2 = CpuTimer::getCurrentTimePoint();
+            referenceTime += CpuTimer::calcDuration(t0, t1);
+            hierarchyTime += CpuTimer::calcDuration(t1, t2);
+        }
+
+        EXPECT(isBitwiseEqual(result.global, expected.global));
+        EXPECT(isBitwiseEqual(result.invTransposeSkinning, expected.invTransposeSkinning));
+        logInfo("Transform update of {} nodes: glm {:.2f} ms, TransformHierarchy ({} levels, {} threads) {:.2f} ms",
+            nodeCount, referenceTime / kIterations, hierarchy.getLevelCount(), Threading::getThreadCount(), hierarchyTime / kIterations);
+    }
+}
@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/BlockCompressedStream.h"
+#include <lz4_stream/lz4_stream.h>
+#include <random>
+#include <sstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Generate data resembling packed vertex data: smoothly varying floats mixed with some noise.
+        */
+        std::vector<char> generateData(size_t size, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::uniform_real_distribution<float> noise(-0.01f, 0.01f);
+            std::vector<float> values(size / sizeof(float));
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                values[i] = (i % 8 < 6) ? std::sin((float)(i / 8) * 0.001f) + noise(rng) : 0.f;
+            }
+            std::vector<char> data(size);
+            std::memcpy(data.data(), values.data(), values.size() * sizeof(float));
+            return data;
+        }
+
+        std::string compress(const std::vector<char>& data, BlockCodec codec, size_t blockSize)
+        {
+            std::ostringstream os;
+            BlockCompressedOutputStream zs(os, codec, blockSize);
+            zs.write(data.data(), data.size());
+            zs.close();
+            return os.str();
+        }
+
+        std::vector<char> decompress(const std::string& compressed, size_t size)
+        {
+            std::istringstream is(compressed);
+            BlockCompressedInputStream zs(is);
+            std::vector<char> data(size);
+            zs.read(data.data(), size);
+            return data;
+        }
+
+        double toMBs(size_t bytes, double seconds)
+        {
+            return (double)bytes / (1024.0 * 1024.0) / std::max(seconds, 1e-9);
+        }
+    }
+
+    CPU_TEST(BlockCompressedStreamRoundtrip)
+    {
+        for (auto codec : { BlockCodec::LZ4, BlockCodec::LZ4HC })
+        {
+            for (size_t size : { 0, 1, 1000, 1 << 20, 3 * (1 << 20) + 17 })
+            {
+                auto data = generateData(size, (uint32_t)size);
+                auto compressed = compress(data, codec, 64 * 1024);
+                EXPECT(decompress(compressed, size) == data);
+            }
+        }
+
+        // Incompressible data is stored as raw blocks.
+        std::vector<char> noise(100000);
+        std::mt19937 rng(1);
+        for (auto& c : noise) c = (char)rng();
+        auto compressed = compress(noise, BlockCodec::LZ4, 4096);
+        EXPECT(decompress(compressed, noise.size()) == noise);
+
+        // Data following the stream is left untouched.
+        std::stringstream ss;
+        {
+            BlockCompressedOutputStream zs(ss);
+            zs << "first";
+        }
+        ss << "second";
+        {
+            BlockCompressedInputStream zs(ss);
+            std::string str;
+            zs >> str;
+            EXPECT_EQ(str, "first");
+        }
+        std::string trailing;
+        ss >> trailing;
+        EXPECT_EQ(trailing, "second");
+    }
+
+    CPU_TEST(BlockCompressedStreamTruncated)
+    {
+        auto data = generateData(1 << 20, 1);
+        auto compressed = compress(data, BlockCodec::LZ4, 64 * 1024);
+        compressed.resize(compressed.size() - 16);
+
+        bool caught = false;
+        try
+        {
+            decompress(compressed, data.size() + 1);
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+
+    CPU_TEST(BlockCompressedStreamManyBlocks)
+    {
+        // Use many more blocks than worker threads so that blocks are compressed and decompressed out of order.
+        const size_t kSize = 4 * 1024 * 1024;
+        const size_t kBlockSize = 16 * 1024;
+        auto data = generateData(kSize, 0);
+
+        std::vector<size_t> compressedSizes;
+        for (auto codec : { BlockCodec::LZ4, BlockCodec::LZ4HC })
+        {
+            auto compressed = compress(data, codec, kBlockSize);
+            EXPECT(compressed.size() < data.size());
+            compressedSizes.push_back(compressed.size());
+
+            // Read back in chunks that don't align with the blocks.
+            std::istringstream is(compressed);
+            BlockCompressedInputStream zs(is);
+            std::vector<char> result(kSize);
+            for (size_t offset = 0; offset < kSize; offset += 10007)
+            {
+                zs.read(result.data() + offset, std::min<size_t>(10007, kSize - offset));
+            }
+            EXPECT(result == data);
+        }
+        EXPECT(compressedSizes[1] <= compressedSizes[0]) << "LZ4HC should compress at least as well as LZ4";
+    }
+
+    CPU_TEST(BlockCompressedStreamThroughput)
+    {
+        // Kept small so that the test suite stays fast. Increase the size for more stable numbers.
+        const size_t kSize = 32 * 1024 * 1024;
+        auto data = generateData(kSize, 0);
+
+        // Baseline: single LZ4 frame stream as used by the scene cache before.
+        {
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            std::ostringstream os;
+            {
+                lz4_stream::basic_ostream<BlockCompressedOutputStream::kDefaultBlockSize> zs(os);
+                zs.write(data.data(), data.size());
+            }
+            auto t1 = CpuTimer::getCurrentTimePoint();
+            std::istringstream is(os.str());
+            std::vector<char> result(kSize);
+            auto t2 = CpuTimer::getCurrentTimePoint();
+            {
+                lz4_stream::basic_istream<BlockCompressedOutputStream::kDefaultBlockSize, BlockCompressedOutputStream::kDefaultBlockSize> zs(is);
+                zs.read(result.data(), result.size());
+            }
+            auto t3 = CpuTimer::getCurrentTimePoint();
+            EXPECT(result == data);
+            logInfo("lz4_stream: compress {:.0f} MB/s, decompress {:.0f} MB/s, ratio {:.2f}",
+                toMBs(kSize, CpuTimer::calcDuration(t0, t1) / 1000.0), toMBs(kSize, CpuTimer::calcDuration(t2, t3) / 1000.0), (double)kSize / os.str().size());
+        }
+
+        for (auto codec : { BlockCodec::LZ4, BlockCodec::LZ4HC })
+        {
+            auto t0 = CpuTimer::getCurrentTimePoint();
+            auto compressed = compress(data, codec, BlockCompressedOutputStream::kDefaultBlockSize);
+            auto t1 = CpuTimer::getCurrentTimePoint();
+            auto result = decompress(compressed, kSize);
+            auto t2 = CpuTimer::getCurrentTimePoint();
+            EXPECT(result == data);
+            logInfo("BlockCompressedStream ({}, {} threads): compress {:.0f} MB/s, decompress {:.0f} MB/s, ratio {:.2f}",
+                codec == BlockCodec::LZ4 ? "LZ4" : "LZ4HC", Threading::getThreadCount(),
+                toMBs(kSize, CpuTimer::calcDuration(t0, t1) / 1000.0), toMBs(kSize, CpuTimer::calcDuration(t1, t2) / 1000.0), (double)kSize / compressed.size());
+        }
+    }
+}
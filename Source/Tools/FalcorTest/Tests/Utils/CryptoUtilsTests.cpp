@@ -31,6 +31,22 @@
 
 namespace Falcor
 {
+    namespace
+    {
+        std::vector<uint8_t> generateRandomData(size_t size, uint32_t seed)
+        {
+            std::mt19937 rng(seed);
+            std::vector<uint8_t> data(size);
+            for (auto& v : data) v = (uint8_t)rng();
+            return data;
+        }
+
+        double toGBs(size_t bytes, double seconds)
+        {
+            return (double)bytes / (1024.0 * 1024.0 * 1024.0) / std::max(seconds, 1e-9);
+        }
+    }
+
     CPU_TEST(SHA1)
     {
         {
@@ -55,4 +71,101 @@ namespace Falcor
             EXPECT(SHA1::compute(str.data(), str.size()) == md);
         }
     }
+
+    CPU_TEST(Hash128)
+    {
+        {
+            std::string str1{"Hello "};
+            std::string str2{"World!"};
+            Hash128::MD md{0x12, 0x00, 0xda, 0xec, 0x44, 0xca, 0xb1, 0xf9, 0x93, 0x39, 0xa5, 0xb8, 0xe7, 0xde, 0x26, 0x98};
+            Hash128 hash;
+            hash.update(str1.data(), str1.size());
+            hash.update(str2.data(), str2.size());
+            EXPECT(hash.final() == md);
+            EXPECT_EQ(Hash128::toString(md), std::string("1200daec44cab1f99339a5b8e7de2698"));
+        }
+
+        {
+            std::string str{"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum."};
+            Hash128::MD md{0x15, 0x1d, 0x82, 0x0e, 0xac, 0xe8, 0xf7, 0x86, 0x76, 0x02, 0x50, 0xc3, 0x8e, 0xe2, 0x00, 0x50};
+            EXPECT(Hash128::compute(str.data(), str.size()) == md);
+        }
+
+        // Streaming, serial and parallel hashing must agree for sizes around the stripe, block and chunk boundaries.
+        auto data = generateRandomData(3 * Hash128::kChunkSize + 123, 0);
+        for (size_t size : std::initializer_list<size_t>{ 0, 1, 63, 64, 65, 1023, 1024, 1025, 5000, Hash128::kChunkSize, Hash128::kChunkSize + 1, 3 * Hash128::kChunkSize, data.size() })
+        {
+            auto md = Hash128::compute(data.data(), size);
+            EXPECT(Hash128::computeParallel(data.data(), size) == md) << "size=" << size;
+
+            Hash128 hash;
+            size_t offset = 0;
+            size_t step = 1;
+            while (offset < size)
+            {
+                size_t count = std::min(step, size - offset);
+                hash.update(data.data() + offset, count);
+                offset += count;
+                step = step * 3 + 7;
+            }
+            EXPECT(hash.final() == md) << "size=" << size;
+        }
+
+        // Zero padding of the last stripe must not cause collisions.
+        uint8_t zeros[8] = {};
+        EXPECT(Hash128::compute(zeros, 3) != Hash128::compute(zeros, 4));
+
+        // Flipping any bit must change the digest.
+        auto block = generateRandomData(256, 1);
+        auto md = Hash128::compute(block.data(), block.size());
+        for (size_t i = 0; i < block.size() * 8; i++)
+        {
+            block[i / 8] ^= 1 << (i % 8);
+            EXPECT(Hash128::compute(block.data(), block.size()) != md) << "bit=" << i;
+            block[i / 8] ^= 1 << (i % 8);
+        }
+    }
+
+    CPU_TEST(Hash128ManyChunks)
+    {
+        // Use more chunks than worker threads so that the chunk digests are computed out of order.
+        auto data = generateRandomData(17 * Hash128::kChunkSize + 5, 0);
+        auto md = Hash128::compute(data.data(), data.size());
+        EXPECT(Hash128::computeParallel(data.data(), data.size()) == md);
+
+        Hash128 hash;
+        for (size_t offset = 0; offset < data.size(); offset += 100003)
+        {
+            hash.update(data.data() + offset, std::min<size_t>(100003, data.size() - offset));
+        }
+        EXPECT(hash.final() == md);
+
+        // Changes in any chunk must change the digest.
+        for (size_t offset : { size_t(0), 8 * Hash128::kChunkSize + 17, data.size() - 1 })
+        {
+            data[offset] ^= 1;
+            EXPECT(Hash128::computeParallel(data.data(), data.size()) != md) << "offset=" << offset;
+            data[offset] ^= 1;
+        }
+    }
+
+    CPU_TEST(Hash128Throughput)
+    {
+        // Kept small so that the test suite stays fast. Increase the size for more stable numbers.
+        const size_t kSize = 64 * 1024 * 1024;
+        auto data = generateRandomData(kSize, 0);
+
+        auto t0 = CpuTimer::getCurrentTimePoint();
+        SHA1::compute(data.data(), data.size());
+        auto t1 = CpuTimer::getCurrentTimePoint();
+        auto serial = Hash128::compute(data.data(), data.size());
+        auto t2 = CpuTimer::getCurrentTimePoint();
+        auto parallel = Hash128::computeParallel(data.data(), data.size());
+        auto t3 = CpuTimer::getCurrentTimePoint();
+
+        EXPECT(parallel == serial);
+        logInfo("SHA1: {:.2f} GB/s, Hash128: {:.2f} GB/s, Hash128 parallel ({} threads): {:.2f} GB/s",
+            toGBs(kSize, CpuTimer::calcDuration(t0, t1) / 1000.0), toGBs(kSize, CpuTimer::calcDuration(t1, t2) / 1000.0),
+            Threading::getThreadCount(), toGBs(kSize, CpuTimer::calcDuration(t2, t3) / 1000.0));
+    }
 }
@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/DiskCache.h"
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::filesystem::path createTempDirectory()
+        {
+            std::random_device rd;
+            auto path = std::filesystem::temp_directory_path() / fmt::format("FalcorDiskCacheTest{:08x}", rd());
+            std::filesystem::remove_all(path);
+            return path;
+        }
+
+        void writeEntry(DiskCache& cache, const std::string& name, size_t size)
+        {
+            auto tempPath = cache.createTempPath(name);
+            std::ofstream(tempPath, std::ios::binary) << std::string(size, 'x');
+            cache.commit(name, tempPath);
+        }
+    }
+
+    CPU_TEST(DiskCache_Commit)
+    {
+        auto directory = createTempDirectory();
+        {
+            auto pCache = DiskCache::create(directory, 1000);
+            EXPECT(!pCache->touch("a"));
+
+            // Uncommitted entries are not visible.
+            auto tempPath = pCache->createTempPath("a");
+            std::ofstream(tempPath, std::ios::binary) << "data";
+            EXPECT(!pCache->touch("a"));
+            EXPECT(pCache->commit("a", tempPath));
+            EXPECT(pCache->touch("a"));
+            EXPECT(!std::filesystem::exists(tempPath));
+            EXPECT_EQ(pCache->getStats().entryCount, 1);
+            EXPECT_EQ(pCache->getStats().totalSize, 4);
+
+            // Committing again replaces the entry.
+            writeEntry(*pCache, "a", 10);
+            EXPECT_EQ(pCache->getStats().entryCount, 1);
+            EXPECT_EQ(pCache->getStats().totalSize, 10);
+
+            // Entries committed through another object sharing the directory are visible.
+            auto pCache2 = DiskCache::create(directory, 1000);
+            writeEntry(*pCache2, "b", 10);
+            EXPECT(pCache->touch("b"));
+            EXPECT_EQ(pCache->getStats().entryCount, 2);
+
+            pCache->remove("b");
+            EXPECT(!pCache2->touch("b"));
+        }
+        std::filesystem::remove_all(directory);
+    }
+
+    CPU_TEST(DiskCache_Eviction)
+    {
+        auto directory = createTempDirectory();
+        {
+            auto pCache = DiskCache::create(directory, 1000);
+            for (uint32_t i = 0; i < 20; i++)
+            {
+                writeEntry(*pCache, std::to_string(i), 100);
+                // Keep the first entry in use.
+                EXPECT(pCache->touch("0"));
+            }
+
+            auto stats = pCache->getStats();
+            EXPECT_GT(stats.evictions, 0);
+            EXPECT_LE(stats.totalSize, 1000);
+            EXPECT(pCache->touch("0"));
+            EXPECT(!pCache->touch("1"));
+            EXPECT(pCache->touch("19"));
+
+            // An entry exceeding the size limit on its own is kept until the next commit.
+            writeEntry(*pCache, "large", 2000);
+            EXPECT(pCache->touch("large"));
+            EXPECT(!pCache->touch("0"));
+
+            pCache->clear();
+            EXPECT_EQ(pCache->getStats().entryCount, 0);
+            EXPECT(!pCache->touch("large"));
+        }
+        std::filesystem::remove_all(directory);
+    }
+}
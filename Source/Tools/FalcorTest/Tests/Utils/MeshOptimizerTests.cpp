@@ -0,0 +1,485 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/MeshOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Triangle = std::array<uint32_t, 3>;
+
+        /** Creates a regular grid of n x n quads with two triangles each, and returns its vertex count.
+        */
+        uint32_t createGrid(uint32_t n, std::vector<uint32_t>& indices)
+        {
+            indices.clear();
+            for (uint32_t y = 0; y < n; y++)
+            {
+                for (uint32_t x = 0; x < n; x++)
+                {
+                    uint32_t i0 = y * (n + 1) + x;
+                    uint32_t i1 = i0 + 1;
+                    uint32_t i2 = i0 + n + 1;
+                    uint32_t i3 = i2 + 1;
+                    indices.insert(indices.end(), { i0, i1, i2, i1, i3, i2 });
+                }
+            }
+            return (n + 1) * (n + 1);
+        }
+
+        std::vector<Triangle> getTriangles(const std::vector<uint32_t>& indices)
+        {
+            std::vector<Triangle> triangles(indices.size() / 3);
+            for (size_t i = 0; i < triangles.size(); i++) triangles[i] = { indices[3 * i], indices[3 * i + 1], indices[3 * i + 2] };
+            return triangles;
+        }
+
+        /** Creates a UV sphere with n segments around the equator, and returns its positions.
+        */
+        std::vector<float3> createSphere(uint32_t n, std::vector<uint32_t>& indices)
+        {
+            std::vector<float3> positions;
+            indices.clear();
+            const uint32_t rows = n / 2;
+            for (uint32_t y = 0; y <= rows; y++)
+            {
+                for (uint32_t x = 0; x <= n; x++)
+                {
+                    float theta = (float)M_PI * y / rows;
+                    float phi = 2.f * (float)M_PI * x / n;
+                    positions.push_back(float3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+                }
+            }
+            for (uint32_t y = 0; y < rows; y++)
+            {
+                for (uint32_t x = 0; x < n; x++)
+                {
+                    uint32_t i0 = y * (n + 1) + x;
+                    uint32_t i1 = i0 + 1;
+                    uint32_t i2 = i0 + n + 1;
+                    uint32_t i3 = i2 + 1;
+                    indices.insert(indices.end(), { i0, i2, i1, i1, i2, i3 });
+                }
+            }
+            return positions;
+        }
+
+        /** Merges vertices with the same position and removes the resulting degenerate triangles.
+        */
+        void weldVertices(const std::vector<float3>& positions, std::vector<uint32_t>& indices)
+        {
+            std::vector<uint32_t> remap(positions.size());
+            for (uint32_t i = 0; i < (uint32_t)positions.size(); i++)
+            {
+                remap[i] = i;
+                for (uint32_t j = 0; j < i; j++)
+                {
+                    if (glm::length(positions[j] - positions[i]) < 1e-5f)
+                    {
+                        remap[i] = j;
+                        break;
+                    }
+                }
+            }
+
+            std::vector<uint32_t> welded;
+            for (auto tri : getTriangles(indices))
+            {
+                for (auto& v : tri) v = remap[v];
+                if (tri[0] != tri[1] && tri[1] != tri[2] && tri[2] != tri[0]) welded.insert(welded.end(), tri.begin(), tri.end());
+            }
+            indices = std::move(welded);
+        }
+
+        /** Returns the mesh triangles of a meshlet list.
+        */
+        std::vector<Triangle> getMeshletTriangles(const MeshOptimizer::MeshletList& list, const MeshOptimizer::Meshlet& meshlet)
+        {
+            std::vector<Triangle> triangles(meshlet.triangleCount);
+            for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+            {
+                const uint32_t packed = list.triangles[meshlet.triangleOffset + t];
+                for (uint32_t j = 0; j < 3; j++) triangles[t][j] = list.vertices[meshlet.vertexOffset + ((packed >> (8 * j)) & 0xff)];
+            }
+            return triangles;
+        }
+
+        void shuffleTriangles(std::vector<uint32_t>& indices, uint32_t seed)
+        {
+            auto triangles = getTriangles(indices);
+            std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+            for (size_t i = 0; i < triangles.size(); i++) std::copy(triangles[i].begin(), triangles[i].end(), indices.begin() + 3 * i);
+        }
+    }
+
+    CPU_TEST(MeshOptimizer_AnalyzeVertexCache)
+    {
+        // A single triangle transforms all its vertices.
+        {
+            std::vector<uint32_t> indices = { 0, 1, 2 };
+            auto stats = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), 3);
+            EXPECT_EQ(stats.triangleCount, 1);
+            EXPECT_EQ(stats.vertexCount, 3);
+            EXPECT_EQ(stats.transformedVertexCount, 3);
+            EXPECT_EQ(stats.getACMR(), 3.0);
+            EXPECT_EQ(stats.getATVR(), 1.0);
+        }
+
+        // Two triangles sharing an edge transform four vertices.
+        {
+            std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+            auto stats = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), 4);
+            EXPECT_EQ(stats.triangleCount, 2);
+            EXPECT_EQ(stats.vertexCount, 4);
+            EXPECT_EQ(stats.transformedVertexCount, 4);
+        }
+
+        // With a cache of three entries, vertex 0 is evicted by vertex 3 before it is used again (FIFO).
+        {
+            std::vector<uint32_t> indices = { 0, 1, 2, 1, 2, 3, 3, 2, 0 };
+            auto stats = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), 4, 3);
+            EXPECT_EQ(stats.transformedVertexCount, 5);
+            stats = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), 4, 4);
+            EXPECT_EQ(stats.transformedVertexCount, 4);
+        }
+
+        // Unreferenced vertices are not counted.
+        {
+            std::vector<uint32_t> indices = { 0, 2, 4 };
+            auto stats = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), 5);
+            EXPECT_EQ(stats.vertexCount, 3);
+        }
+    }
+
+    CPU_TEST(MeshOptimizer_OptimizeVertexCache)
+    {
+        std::vector<uint32_t> indices;
+        const uint32_t vertexCount = createGrid(64, indices);
+        shuffleTriangles(indices, 1);
+
+        const auto triangles = getTriangles(indices);
+        const auto before = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+        MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+        const auto after = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+        // The result must contain the same triangles with the same vertex order.
+        auto expected = triangles;
+        auto result = getTriangles(indices);
+        std::sort(expected.begin(), expected.end());
+        std::sort(result.begin(), result.end());
+        EXPECT(expected == result);
+
+        // A randomly ordered grid is close to the worst case, an optimized grid should be well below one miss per triangle.
+        EXPECT_GT(before.getACMR(), 2.5);
+        EXPECT_LT(after.getACMR(), 0.8);
+        EXPECT_EQ(before.vertexCount, after.vertexCount);
+    }
+
+    CPU_TEST(MeshOptimizer_OptimizeVertexCacheDegenerate)
+    {
+        std::vector<uint32_t> indices = { 0, 0, 0, 0, 1, 1, 1, 0, 2 };
+        auto expected = getTriangles(indices);
+
+        MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), 3);
+
+        auto result = getTriangles(indices);
+        std::sort(expected.begin(), expected.end());
+        std::sort(result.begin(), result.end());
+        EXPECT(expected == result);
+
+        // Invalid input.
+        bool caught = false;
+        try
+        {
+            MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), 2);
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+
+    CPU_TEST(MeshOptimizer_VertexFetchRemap)
+    {
+        std::vector<uint32_t> indices = { 4, 2, 0, 0, 2, 5 };
+        const auto remap = MeshOptimizer::computeVertexFetchRemap(indices.data(), indices.size(), 6);
+
+        // Referenced vertices are numbered in order of first use, unreferenced vertices are placed last in their original order.
+        std::vector<uint32_t> expected = { 2, 4, 1, 5, 0, 3 };
+        EXPECT(remap == expected);
+
+        // Remapping does not change the cache efficiency.
+        std::vector<uint32_t> gridIndices;
+        const uint32_t vertexCount = createGrid(16, gridIndices);
+        shuffleTriangles(gridIndices, 2);
+        const auto before = MeshOptimizer::analyzeVertexCache(gridIndices.data(), gridIndices.size(), vertexCount);
+
+        const auto gridRemap = MeshOptimizer::computeVertexFetchRemap(gridIndices.data(), gridIndices.size(), vertexCount);
+        uint32_t maxIndex = 0;
+        bool firstUseOrder = true;
+        for (auto& index : gridIndices)
+        {
+            index = gridRemap[index];
+            firstUseOrder = firstUseOrder && index <= maxIndex;
+            maxIndex = std::max(maxIndex, index + 1);
+        }
+        EXPECT(firstUseOrder);
+
+        const auto after = MeshOptimizer::analyzeVertexCache(gridIndices.data(), gridIndices.size(), vertexCount);
+        EXPECT_EQ(before.transformedVertexCount, after.transformedVertexCount);
+    }
+
+    CPU_TEST(MeshOptimizer_BuildMeshlets)
+    {
+        std::vector<uint32_t> indices;
+        const auto positions = createSphere(128, indices);
+        MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), (uint32_t)positions.size());
+
+        const auto list = MeshOptimizer::buildMeshlets(indices.data(), indices.size(), positions.data(), sizeof(float3), (uint32_t)positions.size());
+        EXPECT_GT(list.meshlets.size(), 0);
+
+        std::vector<Triangle> triangles;
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> dist(-4.f, 4.f);
+        uint32_t culledCount = 0;
+
+        for (const auto& meshlet : list.meshlets)
+        {
+            EXPECT(meshlet.vertexCount >= 3 && meshlet.vertexCount <= MeshOptimizer::kDefaultMeshletMaxVertices);
+            EXPECT(meshlet.triangleCount >= 1 && meshlet.triangleCount <= MeshOptimizer::kDefaultMeshletMaxTriangles);
+
+            // All vertices are inside the bounds.
+            for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+            {
+                const float3 p = positions[list.vertices[meshlet.vertexOffset + i]];
+                EXPECT(p.x >= meshlet.boundsMin.x && p.y >= meshlet.boundsMin.y && p.z >= meshlet.boundsMin.z);
+                EXPECT(p.x <= meshlet.boundsMax.x && p.y <= meshlet.boundsMax.y && p.z <= meshlet.boundsMax.z);
+            }
+
+            // The normal cone test is conservative, i.e. all triangles of a culled meshlet are backfacing.
+            const auto meshletTriangles = getMeshletTriangles(list, meshlet);
+            for (uint32_t i = 0; i < 100; i++)
+            {
+                const float3 eye(dist(rng), dist(rng), dist(rng));
+                if (glm::dot(glm::normalize(meshlet.coneApex - eye), meshlet.coneAxis) < meshlet.coneCutoff) continue;
+                culledCount++;
+                for (const auto& tri : meshletTriangles)
+                {
+                    // Skip the degenerate triangles at the poles.
+                    const float3 n = glm::cross(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+                    if (glm::length(n) == 0.f) continue;
+                    EXPECT_LE(glm::dot(eye - positions[tri[0]], glm::normalize(n)), 1e-4f);
+                }
+            }
+
+            triangles.insert(triangles.end(), meshletTriangles.begin(), meshletTriangles.end());
+        }
+        EXPECT_GT(culledCount, 0);
+
+        // The meshlets contain every triangle exactly once with the original winding.
+        auto expected = getTriangles(indices);
+        std::sort(expected.begin(), expected.end());
+        std::sort(triangles.begin(), triangles.end());
+        EXPECT(expected == triangles);
+    }
+
+    CPU_TEST(MeshOptimizer_BuildMeshletsLimits)
+    {
+        std::vector<uint32_t> indices;
+        const uint32_t vertexCount = createGrid(8, indices);
+        std::vector<float3> positions(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++) positions[i] = float3((float)(i % 9), (float)(i / 9), 0.f);
+
+        // One triangle per meshlet.
+        auto list = MeshOptimizer::buildMeshlets(indices.data(), indices.size(), positions.data(), sizeof(float3), vertexCount, 3, 1);
+        EXPECT_EQ(list.meshlets.size(), indices.size() / 3);
+        EXPECT_EQ(list.vertices.size(), indices.size());
+
+        // A flat grid has a normal cone with zero angle.
+        list = MeshOptimizer::buildMeshlets(indices.data(), indices.size(), positions.data(), sizeof(float3), vertexCount);
+        for (const auto& meshlet : list.meshlets)
+        {
+            EXPECT_LE(meshlet.vertexCount, MeshOptimizer::kDefaultMeshletMaxVertices);
+            EXPECT_EQ(meshlet.coneAxis.z, 1.f);
+            EXPECT_LT(meshlet.coneCutoff, 1e-3f);
+        }
+
+        // Invalid limits.
+        bool caught = false;
+        try
+        {
+            MeshOptimizer::buildMeshlets(indices.data(), indices.size(), positions.data(), sizeof(float3), vertexCount, MeshOptimizer::kMaxMeshletVertices + 1, 1);
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+    }
+
+    CPU_TEST(MeshOptimizer_SimplifyFlat)
+    {
+        // Flat grid with a UV seam along the middle column. The vertices on the seam are duplicated for the right half.
+        const uint32_t n = 32;
+        std::vector<uint32_t> indices;
+        uint32_t vertexCount = createGrid(n, indices);
+        std::vector<float3> positions(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++) positions[i] = float3((float)(i % (n + 1)), (float)(i / (n + 1)), 0.f);
+
+        std::vector<uint32_t> seamVertices;
+        for (uint32_t y = 0; y <= n; y++)
+        {
+            seamVertices.push_back(y * (n + 1) + n / 2);
+            positions.push_back(positions[seamVertices.back()]);
+            seamVertices.push_back(vertexCount++);
+        }
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const bool rightHalf = positions[indices[i]].x + positions[indices[i + 1]].x + positions[indices[i + 2]].x > 1.5f * n;
+            for (uint32_t j = 0; rightHalf && j < 3; j++)
+            {
+                if (positions[indices[i + j]].x == (float)(n / 2)) indices[i + j] = vertexCount - (n + 1) + indices[i + j] / (n + 1);
+            }
+        }
+
+        // Nothing to do if the target is not below the index count.
+        float error = -1.f;
+        auto result = MeshOptimizer::simplify(indices.data(), indices.size(), positions.data(), sizeof(float3), vertexCount, indices.size(), 0.f, &error);
+        EXPECT(result == indices);
+        EXPECT_EQ(error, 0.f);
+
+        // The interior of a flat grid can be removed without error.
+        const size_t target = indices.size() / 4;
+        result = MeshOptimizer::simplify(indices.data(), indices.size(), positions.data(), sizeof(float3), vertexCount, target, 1e-4f, &error);
+        EXPECT_LE(result.size(), target);
+        EXPECT_EQ(result.size() % 3, 0);
+        EXPECT_LE(error, 1e-4f);
+
+        // No triangle is flipped or degenerate, and the total area is unchanged.
+        float area = 0.f;
+        std::vector<bool> referenced(vertexCount, false);
+        for (const auto& tri : getTriangles(result))
+        {
+            const float3 normal = glm::cross(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+            EXPECT_GT(normal.z, 0.f);
+            area += 0.5f * normal.z;
+            for (uint32_t v : tri) referenced[v] = true;
+        }
+        EXPECT_LT(std::abs(area - (float)(n * n)), 1e-2f);
+
+        // The seam vertices on both sides are kept.
+        for (uint32_t v : seamVertices) EXPECT(referenced[v]);
+    }
+
+    CPU_TEST(MeshOptimizer_SimplifySphere)
+    {
+        // Closed sphere without seams, so that no vertices are locked.
+        std::vector<uint32_t> indices;
+        const auto positions = createSphere(64, indices);
+        const uint32_t vertexCount = (uint32_t)positions.size();
+        weldVertices(positions, indices);
+
+        // A tight error bound prevents simplification of the curved surface.
+        float error = 0.f;
+        auto result = MeshOptimizer::simplify(indices.data(), indices.size(), positions.data(), sizeof(float3), vertexCount, indices.size() / 10, 1e-6f, &error);
+        EXPECT_GT(result.size(), indices.size() / 2);
+        EXPECT_LE(error, 1e-6f);
+
+        // Successive targets give increasing errors.
+        float prevError = 0.f;
+        for (size_t divisor : { 4, 10, 20 })
+        {
+            const size_t target = indices.size() / divisor / 3 * 3;
+            result = MeshOptimizer::simplify(indices.data(), indices.size(), positions.data(), sizeof(float3), vertexCount, target, 1.f, &error);
+            EXPECT_LE(result.size(), target);
+            EXPECT_GT(error, prevError);
+            EXPECT_LT(error, 0.1f);
+            prevError = error;
+
+            for (const auto& tri : getTriangles(result))
+            {
+                EXPECT(tri[0] != tri[1] && tri[1] != tri[2] && tri[2] != tri[0]);
+            }
+        }
+    }
+
+    CPU_TEST(MeshOptimizer_FindRigidTransform)
+    {
+        std::vector<uint32_t> indices;
+        const auto positions = createSphere(16, indices);
+        const size_t count = positions.size();
+
+        // Rotate and translate a copy of the sphere.
+        const float3 u = glm::normalize(float3(1.f, 2.f, 3.f));
+        const float3 v = glm::normalize(glm::cross(u, float3(0.f, 0.f, 1.f)));
+        const glm::mat3 rotation(u, v, glm::cross(u, v));
+        const float3 translation(100.f, -20.f, 5.f);
+
+        std::vector<float3> copy(count);
+        for (size_t i = 0; i < count; i++) copy[i] = rotation * positions[i] + translation;
+
+        glm::mat4 transform;
+        EXPECT(MeshOptimizer::findRigidTransform(positions.data(), copy.data(), sizeof(float3), count, 1e-5f, transform));
+        for (size_t i = 0; i < count; i++)
+        {
+            const float4 p = transform * float4(positions[i], 1.f);
+            EXPECT_LT(glm::length(float3(p.x, p.y, p.z) - copy[i]), 1e-4f);
+        }
+
+        // Identical copies give an identity transform.
+        EXPECT(MeshOptimizer::findRigidTransform(positions.data(), positions.data(), sizeof(float3), count, 1e-5f, transform));
+        for (size_t i = 0; i < count; i++)
+        {
+            const float4 p = transform * float4(positions[i], 1.f);
+            EXPECT_LT(glm::length(float3(p.x, p.y, p.z) - positions[i]), 1e-5f);
+        }
+
+        // Reflections, scaling and deformations are rejected.
+        std::vector<float3> other(count);
+        for (size_t i = 0; i < count; i++) other[i] = float3(-copy[i].x, copy[i].y, copy[i].z);
+        EXPECT(!MeshOptimizer::findRigidTransform(positions.data(), other.data(), sizeof(float3), count, 1e-5f, transform));
+
+        for (size_t i = 0; i < count; i++) other[i] = copy[i] * 1.01f;
+        EXPECT(!MeshOptimizer::findRigidTransform(positions.data(), other.data(), sizeof(float3), count, 1e-5f, transform));
+
+        other = copy;
+        other[count / 2] = other[count / 2] + float3(0.01f, 0.f, 0.f);
+        EXPECT(!MeshOptimizer::findRigidTransform(positions.data(), other.data(), sizeof(float3), count, 1e-5f, transform));
+        EXPECT(MeshOptimizer::findRigidTransform(positions.data(), other.data(), sizeof(float3), count, 0.02f, transform));
+
+        // Collinear points don't define a rotation.
+        const std::vector<float3> line = { float3(0.f), float3(1.f, 0.f, 0.f), float3(2.f, 0.f, 0.f) };
+        EXPECT(!MeshOptimizer::findRigidTransform(line.data(), line.data(), sizeof(float3), line.size(), 1e-5f, transform));
+    }
+}
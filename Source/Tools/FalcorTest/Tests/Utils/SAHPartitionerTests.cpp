@@ -0,0 +1,176 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/SAHPartitioner.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using namespace SAHPartitioner;
+
+        /** Creates an n x n grid of unit cubes in the xz-plane with a gap between them.
+        */
+        std::vector<Item> createGrid(uint32_t n, uint64_t triangleCount)
+        {
+            std::vector<Item> items;
+            for (uint32_t z = 0; z < n; z++)
+            {
+                for (uint32_t x = 0; x < n; x++)
+                {
+                    float3 p = float3(x * 1.5f, 0.f, z * 1.5f);
+                    items.push_back({ AABB(p, p + float3(1.f)), triangleCount });
+                }
+            }
+            return items;
+        }
+
+        /** Checks that each item is in exactly one group and that the groups respect the triangle limit.
+        */
+        void checkPartition(CPUUnitTestContext& ctx, const std::vector<Item>& items, const Partition& partition, uint64_t maxTriangleCount)
+        {
+            std::vector<uint32_t> itemGroupCount(items.size(), 0);
+            for (const auto& group : partition.groups)
+            {
+                EXPECT(!group.empty());
+                EXPECT(std::is_sorted(group.begin(), group.end()));
+
+                uint64_t triangleCount = 0;
+                for (uint32_t i : group)
+                {
+                    itemGroupCount[i]++;
+                    triangleCount += items[i].triangleCount;
+                }
+                if (group.size() > 1) EXPECT_LE(triangleCount, maxTriangleCount);
+            }
+            for (uint32_t count : itemGroupCount) EXPECT_EQ(count, 1u);
+        }
+    }
+
+    CPU_TEST(SAHPartitioner_NoSplit)
+    {
+        std::vector<Item> items = createGrid(4, 100);
+        Partition partition = SAHPartitioner::partition(items.data(), items.size(), 1600);
+
+        EXPECT_EQ(partition.groups.size(), 1u);
+        checkPartition(ctx, items, partition, 1600);
+        EXPECT_EQ(partition.cost, 1.0);
+        EXPECT_EQ(partition.overlap, 0.0);
+
+        partition = SAHPartitioner::partition(nullptr, 0, 1600);
+        EXPECT(partition.groups.empty());
+    }
+
+    CPU_TEST(SAHPartitioner_Grid)
+    {
+        // Each quarter of the grid fits in a group. The split planes fall in the gaps between the cubes.
+        std::vector<Item> items = createGrid(8, 100);
+        Partition partition = SAHPartitioner::partition(items.data(), items.size(), 1600);
+
+        EXPECT_EQ(partition.groups.size(), 4u);
+        checkPartition(ctx, items, partition, 1600);
+        EXPECT_LT(partition.cost, 0.5);
+        EXPECT_EQ(partition.overlap, 0.0);
+
+        // A partition in item order (pairs of rows of the grid) has no overlap either, but a higher cost.
+        Partition rows;
+        rows.groups.resize(4);
+        for (uint32_t i = 0; i < (uint32_t)items.size(); i++) rows.groups[i / 16].push_back(i);
+        SAHPartitioner::evaluate(items.data(), items.size(), rows);
+        EXPECT_EQ(rows.overlap, 0.0);
+        EXPECT_GT(rows.cost, partition.cost);
+    }
+
+    CPU_TEST(SAHPartitioner_LargeItem)
+    {
+        // An item above the limit is placed in a group by itself.
+        std::vector<Item> items = createGrid(4, 100);
+        items[5].triangleCount = 1000;
+        Partition partition = SAHPartitioner::partition(items.data(), items.size(), 400);
+
+        checkPartition(ctx, items, partition, 400);
+        auto it = std::find_if(partition.groups.begin(), partition.groups.end(), [](const auto& group) { return group[0] == 5 || (group.size() > 1 && group[1] == 5); });
+        EXPECT(it != partition.groups.end());
+        if (it != partition.groups.end()) EXPECT_EQ(it->size(), 1u);
+    }
+
+    CPU_TEST(SAHPartitioner_CoincidentItems)
+    {
+        // Items with the same centroid are split by triangle count.
+        std::vector<Item> items(4, { AABB(float3(0.f), float3(1.f)), 100 });
+        Partition partition = SAHPartitioner::partition(items.data(), items.size(), 200);
+
+        EXPECT_EQ(partition.groups.size(), 2u);
+        checkPartition(ctx, items, partition, 200);
+        EXPECT_EQ(partition.cost, 1.0);
+        EXPECT_EQ(partition.overlap, 1.0);
+    }
+
+    CPU_TEST(SAHPartitioner_Random)
+    {
+        // Random boxes in a cube. The SAH partition should beat a partition in item order.
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+        std::uniform_int_distribution<uint64_t> triangles(1, 1000);
+
+        std::vector<Item> items(1000);
+        uint64_t totalTriangleCount = 0;
+        for (auto& item : items)
+        {
+            float3 p = float3(u(rng), u(rng), u(rng)) * 100.f;
+            float3 e = float3(u(rng), u(rng), u(rng)) * 5.f;
+            item = { AABB(p, p + e), triangles(rng) };
+            totalTriangleCount += item.triangleCount;
+        }
+
+        const uint64_t maxTriangleCount = totalTriangleCount / 7;
+        Partition partition = SAHPartitioner::partition(items.data(), items.size(), maxTriangleCount);
+        checkPartition(ctx, items, partition, maxTriangleCount);
+        EXPECT_GE(partition.groups.size(), 8u);
+        EXPECT_LE(partition.groups.size(), 10u);
+
+        Partition ordered;
+        uint64_t triangleCount = 0;
+        for (uint32_t i = 0; i < (uint32_t)items.size(); i++)
+        {
+            if (ordered.groups.empty() || triangleCount + items[i].triangleCount > maxTriangleCount)
+            {
+                ordered.groups.emplace_back();
+                triangleCount = 0;
+            }
+            ordered.groups.back().push_back(i);
+            triangleCount += items[i].triangleCount;
+        }
+        SAHPartitioner::evaluate(items.data(), items.size(), ordered);
+
+        EXPECT_LT(partition.cost, ordered.cost);
+        EXPECT_LT(partition.overlap, ordered.overlap);
+    }
+}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCache.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        std::filesystem::path createTempDirectory()
+        {
+            std::random_device rd;
+            auto path = std::filesystem::temp_directory_path() / fmt::format("FalcorTextureCacheTest{:08x}", rd());
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+            return path;
+        }
+
+        void testTextureCache(GPUUnitTestContext& ctx, bool compress)
+        {
+            const uint32_t kSize = 64;
+            auto directory = createTempDirectory();
+            {
+                // Write a test image.
+                std::vector<uint8_t> image(kSize * kSize * 4);
+                for (size_t i = 0; i < image.size(); i++) image[i] = (uint8_t)((i * 37) ^ (i >> 7));
+                auto imagePath = directory / "image.png";
+                Bitmap::saveImage(imagePath, kSize, kSize, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, image.data());
+
+                auto pCache = TextureCache::create(directory / "cache", TextureCache::kDefaultSizeLimit, compress);
+
+                auto pCold = pCache->loadFromFile(imagePath, true, true, Resource::BindFlags::ShaderResource);
+                EXPECT(pCold != nullptr);
+                EXPECT_EQ(pCache->getStats().misses, 1);
+                EXPECT_EQ(pCache->getStats().hits, 0);
+
+                auto pWarm = pCache->loadFromFile(imagePath, true, true, Resource::BindFlags::ShaderResource);
+                EXPECT(pWarm != nullptr);
+                EXPECT_EQ(pCache->getStats().hits, 1);
+                if (!pCold || !pWarm) return;
+
+                EXPECT_EQ(pWarm->getWidth(), kSize);
+                EXPECT_EQ(pWarm->getHeight(), kSize);
+                EXPECT_EQ(pWarm->getMipCount(), pCold->getMipCount());
+                EXPECT(isSrgbFormat(pWarm->getFormat()));
+                EXPECT(pWarm->getSourcePath() == imagePath);
+
+                if (compress)
+                {
+                    // Mipmapped textures get extra bind flags, but compression only depends on the requested bind flags.
+                    EXPECT(isCompressedFormat(pWarm->getFormat()));
+                }
+                else
+                {
+                    // Uncompressed entries hold the exact texture data.
+                    EXPECT(pWarm->getFormat() == pCold->getFormat());
+                    for (uint32_t mip = 0; mip < pCold->getMipCount(); mip++)
+                    {
+                        auto cold = ctx.getRenderContext()->readTextureSubresource(pCold.get(), mip);
+                        auto warm = ctx.getRenderContext()->readTextureSubresource(pWarm.get(), mip);
+                        EXPECT(cold == warm) << "mip = " << mip;
+                    }
+                }
+
+                // Different load settings use separate entries.
+                auto pLinear = pCache->loadFromFile(imagePath, true, false, Resource::BindFlags::ShaderResource);
+                EXPECT(pLinear != nullptr);
+                EXPECT_EQ(pCache->getStats().misses, 2);
+            }
+            std::filesystem::remove_all(directory);
+        }
+    }
+
+    GPU_TEST(TextureCache_Uncompressed)
+    {
+        testTextureCache(ctx, false);
+    }
+
+    GPU_TEST(TextureCache_Compressed)
+    {
+        testTextureCache(ctx, true);
+    }
+}
@@ -0,0 +1,131 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+#include <atomic>
+
+namespace Falcor
+{
+    CPU_TEST(ThreadingTasks)
+    {
+        std::atomic<uint32_t> counter = 0;
+        std::vector<Threading::Task> tasks;
+        for (uint32_t i = 0; i < 1000; i++) tasks.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+        for (auto& task : tasks) task.finish();
+        EXPECT_EQ(counter.load(), 1000u);
+        for (auto& task : tasks) EXPECT(!task.isRunning());
+
+        // Continuations run after the task they are attached to.
+        std::atomic<uint32_t> value = 0;
+        auto first = Threading::dispatchTask([&value]() { value = 1; });
+        auto second = first.then([&value]() { value = value * 10; });
+        second.finish();
+        EXPECT_EQ(value.load(), 10u);
+
+        // Exceptions are rethrown when waiting for the task.
+        bool caught = false;
+        try
+        {
+            Threading::dispatchTask([]() { throw RuntimeError("Task failed"); }).finish();
+        }
+        catch (const RuntimeError&)
+        {
+            caught = true;
+        }
+        EXPECT(caught);
+
+        // Empty task handles are never running.
+        Threading::Task empty;
+        EXPECT(!empty.isValid());
+        EXPECT(!empty.isRunning());
+    }
+
+    CPU_TEST(ThreadingParallelFor)
+    {
+        const size_t kCount = 100000;
+        std::vector<uint32_t> data(kCount, 0);
+        Threading::parallelFor(0, kCount, [&data](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++) data[i] += (uint32_t)i;
+        });
+        for (size_t i = 0; i < kCount; i++) EXPECT_EQ(data[i], (uint32_t)i);
+
+        // Nested parallel loops dispatched from within tasks must not deadlock.
+        std::atomic<uint64_t> sum = 0;
+        auto task = Threading::dispatchTask([&sum]()
+        {
+            Threading::parallelFor(0, 1000, [&sum](size_t begin, size_t end)
+            {
+                Threading::parallelFor(begin, end, [&sum](size_t b, size_t e)
+                {
+                    for (size_t i = b; i < e; i++) sum += i;
+                }, 1);
+            }, 10);
+        });
+        task.finish();
+        EXPECT_EQ(sum.load(), 499500ull);
+    }
+
+    CPU_TEST(ThreadingParallelReduce)
+    {
+        const size_t kCount = 1000000;
+        auto map = [](size_t begin, size_t end)
+        {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; i++) sum += 1.0 / (double)(i + 1);
+            return sum;
+        };
+        auto reduce = [](double a, double b) { return a + b; };
+
+        // The result must be deterministic across runs.
+        double result = Threading::parallelReduce(0, kCount, 0.0, map, reduce);
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            EXPECT_EQ(result, Threading::parallelReduce(0, kCount, 0.0, map, reduce));
+        }
+        EXPECT_LT(std::abs(result - map(0, kCount)), 1e-9);
+
+        bool found = Threading::parallelReduce(0, kCount, false, [](size_t begin, size_t end) { return begin <= 777 && 777 < end; }, [](bool a, bool b) { return a || b; });
+        EXPECT(found);
+    }
+
+    CPU_TEST(ThreadingStats)
+    {
+        Threading::finish();
+        Threading::resetStats();
+        for (uint32_t i = 0; i < 100; i++) Threading::dispatchTask([]() {});
+        Threading::finish();
+
+        auto stats = Threading::getStats();
+        EXPECT_EQ(stats.threadCount, Threading::getThreadCount());
+        EXPECT_EQ(stats.tasksDispatched, 100ull);
+        EXPECT_EQ(stats.tasksExecuted, 100ull);
+        EXPECT_EQ(stats.queueDepth, 0ull);
+        EXPECT_EQ(stats.activeTasks, 0ull);
+    }
+}